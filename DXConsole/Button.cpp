@@ -87,11 +87,15 @@ void Button::OnMouseDown(const KeyState& keyState, const DirectX::XMFLOAT2& mous
 	if(keyState.key == MOUSE_BUTTON::LEFT && buttonState == ButtonStyle::BUTTON_STATES::HOVER)
 	{
 		background->ChangePreset(static_cast<int>(ButtonStyle::BUTTON_STATES::CLICK));
+		SetDirty();
 	}
 }
 
 void Button::OnMouseUp(const KeyState& keyState, const DirectX::XMFLOAT2& mousePosition)
 {
+	//Every branch changes the preset. Set before callbackFunction since it might remove this button
+	SetDirty();
+
 	if(area.Contains(mousePosition))
 	{
 		if(buttonState == ButtonStyle::BUTTON_STATES::CLICK)
@@ -116,11 +120,13 @@ void Button::OnMouseUp(const KeyState& keyState, const DirectX::XMFLOAT2& mouseP
 void Button::Highlight()
 {
 	background->ChangePreset(static_cast<int>(ButtonStyle::BUTTON_STATES::HOVER));
+	SetDirty();
 }
 
 void Button::UnHighlight()
 {
 	background->ChangePreset(static_cast<int>(ButtonStyle::BUTTON_STATES::NORMAL));
+	SetDirty();
 }
 
 void Button::SetCallbackFunction(std::function<void(std::string)> callbackFunction)
@@ -130,7 +136,9 @@ void Button::SetCallbackFunction(std::function<void(std::string)> callbackFuncti
 
 void Button::SetText(const std::string& text)
 {
-	this->text = this->style->characterSet->ConstructString(text);
+	this->style->characterSet->ConstructString(text, this->text);
+
+	SetDirty();
 }
 
 std::string Button::GetText() const
@@ -1,15 +1,13 @@
 #ifndef OPENGLWINDOW_PARAMETER_H
 #define OPENGLWINDOW_PARAMETER_H
 
-//This file is massive... Maybe one day I will figure out a way to shrink it
-//Made it smaller, but it's still pretty big
-
 #include <string>
-#include <sstream>
 #include <vector>
 #include <limits>
-
-#include <sstream>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <type_traits>
 
 #include <DirectXMath.h>
 
@@ -22,242 +20,231 @@ struct Argument
 {
 	enum class TYPE { NONE, BOOL, INT32, INT64, UINT64, FLOAT, DOUBLE, STRING, UNKNOWN };
 
-	Argument() 
-		: type(TYPE::NONE)
-	{}
-	Argument(const std::string& text)
-		: type(TYPE::STRING)
-	{
-		values.emplace_back(text);
-	}
-	Argument(const char* text)
-		: Argument(std::string(text))
-	{}
-	~Argument() = default;
-
-	Argument& operator=(const std::string& rhs)
+	//A single value of any TYPE. Numbers are kept as numbers and are only turned into text by ToString,
+	//so passing values between commands and doing arithmetic on them never goes through strings
+	class Value
 	{
-		origin = "";
-		values.emplace_back(rhs);
-		type = TYPE::STRING;
-
-		return *this;
-	}
-
-	Argument operator+(const Argument& rhs)
-	{
-		auto pair = ConvertToCompatibleTypes(rhs);
-
-		if(pair.first.values.size() != pair.second.values.size())
+	public:
+		Value()
+			: type(TYPE::NONE)
 		{
-			if(pair.first.values.size() == 1)
-				return pair.first; //1 + (1,2,3) doens't really make sense, so don't do anything
-			else if(pair.second.values.size() == 1)
-				pair.second = std::move(PadValues(pair.second, pair.first.values.size())); //(1,2,3) + 1 just adds 1 to each index
+			number.uint64Value = 0;
 		}
-
-		Argument returnArgument;
-		returnArgument.type = pair.first.type;
-		returnArgument.origin = pair.first.values.front() + " - " + pair.second.values.front();
-
-		returnArgument.values.resize(pair.first.values.size());
-
-		switch (pair.first.type)
+		explicit Value(bool value)
+			: type(TYPE::BOOL)
 		{
-		case TYPE::BOOL:
+			number.uint64Value = 0;
+			number.boolValue = value;
+		}
+		explicit Value(int32_t value)
+			: type(TYPE::INT32)
 		{
-			//Convert to double because then it works whether it's a double, int, or whatever
-			for(std::vector<std::string>::size_type i = 0, end = pair.first.values.size(); i < end; ++i)
-			{
-				double addVal = ParseType<double>(pair.second.values[i]);
-				//Adding > 0 to a bool will always make it 1
-				if(addVal > 0.0)
-					returnArgument.values[i] = "1";
-			}
-			break;
+			number.uint64Value = 0;
+			number.int32Value = value;
 		}
-		case TYPE::INT32:
-			returnArgument.values = std::move(AddTypeAndConvertToString<int32_t>(pair.first.values, pair.second.values));
-			break;
-		case TYPE::INT64:
-			returnArgument.values = std::move(AddTypeAndConvertToString<int64_t>(pair.first.values, pair.second.values));
-			break;
-		case TYPE::UINT64:
-			returnArgument.values = std::move(AddTypeAndConvertToString<uint32_t>(pair.first.values, pair.second.values));
-			break;
-		case TYPE::FLOAT:
-			returnArgument.values = std::move(AddTypeAndConvertToString<float>(pair.first.values, pair.second.values));
-			break;
-		case TYPE::DOUBLE:
-			returnArgument.values = std::move(AddTypeAndConvertToString<double>(pair.first.values, pair.second.values));
-			break;
-		case TYPE::STRING:
-			for(std::vector<std::string>::size_type i = 0, end = pair.first.values.size(); i < end; ++i)
-				returnArgument.values[i] = pair.first.values[i] + pair.second.values[i];
-			break;
-		default:
-			//Nothing to do for the rest
-			break;
+		explicit Value(int64_t value)
+			: type(TYPE::INT64)
+		{
+			number.int64Value = value;
 		}
+		explicit Value(uint64_t value)
+			: type(TYPE::UINT64)
+		{
+			number.uint64Value = value;
+		}
+		explicit Value(float value)
+			: type(TYPE::FLOAT)
+		{
+			number.uint64Value = 0;
+			number.floatValue = value;
+		}
+		explicit Value(double value)
+			: type(TYPE::DOUBLE)
+		{
+			number.doubleValue = value;
+		}
+		Value(const std::string& text)
+			: type(TYPE::STRING)
+			, text(text)
+		{
+			number.uint64Value = 0;
+		}
+		Value(std::string&& text)
+			: type(TYPE::STRING)
+			, text(std::move(text))
+		{
+			number.uint64Value = 0;
+		}
+		Value(const char* text)
+			: Value(std::string(text))
+		{}
+		~Value() = default;
 
-		return returnArgument;
-	}
-
-	Argument operator-(const Argument& rhs)
-	{
-		//Check operator+ for comments
-
-		auto pair = ConvertToCompatibleTypes(rhs);
+		TYPE GetType() const
+		{
+			return type;
+		}
 
-		if(pair.first.values.size() != pair.second.values.size())
+		bool IsNumber() const
 		{
-			if(pair.first.values.size() == 1)
-				return pair.first;
-			else if(pair.second.values.size() == 1)
-				pair.second = std::move(PadValues(pair.second, pair.first.values.size()));
+			return type != TYPE::NONE
+				&& type != TYPE::STRING
+				&& type != TYPE::UNKNOWN;
 		}
 
-		Argument returnArgument;
-		returnArgument.type = pair.first.type;
-		returnArgument.origin = pair.first.values.front() + " - " + pair.second.values.front();
+		//Converts the value to T. Strings are parsed, anything that can't be parsed becomes 0
+		template<typename T>
+		T As() const
+		{
+			static_assert(std::is_arithmetic<T>::value, "Value can only be converted to arithmetic types, use ToString for text");
 
-		returnArgument.values.resize(pair.first.values.size());
+			//Anything above 0 is true, same as when values were stored as text
+			if(std::is_same<T, bool>::value)
+				return static_cast<T>(AsDouble() > 0.0);
 
-		switch(pair.first.type)
-		{
-			case TYPE::BOOL:
+			switch(type)
 			{
-				for(std::vector<std::string>::size_type i = 0, end = pair.first.values.size(); i < end; ++i)
-				{
-					double addVal = ParseType<double>(pair.second.values[i]);
-
-					if(addVal > 0.0)
-						returnArgument.values[i] = "0";
-				}
-				break;
+				case TYPE::BOOL:
+					return static_cast<T>(number.boolValue);
+				case TYPE::INT32:
+					return static_cast<T>(number.int32Value);
+				case TYPE::INT64:
+					return static_cast<T>(number.int64Value);
+				case TYPE::UINT64:
+					return static_cast<T>(number.uint64Value);
+				case TYPE::FLOAT:
+					return static_cast<T>(number.floatValue);
+				case TYPE::DOUBLE:
+					return static_cast<T>(number.doubleValue);
+				case TYPE::STRING:
+					return ParseText<T>();
+				default:
+					return static_cast<T>(0);
 			}
-			case TYPE::INT32:
-				returnArgument.values = std::move(SubtractTypeAndConvertToString<int32_t>(pair.first.values, pair.second.values));
-				break;
-			case TYPE::INT64:
-				returnArgument.values = std::move(SubtractTypeAndConvertToString<int64_t>(pair.first.values, pair.second.values));
-				break;
-			case TYPE::UINT64:
-				returnArgument.values = std::move(SubtractTypeAndConvertToString<uint64_t>(pair.first.values, pair.second.values));
-				break;
-			case TYPE::FLOAT:
-				returnArgument.values = std::move(SubtractTypeAndConvertToString<float>(pair.first.values, pair.second.values));
-				break;
-			case TYPE::DOUBLE:
-				returnArgument.values = std::move(SubtractTypeAndConvertToString<double>(pair.first.values, pair.second.values));
-				break;
-			default:
-				//No string since -= isn't an operator for strings in C++
-				break;
 		}
 
-		return returnArgument;
-	}
-
-	Argument operator*(const Argument& rhs)
-	{
-		//Check operator+ for comments
-
-		auto pair = ConvertToCompatibleTypes(rhs);
-
-		if(pair.first.values.size() != pair.second.values.size())
+		std::string ToString() const
 		{
-			if(pair.first.values.size() == 1)
-				return pair.first;
-			else if(pair.second.values.size() == 1)
-				pair.second = std::move(PadValues(pair.second, pair.first.values.size()));
+			switch(type)
+			{
+				case TYPE::BOOL:
+					return std::to_string(static_cast<int>(number.boolValue));
+				case TYPE::INT32:
+					return std::to_string(number.int32Value);
+				case TYPE::INT64:
+					return std::to_string(number.int64Value);
+				case TYPE::UINT64:
+					return std::to_string(number.uint64Value);
+				case TYPE::FLOAT:
+					return std::to_string(number.floatValue);
+				case TYPE::DOUBLE:
+					return std::to_string(number.doubleValue);
+				case TYPE::STRING:
+					return text;
+				default:
+					return "";
+			}
 		}
 
-		Argument returnArgument;
-		returnArgument.type = pair.first.type;
-		returnArgument.origin = pair.first.values.front() + " * " + pair.second.values.front();
+	private:
+		TYPE type;
 
-		returnArgument.values.resize(pair.first.values.size());
+		union
+		{
+			bool boolValue;
+			int32_t int32Value;
+			int64_t int64Value;
+			uint64_t uint64Value;
+			float floatValue;
+			double doubleValue;
+		} number;
 
-		switch(pair.first.type)
+		std::string text; //Only used by TYPE::STRING
+
+		double AsDouble() const
 		{
-			case TYPE::BOOL:
+			switch(type)
 			{
-				for(std::vector<std::string>::size_type i = 0, end = pair.first.values.size(); i < end; ++i)
-				{
-					double addVal = ParseType<double>(pair.second.values[i]);
-
-					if(addVal == 0.0)
-						returnArgument.values[i] = "0";
-				}
-				break;
+				case TYPE::BOOL:
+					return number.boolValue ? 1.0 : 0.0;
+				case TYPE::INT32:
+					return static_cast<double>(number.int32Value);
+				case TYPE::INT64:
+					return static_cast<double>(number.int64Value);
+				case TYPE::UINT64:
+					return static_cast<double>(number.uint64Value);
+				case TYPE::FLOAT:
+					return static_cast<double>(number.floatValue);
+				case TYPE::DOUBLE:
+					return number.doubleValue;
+				case TYPE::STRING:
+					return ParseText<double>();
+				default:
+					return 0.0;
 			}
-			case TYPE::INT32:
-				returnArgument.values = std::move(MultiplyTypeAndConvertToString<int32_t>(pair.first.values, pair.second.values));
-				break;
-			case TYPE::INT64:
-				returnArgument.values = std::move(MultiplyTypeAndConvertToString<int64_t>(pair.first.values, pair.second.values));
-				break;
-			case TYPE::UINT64:
-				returnArgument.values = std::move(MultiplyTypeAndConvertToString<uint64_t>(pair.first.values, pair.second.values));
-				break;
-			case TYPE::FLOAT:
-				returnArgument.values = std::move(MultiplyTypeAndConvertToString<float>(pair.first.values, pair.second.values));
-				break;
-			case TYPE::DOUBLE:
-				returnArgument.values = std::move(MultiplyTypeAndConvertToString<double>(pair.first.values, pair.second.values));
-				break;
-			default:
-				//No string since -= isn't an operator for strings in C++
-				break;
 		}
 
-		return returnArgument;
+		template<typename T>
+		T ParseText() const
+		{
+			if(std::is_floating_point<T>::value)
+				return static_cast<T>(std::strtod(text.c_str(), nullptr));
+			else if(std::is_unsigned<T>::value)
+				return static_cast<T>(std::strtoull(text.c_str(), nullptr, 10));
+			else
+				return static_cast<T>(std::strtoll(text.c_str(), nullptr, 10));
+		}
+	};
+
+	Argument()
+		: type(TYPE::NONE)
+	{}
+	Argument(const std::string& text)
+		: type(TYPE::STRING)
+	{
+		values.emplace_back(text);
 	}
+	Argument(const char* text)
+		: Argument(std::string(text))
+	{}
+	~Argument() = default;
 
-	Argument operator/(const Argument& rhs)
+	Argument& operator=(const std::string& rhs)
 	{
-		//Check operator+ for comments
+		origin = "";
+		values.clear();
+		values.emplace_back(rhs);
+		type = TYPE::STRING;
 
-		auto pair = ConvertToCompatibleTypes(rhs);
+		return *this;
+	}
 
-		if(pair.first.values.size() != pair.second.values.size())
-		{
-			if(pair.first.values.size() == 1)
-				return pair.first;
-			else if(pair.second.values.size() == 1)
-				pair.second = std::move(PadValues(pair.second, pair.first.values.size()));
-		}
+	Argument operator+(const Argument& rhs) const
+	{
+		return Calculate(rhs, '+');
+	}
 
-		Argument returnArgument;
-		returnArgument.type = pair.first.type;
-		returnArgument.origin = pair.first.values.front() + " / " + pair.second.values.front();
+	Argument operator-(const Argument& rhs) const
+	{
+		return Calculate(rhs, '-');
+	}
 
-		returnArgument.values.resize(pair.first.values.size());
+	Argument operator*(const Argument& rhs) const
+	{
+		return Calculate(rhs, '*');
+	}
 
-		switch(pair.first.type)
-		{
-			case TYPE::INT32:
-				returnArgument.values = std::move(DivideTypeAndConvertToString<int32_t>(pair.first.values, pair.second.values));
-				break;
-			case TYPE::INT64:
-				returnArgument.values = std::move(DivideTypeAndConvertToString<int64_t>(pair.first.values, pair.second.values));
-				break;
-			case TYPE::UINT64:
-				returnArgument.values = std::move(DivideTypeAndConvertToString<uint64_t>(pair.first.values, pair.second.values));
-				break;
-			case TYPE::FLOAT:
-				returnArgument.values = std::move(DivideTypeAndConvertToString<float>(pair.first.values, pair.second.values));
-				break;
-			case TYPE::DOUBLE:
-				returnArgument.values = std::move(DivideTypeAndConvertToString<double>(pair.first.values, pair.second.values));
-				break;
-			default:
-				//Who would ever divide a bool?
-				break;
-		}
+	Argument operator/(const Argument& rhs) const
+	{
+		return Calculate(rhs, '/');
+	}
 
-		return returnArgument;
+	//Whether this is a single number (or bool). The >> operators turn anything else into 0 without complaining,
+	//so check this first when the value has to be valid
+	bool IsNumber() const
+	{
+		return values.size() == 1
+			&& values.front().IsNumber();
 	}
 
 	explicit operator std::string() const
@@ -265,180 +252,130 @@ struct Argument
 		if(values.size() == 0)
 			return "";
 
-		std::string asString;
-
 		if(values.size() == 1)
-			asString += values.front();
-		else
-		{
-			asString += "[";
+			return values.front().ToString();
 
-			for(auto value : values)
-				asString += value + ", ";
+		std::string asString = "[";
 
-			asString.erase(asString.size() - 2);
+		for(const Value& value : values)
+			asString += value.ToString() + ", ";
 
-			asString += "]";
-		}
+		asString.erase(asString.size() - 2);
 
-		return asString;
-	}
+		asString += "]";
 
-	template<typename T>
-	T ParseType(const std::string& value)
-	{
-		std::stringstream sstream;
-		T returnValue;
-
-		sstream << value;
-		sstream >> returnValue;
-
-		return returnValue;
+		return asString;
 	}
 
 	//"origin" is used to represent where "value" came from.
 	//For instance, when the GetSet function is called the origin will be the variable's name.
 	//When the Print function is called the origin will be "CommandPrint"
 	std::string origin;
-	std::vector<std::string> values;
+	std::vector<Value> values;
 	TYPE type;
 
 private:
-	std::pair<Argument, Argument> ConvertToCompatibleTypes(const Argument& other)
+	Argument Calculate(const Argument& rhs, char operation) const
 	{
-		std::pair<Argument, Argument> returnPair(*this, other);
+		//1 + (1,2,3) doesn't really make sense, so don't do anything.
+		//(1,2,3) + 1 applies 1 to each index
+		if(values.size() != rhs.values.size()
+			&& rhs.values.size() != 1)
+			return *this;
 
-		if(type == TYPE::FLOAT || type == TYPE::DOUBLE)
-		{
-			if(other.type == TYPE::DOUBLE)
-				returnPair.first.type = TYPE::DOUBLE;
-			else
-				returnPair.second.type = type;
-		}
-		else if(other.type == TYPE::FLOAT || other.type == TYPE::DOUBLE)
-		{
-			if(type == TYPE::DOUBLE)
-				returnPair.second.type = TYPE::DOUBLE;
-			else
-				returnPair.first.type = other.type;
-		}
-		else
-		{
-			switch(type)
-			{
-			case TYPE::NONE:
-				returnPair.first.type = other.type;
-				break;
-			case TYPE::BOOL:
-				returnPair.second.type = TYPE::BOOL;
-				break;
-			case TYPE::INT32:
-				if(other.type == TYPE::INT64 || other.type == TYPE::UINT64)
-					returnPair.first.type = other.type;
-				else
-					returnPair.second.type = TYPE::INT32;
-				break;
-			case TYPE::INT64:
-				if(other.type == TYPE::UINT64)
-					returnPair.first.type = TYPE::UINT64;
-				else
-					returnPair.second.type = TYPE::INT64;
-				break;
-			case TYPE::UINT64:
-				returnPair.second.type = TYPE::UINT64;
-				break;
-			case TYPE::STRING:
-				returnPair.second.type = TYPE::STRING;
-				break;
-			case TYPE::UNKNOWN:
-				returnPair.second.type = TYPE::UNKNOWN;
-				break;
-			default:
-				break;
-			}
-		}
+		Argument returnArgument;
+		returnArgument.values.reserve(values.size());
 
-		return returnPair;
-	}
-	Argument PadValues(Argument argument, std::vector<std::string>::size_type count)
-	{
-		values.reserve(count);
+		for(std::vector<Value>::size_type i = 0, end = values.size(); i < end; ++i)
+			returnArgument.values.emplace_back(Calculate(values[i], rhs.values.size() == 1 ? rhs.values.front() : rhs.values[i], operation));
 
-		for(std::vector<std::string>::size_type i = 1; i < count; ++i)
-			values.emplace_back(values.front());
+		returnArgument.type = returnArgument.values.empty() ? type : returnArgument.values.front().GetType();
 
-		return argument;
+		return returnArgument;
 	}
 
-	template<typename T>
-	std::vector<std::string> AddTypeAndConvertToString(std::vector<std::string>& lhs, std::vector<std::string>& rhs)
+	static Value Calculate(const Value& lhs, const Value& rhs, char operation)
 	{
-		std::vector<std::string> returnVector;
-		returnVector.reserve(lhs.size());
-
-		for(std::vector<std::string>::size_type i = 0, end = lhs.size(); i < end; ++i)
+		switch(GetCompatibleType(lhs.GetType(), rhs.GetType()))
 		{
-			T first = ParseType<T>(lhs[i]);
-			T second = ParseType<T>(rhs[i]);
-
-			returnVector.emplace_back(std::to_string(first + second));
-		}
-
-		return returnVector;
-	}
-
-	template<typename T>
-	std::vector<std::string> SubtractTypeAndConvertToString(std::vector<std::string>& lhs, std::vector<std::string>& rhs)
-	{
-		std::vector<std::string> returnVector;
-		returnVector.reserve(lhs.size());
+			case TYPE::BOOL:
+			{
+				//Adding > 0 to a bool will always make it 1, subtracting > 0 will always make it 0,
+				//and multiplying by 0 will always make it 0. Who would ever divide a bool?
+				double rhsValue = rhs.As<double>();
 
-		for(std::vector<std::string>::size_type i = 0, end = lhs.size(); i < end; ++i)
-		{
-			T first = ParseType<T>(lhs[i]);
-			T second = ParseType<T>(rhs[i]);
+				if(operation == '+' && rhsValue > 0.0)
+					return Value(true);
+				else if((operation == '-' && rhsValue > 0.0)
+						|| (operation == '*' && rhsValue == 0.0))
+					return Value(false);
 
-			returnVector.emplace_back(std::to_string(first - second));
+				return Value(lhs.As<bool>());
+			}
+			case TYPE::INT32:
+				return Value(CalculateNumber(lhs.As<int32_t>(), rhs.As<int32_t>(), operation));
+			case TYPE::INT64:
+				return Value(CalculateNumber(lhs.As<int64_t>(), rhs.As<int64_t>(), operation));
+			case TYPE::UINT64:
+				return Value(CalculateNumber(lhs.As<uint64_t>(), rhs.As<uint64_t>(), operation));
+			case TYPE::FLOAT:
+				return Value(CalculateNumber(lhs.As<float>(), rhs.As<float>(), operation));
+			case TYPE::DOUBLE:
+				return Value(CalculateNumber(lhs.As<double>(), rhs.As<double>(), operation));
+			case TYPE::STRING:
+				//No other operators since they aren't defined for strings in C++
+				if(operation == '+')
+					return Value(lhs.ToString() + rhs.ToString());
+				return lhs;
+			default:
+				return lhs;
 		}
-
-		return returnVector;
 	}
 
 	template<typename T>
-	std::vector<std::string> MultiplyTypeAndConvertToString(std::vector<std::string>& lhs, std::vector<std::string>& rhs)
+	static T CalculateNumber(T lhs, T rhs, char operation)
 	{
-		std::vector<std::string> returnVector;
-		returnVector.reserve(lhs.size());
-
-		for(std::vector<std::string>::size_type i = 0, end = lhs.size(); i < end; ++i)
+		switch(operation)
 		{
-			T first = ParseType<T>(lhs[i]);
-			T second = ParseType<T>(rhs[i]);
-
-			returnVector.emplace_back(std::to_string(first * second));
+			case '+':
+				return lhs + rhs;
+			case '-':
+				return lhs - rhs;
+			case '*':
+				return lhs * rhs;
+			case '/':
+				if(rhs == static_cast<T>(0))
+					throw std::invalid_argument("Division by zero: " + std::to_string(lhs) + "/" + std::to_string(rhs));
+				return lhs / rhs;
+			default:
+				return lhs;
 		}
-
-		return returnVector;
 	}
 
-	template<typename T>
-	std::vector<std::string> DivideTypeAndConvertToString(std::vector<std::string>& lhs, std::vector<std::string>& rhs)
+	//Floating point wins over integers, wider integers win over narrower ones,
+	//and otherwise the type of the left hand side is used
+	static TYPE GetCompatibleType(TYPE lhs, TYPE rhs)
 	{
-		std::vector<std::string> returnVector;
-		returnVector.reserve(lhs.size());
+		if(lhs == TYPE::FLOAT || lhs == TYPE::DOUBLE)
+			return rhs == TYPE::DOUBLE ? TYPE::DOUBLE : lhs;
+		else if(rhs == TYPE::FLOAT || rhs == TYPE::DOUBLE)
+			return rhs;
 
-		for(std::vector<std::string>::size_type i = 0, end = lhs.size(); i < end; ++i)
+		switch(lhs)
 		{
-			T first = ParseType<T>(lhs[i]);
-			T second = ParseType<T>(rhs[i]);
-
-			if(second != static_cast<T>(0))
-				returnVector.emplace_back(std::to_string(first / second));
-			else
-				returnVector.emplace_back("Division by zero: " + std::to_string(first) + "/" + std::to_string(second));
+			case TYPE::NONE:
+				return rhs;
+			case TYPE::INT32:
+				if(rhs == TYPE::INT64 || rhs == TYPE::UINT64)
+					return rhs;
+				return TYPE::INT32;
+			case TYPE::INT64:
+				if(rhs == TYPE::UINT64)
+					return TYPE::UINT64;
+				return TYPE::INT64;
+			default:
+				return lhs;
 		}
-
-		return returnVector;
 	}
 };
 
@@ -450,10 +387,7 @@ namespace
 		if(lhs.values.size() != 1)
 			return false;
 
-		std::stringstream sstream;
-		sstream << lhs.values.front();
-
-		sstream >> rhs;
+		rhs = lhs.values.front().As<T>();
 
 		return true;
 	}
@@ -463,12 +397,7 @@ namespace
 //Operators to convert a list of argument to primitive data types as well as string concats
 inline bool operator>>(const Argument& lhs, bool& rhs)
 {
-	if(lhs.values.size() != 1)
-		return false;
-
-	rhs = std::atoi(&lhs.values.front().c_str()[0]) > 0;
-
-	return true;
+	return ExtractFromArgument(lhs, rhs);
 }
 
 inline bool operator>>(const Argument& lhs, int8_t& rhs)
@@ -528,67 +457,67 @@ inline void operator>>(const Argument& lhs, std::string& rhs)
 
 inline void operator>>(bool lhs, Argument& rhs)
 {
-	rhs.values.emplace_back(std::to_string(lhs));
+	rhs.values.emplace_back(lhs);
 	rhs.type = Argument::TYPE::BOOL;
 }
 
 inline void operator>>(int8_t lhs, Argument& rhs)
 {
-	rhs.values.emplace_back(std::to_string(lhs));
+	rhs.values.emplace_back(static_cast<int32_t>(lhs));
 	rhs.type = Argument::TYPE::INT32;
 }
 
 inline void operator>>(uint8_t lhs, Argument& rhs)
 {
-	rhs.values.emplace_back(std::to_string(lhs));
+	rhs.values.emplace_back(static_cast<int32_t>(lhs));
 	rhs.type = Argument::TYPE::INT32;
 }
 
 inline void operator>>(int16_t lhs, Argument& rhs)
 {
-	rhs.values.emplace_back(std::to_string(lhs));
+	rhs.values.emplace_back(static_cast<int32_t>(lhs));
 	rhs.type = Argument::TYPE::INT32;
 }
 
 inline void operator>>(uint16_t lhs, Argument& rhs)
 {
-	rhs.values.emplace_back(std::to_string(lhs));
+	rhs.values.emplace_back(static_cast<int32_t>(lhs));
 	rhs.type = Argument::TYPE::INT32;
 }
 
 inline void operator>>(int32_t lhs, Argument& rhs)
 {
-	rhs.values.emplace_back(std::to_string(lhs));
+	rhs.values.emplace_back(lhs);
 	rhs.type = Argument::TYPE::INT32;
 }
 
 inline void operator>>(uint32_t lhs, Argument& rhs)
 {
-	rhs.values.emplace_back(std::to_string(lhs));
+	rhs.values.emplace_back(static_cast<int64_t>(lhs));
 	rhs.type = Argument::TYPE::INT64;
 }
 
 inline void operator>>(int64_t lhs, Argument& rhs)
 {
-	rhs.values.emplace_back(std::to_string(lhs));
+	rhs.values.emplace_back(lhs);
 	rhs.type = Argument::TYPE::INT64;
 }
 
 inline void operator>>(uint64_t lhs, Argument& rhs)
 {
-	rhs.values.emplace_back(std::to_string(lhs));
+	rhs.values.emplace_back(lhs);
 	rhs.type = Argument::TYPE::UINT64;
 }
 
 inline void operator>>(float lhs, Argument& rhs)
 {
-	rhs.values.emplace_back(std::to_string(lhs));
+	rhs.values.emplace_back(lhs);
 	rhs.type = Argument::TYPE::FLOAT;
 }
 
 inline void operator>>(double lhs, Argument& rhs)
 {
-	rhs.values.emplace_back(std::to_string(lhs));
+	rhs.values.emplace_back(lhs);
 	rhs.type = Argument::TYPE::DOUBLE;
 }
 
@@ -604,8 +533,8 @@ inline bool operator>>(const Argument& lhs, DirectX::XMFLOAT2& rhs)
 	if(lhs.values.size() != 2)
 		return false;
 
-	rhs.x = std::stof(lhs.values[0]);
-	rhs.y = std::stof(lhs.values[1]);
+	rhs.x = lhs.values[0].As<float>();
+	rhs.y = lhs.values[1].As<float>();
 
 	return true;
 }
@@ -616,8 +545,8 @@ inline bool operator>>(const DirectX::XMFLOAT2& lhs, Argument& rhs)
 
 	rhs.type = Argument::TYPE::FLOAT;
 
-	rhs.values.emplace_back(std::to_string(lhs.x));
-	rhs.values.emplace_back(std::to_string(lhs.y));
+	rhs.values.emplace_back(lhs.x);
+	rhs.values.emplace_back(lhs.y);
 
 	return true;
 }
@@ -627,9 +556,9 @@ inline bool operator>>(const Argument& lhs, DirectX::XMFLOAT3& rhs)
 	if(lhs.values.size() != 3)
 		return false;
 
-	rhs.x = std::stof(lhs.values[0]);
-	rhs.y = std::stof(lhs.values[1]);
-	rhs.z = std::stof(lhs.values[2]);
+	rhs.x = lhs.values[0].As<float>();
+	rhs.y = lhs.values[1].As<float>();
+	rhs.z = lhs.values[2].As<float>();
 
 	return true;
 }
@@ -640,30 +569,21 @@ inline bool operator>>(const DirectX::XMFLOAT3& lhs, Argument& rhs)
 
 	rhs.type = Argument::TYPE::FLOAT;
 
-	rhs.values.emplace_back(std::to_string(lhs.x));
-	rhs.values.emplace_back(std::to_string(lhs.y));
-	rhs.values.emplace_back(std::to_string(lhs.z));
+	rhs.values.emplace_back(lhs.x);
+	rhs.values.emplace_back(lhs.y);
+	rhs.values.emplace_back(lhs.z);
 
 	return true;
 }
 
 inline std::string operator+(const std::string& lhs, const Argument& rhs)
 {
-	std::string temp = lhs;
-
-	rhs >> temp;
-
-	return lhs + temp;
+	return lhs + std::string(rhs);
 }
 
 inline std::string operator+(const Argument& lhs, const std::string& rhs)
 {
-	std::string temp;
-
-	lhs >> temp;
-	temp += rhs;
-
-	return temp;
+	return std::string(lhs) + rhs;
 }
 
 inline std::string operator+=(std::string lhs, const Argument& rhs)
@@ -0,0 +1,184 @@
+#include "benchmarkScript.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+
+TimingStatistics::TimingStatistics()
+	: sum(0.0)
+	, min(std::numeric_limits<double>::max())
+	, max(std::numeric_limits<double>::lowest())
+	, count(0)
+{
+
+}
+
+void TimingStatistics::Add(double milliseconds)
+{
+	sum += milliseconds;
+	min = std::min(min, milliseconds);
+	max = std::max(max, milliseconds);
+	++count;
+}
+
+double TimingStatistics::GetAverage() const
+{
+	return count > 0 ? sum / count : 0.0;
+}
+
+BenchmarkScript::BenchmarkScript()
+	: warmupFrames(30)
+	, measureFrames(120)
+	, currentFrame(0)
+{
+
+}
+
+std::string BenchmarkScript::Parse(const std::string& path, const std::string& scriptName, const DirectiveParser& parseDirective)
+{
+	outputPath = path + ".csv";
+	warmupFrames = 30;
+	measureFrames = 120;
+	currentFrame = 0;
+
+	std::ifstream in(path);
+	if(!in.is_open())
+		return "Couldn't open " + scriptName + " \"" + path + "\"";
+
+	std::string line;
+	for(int lineNr = 1; std::getline(in, line); ++lineNr)
+	{
+		line = TrimTextFrontBack(line);
+
+		if(line.empty() || line.compare(0, 2, "//") == 0)
+			continue;
+
+		size_t directiveEnd = line.find_first_of(" \t");
+		if(directiveEnd == line.npos)
+			return "Expected arguments after \"" + line + "\" on line " + std::to_string(lineNr);
+
+		std::string directive = line.substr(0, directiveEnd);
+		std::string arguments = TrimTextFrontBack(line.substr(directiveEnd));
+
+		std::string errorString;
+
+		if(directive == "warmup" || directive == "measure")
+		{
+			char* end = nullptr;
+			long frames = std::strtol(arguments.c_str(), &end, 10);
+
+			if(end != arguments.c_str() + arguments.size()
+				|| frames < 0
+				|| frames > std::numeric_limits<int>::max()
+				|| (directive == "measure" && frames == 0))
+				errorString = "Expected a frame count after \"" + directive + "\"";
+			else if(directive == "warmup")
+				warmupFrames = static_cast<int>(frames);
+			else
+				measureFrames = static_cast<int>(frames);
+		}
+		else if(directive == "output")
+			outputPath = arguments;
+		else
+			errorString = parseDirective(directive, arguments);
+
+		if(!errorString.empty())
+			return "Error in " + scriptName + " \"" + path + "\" on line " + std::to_string(lineNr) + ": " + errorString;
+	}
+
+	return "";
+}
+
+const std::string& BenchmarkScript::GetOutputPath() const
+{
+	return outputPath;
+}
+
+int BenchmarkScript::GetWarmupFrames() const
+{
+	return warmupFrames;
+}
+
+int BenchmarkScript::GetMeasureFrames() const
+{
+	return measureFrames;
+}
+
+void BenchmarkScript::Restart()
+{
+	currentFrame = 0;
+}
+
+bool BenchmarkScript::IsFirstFrame() const
+{
+	return currentFrame == 0;
+}
+
+void BenchmarkScript::AddTiming(Timings& timings, const std::string& name, double milliseconds) const
+{
+	if(currentFrame < warmupFrames)
+		return;
+
+	timings[name].Add(milliseconds);
+}
+
+bool BenchmarkScript::EndFrame()
+{
+	++currentFrame;
+
+	if(currentFrame < warmupFrames + measureFrames)
+		return false;
+
+	currentFrame = 0;
+
+	return true;
+}
+
+std::string BenchmarkScript::TrimTextFrontBack(const std::string& text)
+{
+	size_t firstNotOf = text.find_first_not_of(" \t");
+	if(firstNotOf == text.npos)
+		return "";
+
+	size_t lastNotOf = text.find_last_not_of(" \t");
+
+	return text.substr(firstNotOf, lastNotOf - firstNotOf + 1);
+}
+
+std::string BenchmarkScript::CSVField(const std::string& text)
+{
+	if(text.find_first_of(",\"\n") == text.npos)
+		return text;
+
+	std::string quoted = "\"";
+
+	for(char character : text)
+	{
+		if(character == '"')
+			quoted += '"';
+
+		quoted += character;
+	}
+
+	return quoted + "\"";
+}
+
+void BenchmarkScript::WriteTimingHeader(std::ostream& out, const std::set<std::string>& timingNames)
+{
+	for(const std::string& name : timingNames)
+		out << ',' << CSVField(name + " avg") << ',' << CSVField(name + " min") << ',' << CSVField(name + " max");
+}
+
+void BenchmarkScript::WriteTimings(std::ostream& out, const std::set<std::string>& timingNames, const Timings& timings)
+{
+	for(const std::string& name : timingNames)
+	{
+		auto iter = timings.find(name);
+
+		if(iter == timings.end())
+			out << ",,,";
+		else
+			out << ',' << iter->second.GetAverage() << ',' << iter->second.min << ',' << iter->second.max;
+	}
+}
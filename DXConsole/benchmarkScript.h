@@ -0,0 +1,131 @@
+#ifndef OPENGLWINDOW_BENCHMARKSCRIPT_H
+#define OPENGLWINDOW_BENCHMARKSCRIPT_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <functional>
+#include <ostream>
+
+/**
+* Average, min and max of one timing over the measured frames of a configuration
+*/
+struct TimingStatistics
+{
+	TimingStatistics();
+
+	void Add(double milliseconds);
+	double GetAverage() const;
+
+	double sum;
+	double min;
+	double max;
+	int count;
+};
+
+/**
+* Script parsing, frame counting and CSV output shared by benchmarks that render each of a
+* number of configurations for a while and record timings, e.g. ConsoleSweepRunner
+*
+* Scripts are plaintext files where each line is a directive. Blank lines are allowed and
+* lines can be commented with //. These directives are handled here, anything else is passed
+* on to the benchmark:
+*
+* \code
+* //Frames to render before measuring each configuration, default 30
+* warmup 30
+* //Frames to measure each configuration, default 120
+* measure 120
+* //Where to write results, default <script path>.csv
+* output results.csv
+* \endcode
+*/
+class BenchmarkScript
+{
+public:
+	typedef std::map<std::string, TimingStatistics> Timings;
+	//std::string(const std::string& directive, const std::string& arguments), returns an error message or an empty string
+	typedef std::function<std::string(const std::string&, const std::string&)> DirectiveParser;
+
+	BenchmarkScript();
+	~BenchmarkScript() = default;
+
+	/**
+	* Resets everything to its default and parses the script at \p path
+	*
+	* \param path path (including extension) to the script
+	* \param scriptName what the script is called in error messages, e.g. "sweep script"
+	* \param parseDirective called for every directive that isn't handled here
+	* \returns an empty string if successful, otherwise an error message
+	*/
+	std::string Parse(const std::string& path, const std::string& scriptName, const DirectiveParser& parseDirective);
+
+	const std::string& GetOutputPath() const;
+	int GetWarmupFrames() const;
+	int GetMeasureFrames() const;
+
+	/**
+	* Starts over at the first warmup frame of a configuration
+	*/
+	void Restart();
+	/**
+	* \returns true if no frame of the current configuration has ended yet
+	*/
+	bool IsFirstFrame() const;
+	/**
+	* Adds a timing to \p timings, unless the current frame is a warmup frame
+	*/
+	void AddTiming(Timings& timings, const std::string& name, double milliseconds) const;
+	/**
+	* Ends the current frame
+	*
+	* \returns true if it was the last measured frame of the configuration. The next frame starts a new one
+	*/
+	bool EndFrame();
+
+	/**
+	* \see ConsoleCommandManager::TrimTextFrontBack for documentation
+	*/
+	static std::string TrimTextFrontBack(const std::string& text);
+	/**
+	* Quotes \p text if it would otherwise break the CSV format
+	*/
+	static std::string CSVField(const std::string& text);
+
+	/**
+	* Every timing name used by any of \p results, sorted. Timings can differ between
+	* configurations (e.g. one per ray bounce), so each one becomes a column
+	*/
+	template<typename Result>
+	static std::set<std::string> GetTimingNames(const std::vector<Result>& results, Timings Result::* timings)
+	{
+		std::set<std::string> timingNames;
+
+		for(const Result& result : results)
+		{
+			for(const auto& pair : result.*timings)
+				timingNames.insert(pair.first);
+		}
+
+		return timingNames;
+	}
+
+	/**
+	* Writes ",<name> avg,<name> min,<name> max" for every name
+	*/
+	static void WriteTimingHeader(std::ostream& out, const std::set<std::string>& timingNames);
+	/**
+	* Writes ",<avg>,<min>,<max>" for every name, or empty fields if \p timings doesn't contain it
+	*/
+	static void WriteTimings(std::ostream& out, const std::set<std::string>& timingNames, const Timings& timings);
+private:
+	std::string outputPath;
+
+	int warmupFrames;
+	int measureFrames;
+
+	int currentFrame;
+};
+
+#endif //OPENGLWINDOW_BENCHMARKSCRIPT_H
@@ -16,7 +16,7 @@ Argument CommandDumpConsole::Execute(const ContextPointers* const contextPointer
 		returnArgument = GetUsage();
 	else if(arguments.size() == 1)
 	{
-		std::string outPath = arguments.front().values.front();
+		std::string outPath = arguments.front().values.front().ToString();
 
 		std::ofstream out(outPath, std::ios_base::app);
 
@@ -33,7 +33,7 @@ Argument CommandDumpConsole::Execute(const ContextPointers* const contextPointer
 	}
 	else
 	{
-		std::string outPath = arguments.front().values.front();
+		std::string outPath = arguments.front().values.front().ToString();
 
 		std::ofstream out(outPath, std::ios_base::app);
 
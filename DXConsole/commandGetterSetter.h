@@ -36,10 +36,7 @@ public:
 			Argument tempArgument;
 
 			for(const Argument& argument : arguments)
-			{
-				for(const std::string& value : argument.values)
-					tempArgument.values.emplace_back(value);
-			}
+				tempArgument.values.insert(tempArgument.values.end(), argument.values.begin(), argument.values.end());
 
 			tempArgument.type = arguments.front().type;
 
@@ -50,13 +47,11 @@ public:
 				returnArgument.values.emplace_back("Couldn't insert \"" + tempArgument + "\" into value. Check your input and/or data types.");
 			else
 			{
-				//Use sstream since it already has overloads for >> for primitive data types
 				setter(tempValue);
 
 				tempValue >> returnArgument;
-				returnArgument.values.front().insert(0, name + " = ");
-
-				returnArgument.type = arguments.size() == 1 ? arguments.front().type : Argument::TYPE::UNKNOWN;
+				returnArgument = name + " = " + returnArgument;
+				returnArgument.origin = name;
 			}
 		}
 
@@ -15,16 +15,16 @@ Argument CommandHelp::Execute(const ContextPointers* const contextPointers, cons
 		returnArgument = GetHelpUsageExample();
 	else if(arguments.size() == 1)
 	{
-		Argument frontArgument = arguments.front();
+		std::string command = arguments.front().values.front().ToString();
 
-		auto parenIndex = frontArgument.values.front().find('(');
-		if(parenIndex != frontArgument.values.front().npos)
-			frontArgument.values.front().erase(parenIndex);
+		auto parenIndex = command.find('(');
+		if(parenIndex != command.npos)
+			command.erase(parenIndex);
 
-		if(contextPointers->commandManager->GetCommand(frontArgument.values.front()) != nullptr)
-			returnArgument = "Printing help for " + arguments.front() + ":\n" + contextPointers->commandManager->GetCommand(frontArgument.values.front())->GetHelpUsageExample();
+		if(contextPointers->commandManager->GetCommand(command) != nullptr)
+			returnArgument = "Printing help for " + arguments.front() + ":\n" + contextPointers->commandManager->GetCommand(command)->GetHelpUsageExample();
 		else
-			returnArgument = "Couldn't print help for command \"" + frontArgument.values.front() + "\" since there is no such command";
+			returnArgument = "Couldn't print help for command \"" + command + "\" since there is no such command";
 	}
 	else
 		returnArgument = "Expected one or zero arguments, got " + std::to_string(arguments.size());
@@ -2,6 +2,7 @@
 #include <sstream>
 #include <algorithm>
 #include <cctype>
+#include <fstream>
 
 #include "button.h"
 #include <DXLib/input.h>
@@ -39,11 +40,11 @@ Console::~Console()
 	{
 		try
 		{
-			autoexecManager.WriteAutoexec(style->autoexecFile);
+			autoexecManager.Flush(style->autoexecFile);
 		}
 		catch(std::exception& ex)
 		{
-			Logger::LogLine(LOG_TYPE::FATAL, "Caught exception in WriteAutoexec(): " + std::string(ex.what()));
+			Logger::LogLine(LOG_TYPE::FATAL, "Caught exception in Flush(): " + std::string(ex.what()));
 		}
 	}
 }
@@ -99,6 +100,8 @@ void Console::Init(Rect area, const std::shared_ptr<GUIStyle>& style, std::uniqu
 	            , this->style->outputBackgroundStyle);
 
 	output.allowEdit = true;
+	output.SetMaxLines(this->style->maxLines);
+	output.SetTrimCallback(std::bind(&Console::DumpLines, this, std::placeholders::_1));
 
 	////////////////////////////////////////
 	//Label
@@ -216,6 +219,9 @@ void Console::Update(std::chrono::nanoseconds delta)
 {
 	manager.Update(delta);
 
+	if(!style->autoexecFile.empty())
+		autoexecManager.Update(style->autoexecFile, std::chrono::milliseconds(style->autoexecWriteInterval));
+
 	if(Input::MouseMoved())
 	{
 		if(grabPosition.x != -1.0f)
@@ -262,11 +268,7 @@ void Console::Update(std::chrono::nanoseconds delta)
 void Console::Draw(SpriteRenderer* spriteRenderer)
 {
 	if(actualDraw)
-	{
-		DrawBackground(spriteRenderer);
-		DrawMiddle(spriteRenderer);
-		DrawForeground(spriteRenderer);
-	}
+		GUIContainer::Draw(spriteRenderer);
 	else
 	{
 		if(lastMessagesDuration > 0.0f)
@@ -278,24 +280,24 @@ void Console::DrawBackground(SpriteRenderer* spriteRenderer)
 {
 	background->Draw(spriteRenderer);
 
-	output.DrawBackground(spriteRenderer);
-	input.DrawBackground(spriteRenderer);
+	output.DrawLayer(spriteRenderer, DRAW_LAYER::BACKGROUND);
+	input.DrawLayer(spriteRenderer, DRAW_LAYER::BACKGROUND);
 }
 
 void Console::DrawMiddle(SpriteRenderer* spriteRenderer)
 {
-	output.DrawMiddle(spriteRenderer);
-	input.DrawMiddle(spriteRenderer);
+	output.DrawLayer(spriteRenderer, DRAW_LAYER::MIDDLE);
+	input.DrawLayer(spriteRenderer, DRAW_LAYER::MIDDLE);
 }
 
 void Console::DrawForeground(SpriteRenderer* spriteRenderer)
 {
-	output.DrawForeground(spriteRenderer);
-	input.DrawForeground(spriteRenderer);
+	output.DrawLayer(spriteRenderer, DRAW_LAYER::FOREGROUND);
+	input.DrawLayer(spriteRenderer, DRAW_LAYER::FOREGROUND);
 	promptLabel.Draw(spriteRenderer);
 
-	if(completeList.GetDraw())
-		completeList.Draw(spriteRenderer);
+	//Skipped in DrawLayer while completeList is hidden
+	completeList.Draw(spriteRenderer);
 }
 
 std::string Console::ExecuteCommand(const std::string& command)
@@ -306,7 +308,15 @@ std::string Console::ExecuteCommand(const std::string& command)
 
 	try
 	{
-		return commandManager.ExecuteCommand(command);
+		std::string result = commandManager.ExecuteCommand(command);
+
+		//Suggest commands from the history before others
+		commandManager.MarkUsed(nameArgs.first);
+
+		if(commandExecutedCallback)
+			commandExecutedCallback(command);
+
+		return result;
 	}
 	catch(std::invalid_argument& ex)
 	{
@@ -314,6 +324,16 @@ std::string Console::ExecuteCommand(const std::string& command)
 	}
 }
 
+ConsoleVariable* Console::GetVariable(const std::string& name) const
+{
+	return commandManager.GetVariable(name);
+}
+
+void Console::SetCommandExecutedCallback(std::function<void(const std::string&)> callback)
+{
+	commandExecutedCallback = std::move(callback);
+}
+
 bool Console::AddCommand(ConsoleCommand* command)
 {
 	std::string errorString = commandManager.AddCommand(command);
@@ -330,17 +350,14 @@ void Console::AddText(const std::string& text)
 
 	if(style->lastMessagesStyle != nullptr)
 	{
-		int linesBefore = lastMessages.GetLineCount();
-
 		lastMessages.AddText(text);
 
-		int linesAfter = lastMessages.GetLineCount();
-
-		lastMessagesTexts.push(linesAfter - linesBefore);
+		//Lines rather than rows, rows aren't known until the text is wrapped
+		lastMessagesTexts.push(static_cast<int>(std::count(text.begin(), text.end(), '\n')) + 1);
 
 		if(lastMessagesTexts.size() > style->lastMessagesToDraw)
 		{
-			lastMessages.EraseLines(0, lastMessagesTexts.front());
+			lastMessages.EraseFirstLines(lastMessagesTexts.front());
 			lastMessagesTexts.pop();
 		}
 
@@ -351,6 +368,17 @@ void Console::AddText(const std::string& text)
 	}
 }
 
+void Console::DumpLines(const std::vector<std::string>& lines)
+{
+	if(style->dumpFile.empty())
+		return;
+
+	std::ofstream out(style->dumpFile, std::ofstream::app);
+
+	for(const std::string& line : lines)
+		out << line << '\n';
+}
+
 void Console::SetPosition(const DirectX::XMFLOAT2& newPosition)
 {
 	SetPosition(newPosition.x, newPosition.y);
@@ -608,21 +636,11 @@ void Console::OnChar(unsigned int keyCode)
 	{
 		SwitchCompleteListMode(COMPLETE_LIST_MODE::COMPLETION);
 
-		std::string textBeforeModification = input.GetActiveCharacterBlockText();
-
 		input.OnChar(keyCode);
 
-		std::string textAfterModification = GenerateSuggestionText();
-
-		completeList.ClearElements();
-
-		//If text was appended we only need to strip the suggestions,
-		//otherwise a whole new set has to be generated
-		if(!textBeforeModification.empty()
-			&& textAfterModification.find(textBeforeModification) == 0)
-			TrimSuggestions(textAfterModification);
-		else
-			GenerateSuggestions(textAfterModification);
+		//Only the best matches are kept, so appending text can make entries
+		//that weren't in the list before show up. Always generate a new set
+		GenerateSuggestions(GenerateSuggestionText());
 
 		MoveSuggestionButtonsToCompleteList();
 		ShowCompleteList();
@@ -787,20 +805,6 @@ void Console::EnterPressed()
 		{
 			AddText("An unknown exception was caught when trying to execute\"" + text + "\": " + std::string(ex.what()));
 		}
-			
-		unsigned int linesAfter = output.GetLineCount();
-
-		if(linesAfter > style->maxLines
-			&& !style->dumpFile.empty())
-		{
-			std::ofstream out(style->dumpFile, std::ofstream::app);
-
-			std::vector<std::string> lineRange = output.GetLines(0, linesAfter - style->maxLines);
-			output.EraseLines(0, linesAfter - style->maxLines);
-
-			for(auto line : lineRange)
-				out << line << '\n';
-		}
 
 		input.SetText("");
 
@@ -945,10 +949,11 @@ void Console::MoveSuggestionButtonsToCompleteList()
 	completeList.ClearElements();
 
 	std::vector<GUIContainer*> completeListElements;
-	completeListElements.reserve(suggestionButtons.size());
+	completeListElements.reserve(suggestions.size());
 
-	for(const auto& pointer : suggestionButtons)
-		completeListElements.push_back(pointer.get());
+	//Buttons past suggestions.size() are kept around for later
+	for(int i = 0, end = static_cast<int>(suggestions.size()); i < end; i++)
+		completeListElements.push_back(suggestionButtons[i].get());
 
 	UpdateCompleteListArea();
 	completeList.SetElements(std::move(completeListElements));
@@ -1055,57 +1060,29 @@ void Console::SwitchCompleteListMode(COMPLETE_LIST_MODE mode)
 	}
 }
 
-void Console::TrimSuggestions(const std::string& text)
-{
-	std::vector<const DictionaryEntry*> newSuggestions;
-
-	for(const DictionaryEntry* entry : suggestions)
-	{
-		if(entry->Matches(text))
-			newSuggestions.push_back(entry);
-	}
-
-	suggestions = std::move(newSuggestions);
-
-	suggestionButtons.erase(suggestionButtons.begin() + suggestions.size(), suggestionButtons.end());
-
-	for(int i = 0, end = static_cast<int>(suggestions.size()); i < end; i++)
-		static_cast<Button*>(suggestionButtons[i].get())->SetText(suggestions[i]->GetName());
-}
-
 void Console::GenerateSuggestions(const std::string& text)
 {
 	//Need to clear here since some pointers may be removed
 	completeList.ClearElements();
 
-	suggestions = commandManager.Match(text);
+	commandManager.Match(text, style->suggestionCount, suggestions);
 
-	if(suggestions.size() > 0)
+	for(auto i = suggestionButtons.size(), end = suggestions.size(); i < end; i++)
 	{
-		if(suggestions.size() >= suggestionButtons.size())
-		{
-			for(auto i = suggestionButtons.size(), end = suggestions.size(); i < end; i++)
-			{
-				std::unique_ptr<Button> button = std::unique_ptr<Button>(new Button);
-
-				button->Init(Rect(DirectX::XMFLOAT2(), DirectX::XMFLOAT2(completeListBackground->GetWorkArea().GetWidth(), static_cast<float>(this->style->characterSet->GetLineHeight())))
-							 , style->completeListButtonStyle
-							 , std::unique_ptr<GUIBackground>(style->completeListButtonBackground->Clone())
-							 , style->completeListButtonBackgroundStyle
-							 , nullptr
-							 , "");
+		std::unique_ptr<Button> button = std::unique_ptr<Button>(new Button);
 
-				suggestionButtons.push_back(std::move(button));
-			}
+		button->Init(Rect(DirectX::XMFLOAT2(), DirectX::XMFLOAT2(completeListBackground->GetWorkArea().GetWidth(), static_cast<float>(this->style->characterSet->GetLineHeight())))
+					 , style->completeListButtonStyle
+					 , std::unique_ptr<GUIBackground>(style->completeListButtonBackground->Clone())
+					 , style->completeListButtonBackgroundStyle
+					 , nullptr
+					 , "");
 
-			for(int i = 0, end = static_cast<int>(suggestions.size()); i < end; i++)
-				static_cast<Button*>(suggestionButtons[i].get())->SetText(suggestions[i]->GetName());
-		}
-		else
-			TrimSuggestions(text);
+		suggestionButtons.push_back(std::move(button));
 	}
-	else
-		suggestionButtons.clear();
+
+	for(int i = 0, end = static_cast<int>(suggestions.size()); i < end; i++)
+		static_cast<Button*>(suggestionButtons[i].get())->SetText(suggestions[i]->GetName());
 }
 
 void Console::HighlightCompleteListIndex(int index)
@@ -1329,10 +1306,10 @@ Argument Console::AddAutoexecWatchInternal(const std::vector<Argument>& argument
 	int count = 0;
 	for(const auto& argument : arguments)
 	{
-		if(AddAutoexecWatch(argument.values.front()))
+		if(AddAutoexecWatch(argument.values.front().ToString()))
 			++count;
 		else
-			returnString += "Couldn't add \"" + argument.values.front() + "\" to autoexec since there is no such variable\n";
+			returnString += "Couldn't add \"" + argument.values.front().ToString() + "\" to autoexec since there is no such variable\n";
 	}
 
 	returnString += "Added " + std::to_string(count) + " variable" + (count > 1 ? "s" : "") + " to autoexec watches"; //Worth ternary
@@ -1349,7 +1326,7 @@ Argument Console::RemoveAutoexecWatchInternal(const std::vector<Argument>& argum
 	int count = 0;
 	for(const auto& argument : arguments)
 	{
-		if(RemoveAutoexecWatch(argument.values.front()))
+		if(RemoveAutoexecWatch(argument.values.front().ToString()))
 			++count;
 	}
 
@@ -1406,7 +1383,7 @@ Argument Console::ApplyPausedAutoexecWatchesInteral(const std::vector<Argument>&
 		std::vector<std::string> watchesToApply;
 
 		for(const Argument& watch : arguments)
-			watchesToApply.emplace_back(watch.values.front());
+			watchesToApply.emplace_back(watch.values.front().ToString());
 
 		std::vector<std::string> nonappliedWatches = autoexecManager.ApplySelectedPausedChanges(watchesToApply);
 
@@ -19,6 +19,7 @@
 #include <unordered_set>
 #include <deque>
 #include <queue>
+#include <functional>
 #include <unordered_set>
 
 /**
@@ -75,6 +76,21 @@ public:
 	* an error occurred
 	*/
 	std::string ExecuteCommand(const std::string& command);
+	/**
+	* Gets the variable called \p name
+	*
+	* \param name name of the variable
+	* \returns nullptr if there is no command called \p name, or if the command isn't a ConsoleVariable
+	*/
+	ConsoleVariable* GetVariable(const std::string& name) const;
+	/**
+	* Sets a function to call after each command executed through ExecuteCommand, both
+	* from the input field and from code. Commands that fail to execute and commands
+	* executed by autoexec aren't passed on
+	*
+	* \param callback function to call with the executed command, or an empty function
+	*/
+	void SetCommandExecutedCallback(std::function<void(const std::string&)> callback);
 
 	/**
 	* Adds the given command so that it can be called from the console.
@@ -211,6 +227,8 @@ protected:
 	ConsoleCommandManager commandManager;
 	ConsoleAutoexecManager autoexecManager;
 
+	std::function<void(const std::string&)> commandExecutedCallback;
+
 	/**
 	* Called when Console_AddAutoexecWatch is executed
 	*
@@ -289,12 +307,19 @@ protected:
 	//When moved, completeList will hold the raw pointers and the unique_ptr will stay inside these vectors
 	std::vector<std::unique_ptr<GUIContainer>> historyButtons;
 	std::vector<std::unique_ptr<GUIContainer>> suggestionButtons;
-	//All suggestions from the commandDictionary
+	//Best suggestions from the commandDictionary, reused between keystrokes
 	std::vector<const DictionaryEntry*> suggestions;
 
 	DirectX::XMFLOAT2 grabPosition;
 	bool move;
 
+	/**
+	* Called by #output when lines are removed because of ConsoleStyle::maxLines
+	*
+	* Appends \p lines to ConsoleStyle::dumpFile, if there is one
+	*/
+	void DumpLines(const std::vector<std::string>& lines);
+
 	/**
 	* Called when OnKeyDown is called with GLFW_KEY_UP
 	*/
@@ -355,7 +380,7 @@ protected:
 	*/
 	void MoveHistoryButtonsToCompleteList();
 	/**
-	* Clears #completeList and inserts all elements from #suggestionButtons
+	* Clears #completeList and inserts one element from #suggestionButtons per suggestion
 	*/
 	void MoveSuggestionButtonsToCompleteList();
 
@@ -392,13 +417,6 @@ protected:
 	*/
 	void SwitchCompleteListMode(COMPLETE_LIST_MODE mode);
 	/**
-	* Loops through #suggestions and calls DictionaryEntry::Match with \text as an argument,
-	* then removes all non-matching elements and updates #suggestions and #suggestionButtons
-	* 
-	* \param text text to match each element in #suggestions against
-	*/
-	void TrimSuggestions(const std::string& text);
-	/**
 	* Generates commands by using ConsoleCommandManager::Match, also populates updates #suggestionButtons
 	* 
 	* \param text text to match against. Used as an argument to ConsoleCommandManager::Match
@@ -1,23 +1,43 @@
 #include "consoleAutoexecManager.h"
 
 #include <fstream>
+#include <sstream>
+#include <set>
+
+#include <windows.h>
 
 #include <DXLib/logger.h>
 
 ConsoleAutoexecManager::ConsoleAutoexecManager()
 	: autoexecLoaded(false)
-	, autoexecFound(false)
 	, paused(false)
+	, dirty(false)
+	, hasPendingSnapshot(false)
+	, stopWriter(false)
 {}
 
+ConsoleAutoexecManager::~ConsoleAutoexecManager()
+{
+	StopWriter();
+}
+
 void ConsoleAutoexecManager::FunctionExecuted(const std::string& function, const std::string& arguments)
 {
 	if(!paused)
 	{
-		if(autoexecWatchesVariables.count(function) > 0)
-			autoexecWatchesVariables[function] = arguments;
-		else if(autoexecWatchesFunctions.count(function) > 0)
-			autoexecWatchesFunctions[function] = arguments;
+		auto iter = autoexecWatchesVariables.find(function);
+		if(iter == autoexecWatchesVariables.end())
+		{
+			iter = autoexecWatchesFunctions.find(function);
+			if(iter == autoexecWatchesFunctions.end())
+				return;
+		}
+
+		if(iter->second != arguments)
+		{
+			iter->second = arguments;
+			dirty = true;
+		}
 	}
 	else
 	{
@@ -42,6 +62,9 @@ bool ConsoleAutoexecManager::AddAutoexecWatch(const std::string& command, Consol
 			autoexecWatchesFunctions.emplace(command, "");
 		else
 			autoexecWatchesVariables.emplace(command, variable->GetValue());
+
+		removedWatches.erase(command);
+		dirty = true;
 	}
 
 	return true;
@@ -53,12 +76,14 @@ bool ConsoleAutoexecManager::RemoveAutoexecWatch(const std::string& command)
 	{
 		autoexecWatchesVariables.erase(command);
 		removedWatches.emplace(command);
+		dirty = true;
 		return true;
 	}
 	else if(autoexecWatchesFunctions.count(command) > 0)
 	{
 		autoexecWatchesFunctions.erase(command);
 		removedWatches.emplace(command);
+		dirty = true;
 		return true;
 	}
 
@@ -110,10 +135,7 @@ bool ConsoleAutoexecManager::ParseAutoexec(const std::string& path, ConsoleComma
 
 	autoexecLoaded = true;
 	if(!in.is_open())
-	{
-		autoexecFound = false;
 		return false;
-	}
 
 	std::string line;
 	for(int lineNr = 1; std::getline(in, line); ++lineNr)
@@ -156,6 +178,9 @@ bool ConsoleAutoexecManager::ParseAutoexec(const std::string& path, ConsoleComma
 		}
 	}
 
+	//The file already contains everything that was just parsed
+	dirty = false;
+
 	return true;
 }
 
@@ -167,28 +192,127 @@ bool ConsoleAutoexecManager::WriteAutoexec(const std::string& path)
 		return false;
 	}
 
-	if(autoexecWatchesVariables.empty() && autoexecWatchesFunctions.empty())
-		return true;
+	//Anything queued is older than what is about to be written, but a write might be in progress
+	{
+		std::lock_guard<std::mutex> lock(writerMutex);
+		hasPendingSnapshot = false;
+	}
 
-	if(!autoexecFound)
-		std::ofstream createFile(path);
+	StopWriter();
 
-	std::ofstream out(path + ".tmp", std::ofstream::trunc);
-	std::ifstream in(path);
+	dirty = false;
+
+	return WriteSnapshot(path, TakeSnapshot());
+}
+
+void ConsoleAutoexecManager::Update(const std::string& path, std::chrono::milliseconds writeInterval)
+{
+	if(!dirty
+		|| !autoexecLoaded)
+		return;
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if(now - lastQueueTime < writeInterval)
+		return;
+
+	lastQueueTime = now;
+	QueueSnapshot(path);
+}
+
+void ConsoleAutoexecManager::Flush(const std::string& path)
+{
+	if(dirty
+		&& autoexecLoaded)
+		QueueSnapshot(path);
+
+	StopWriter();
+}
+
+ConsoleAutoexecManager::Snapshot ConsoleAutoexecManager::TakeSnapshot()
+{
+	Snapshot snapshot;
+
+	snapshot.variables = autoexecWatchesVariables;
+	snapshot.functions = autoexecWatchesFunctions;
+	snapshot.removedWatches = removedWatches;
+
+	return snapshot;
+}
+
+void ConsoleAutoexecManager::QueueSnapshot(const std::string& path)
+{
+	dirty = false;
+
+	Snapshot snapshot = TakeSnapshot();
 
-	if(!out.is_open())
 	{
-		Logger::LogLine(LOG_TYPE::WARNING, "Couldn't create temporary file \"" + path + ".tmp\"" + ", can't write to autoexec");
-		return false;
+		std::lock_guard<std::mutex> lock(writerMutex);
+
+		pendingPath = path;
+		pendingSnapshot = std::move(snapshot);
+		hasPendingSnapshot = true;
+
+		if(!writerThread.joinable())
+		{
+			stopWriter = false;
+			writerThread = std::thread(&ConsoleAutoexecManager::WriterMain, this);
+		}
 	}
-	else if(!in.is_open())
+
+	writerCondition.notify_one();
+}
+
+void ConsoleAutoexecManager::StopWriter()
+{
 	{
-		Logger::LogLine(LOG_TYPE::WARNING, "Couldn't open autoexec file at \"" + path + "\", can't write to autoexec");
-		return false;
+		std::lock_guard<std::mutex> lock(writerMutex);
+
+		if(!writerThread.joinable())
+			return;
+
+		stopWriter = true;
+	}
+
+	writerCondition.notify_one();
+	writerThread.join();
+}
+
+void ConsoleAutoexecManager::WriterMain()
+{
+	std::unique_lock<std::mutex> lock(writerMutex);
+
+	while(true)
+	{
+		writerCondition.wait(lock, [this]() { return hasPendingSnapshot || stopWriter; });
+
+		//Write whatever is queued before stopping
+		if(!hasPendingSnapshot)
+			return;
+
+		std::string path = std::move(pendingPath);
+		Snapshot snapshot = std::move(pendingSnapshot);
+		hasPendingSnapshot = false;
+
+		lock.unlock();
+		WriteSnapshot(path, std::move(snapshot));
+		lock.lock();
 	}
+}
+
+bool ConsoleAutoexecManager::WriteSnapshot(const std::string& path, Snapshot snapshot)
+{
+	if(snapshot.variables.empty()
+		&& snapshot.functions.empty()
+		&& snapshot.removedWatches.empty())
+		return true;
+
+	std::ostringstream out;
+
+	//A missing file is the same as an empty one
+	std::ifstream in(path);
 
 	std::string line;
-	for(int lineNr = 1; std::getline(in, line); ++lineNr)
+	while(std::getline(in, line))
 	{
 		line = TrimTextFrontBack(line);
 
@@ -214,29 +338,29 @@ bool ConsoleAutoexecManager::WriteAutoexec(const std::string& path)
 		}
 
 		std::string function = line.substr(0, index);
-		if(removedWatches.count(function) != 0)
+		if(snapshot.removedWatches.count(function) != 0)
 			continue;
 
 		if(addWatch)
 		{
-			if(autoexecWatchesVariables.count(function) > 0)
+			if(snapshot.variables.count(function) > 0)
 			{
 				if(paren)
-					out << "watch " << function << "(" << autoexecWatchesVariables[function] << ")" << '\n';
+					out << "watch " << function << "(" << snapshot.variables[function] << ")" << '\n';
 				else
-					out << "watch " << function << " " << autoexecWatchesVariables[function] << '\n';
+					out << "watch " << function << " " << snapshot.variables[function] << '\n';
 
-				autoexecWatchesVariables.erase(function);
+				snapshot.variables.erase(function);
 
 			}
-			else if(autoexecWatchesFunctions.count(function) > 0)
+			else if(snapshot.functions.count(function) > 0)
 			{
 				if(paren)
-					out << "watch " << function << "(" << autoexecWatchesFunctions[function] << ")" << '\n';
+					out << "watch " << function << "(" << snapshot.functions[function] << ")" << '\n';
 				else
-					out << "watch " << function << " " << autoexecWatchesFunctions[function] << '\n';
+					out << "watch " << function << " " << snapshot.functions[function] << '\n';
 
-				autoexecWatchesFunctions.erase(function);
+				snapshot.functions.erase(function);
 			}
 			else
 				out << "watch " << line << '\n';
@@ -245,17 +369,45 @@ bool ConsoleAutoexecManager::WriteAutoexec(const std::string& path)
 			out << line << '\n';
 	}
 
-	for(auto pair : autoexecWatchesVariables)
+	in.close();
+
+	for(auto pair : snapshot.variables)
 		out << "watch " << pair.first << "(" << pair.second << ")" << '\n';
 
-	for(auto pair : autoexecWatchesFunctions)
+	for(auto pair : snapshot.functions)
 		out << "watch " << pair.first << "(" << pair.second << ")" << '\n';
 
-	in.close();
-	out.close();
+	std::string text = out.str();
+	std::string temporaryPath = path + ".tmp";
+
+	//Write to a temporary file and make sure it's on disk before replacing the old file,
+	//that way the autoexec file is always either the old or the new version
+	HANDLE file = CreateFileA(temporaryPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+	{
+		Logger::LogLine(LOG_TYPE::WARNING, "Couldn't create temporary file \"" + temporaryPath + "\"" + ", can't write to autoexec");
+		return false;
+	}
+
+	DWORD bytesWritten = 0;
+	bool written = WriteFile(file, text.data(), static_cast<DWORD>(text.size()), &bytesWritten, nullptr) != FALSE
+		&& bytesWritten == text.size()
+		&& FlushFileBuffers(file) != FALSE;
 
-	std::remove(path.c_str());
-	std::rename((path + ".tmp").c_str(), path.c_str());
+	CloseHandle(file);
+
+	if(!written)
+	{
+		Logger::LogLine(LOG_TYPE::WARNING, "Couldn't write to temporary file \"" + temporaryPath + "\"" + ", can't write to autoexec");
+		DeleteFileA(temporaryPath.c_str());
+		return false;
+	}
+
+	if(!MoveFileExA(temporaryPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+	{
+		Logger::LogLine(LOG_TYPE::WARNING, "Couldn't replace autoexec file at \"" + path + "\" with \"" + temporaryPath + "\"");
+		return false;
+	}
 
 	return true;
 }
@@ -286,6 +438,8 @@ void ConsoleAutoexecManager::ApplyPausedChanges()
 		if(autoexecWatchesFunctions.count(pair.first) > 0)
 			autoexecWatchesFunctions[pair.first] = pair.second;
 	}
+
+	dirty = true;
 }
 
 std::vector<std::string> ConsoleAutoexecManager::ApplySelectedPausedChanges(const std::vector<std::string>& watches)
@@ -302,6 +456,9 @@ std::vector<std::string> ConsoleAutoexecManager::ApplySelectedPausedChanges(cons
 			nonappliedChanges.emplace(name);
 	}
 
+	if(nonappliedChanges.size() != watches.size())
+		dirty = true;
+
 	std::vector<std::string> nonappliedChangesVector;
 	nonappliedChangesVector.insert(nonappliedChangesVector.end(), nonappliedChanges.begin(), nonappliedChanges.end());
 	return nonappliedChangesVector;
@@ -4,6 +4,10 @@
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 
 #include "consoleCommandManager.h"
 
@@ -16,13 +20,22 @@
 * The layout of the autoexec file will be preserved, and any new watches
 * will be added last
 *
+* Executing a watched command only marks the watches as changed. Update takes a
+* snapshot of the watches at most once per interval and hands it to a background
+* thread, which writes it to a temporary file, flushes it to disk and then replaces
+* the autoexec file with it. Snapshots that haven't been written yet are replaced
+* by newer ones, so rapid changes result in a single write
+*
 * \see AddAutoexecWatch for information regarding watches
 */
 class ConsoleAutoexecManager
 {
 public:
 	ConsoleAutoexecManager();
-	~ConsoleAutoexecManager() = default;
+	/**
+	* Waits for any queued write to finish
+	*/
+	~ConsoleAutoexecManager();
 
 	/**
 	* Called whenever a function is executed so it can be added to the autoexec file if needed
@@ -134,13 +147,28 @@ public:
 	*/
 	bool ParseAutoexec(const std::string& path, ConsoleCommandManager& commandManager);
 	/**
-	* Writes all autoexec watches to the file at \p path
+	* Writes all autoexec watches to the file at \p path on the calling thread
 	* 
 	* \param path path (including extension) to autoexec file
-	* \returns false if the file at path cannot be opened, or a file at path + ".tmp"
-	* can't be created
+	* \returns false if a file at path + ".tmp" can't be created, or if it can't replace
+	* the file at \p path
 	*/
 	bool WriteAutoexec(const std::string& path);
+	/**
+	* Queues a write of all autoexec watches if they have changed, and if at least
+	* \p writeInterval has passed since the last write was queued. Should be called regularly
+	*
+	* \param path path (including extension) to autoexec file
+	* \param writeInterval minimum time between writes
+	*/
+	void Update(const std::string& path, std::chrono::milliseconds writeInterval);
+	/**
+	* Queues a write of all autoexec watches if they have changed and waits for
+	* every queued write to finish
+	*
+	* \param path path (including extension) to autoexec file
+	*/
+	void Flush(const std::string& path);
 
 	/**
 	* Pauses autoexec watches
@@ -170,6 +198,14 @@ public:
 	*/
 	std::vector<std::string> ApplySelectedPausedChanges(const std::vector<std::string>& watches);
 private:
+	//Everything needed to write the autoexec file, so that it can be written on another thread
+	struct Snapshot
+	{
+		std::unordered_map<std::string, std::string> variables;
+		std::unordered_map<std::string, std::string> functions;
+		std::unordered_set<std::string> removedWatches;
+	};
+
 	//<function, arguments>
 	std::unordered_map<std::string, std::string> autoexecWatchesVariables;
 	std::unordered_map<std::string, std::string> autoexecWatchesFunctions;
@@ -180,14 +216,40 @@ private:
 	std::unordered_set<std::string> removedWatches;
 
 	bool autoexecLoaded;
-	bool autoexecFound;
 
 	bool paused;
 
+	//Whether any watch has changed since the last snapshot
+	bool dirty;
+	std::chrono::steady_clock::time_point lastQueueTime;
+
+	std::thread writerThread;
+	std::mutex writerMutex;
+	std::condition_variable writerCondition;
+
+	//Protected by writerMutex
+	bool hasPendingSnapshot;
+	bool stopWriter;
+	std::string pendingPath;
+	Snapshot pendingSnapshot;
+
+	Snapshot TakeSnapshot();
+	void QueueSnapshot(const std::string& path);
+	void StopWriter();
+	void WriterMain();
+
+	/**
+	* Merges \p snapshot into the autoexec file at \p path. Lines in the file are kept and updated with
+	* the watches' values, watches that aren't in the file are added last
+	*
+	* \returns false if the file couldn't be written
+	*/
+	static bool WriteSnapshot(const std::string& path, Snapshot snapshot);
+
 	/**
 	* \see ConsoleCommandManager::TrimTextFrontBack for documentation
 	*/
-	std::string TrimTextFrontBack(const std::string& text);
+	static std::string TrimTextFrontBack(const std::string& text);
 };
 
 #endif //OPENGLWINDOW_CONSOLEAUTOEXECMANAGER_H
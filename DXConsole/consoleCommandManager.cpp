@@ -1,6 +1,9 @@
 #include "consoleCommandManager.h"
 
-#include <stack>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
 
 /*
 ConsoleCommandManager::ConsoleCommandManager()
@@ -75,36 +78,30 @@ std::pair<std::string, std::string> ConsoleCommandManager::ParseFunctionAndArgum
 
 std::string ConsoleCommandManager::ExecuteCommand(std::string text)
 {
-	std::pair<std::string, std::string> functionParam = ParseFunctionAndArgumentList(text);
+	auto iter = compiledCommands.find(text);
+	if(iter == compiledCommands.end())
+	{
+		std::pair<std::string, std::string> functionParam = ParseFunctionAndArgumentList(text);
 
-	if(commandMap.find(functionParam.first) == commandMap.end())
-		throw std::invalid_argument("Evaluated \"" + text + "\" to be a function call to \"" + functionParam.first + "\" , but no such function was found");
+		std::unique_ptr<ExpressionNode> compiled = CompileCall(functionParam.first, functionParam.second, text);
 
-	std::vector<std::string> textArguments = SplitArg(functionParam.second, ',');
+		if(compiledCommands.size() >= MAX_COMPILED_COMMANDS)
+			compiledCommands.clear();
 
-	std::vector<Argument> arguments;
-	if(commandMap[functionParam.first]->GetForceStringArguments())
-	{
-		for(const std::string& argument : textArguments)
-		{
-			if(argument.front() == '\"')
-				arguments.emplace_back(argument.substr(1, argument.size() - 2));
-			else
-				arguments.emplace_back(argument);
-		}
-	}
-	else
-	{
-		for(const std::string& argument : textArguments)
-			arguments.emplace_back(EvaluateExpression(argument));
+		iter = compiledCommands.emplace(text, std::move(compiled)).first;
 	}
 
-	return std::string(commandMap[functionParam.first]->Execute(&contextPointers, arguments));
+	return std::string(Evaluate(*iter->second));
+}
+
+void ConsoleCommandManager::Match(const std::string& text, int maxMatches, std::vector<const DictionaryEntry*>& outMatches) const
+{
+	commandDictionary.Match(text, maxMatches, outMatches);
 }
 
-std::vector<const DictionaryEntry*> ConsoleCommandManager::Match(const std::string& text) const
+void ConsoleCommandManager::MarkUsed(const std::string& command)
 {
-	return commandDictionary.Match(text);
+	commandDictionary.MarkUsed(command);
 }
 
 ConsoleVariable* ConsoleCommandManager::GetVariable(const std::string& variable) const
@@ -123,368 +120,342 @@ ConsoleCommand* ConsoleCommandManager::GetCommand(const std::string& command) co
 	return commandMap.at(command).get();
 }
 
-Argument ConsoleCommandManager::ExecuteArgumentFunction(std::string text)
+std::unique_ptr<ConsoleCommandManager::ExpressionNode> ConsoleCommandManager::CompileCall(const std::string& function, const std::string& argumentList, const std::string& source)
 {
-	std::pair<std::string, std::string> functionParam = ParseFunctionAndArgumentList(text);
+	auto commandIter = commandMap.find(function);
+	if(commandIter == commandMap.end())
+		throw std::invalid_argument("Evaluated \"" + source + "\" to be a function call to \"" + function + "\" , but no such function was found");
 
-	if(commandMap.find(functionParam.first) == commandMap.end())
-		throw std::invalid_argument("Evaluated \"" + text + "\" to be a function call to \"" + functionParam.first + "\" , but no such function was found");
+	std::unique_ptr<ExpressionNode> call(new ExpressionNode(ExpressionNode::KIND::CALL));
+	call->command = commandIter->second.get();
 
-	try
-	{
-		std::vector<std::string> textArguments = SplitArg(functionParam.second, ' ');
+	std::vector<std::string> textArguments = SplitArg(argumentList, ',');
+	call->children.reserve(textArguments.size());
 
-		std::vector<Argument> arguments;
-		if(commandMap[functionParam.first]->GetForceStringArguments())
+	for(const std::string& argument : textArguments)
+	{
+		if(call->command->GetForceStringArguments())
 		{
-			for(const std::string& argument : textArguments)
-			{
-				if(argument.front() == '"')
-					arguments.emplace_back(argument.substr(1, argument.size() - 2));
-				else
-					arguments.emplace_back(argument);
-			}
+			std::unique_ptr<ExpressionNode> constant(new ExpressionNode(ExpressionNode::KIND::CONSTANT));
+
+			if(argument.size() >= 2 && argument.front() == '"')
+				constant->constant = argument.substr(1, argument.size() - 2);
+			else
+				constant->constant = argument;
+
+			call->children.emplace_back(std::move(constant));
 		}
 		else
 		{
-			for(const std::string& argument : textArguments)
-				arguments.emplace_back(EvaluateExpression(argument));
+			call->children.emplace_back(CompileExpression(argument));
+			call->children.back()->source = argument;
 		}
-
-		return commandMap[functionParam.first]->Execute(&contextPointers, arguments);
 	}
-	catch(std::invalid_argument& ex)
+
+	return call;
+}
+
+std::unique_ptr<ConsoleCommandManager::ExpressionNode> ConsoleCommandManager::CompileExpression(const std::string& expression)
+{
+	if(expression.empty())
+		return std::unique_ptr<ExpressionNode>(new ExpressionNode(ExpressionNode::KIND::CONSTANT));
+
+	size_t index = 0;
+	std::unique_ptr<ExpressionNode> node = CompileSum(expression, index);
+
+	if(index != expression.size())
+		throw std::invalid_argument("Evaluated \"" + expression + "\" to be an expression, but found unexpected \"" + expression.substr(index) + "\"");
+
+	return node;
+}
+
+std::unique_ptr<ConsoleCommandManager::ExpressionNode> ConsoleCommandManager::CompileSum(const std::string& expression, size_t& index)
+{
+	std::unique_ptr<ExpressionNode> lhs = CompileProduct(expression, index);
+
+	while(index < expression.size()
+		&& (expression[index] == '+' || expression[index] == '-'))
 	{
-		Argument exceptionArgument(ex.what());
-		exceptionArgument.origin = "invalid_argument exception";
+		std::unique_ptr<ExpressionNode> operation(new ExpressionNode(ExpressionNode::KIND::OPERATION));
+		operation->operation = expression[index] == '+' ? OPERATORS::PLUS : OPERATORS::MINUS;
+
+		++index;
 
-		return exceptionArgument;
+		operation->children.emplace_back(std::move(lhs));
+		operation->children.emplace_back(CompileProduct(expression, index));
+
+		lhs = std::move(operation);
 	}
+
+	return lhs;
 }
 
-Argument ConsoleCommandManager::EvaluateExpression(std::string expression) /*throws invalid_argument */
+std::unique_ptr<ConsoleCommandManager::ExpressionNode> ConsoleCommandManager::CompileProduct(const std::string& expression, size_t& index)
 {
-	Argument returnArgument;
-	returnArgument.values.emplace_back(expression);
+	std::unique_ptr<ExpressionNode> lhs = CompileOperand(expression, index);
 
-	if(expression.size() == 0)
-		returnArgument.type = Argument::TYPE::NONE;
-	else
+	while(index < expression.size()
+		&& (expression[index] == '*' || expression[index] == '/'))
 	{
-		//There are three different things to extract:
-		//"adsf" => string, asdf
-		//someFunction(parameters) => call function and return its return value
-		//numbers => int32/int64/uint64/float/double, number
-		if(expression[0] == '"')
-		{
-			//string
-			for(int i = 1, end = static_cast<int>(expression.size() - 1); i < end; ++i)
-			{
-				auto character = expression[i];
+		std::unique_ptr<ExpressionNode> operation(new ExpressionNode(ExpressionNode::KIND::OPERATION));
+		operation->operation = expression[index] == '*' ? OPERATORS::MULT : OPERATORS::DIV;
 
-				if(character == '"' && expression[i - 1] != '\\')
-					throw std::invalid_argument("Evaluated \"" + expression + "\" to be a string, but some additional quote (\") was found");
-				else if(character == '\\' && expression[i + 1] == '"')
-				{
-					expression.erase(i, 1);
-					--end;
-				}
-			}
+		++index;
 
-			if(expression.back() != '"')
-				throw std::invalid_argument("Evaluated \"" + expression + "\" to be a string, but no closing quote was found");
+		operation->children.emplace_back(std::move(lhs));
+		operation->children.emplace_back(CompileOperand(expression, index));
 
-			returnArgument.type = Argument::TYPE::STRING;
-			returnArgument.values.front() = expression.substr(1, expression.size() - 2);
-		}
-		else
-		{
-			//At this point it's either misspelled, a number, or a function call.
-			//If it's a number or a function call arithmetic operators are allowed, so we need to check for that
-			returnArgument = ParseExpression(expression);
-		}
+		lhs = std::move(operation);
 	}
 
-	returnArgument.origin = expression;
-	return returnArgument;
+	return lhs;
 }
 
-Argument ConsoleCommandManager::ParseExpression(std::string expression)
+std::unique_ptr<ConsoleCommandManager::ExpressionNode> ConsoleCommandManager::CompileOperand(const std::string& expression, size_t& index)
 {
-	Argument returnArgument;
+	if(index >= expression.size())
+		throw std::invalid_argument("Evaluated \"" + expression + "\" to be an expression, but it ended where a value was expected");
 
-	std::queue<std::string> expressionParts = SplitExpression(expression);
+	char character = expression[index];
 
-	if(expressionParts.size() > 1)
-		returnArgument = CalculateExpression(expressionParts);
-	else if(std::isalpha(expression[0]))
+	if(character == '+' || character == '-')
 	{
-		if(expression == "true" || expression == "TRUE")
-		{
-			returnArgument.type = Argument::TYPE::BOOL;
-			returnArgument.values.emplace_back("1");
-		}
-		else if(expression == "false" || expression == "FALSE")
-		{
-			returnArgument.type = Argument::TYPE::BOOL;
-			returnArgument.values.emplace_back("0");
-		}
+		//Unary +/- is the same as 0 +/- operand
+		std::unique_ptr<ExpressionNode> zero(new ExpressionNode(ExpressionNode::KIND::CONSTANT));
+		static_cast<int32_t>(0) >> zero->constant;
+
+		std::unique_ptr<ExpressionNode> operation(new ExpressionNode(ExpressionNode::KIND::OPERATION));
+		operation->operation = character == '+' ? OPERATORS::PLUS : OPERATORS::MINUS;
+
+		++index;
 
-		if(expression.back() == ',')
-			expression.pop_back();
+		operation->children.emplace_back(std::move(zero));
+		operation->children.emplace_back(CompileOperand(expression, index));
 
-		returnArgument = ExecuteArgumentFunction(expression);
+		return operation;
 	}
-	else
+	else if(character == '(')
+	{
+		++index;
+
+		std::unique_ptr<ExpressionNode> node = CompileSum(expression, index);
+
+		if(index >= expression.size() || expression[index] != ')')
+			throw std::invalid_argument("\"" + expression + "\" has unbalanced parentheses");
+
+		++index;
+
+		return node;
+	}
+	else if(character == '"')
 	{
-		//int32/int64/uint64/float/double
-		std::stringstream sstream(expression);
+		std::string text;
 
-		if(expression.back() == 'f')
+		for(++index; index < expression.size(); ++index)
 		{
-			if(TryExtract<float>(sstream))
+			if(expression[index] == '\\'
+				&& index + 1 < expression.size()
+				&& expression[index + 1] == '"')
 			{
-				returnArgument.type = Argument::TYPE::FLOAT;
-				returnArgument.values.emplace_back(sstream.str());
-				//returnArgument.values.emplace_back(expression.substr(0, expression.size() - 1));
+				text += '"';
+				++index;
 			}
+			else if(expression[index] == '"')
+				break;
 			else
-				throw std::invalid_argument("Evaluated \"" + expression + "\" to be a float, but extraction failed");
+				text += expression[index];
 		}
-		else if(expression.find('.') != expression.npos)
-		{
-			if(std::count(expression.begin(), expression.end(), '.') == 1)
-			{
-				if(TryExtract<double>(sstream))
-				{
-					returnArgument.type = Argument::TYPE::DOUBLE;
-					returnArgument.values.emplace_back(sstream.str());
-				}
-				else
-					throw std::invalid_argument("Evaluated \"" + expression + "\" to be a double, but extraction failed");
-			}
-			else
-				throw std::invalid_argument("Evaluated \"" + expression + "\" to be a double, but more than one decimal point was found");
-		}
-		else
-		{
-			for(char character : expression)
-			{
-				if(!std::isdigit(character)
-					&& character != '-'
-					&& character != '+')
-					throw std::invalid_argument("Evaluated \"" + expression + "\" to be an integer, but " + character + " was not a number or a +/-");
-			}
 
-			if(TryExtract<int32_t>(sstream))
-				returnArgument.type = Argument::TYPE::INT32;
-			else if(TryExtract<int64_t>(sstream))
-				returnArgument.type = Argument::TYPE::INT64;
-			else if(TryExtract<uint64_t>(sstream))
-				returnArgument.type = Argument::TYPE::UINT64;
-			else
-				throw std::invalid_argument("Evaluated \"" + expression + "\" to be a integer, but extraction failed");
+		if(index >= expression.size())
+			throw std::invalid_argument("Evaluated \"" + expression + "\" to be a string, but no closing quote was found");
 
-			returnArgument.values.emplace_back(sstream.str());
+		++index; //Skip closing quote
 
-		}
-	}
+		std::unique_ptr<ExpressionNode> constant(new ExpressionNode(ExpressionNode::KIND::CONSTANT));
+		constant->constant = text;
 
-	returnArgument.origin = expression;
-	return returnArgument;
-}
+		return constant;
+	}
+	else if(std::isalpha(character))
+	{
+		size_t nameBegin = index;
 
-Argument ConsoleCommandManager::CalculateExpression(std::queue<std::string>& expressionParts)
-{
-	//Console_Print(1.0 / 2.0f + 5.0 * 2.0 - 1 * 3 / 5)
+		while(index < expression.size()
+			&& (std::isalnum(expression[index]) || expression[index] == '_'))
+			++index;
 
-	//1.0 / 2.0f + 5.0 * 2.0 - 1 * 3 / 5
-	//0.5 + 5.0 * 2.0 - 1 * 3 / 5
-	//0.5 + 10.0 - 1 * 3 / 5
-	//0.5 + 10.0 - 3 / 5
-	//0.5 + 10.0 - 0.6
-	//10.5 - 0.6
-	//9.9
+		std::string name = expression.substr(nameBegin, index - nameBegin);
 
+		if(name == "true" || name == "TRUE"
+			|| name == "false" || name == "FALSE")
+		{
+			std::unique_ptr<ExpressionNode> constant(new ExpressionNode(ExpressionNode::KIND::CONSTANT));
+			(name == "true" || name == "TRUE") >> constant->constant;
 
-	//Console_Print(1 * 2 / 3)
+			return constant;
+		}
 
-	std::stack<Argument> operands;
-	std::stack<OPERATORS> operators;
+		if(index >= expression.size() || expression[index] != '(')
+			return CompileCall(name, "", expression); //No arguments given to the function
 
-	const static bool execute[5][5] =
-	{//     +    -      *      /     NONE
-		{ true, true, true, true, false }, // +
-		{ true, true, true, true, false }, // -
-		{ false, false, true, true, false }, // *
-		{ false, false, true, true, false },  // /
-		{ false, false, false, false, false }  // NONE
-	};
+		//Find the matching parenthesis, ignoring any inside strings
+		size_t argumentsBegin = index + 1;
 
-	while(expressionParts.size() > 0)
-	{
-		std::string part = expressionParts.front();
-		expressionParts.pop();
+		int depth = 0;
+		bool insideString = false;
+		char lastCharacter = 0;
 
-		if(part == "(" || part == ")")
+		for(; index < expression.size(); ++index)
 		{
-			if(part == "(")
-			{
-				Argument newOperand = CalculateExpression(expressionParts);
+			char current = expression[index];
 
-				operands.emplace(std::move(newOperand));
-			}
-			else
+			if(current == '"' && lastCharacter != '\\')
+				insideString = !insideString;
+			else if(!insideString)
 			{
-				while(operators.size() > 0)
-					ExecuteSingleCalculation(operands, operators);
-
-				return operands.top();
+				if(current == '(')
+					++depth;
+				else if(current == ')' && --depth == 0)
+					break;
 			}
+
+			lastCharacter = current;
 		}
-		else
-		{
-			OPERATORS current = OPERATORS::NONE;
 
-			switch(part[0])
-			{
-				case '+':
-					current = OPERATORS::PLUS;
-					break;
-				case '-':
-					current = OPERATORS::MINUS;
-					break;
-				case '*':
-					current = OPERATORS::MULT;
-					break;
-				case '/':
-					current = OPERATORS::DIV;
-					break;
-				default:
-					break;
-			}
+		if(index >= expression.size())
+			throw std::invalid_argument("\"" + expression + "\" has unbalanced parentheses");
 
-			if(current == OPERATORS::NONE)
-			{
-				//This is either a function call or a number/string
-				if(std::isalpha(part[0]))
-				{
-					//Function call
-					//Check for arguments
-					if(expressionParts.size() > 0
-						&& expressionParts.front() == "(")
-					{
-						//Function has arguments, so collect all of them and then execute the function
-						std::string functionWithArgs = part;
-
-						int depth = 0;
-
-						while(expressionParts.size() > 0)
-						{
-							std::string currentPart = expressionParts.front();
-							expressionParts.pop();
-
-							if(currentPart == "(")
-								++depth;
-							else if(currentPart == ")")
-							{
-								--depth;
-
-								if(depth == 0)
-								{
-									functionWithArgs += currentPart;
-									break;
-								}
-							}
-
-							functionWithArgs += currentPart;
-						}
-
-						Argument newArg = ExecuteArgumentFunction(functionWithArgs);
-						operands.emplace(std::move(newArg));
-					}
-					else
-					{
-						//No arguments given to the function
-						Argument newArg = ExecuteArgumentFunction(part + "()");
-						operands.emplace(std::move(newArg));
-					}
-				}
-				else
-					operands.emplace(std::move(part)); //Number/string
-			}
-			else
-			{
-				if(operators.size() > 0)
-				{
-					if(execute[static_cast<int>(current)][static_cast<int>(operators.top())])
-						ExecuteSingleCalculation(operands, operators);
-				}
+		++index; //Skip )
 
-				operators.emplace(current);
-			}
-		}
+		return CompileCall(name, expression.substr(argumentsBegin, index - 1 - argumentsBegin), expression);
 	}
+	else if(std::isdigit(character) || character == '.')
+	{
+		size_t numberBegin = index;
 
-	while(operators.size() > 0)
-		ExecuteSingleCalculation(operands, operators);
+		while(index < expression.size()
+			&& (std::isdigit(expression[index]) || expression[index] == '.'))
+			++index;
 
-	return operands.top();
+		if(index < expression.size() && expression[index] == 'f')
+			++index;
+
+		return CompileNumber(expression.substr(numberBegin, index - numberBegin));
+	}
+
+	throw std::invalid_argument("Evaluated \"" + expression + "\" to be an expression, but '" + character + "' isn't a number, string, function, or operator");
 }
 
-void ConsoleCommandManager::ExecuteSingleCalculation(std::stack<Argument>& operands, std::stack<OPERATORS>& operators)
+std::unique_ptr<ConsoleCommandManager::ExpressionNode> ConsoleCommandManager::CompileNumber(const std::string& number)
 {
-	OPERATORS opToPerform = operators.top();
-	operators.pop();
+	std::unique_ptr<ExpressionNode> constant(new ExpressionNode(ExpressionNode::KIND::CONSTANT));
 
-	Argument rhs;
-	if(operands.size() > 0)
+	const char* begin = number.c_str();
+	char* end = nullptr;
+
+	if(number.back() == 'f')
 	{
-		rhs = EvaluateExpression(operands.top().values.front());
-		operands.pop();
+		float value = std::strtof(begin, &end);
+
+		if(end != begin + number.size() - 1)
+			throw std::invalid_argument("Evaluated \"" + number + "\" to be a float, but extraction failed");
+
+		value >> constant->constant;
 	}
-	else
+	else if(number.find('.') != number.npos)
 	{
-		rhs.type = Argument::TYPE::INT32;
-		rhs.values.emplace_back("0");
-	}
+		if(std::count(number.begin(), number.end(), '.') != 1)
+			throw std::invalid_argument("Evaluated \"" + number + "\" to be a double, but more than one decimal point was found");
 
-	Argument lhs;
-	if(operands.size() > 0)
-	{
-		lhs = EvaluateExpression(operands.top().values.front());
-		operands.pop();
+		double value = std::strtod(begin, &end);
+
+		if(end != begin + number.size())
+			throw std::invalid_argument("Evaluated \"" + number + "\" to be a double, but extraction failed");
+
+		value >> constant->constant;
 	}
 	else
 	{
-		lhs.type = Argument::TYPE::INT32;
-		lhs.values.emplace_back("0");
+		errno = 0;
+		long long value = std::strtoll(begin, &end, 10);
+
+		if(end != begin + number.size())
+			throw std::invalid_argument("Evaluated \"" + number + "\" to be an integer, but extraction failed");
+
+		if(errno != ERANGE)
+		{
+			if(value <= std::numeric_limits<int32_t>::max())
+				static_cast<int32_t>(value) >> constant->constant;
+			else
+				static_cast<int64_t>(value) >> constant->constant;
+		}
+		else
+		{
+			errno = 0;
+			unsigned long long unsignedValue = std::strtoull(begin, &end, 10);
+
+			if(errno == ERANGE)
+				throw std::invalid_argument("Evaluated \"" + number + "\" to be a integer, but it's too large");
+
+			static_cast<uint64_t>(unsignedValue) >> constant->constant;
+		}
 	}
 
-	Argument result;
+	return constant;
+}
+
+Argument ConsoleCommandManager::Evaluate(const ExpressionNode& node)
+{
+	Argument returnArgument;
 
-	switch(opToPerform)
+	switch(node.kind)
 	{
-		case OPERATORS::PLUS:
-			result = lhs + rhs;
-			break;
-		case OPERATORS::MINUS:
-			result = lhs - rhs;
-			break;
-		case OPERATORS::MULT:
-			result = lhs * rhs;
+		case ExpressionNode::KIND::CONSTANT:
+			returnArgument = node.constant;
 			break;
-		case OPERATORS::DIV:
-			result = lhs / rhs;
+		case ExpressionNode::KIND::CALL:
+		{
+			std::vector<Argument> arguments;
+			arguments.reserve(node.children.size());
+
+			for(const std::unique_ptr<ExpressionNode>& child : node.children)
+				arguments.emplace_back(Evaluate(*child));
+
+			returnArgument = node.command->Execute(&contextPointers, arguments);
 			break;
-		case OPERATORS::NONE:
+		}
+		case ExpressionNode::KIND::OPERATION:
+		{
+			Argument lhs = Evaluate(*node.children[0]);
+			Argument rhs = Evaluate(*node.children[1]);
+
+			switch(node.operation)
+			{
+				case OPERATORS::PLUS:
+					returnArgument = lhs + rhs;
+					break;
+				case OPERATORS::MINUS:
+					returnArgument = lhs - rhs;
+					break;
+				case OPERATORS::MULT:
+					returnArgument = lhs * rhs;
+					break;
+				case OPERATORS::DIV:
+					returnArgument = lhs / rhs;
+					break;
+				default:
+					break;
+			}
 			break;
+		}
 		default:
-			//This won't ever happen since it would throw in the previous switch statement
 			break;
 	}
 
-	operands.push(result);
+	if(!node.source.empty())
+		returnArgument.origin = node.source;
+
+	return returnArgument;
 }
 
 std::vector<std::string> ConsoleCommandManager::SplitArg(std::string args, char delimiter)
@@ -542,46 +513,6 @@ std::vector<std::string> ConsoleCommandManager::SplitArg(std::string args, char
 	return returnVector;
 }
 
-std::queue<std::string> ConsoleCommandManager::SplitExpression(std::string expression)
-{
-	const static std::string arithmeticOps = "+-/*()";
-
-	std::queue<std::string> returnVector;
-
-	//2.0f+Print()*2.0f
-
-	//Print()*2.0f
-	//)*2.0f
-
-	auto index = expression.find_first_of(arithmeticOps);
-	while(index != expression.npos)
-	{
-		if(index == 0)
-		{
-			//Value
-			returnVector.emplace(expression.substr(0, 1));
-			expression.erase(0, 1);
-		}
-		else
-		{
-			//Value
-			returnVector.emplace(expression.substr(0, index));
-
-			//Op
-			returnVector.emplace(expression.substr(index, 1));
-			expression.erase(0, index + 1);
-		}
-
-
-		index = expression.find_first_of(arithmeticOps);
-	}
-
-	if(!expression.empty())
-		returnVector.emplace(expression.substr(0, index));
-
-	return returnVector;
-}
-
 std::string ConsoleCommandManager::TrimText(std::string text)
 {
 	if(text.size() == 0)
@@ -2,10 +2,10 @@
 #define OPENGLWINDOW_CONSOLECOMMANDMANAGER_H
 
 #include <memory>
-#include <queue>
 #include <string>
 #include <cctype>
-#include <stack>
+#include <map>
+#include <unordered_map>
 
 #include "textBox.h"
 #include "textField.h"
@@ -76,6 +76,9 @@ public:
 	* 1. FunctionCall OtherFunction()
 	* 2. FunctionCall OtherFunction(), AnotherFunction()
 	*
+	* The text is only parsed the first time it's executed, after that the compiled
+	* command is reused until #MAX_COMPILED_COMMANDS different commands have been executed
+	*
 	* \throws std::invalid_argument if \p text is invalid, exception contains details
 	* \param text command to execute
 	* \returns the command's returned Argument cast to a string
@@ -83,14 +86,21 @@ public:
 	std::string ExecuteCommand(std::string text);
 
 	/**
-	* Matches the given text with all available commands
+	* Finds the commands that best match the given text
 	*
-	* Matched using DictionaryEntry::Matches
+	* See Dictionary::Match for how matches are ranked
 	* 
 	* \param text text to match against all commands
-	* \returns an std::vector containing all commands with a matching name
+	* \param maxMatches max number of commands to return
+	* \param outMatches cleared and filled with the best matching commands, best match first
+	*/
+	void Match(const std::string& text, int maxMatches, std::vector<const DictionaryEntry*>& outMatches) const;
+	/**
+	* Marks \p command as recently used so that it's ranked higher by #Match
+	* 
+	* \param command name of the command
 	*/
-	std::vector<const DictionaryEntry*> Match(const std::string& text) const;
+	void MarkUsed(const std::string& command);
 
 	/**
 	* Returns the variable with the given name if it is found
@@ -129,66 +139,95 @@ private:
 	std::map<std::string, std::unique_ptr<ConsoleCommand>> commandMap;
 
 	/**
-	* Same as ConsoleCommandManager::ExecuteCommand, except this returns an argument instead of a string
-	* 
-	* \throws std::invalid_argument if \p text is invalid, exception contains details
-	* \param text command to execute
-	* \returns the command's returned Argument
+	* A parsed command or expression. Built once per command text by #CompileCall and then
+	* evaluated by #Evaluate every time the same text is executed
 	*/
-	Argument ExecuteArgumentFunction(std::string text);
+	struct ExpressionNode
+	{
+		enum class KIND { CONSTANT, CALL, OPERATION };
+
+		ExpressionNode(KIND kind)
+			: kind(kind)
+			, command(nullptr)
+			, operation(OPERATORS::NONE)
+		{}
+
+		KIND kind;
+		//Text this node was compiled from, used as origin of the evaluated Argument. Only set for arguments
+		std::string source;
+
+		Argument constant; //KIND::CONSTANT
+		ConsoleCommand* command; //KIND::CALL. Commands are never removed so this stays valid
+		OPERATORS operation; //KIND::OPERATION
+
+		//Arguments for KIND::CALL, lhs and rhs for KIND::OPERATION
+		std::vector<std::unique_ptr<ExpressionNode>> children;
+	};
+
+	//Compiled commands keyed by the text passed to ExecuteCommand.
+	//Cleared when full so sweeps that execute a new value every time don't grow it forever
+	std::unordered_map<std::string, std::unique_ptr<ExpressionNode>> compiledCommands;
+	static const size_t MAX_COMPILED_COMMANDS = 4096;
+
 	/**
-	* Turns the given text into an Argument
+	* Compiles a call to \p function
 	*
-	* Example:
-	* EvaluateExpression("1") returns an Argument of type int with value "1"
-	* EvaluateExpression("1.0f") returns an Argument of type float with value "1.0f"
-	* EvaluateExpression("1.0") returns an Argument of type double with value "1.0"
-	* EvaluateExpression("\"string\"") returns an Argument of type string with value "string"
-	* EvaluateExpression("true") returns an Argument of type bool with value "true"
-	* 
-	* \throws std::invalid_argument if \p text is invalid, exception contains details
-	* \param expression
-	* \returns
+	* Arguments are compiled with #CompileExpression, unless the command forces string arguments
+	* in which case they are stored as-is with surrounding quotes removed
+	*
+	* \throws std::invalid_argument if there's no such function or an argument is invalid, exception contains details
+	* \param function name of the function to call
+	* \param argumentList comma separated arguments, without surrounding parentheses
+	* \param source text \p function and \p argumentList came from, used for error messages
+	* \returns the compiled call
 	*/
-	Argument EvaluateExpression(std::string expression);
+	std::unique_ptr<ExpressionNode> CompileCall(const std::string& function, const std::string& argumentList, const std::string& source);
 	/**
-	* Turns numbers into a single Argument
+	* Compiles a single argument
 	*
 	* Example:
-	* EvaluateExpression("1 + 1") returns an Argument of type int with value "2"
-	* EvaluateExpression("1 + 1.0f") returns an Argument of type float with value "2.0f"
-	* EvaluateExpression("1") returns an Argument of type int with value "1"
-	* EvaluateExpression("1.0f") returns an Argument of type float with value "1.0f"
-	* EvaluateExpression("1.0") returns an Argument of type double with value "1.0"
-	* EvaluateExpression("true") returns an Argument of type bool with value "true"
+	* CompileExpression("1") evaluates to an Argument of type int with value 1
+	* CompileExpression("1.0f") evaluates to an Argument of type float with value 1.0f
+	* CompileExpression("1.0") evaluates to an Argument of type double with value 1.0
+	* CompileExpression("\"string\"") evaluates to an Argument of type string with value "string"
+	* CompileExpression("true") evaluates to an Argument of type bool with value true
+	* CompileExpression("(1 + 2) * Foo(3)") evaluates to 3 times the result of calling Foo with 3
 	* 
-	* \throws std::invalid_argument if \p text is invalid, exception contains details
-	* \param expression
-	* \returns
+	* \throws std::invalid_argument if \p expression is invalid, exception contains details
+	* \param expression expression to compile
+	* \returns the compiled expression
 	*/
-	Argument ParseExpression(std::string expression);
+	std::unique_ptr<ExpressionNode> CompileExpression(const std::string& expression);
 	/**
-	* Calculates a mathematical expression
+	* Recursive descent over \p expression, starting at \p index
 	*
-	* Example:
-	* EvaluateExpression("1 + 1") returns an Argument of type int with value "2"
-	* EvaluateExpression("1 + 1.0f") returns an Argument of type float with value "2.0f"
-	* 
-	* \param expressionParts a queue with parts of the expression. View ConsoleCommandManager::SplitExpression
-	* \returns
+	* CompileSum handles + and -, CompileProduct handles * and /, and CompileOperand handles
+	* numbers, strings, function calls, parentheses and unary +/-
+	*
+	* \throws std::invalid_argument if \p expression is invalid, exception contains details
+	* \param expression whole expression
+	* \param[out] index index of the first character to compile, moved past the compiled part
+	* \returns the compiled part of \p expression
 	*/
-	Argument CalculateExpression(std::queue<std::string>& expressionParts);
-
+	std::unique_ptr<ExpressionNode> CompileSum(const std::string& expression, size_t& index);
+	std::unique_ptr<ExpressionNode> CompileProduct(const std::string& expression, size_t& index);
+	std::unique_ptr<ExpressionNode> CompileOperand(const std::string& expression, size_t& index);
 	/**
-	* Takes two operands from \p operands and one operator from \p operators and performs one calculation.
-	* Result is pushed onto \p operands
-	*
-	* If \p operands contains less than two operands, "0" will be used instead
+	* Parses a number into an int32/int64/uint64/float/double depending on its format and size
 	*
-	* \param[out] operands a stack containing operands to base the calculation off of
-	* \param[out] operators a stack containing operators to base the calculation off of
+	* \throws std::invalid_argument if \p number can't be parsed
+	* \param number number without sign, "f" suffix means float and a decimal point means double
+	* \returns a constant node with the number
+	*/
+	std::unique_ptr<ExpressionNode> CompileNumber(const std::string& number);
+	/**
+	* Evaluates a compiled node, executing any function calls in it
+	* 
+	* \throws std::invalid_argument if an operation is invalid (such as division by zero)
+	* \param node node to evaluate
+	* \returns the resulting Argument
 	*/
-	void ExecuteSingleCalculation(std::stack<Argument>& operands, std::stack<OPERATORS>& operators);
+	Argument Evaluate(const ExpressionNode& node);
 
 	/**
 	* Splits \p args by \p delimiter
@@ -201,23 +240,6 @@ private:
 	* \returns a vector of strings containing the arguments as split by \p delimiter
 	*/
 	std::vector<std::string> SplitArg(std::string args, char delimiter);
-	/**
-	* Splits a mathematical expression into its components
-	*
-	* The components are:
-	* 1. Arithmetic operators (+-/*)
-	* 2. Parentheses
-	* 3. Operands (function calls, numbers)
-	*
-	* Example:
-	* `SplitExpression("(1 + 2) * 3.0f")` returns
-	* "(", "1", "+", "2", ")", "*", "3.0f"
-	* 
-	* \param expression mathematical expression to split
-	* \returns a queue containing the split expression
-	*/
-	std::queue<std::string> SplitExpression(std::string expression);
-
 	/**
 	* Removes unnecessary whitespace
 	*
@@ -236,23 +258,6 @@ private:
 	*/
 	std::string TrimTextFrontBack(const std::string& text);
 
-	/**
-	* Tries using the >> operator to extract data from /p sstream to a variable of type T
-	*
-	* Example:
-	* 
-	* \param[out] sstream stream to try extracting from
-	* \returns whether or not extraction succeeded
-	*/
-	template<typename T>
-	bool TryExtract(std::stringstream& sstream)
-	{
-		T testVal;
-		sstream >> testVal;
-
-		return !sstream.fail();
-	}
-
 	/**
 	* Makes sure every left parenthesis has a buddy right parenthesis 
 	*
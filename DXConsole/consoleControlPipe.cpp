@@ -0,0 +1,360 @@
+#include "consoleControlPipe.h"
+
+#include <sstream>
+#include <stdexcept>
+
+#include <windows.h>
+
+#include <DXLib/logger.h>
+
+#include "console.h"
+
+ConsoleControlPipe::ConsoleControlPipe()
+	: stopEvent(nullptr)
+	, sendEvent(nullptr)
+	, connected(false)
+	, sendStats(false)
+	, frameNumber(0)
+{
+}
+
+ConsoleControlPipe::~ConsoleControlPipe()
+{
+	Stop();
+}
+
+bool ConsoleControlPipe::Start(const std::string& name)
+{
+	Stop();
+
+	pipeName = "\\\\.\\pipe\\" + name;
+
+	stopEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+	sendEvent = CreateEventA(nullptr, FALSE, FALSE, nullptr);
+
+	if(stopEvent == nullptr
+		|| sendEvent == nullptr)
+	{
+		Logger::LogLine(LOG_TYPE::WARNING, "Couldn't create events for control pipe \"" + pipeName + "\"");
+		Stop();
+
+		return false;
+	}
+
+	pipeThread = std::thread(&ConsoleControlPipe::PipeMain, this);
+
+	Logger::LogLine(LOG_TYPE::INFO, "Listening for console commands on \"" + pipeName + "\"");
+
+	return true;
+}
+
+void ConsoleControlPipe::Stop()
+{
+	if(pipeThread.joinable())
+	{
+		SetEvent(stopEvent);
+		pipeThread.join();
+	}
+
+	if(stopEvent != nullptr)
+	{
+		CloseHandle(stopEvent);
+		stopEvent = nullptr;
+	}
+
+	if(sendEvent != nullptr)
+	{
+		CloseHandle(sendEvent);
+		sendEvent = nullptr;
+	}
+
+	connected = false;
+	sendStats = false;
+
+	std::lock_guard<std::mutex> incomingLock(incomingMutex);
+	incomingCommands.clear();
+
+	std::lock_guard<std::mutex> outgoingLock(outgoingMutex);
+	outgoingText.clear();
+}
+
+void ConsoleControlPipe::ExecutePending(Console* console)
+{
+	{
+		std::lock_guard<std::mutex> lock(incomingMutex);
+
+		if(incomingCommands.empty())
+			return;
+
+		executingCommands.swap(incomingCommands);
+	}
+
+	for(const std::string& command : executingCommands)
+	{
+		if(command.compare(0, 7, "!stats ") == 0)
+		{
+			sendStats = command.compare(7, std::string::npos, "0") != 0;
+			Send("result " + std::to_string(frameNumber) + " stats " + (sendStats ? "enabled" : "disabled"));
+
+			continue;
+		}
+
+		std::string result;
+
+		try
+		{
+			result = console->ExecuteCommand(command);
+		}
+		catch(std::exception& ex)
+		{
+			result = "An unknown exception was caught when trying to execute\"" + command + "\": " + std::string(ex.what());
+		}
+
+		console->AddText(command);
+		if(!result.empty())
+			console->AddText(result);
+
+		Send("result " + std::to_string(frameNumber) + " " + Escape(result));
+	}
+
+	executingCommands.clear();
+}
+
+void ConsoleControlPipe::AddFrameStat(const std::string& name, double milliseconds)
+{
+	if(!sendStats)
+		return;
+
+	std::ostringstream stream;
+	stream << ' ' << name << '=' << milliseconds;
+
+	frameStats += stream.str();
+}
+
+void ConsoleControlPipe::EndFrame()
+{
+	if(sendStats)
+		Send("frame " + std::to_string(frameNumber) + frameStats);
+
+	frameStats.clear();
+	++frameNumber;
+}
+
+bool ConsoleControlPipe::IsConnected() const
+{
+	return connected;
+}
+
+void ConsoleControlPipe::PipeMain()
+{
+	OVERLAPPED readOverlapped = {};
+	OVERLAPPED writeOverlapped = {};
+
+	readOverlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+	writeOverlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+
+	char readBuffer[4096];
+	std::string partialLine;
+	std::string writeText;
+
+	bool stopping = false;
+
+	while(!stopping)
+	{
+		HANDLE pipe = CreateNamedPipeA(pipeName.c_str()
+									   , PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED
+									   , PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS
+									   , 1
+									   , sizeof(readBuffer)
+									   , sizeof(readBuffer)
+									   , 0
+									   , nullptr);
+
+		if(pipe == INVALID_HANDLE_VALUE)
+		{
+			Logger::LogLine(LOG_TYPE::WARNING, "Couldn't create control pipe \"" + pipeName + "\", error " + std::to_string(GetLastError()));
+			break;
+		}
+
+		//Wait for a client
+		bool clientConnected = ConnectNamedPipe(pipe, &readOverlapped) != FALSE;
+		if(!clientConnected)
+		{
+			DWORD error = GetLastError();
+
+			if(error == ERROR_PIPE_CONNECTED)
+				clientConnected = true;
+			else if(error == ERROR_IO_PENDING)
+			{
+				HANDLE events[] = { stopEvent, readOverlapped.hEvent };
+
+				if(WaitForMultipleObjects(2, events, FALSE, INFINITE) == WAIT_OBJECT_0)
+				{
+					DWORD bytes = 0;
+
+					CancelIo(pipe);
+					GetOverlappedResult(pipe, &readOverlapped, &bytes, TRUE);
+
+					stopping = true;
+				}
+				else
+				{
+					DWORD bytes = 0;
+					clientConnected = GetOverlappedResult(pipe, &readOverlapped, &bytes, FALSE) != FALSE;
+				}
+			}
+		}
+
+		connected = clientConnected;
+		partialLine.clear();
+
+		bool readPending = false;
+		bool writePending = false;
+
+		while(connected && !stopping)
+		{
+			if(!readPending)
+			{
+				ResetEvent(readOverlapped.hEvent);
+
+				if(!ReadFile(pipe, readBuffer, sizeof(readBuffer), nullptr, &readOverlapped)
+					&& GetLastError() != ERROR_IO_PENDING)
+					break;
+
+				readPending = true;
+			}
+
+			//The read stays pending while a write is in flight, otherwise a client that sends commands faster than it
+			//reads results fills both pipe buffers and neither side can continue. New output waits for the current
+			//write, sendEvent stays signaled until then
+			HANDLE events[] = { stopEvent, readOverlapped.hEvent, writePending ? writeOverlapped.hEvent : sendEvent };
+			DWORD waitResult = WaitForMultipleObjects(3, events, FALSE, INFINITE);
+
+			if(waitResult == WAIT_OBJECT_0)
+				stopping = true;
+			else if(waitResult == WAIT_OBJECT_0 + 1)
+			{
+				readPending = false;
+
+				DWORD bytesRead = 0;
+				if(!GetOverlappedResult(pipe, &readOverlapped, &bytesRead, FALSE))
+					break;
+
+				std::vector<std::string> lines;
+
+				for(DWORD i = 0; i < bytesRead; ++i)
+				{
+					if(readBuffer[i] == '\n')
+					{
+						if(!partialLine.empty() && partialLine.back() == '\r')
+							partialLine.pop_back();
+
+						if(partialLine.find_first_not_of(" \t") != partialLine.npos)
+							lines.push_back(std::move(partialLine));
+
+						partialLine.clear();
+					}
+					else if(partialLine.size() < MAX_LINE_LENGTH)
+						partialLine += readBuffer[i];
+				}
+
+				if(!lines.empty())
+				{
+					std::lock_guard<std::mutex> lock(incomingMutex);
+					incomingCommands.insert(incomingCommands.end(), std::make_move_iterator(lines.begin()), std::make_move_iterator(lines.end()));
+				}
+			}
+			else if(waitResult == WAIT_OBJECT_0 + 2 && writePending)
+			{
+				writePending = false;
+
+				DWORD bytesWritten = 0;
+				if(!GetOverlappedResult(pipe, &writeOverlapped, &bytesWritten, FALSE))
+					break;
+
+				writeText.clear();
+			}
+			else if(waitResult == WAIT_OBJECT_0 + 2)
+			{
+				{
+					std::lock_guard<std::mutex> lock(outgoingMutex);
+					writeText.swap(outgoingText);
+				}
+
+				if(writeText.empty())
+					continue;
+
+				ResetEvent(writeOverlapped.hEvent);
+
+				if(!WriteFile(pipe, writeText.data(), static_cast<DWORD>(writeText.size()), nullptr, &writeOverlapped)
+					&& GetLastError() != ERROR_IO_PENDING)
+					break;
+
+				writePending = true;
+			}
+			else
+				break;
+		}
+
+		connected = false;
+		sendStats = false;
+
+		//Make sure the buffers aren't used by any pending operation before the pipe is closed
+		if(readPending || writePending)
+		{
+			DWORD bytes = 0;
+
+			CancelIo(pipe);
+
+			if(readPending)
+				GetOverlappedResult(pipe, &readOverlapped, &bytes, TRUE);
+			if(writePending)
+				GetOverlappedResult(pipe, &writeOverlapped, &bytes, TRUE);
+		}
+
+		DisconnectNamedPipe(pipe);
+		CloseHandle(pipe);
+
+		std::lock_guard<std::mutex> lock(outgoingMutex);
+		outgoingText.clear();
+	}
+
+	CloseHandle(readOverlapped.hEvent);
+	CloseHandle(writeOverlapped.hEvent);
+}
+
+void ConsoleControlPipe::Send(const std::string& line)
+{
+	if(!connected)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(outgoingMutex);
+
+		if(outgoingText.size() + line.size() + 1 > MAX_PENDING_OUTPUT)
+			return;
+
+		outgoingText += line;
+		outgoingText += '\n';
+	}
+
+	SetEvent(sendEvent);
+}
+
+std::string ConsoleControlPipe::Escape(const std::string& text)
+{
+	std::string escaped;
+	escaped.reserve(text.size());
+
+	for(char character : text)
+	{
+		if(character == '\\')
+			escaped += "\\\\";
+		else if(character == '\n')
+			escaped += "\\n";
+		else if(character != '\r')
+			escaped += character;
+	}
+
+	return escaped;
+}
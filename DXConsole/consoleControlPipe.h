@@ -0,0 +1,111 @@
+#ifndef OPENGLWINDOW_CONSOLECONTROLPIPE_H
+#define OPENGLWINDOW_CONSOLECONTROLPIPE_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+class Console;
+
+/**
+* Lets other processes execute console commands through a local named pipe
+*
+* A background thread accepts one client at a time on \\\\.\\pipe\\<name> and reads
+* newline-separated command lines. The commands are queued and only executed when
+* ExecutePending is called, which should be done on the main thread between frames.
+* Everything queued since the last call is executed at once, so a burst of commands
+* is applied in the same frame.
+*
+* Lines sent back to the client:
+* \code
+* result <frame> <result>                  //One for each command, in the order they were sent
+* frame <frame> <name>=<ms> <name>=<ms>... //Once per frame if enabled with "!stats 1"
+* \endcode
+* Newlines and backslashes in results are escaped as \\n and \\\\
+*
+* Lines beginning with ! are handled by the pipe instead of the console:
+* + `!stats 1` starts sending frame statistics, `!stats 0` stops it
+*/
+class ConsoleControlPipe
+{
+public:
+	ConsoleControlPipe();
+	~ConsoleControlPipe();
+
+	ConsoleControlPipe(const ConsoleControlPipe&) = delete;
+	ConsoleControlPipe& operator=(const ConsoleControlPipe&) = delete;
+
+	/**
+	* Starts listening on \\\\.\\pipe\\<name>
+	*
+	* \param name name of the pipe, without the \\\\.\\pipe\\ prefix
+	* \returns false if the pipe thread couldn't be started
+	*/
+	bool Start(const std::string& name);
+	/**
+	* Disconnects any client and stops the pipe thread. Queued commands are discarded
+	*/
+	void Stop();
+
+	/**
+	* Executes every command received since the last call
+	*
+	* \param console console to execute the commands with
+	*/
+	void ExecutePending(Console* console);
+
+	/**
+	* Adds a statistic to the current frame. Ignored unless the client has enabled statistics
+	*
+	* \param name name of the statistic, may not contain spaces
+	* \param milliseconds time in milliseconds
+	*/
+	void AddFrameStat(const std::string& name, double milliseconds);
+	/**
+	* Sends the current frame's statistics, if enabled, and starts a new frame
+	*/
+	void EndFrame();
+
+	bool IsConnected() const;
+private:
+	//Output is dropped rather than buffered without bounds if the client stops reading
+	static const size_t MAX_PENDING_OUTPUT = 1024 * 1024;
+	static const size_t MAX_LINE_LENGTH = 64 * 1024;
+
+	std::string pipeName;
+
+	std::thread pipeThread;
+
+	//HANDLEs, void* to keep windows.h out of this header
+	void* stopEvent;
+	void* sendEvent;
+
+	std::atomic<bool> connected;
+	std::atomic<bool> sendStats;
+
+	std::mutex incomingMutex;
+	std::vector<std::string> incomingCommands;
+
+	std::mutex outgoingMutex;
+	std::string outgoingText;
+
+	//Only used on the main thread
+	std::vector<std::string> executingCommands;
+	std::string frameStats;
+	unsigned long long frameNumber;
+
+	void PipeMain();
+
+	/**
+	* Queues \p line to be sent to the client. Does nothing if there is no client
+	*
+	* \param line line to send, without a newline
+	*/
+	void Send(const std::string& line);
+
+	static std::string Escape(const std::string& text);
+};
+
+#endif //OPENGLWINDOW_CONSOLECONTROLPIPE_H
@@ -26,6 +26,7 @@ struct ConsoleStyle
 		, lastMessagesBackgroundStyle(nullptr)
 		, historySize(15)
 		, completeListMaxSize(10)
+		, suggestionCount(32)
 		, inputOutputPadding(0.0f)
 		, padding(0.0f, 0.0f)
 		, lastMessagesToDraw(10)
@@ -34,6 +35,7 @@ struct ConsoleStyle
 		, maxLines(1024)
 		, dumpFile("ConsoleDump.txt")
 		, autoexecFile("Autoexec")
+		, autoexecWriteInterval(2000)
 		, allowMove(true)
 		, allowResize(false)
 		, preferLowercaseFunctions(false)
@@ -65,6 +67,7 @@ struct ConsoleStyle
 
 	int historySize;
 	int completeListMaxSize; //In indexes
+	int suggestionCount; //Only the best matches are shown when completing
 
 	bool allowMove;
 	bool allowResize; //Not 100% functional, but still works
@@ -78,10 +81,11 @@ struct ConsoleStyle
 	std::unique_ptr<GUIBackground> lastMessagesBackground;
 	std::shared_ptr<GUIStyle> lastMessagesBackgroundStyle;
 
-	unsigned int maxLines; //After this many lines the oldest lines will be removed and written to "dumpFile" instead
+	unsigned int maxLines; //After this many lines the oldest lines will be removed and written to "dumpFile" instead. 0 for no limit
 	std::string dumpFile;
 
 	std::string autoexecFile;
+	int autoexecWriteInterval; //In milliseconds. Changed watches are written at most this often, and when the console is destroyed
 
 	std::string labelText;
 };
@@ -0,0 +1,349 @@
+#include "consoleSweepRunner.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cmath>
+#include <set>
+
+#include "console.h"
+
+ConsoleSweepRunner::ConsoleSweepRunner()
+	: console(nullptr)
+	, running(false)
+	, combinationCount(0)
+	, currentCombination(0)
+{
+
+}
+
+std::string ConsoleSweepRunner::Start(const std::string& path, Console* console)
+{
+	if(running)
+		return "A sweep is already running, stop it before starting a new one";
+
+	this->console = console;
+
+	variables.clear();
+	results.clear();
+
+	std::string errorString = script.Parse(path, "sweep script", std::bind(&ConsoleSweepRunner::ParseDirective, this, std::placeholders::_1, std::placeholders::_2));
+	if(!errorString.empty())
+		return errorString;
+
+	if(variables.empty())
+		return "\"" + path + "\" doesn't declare any variables to sweep";
+
+	const int maxCombinations = 100000;
+
+	combinationCount = 1;
+	for(Variable& variable : variables)
+	{
+		ConsoleVariable* consoleVariable = console->GetVariable(variable.name);
+		if(consoleVariable == nullptr)
+			return "Can't sweep \"" + variable.name + "\", there is no such variable";
+
+		variable.originalValue = consoleVariable->GetValue();
+
+		//Multiple values are formatted as [x, y, z]
+		if(variable.originalValue.size() >= 2
+			&& variable.originalValue.front() == '['
+			&& variable.originalValue.back() == ']')
+			variable.originalValue = variable.originalValue.substr(1, variable.originalValue.size() - 2);
+
+		combinationCount *= static_cast<int>(variable.values.size());
+		if(combinationCount > maxCombinations)
+			return "\"" + path + "\" has more than " + std::to_string(maxCombinations) + " combinations";
+	}
+
+	combination.assign(variables.size(), 0);
+	appliedCombination.assign(variables.size(), -1);
+
+	results.reserve(combinationCount);
+
+	currentCombination = 0;
+	running = true;
+
+	console->AddText("Starting sweep of " + std::to_string(combinationCount) + " combinations, "
+					 + std::to_string(script.GetWarmupFrames()) + " warmup and " + std::to_string(script.GetMeasureFrames()) + " measured frames each");
+
+	return "";
+}
+
+void ConsoleSweepRunner::Stop()
+{
+	if(!running)
+		return;
+
+	//Only keep finished combinations
+	if(static_cast<int>(results.size()) > currentCombination)
+		results.resize(currentCombination);
+
+	running = false;
+
+	RestoreVariables();
+
+	if(WriteResults())
+		console->AddText("Sweep stopped, results for " + std::to_string(results.size()) + " combinations written to \"" + script.GetOutputPath() + "\"");
+	else
+		console->AddText("Sweep stopped, couldn't write results to \"" + script.GetOutputPath() + "\"");
+}
+
+bool ConsoleSweepRunner::IsRunning() const
+{
+	return running;
+}
+
+void ConsoleSweepRunner::BeginFrame()
+{
+	if(!running)
+		return;
+
+	if(script.IsFirstFrame())
+		ApplyCombination();
+}
+
+void ConsoleSweepRunner::AddTiming(const std::string& name, double milliseconds)
+{
+	if(!running
+		|| results.empty())
+		return;
+
+	script.AddTiming(results.back().timings, name, milliseconds);
+}
+
+void ConsoleSweepRunner::EndFrame()
+{
+	if(!running)
+		return;
+
+	if(!script.EndFrame())
+		return;
+
+	++currentCombination;
+
+	if(currentCombination < combinationCount)
+	{
+		NextCombination();
+		return;
+	}
+
+	running = false;
+
+	RestoreVariables();
+
+	if(WriteResults())
+		console->AddText("Sweep finished, results written to \"" + script.GetOutputPath() + "\"");
+	else
+		console->AddText("Sweep finished, but results couldn't be written to \"" + script.GetOutputPath() + "\"");
+}
+
+std::string ConsoleSweepRunner::ParseDirective(const std::string& directive, const std::string& arguments)
+{
+	if(directive != "range" && directive != "values")
+		return "Unknown directive \"" + directive + "\"";
+
+	Variable variable;
+
+	size_t nameEnd = arguments.find_first_of(" \t");
+	variable.name = arguments.substr(0, nameEnd);
+
+	std::string valueText = nameEnd == arguments.npos ? "" : BenchmarkScript::TrimTextFrontBack(arguments.substr(nameEnd));
+
+	for(const Variable& existingVariable : variables)
+	{
+		if(existingVariable.name == variable.name)
+			return "\"" + variable.name + "\" is already swept";
+	}
+
+	std::string errorString;
+
+	if(directive == "range")
+		errorString = ParseRange(valueText, variable);
+	else
+		errorString = ParseValues(valueText, variable);
+
+	if(errorString.empty())
+		variables.push_back(std::move(variable));
+
+	return errorString;
+}
+
+std::string ConsoleSweepRunner::ParseRange(const std::string& arguments, Variable& variable)
+{
+	std::istringstream stream(arguments);
+
+	std::string fromText;
+	std::string toText;
+	std::string stepText;
+	std::string rest;
+
+	stream >> fromText >> toText >> stepText >> rest;
+
+	if(stepText.empty() || !rest.empty())
+		return "Expected \"range <variable> <from> <to> <step>\"";
+
+	double numbers[3];
+	const std::string* texts[] = { &fromText, &toText, &stepText };
+
+	bool integers = true;
+
+	for(int i = 0; i < 3; ++i)
+	{
+		const char* begin = texts[i]->c_str();
+		char* end = nullptr;
+
+		numbers[i] = std::strtod(begin, &end);
+
+		if(end != begin + texts[i]->size())
+			return "\"" + *texts[i] + "\" isn't a number";
+
+		if(texts[i]->find_first_of(".eE") != texts[i]->npos)
+			integers = false;
+	}
+
+	double from = numbers[0];
+	double to = numbers[1];
+	double step = numbers[2];
+
+	if(step == 0.0
+		|| (to - from) / step < 0.0)
+		return "A step of " + stepText + " never goes from " + fromText + " to " + toText;
+
+	//Computing each value from the index rather than accumulating step avoids drifting past "to"
+	long long count = static_cast<long long>(std::floor((to - from) / step + 1e-6)) + 1;
+	if(count > 10000)
+		return "Range has more than 10000 values";
+
+	for(long long i = 0; i < count; ++i)
+	{
+		double value = from + step * i;
+
+		if(integers)
+			variable.values.push_back(std::to_string(static_cast<long long>(std::llround(value))));
+		else
+		{
+			std::ostringstream valueStream;
+			valueStream << value;
+
+			variable.values.push_back(valueStream.str());
+		}
+	}
+
+	return "";
+}
+
+std::string ConsoleSweepRunner::ParseValues(const std::string& arguments, Variable& variable)
+{
+	std::string value;
+	bool insideString = false;
+
+	//Split on commas outside of strings and parentheses
+	int depth = 0;
+	for(char character : arguments)
+	{
+		if(character == '"')
+			insideString = !insideString;
+		else if(!insideString)
+		{
+			if(character == '(')
+				++depth;
+			else if(character == ')')
+				--depth;
+			else if(character == ',' && depth == 0)
+			{
+				variable.values.push_back(BenchmarkScript::TrimTextFrontBack(value));
+				value.clear();
+				continue;
+			}
+		}
+
+		value += character;
+	}
+
+	variable.values.push_back(BenchmarkScript::TrimTextFrontBack(value));
+
+	for(const std::string& text : variable.values)
+	{
+		if(text.empty())
+			return "Expected \"values <variable> <value>, <value>, ...\"";
+	}
+
+	return "";
+}
+
+void ConsoleSweepRunner::ApplyCombination()
+{
+	Result result;
+	result.values.reserve(variables.size());
+
+	std::string description;
+
+	for(size_t i = 0; i < variables.size(); ++i)
+	{
+		const Variable& variable = variables[i];
+
+		if(combination[i] != appliedCombination[i])
+		{
+			console->ExecuteCommand(variable.name + "(" + variable.values[combination[i]] + ")");
+			appliedCombination[i] = combination[i];
+		}
+
+		//Setters might clamp or ignore the value, so record what was actually set
+		ConsoleVariable* consoleVariable = console->GetVariable(variable.name);
+		result.values.push_back(consoleVariable != nullptr ? consoleVariable->GetValue() : "");
+
+		if(i > 0)
+			description += ", ";
+		description += variable.name + " = " + result.values.back();
+	}
+
+	results.push_back(std::move(result));
+
+	console->AddText("Sweep " + std::to_string(currentCombination + 1) + "/" + std::to_string(combinationCount) + ": " + description);
+}
+
+void ConsoleSweepRunner::NextCombination()
+{
+	for(int i = static_cast<int>(variables.size()) - 1; i >= 0; --i)
+	{
+		if(++combination[i] < static_cast<int>(variables[i].values.size()))
+			break;
+
+		combination[i] = 0;
+	}
+}
+
+void ConsoleSweepRunner::RestoreVariables()
+{
+	for(const Variable& variable : variables)
+		console->ExecuteCommand(variable.name + "(" + variable.originalValue + ")");
+}
+
+bool ConsoleSweepRunner::WriteResults() const
+{
+	std::ofstream out(script.GetOutputPath(), std::ofstream::trunc);
+	if(!out.is_open())
+		return false;
+
+	std::set<std::string> timingNames = BenchmarkScript::GetTimingNames(results, &Result::timings);
+
+	for(const Variable& variable : variables)
+		out << BenchmarkScript::CSVField(variable.name) << ',';
+
+	out << "frames";
+	BenchmarkScript::WriteTimingHeader(out, timingNames);
+	out << '\n';
+
+	for(const Result& result : results)
+	{
+		for(const std::string& value : result.values)
+			out << BenchmarkScript::CSVField(value) << ',';
+
+		out << script.GetMeasureFrames();
+		BenchmarkScript::WriteTimings(out, timingNames, result.timings);
+		out << '\n';
+	}
+
+	return static_cast<bool>(out);
+}
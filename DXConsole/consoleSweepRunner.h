@@ -0,0 +1,138 @@
+#ifndef OPENGLWINDOW_CONSOLESWEEPRUNNER_H
+#define OPENGLWINDOW_CONSOLESWEEPRUNNER_H
+
+#include <string>
+#include <vector>
+
+#include "benchmarkScript.h"
+
+class Console;
+
+/**
+* Runs a parameter sweep over console variables and records timings for every combination
+*
+* A sweep script is a plaintext file where each line is a directive. Blank lines are allowed
+* and lines can be commented with //. warmup, measure and output are the same as for every
+* BenchmarkScript
+*
+* \code
+* //Frames to render before measuring each combination, default 30
+* warmup 30
+* //Frames to measure each combination, default 120
+* measure 120
+* //Where to write results, default <script path>.csv
+* output sweepResults.csv
+* //range <variable> <from> <to> <step>, both ends are included
+* range rayBounces 1 4 1
+* range lightIntensity 5.0 20.0 7.5
+* //values <variable> <value>, <value>, ... Values are passed to the variable as they are
+* values superSampleCount 1, 2, 4
+* \endcode
+*
+* Every combination of the declared variables is visited, the last declared variable
+* changes the fastest. Variables are set through Console::ExecuteCommand, so any
+* ConsoleVariable (CommandGetSet, CommandGetterSetter etc.) can be swept. A variable
+* is only set when its value differs from the previous combination.
+*
+* Once per frame, call BeginFrame before updating, AddTiming for each timing and
+* EndFrame after drawing. The results are written as a table with one row per
+* combination, containing the values read back from each variable and the average,
+* min, and max of every timing. When the sweep ends every variable is restored to the
+* value it had before the sweep started
+*/
+class ConsoleSweepRunner
+{
+public:
+	ConsoleSweepRunner();
+	~ConsoleSweepRunner() = default;
+
+	/**
+	* Parses the sweep script at \p path and starts the sweep
+	*
+	* \param path path (including extension) to sweep script
+	* \param console console to set variables with
+	* \returns an empty string if the sweep was started, otherwise an error message
+	*/
+	std::string Start(const std::string& path, Console* console);
+	/**
+	* Stops the sweep, writes results for all finished combinations and restores all variables
+	*/
+	void Stop();
+
+	bool IsRunning() const;
+
+	/**
+	* Applies the next combination if the previous one is done
+	*/
+	void BeginFrame();
+	/**
+	* Records a timing for the current frame. Ignored during warmup
+	*
+	* \param name name of the timing, becomes a column in the results
+	* \param milliseconds time in milliseconds
+	*/
+	void AddTiming(const std::string& name, double milliseconds);
+	/**
+	* Ends the current frame. Ends the sweep after the last frame of the last combination
+	*/
+	void EndFrame();
+private:
+	struct Variable
+	{
+		std::string name;
+		std::vector<std::string> values;
+
+		std::string originalValue;
+	};
+
+	struct Result
+	{
+		std::vector<std::string> values; //Read back from the variables after setting them
+		BenchmarkScript::Timings timings;
+	};
+
+	Console* console;
+
+	std::vector<Variable> variables;
+	std::vector<Result> results;
+
+	BenchmarkScript script;
+
+	bool running;
+
+	//Index into Variable::values for each variable
+	std::vector<int> combination;
+	//Index into Variable::values of what was set last, -1 if nothing has been set yet
+	std::vector<int> appliedCombination;
+
+	int combinationCount;
+	int currentCombination;
+
+	/**
+	* Parses a "range" or "values" directive, the rest are handled by BenchmarkScript
+	*
+	* \returns an empty string if successful, otherwise an error message
+	*/
+	std::string ParseDirective(const std::string& directive, const std::string& arguments);
+	/**
+	* Parses the values of a "range" directive into \p variable
+	*
+	* \returns an empty string if successful, otherwise an error message
+	*/
+	std::string ParseRange(const std::string& arguments, Variable& variable);
+	/**
+	* Parses the values of a "values" directive into \p variable
+	*
+	* \returns an empty string if successful, otherwise an error message
+	*/
+	std::string ParseValues(const std::string& arguments, Variable& variable);
+
+	void ApplyCombination();
+	//Steps combination to the next one, like incrementing a number with one digit per variable
+	void NextCombination();
+
+	void RestoreVariables();
+	bool WriteResults() const;
+};
+
+#endif //OPENGLWINDOW_CONSOLESWEEPRUNNER_H
@@ -1,39 +1,309 @@
 #include "dictionary.h"
 
-Dictionary::Dictionary()
+#include <algorithm>
+#include <cctype>
+
+Dictionary::Record::Record(const std::string& name)
+	: entry(name)
+	, key(name)
+	, lastUsed(0)
+	, nextWithSameKey(-1)
+{
+	for(char& character : key)
+		character = static_cast<char>(std::tolower(character));
+
+	characterMask = GetCharacterMask(key);
+}
+
+Dictionary::TrieNode::TrieNode(const std::string& label)
+	: label(label)
+	, firstRecord(-1)
 {
 
 }
 
+Dictionary::Dictionary()
+	: useCounter(0)
+{
+	nodes.emplace_back("");
+}
+
 void Dictionary::AddEntry(const std::string& entry)
 {
-	DictionaryChapter& chapter = chapters[tolower(entry[0])];
+	if(entry.empty()
+		|| Find(entry) != nullptr)
+		return;
+
+	records.emplace_back(entry);
+
+	InsertIntoTrie(static_cast<int>(records.size() - 1));
+}
+
+void Dictionary::MarkUsed(const std::string& entry)
+{
+	std::string key = entry;
+	for(char& character : key)
+		character = static_cast<char>(std::tolower(character));
 
-	chapter.AddEntry(entry);
+	int nodeIndex = FindNode(key, true);
+	if(nodeIndex == -1)
+		return;
+
+	for(int i = nodes[nodeIndex].firstRecord; i != -1; i = records[i].nextWithSameKey)
+	{
+		if(records[i].entry.GetName() == entry)
+		{
+			records[i].lastUsed = ++useCounter;
+			break;
+		}
+	}
 }
 
-const DictionaryEntry* Dictionary::Find(const std::string text) const
+const DictionaryEntry* Dictionary::Find(const std::string& text) const
 {
-	std::map<char, DictionaryChapter>::const_iterator chapterIter = chapters.find(static_cast<char>(tolower(text[0])));
-	if(chapterIter != chapters.end())
-		return chapterIter->second.Find(text);
+	std::string key = text;
+	for(char& character : key)
+		character = static_cast<char>(std::tolower(character));
+
+	int nodeIndex = FindNode(key, true);
+	if(nodeIndex == -1)
+		return nullptr;
+
+	for(int i = nodes[nodeIndex].firstRecord; i != -1; i = records[i].nextWithSameKey)
+	{
+		if(records[i].entry.GetName() == text)
+			return &records[i].entry;
+	}
 
 	return nullptr;
 }
 
-std::vector<const DictionaryEntry*> Dictionary::Match(const std::string text) const
+void Dictionary::Match(const std::string& text, int maxMatches, std::vector<const DictionaryEntry*>& outMatches) const
+{
+	outMatches.clear();
+	candidates.clear();
+
+	if(maxMatches <= 0)
+		return;
+
+	loweredText.assign(text);
+	for(char& character : loweredText)
+		character = static_cast<char>(std::tolower(character));
+
+	//Everything in the subtree begins with text
+	int prefixNode = FindNode(loweredText, false);
+	if(prefixNode != -1)
+	{
+		nodeStack.clear();
+		nodeStack.push_back(prefixNode);
+
+		while(!nodeStack.empty())
+		{
+			const TrieNode& node = nodes[nodeStack.back()];
+			nodeStack.pop_back();
+
+			for(int i = node.firstRecord; i != -1; i = records[i].nextWithSameKey)
+			{
+				const Record& record = records[i];
+
+				AddCandidate(&record, record.key.size() == loweredText.size() ? MATCH_QUALITY::EXACT : MATCH_QUALITY::PREFIX, maxMatches);
+			}
+
+			nodeStack.insert(nodeStack.end(), node.children.begin(), node.children.end());
+		}
+	}
+
+	//Anything found below would be ranked lower than the prefix matches, so only look if there's room left
+	if(static_cast<int>(candidates.size()) < maxMatches
+		&& !loweredText.empty())
+	{
+		uint64_t textMask = GetCharacterMask(loweredText);
+
+		for(const Record& record : records)
+		{
+			if((record.characterMask & textMask) != textMask)
+				continue;
+
+			//Already added as a prefix match
+			if(record.key.compare(0, loweredText.size(), loweredText) == 0)
+				continue;
+
+			if(record.entry.Matches(text))
+				AddCandidate(&record, MATCH_QUALITY::ABBREVIATION, maxMatches);
+			else if(IsSubsequence(loweredText, record.key))
+				AddCandidate(&record, MATCH_QUALITY::SUBSEQUENCE, maxMatches);
+		}
+	}
+
+	std::sort_heap(candidates.begin(), candidates.end(), IsBetter);
+
+	for(const Candidate& candidate : candidates)
+		outMatches.push_back(&candidate.record->entry);
+}
+
+uint64_t Dictionary::GetCharacterMask(const std::string& text)
+{
+	uint64_t mask = 0;
+
+	for(char character : text)
+	{
+		if(character >= 'a' && character <= 'z')
+			mask |= 1ull << (character - 'a');
+		else if(character >= '0' && character <= '9')
+			mask |= 1ull << (26 + character - '0');
+		else if(character == '_')
+			mask |= 1ull << 36;
+		else
+			mask |= 1ull << 63;
+	}
+
+	return mask;
+}
+
+bool Dictionary::IsSubsequence(const std::string& text, const std::string& key)
+{
+	size_t textIndex = 0;
+
+	for(size_t i = 0, end = key.size(); i < end && textIndex < text.size(); i++)
+	{
+		if(key[i] == text[textIndex])
+			++textIndex;
+	}
+
+	return textIndex == text.size();
+}
+
+bool Dictionary::IsBetter(const Candidate& lhs, const Candidate& rhs)
+{
+	if(lhs.quality != rhs.quality)
+		return lhs.quality > rhs.quality;
+
+	if(lhs.record->lastUsed != rhs.record->lastUsed)
+		return lhs.record->lastUsed > rhs.record->lastUsed;
+
+	if(lhs.record->key.size() != rhs.record->key.size())
+		return lhs.record->key.size() < rhs.record->key.size();
+
+	return lhs.record->entry.GetName() < rhs.record->entry.GetName();
+}
+
+void Dictionary::InsertIntoTrie(int recordIndex)
 {
-	std::vector<const DictionaryEntry*> matches;
+	const std::string& key = records[recordIndex].key;
 
-	std::map<char, DictionaryChapter>::const_iterator chapterIter = chapters.find(static_cast<char>(tolower(text[0])));
-	while(chapterIter != chapters.end())
+	int nodeIndex = 0;
+	size_t keyIndex = 0;
+
+	while(keyIndex < key.size())
 	{
-		auto newMatches = chapterIter->second.Match(text);
+		const std::vector<int>& children = nodes[nodeIndex].children;
+
+		auto iter = std::lower_bound(children.begin(), children.end(), key[keyIndex], [this](int child, char character)
+		{
+			return nodes[child].label[0] < character;
+		});
+		size_t childPosition = static_cast<size_t>(iter - children.begin());
+
+		if(iter == children.end()
+			|| nodes[*iter].label[0] != key[keyIndex])
+		{
+			//Nothing shares this prefix, the rest of the key becomes a new leaf
+			int leafIndex = static_cast<int>(nodes.size());
+			nodes.emplace_back(key.substr(keyIndex));
+
+			std::vector<int>& parentChildren = nodes[nodeIndex].children;
+			parentChildren.insert(parentChildren.begin() + childPosition, leafIndex);
+
+			nodeIndex = leafIndex;
+			break;
+		}
+
+		int childIndex = *iter;
+		const std::string& label = nodes[childIndex].label;
+
+		size_t commonLength = 0;
+		while(commonLength < label.size()
+			&& keyIndex + commonLength < key.size()
+			&& label[commonLength] == key[keyIndex + commonLength])
+			++commonLength;
+
+		if(commonLength < label.size())
+		{
+			//Split the edge so the common part gets a node of its own
+			std::string commonLabel = label.substr(0, commonLength);
+			nodes[childIndex].label.erase(0, commonLength);
+
+			int splitIndex = static_cast<int>(nodes.size());
+			nodes.emplace_back(commonLabel);
+			nodes[splitIndex].children.push_back(childIndex);
+			nodes[nodeIndex].children[childPosition] = splitIndex;
 
-		matches.reserve(matches.size() + newMatches.size());
-		matches.insert(matches.end(), std::make_move_iterator(newMatches.begin()), std::make_move_iterator(newMatches.end()));
-		++chapterIter;
+			childIndex = splitIndex;
+		}
+
+		nodeIndex = childIndex;
+		keyIndex += commonLength;
 	}
 
-	return matches;
+	records[recordIndex].nextWithSameKey = nodes[nodeIndex].firstRecord;
+	nodes[nodeIndex].firstRecord = recordIndex;
+}
+
+int Dictionary::FindNode(const std::string& key, bool exact) const
+{
+	int nodeIndex = 0;
+	size_t keyIndex = 0;
+
+	while(keyIndex < key.size())
+	{
+		const std::vector<int>& children = nodes[nodeIndex].children;
+
+		auto iter = std::lower_bound(children.begin(), children.end(), key[keyIndex], [this](int child, char character)
+		{
+			return nodes[child].label[0] < character;
+		});
+
+		if(iter == children.end()
+			|| nodes[*iter].label[0] != key[keyIndex])
+			return -1;
+
+		const std::string& label = nodes[*iter].label;
+		size_t remainingLength = key.size() - keyIndex;
+
+		//Key ends in the middle of this edge
+		if(remainingLength < label.size())
+		{
+			if(exact
+				|| label.compare(0, remainingLength, key, keyIndex, remainingLength) != 0)
+				return -1;
+
+			return *iter;
+		}
+
+		if(label.compare(0, label.size(), key, keyIndex, label.size()) != 0)
+			return -1;
+
+		nodeIndex = *iter;
+		keyIndex += label.size();
+	}
+
+	return nodeIndex;
+}
+
+void Dictionary::AddCandidate(const Record* record, MATCH_QUALITY quality, int maxMatches) const
+{
+	Candidate candidate = { record, quality };
+
+	//candidates is a heap with the worst candidate at the front
+	if(static_cast<int>(candidates.size()) < maxMatches)
+	{
+		candidates.push_back(candidate);
+		std::push_heap(candidates.begin(), candidates.end(), IsBetter);
+	}
+	else if(IsBetter(candidate, candidates.front()))
+	{
+		std::pop_heap(candidates.begin(), candidates.end(), IsBetter);
+		candidates.back() = candidate;
+		std::push_heap(candidates.begin(), candidates.end(), IsBetter);
+	}
 }
@@ -1,11 +1,23 @@
 #ifndef OPENGLWINDOW_DICTIONARY_H
 #define OPENGLWINDOW_DICTIONARY_H
 
-#include "dictionaryChapter.h"
+#include "dictionaryEntry.h"
 
 #include <string>
-#include <map>
+#include <vector>
+#include <deque>
+#include <cstdint>
 
+/**
+* Command/variable names used for completion.
+*
+* Names are stored in a radix trie keyed on their lowercase form, so prefix matches only visit
+* the matching subtree. If there aren't enough prefix matches, every entry is tried with
+* DictionaryEntry::Matches and then as a subsequence, with a character mask to skip entries that
+* can't possibly match.
+*
+* Match reuses internal buffers and is therefore not thread safe
+*/
 class Dictionary
 {
 public:
@@ -14,10 +26,84 @@ public:
 
 	void AddEntry(const std::string& entry);
 
-	const DictionaryEntry* Find(const std::string text) const;
-	std::vector<const DictionaryEntry*> Match(const std::string text) const;
+	/**
+	* Marks \p entry as used, recently used entries are ranked higher by Match
+	*
+	* \param entry exact name of the entry. Nothing happens if it doesn't exist
+	*/
+	void MarkUsed(const std::string& entry);
+
+	const DictionaryEntry* Find(const std::string& text) const;
+	/**
+	* Finds the \p maxMatches best matches for \p text
+	*
+	* Ranked by exact match, then prefix match, then DictionaryEntry::Matches, then subsequence match.
+	* Ties are broken by how recently the entry was marked as used, then by length
+	*
+	* \param text text to match. An empty text matches everything
+	* \param maxMatches max number of entries to return
+	* \param outMatches cleared and filled with the matches, best match first.
+	* Pointers stay valid for as long as the dictionary does
+	*/
+	void Match(const std::string& text, int maxMatches, std::vector<const DictionaryEntry*>& outMatches) const;
 private:
-	std::map<char, DictionaryChapter> chapters;
+	enum class MATCH_QUALITY { SUBSEQUENCE = 0, ABBREVIATION, PREFIX, EXACT };
+
+	struct Record
+	{
+		Record(const std::string& name);
+
+		DictionaryEntry entry;
+		std::string key; //Lowercase name
+
+		uint64_t characterMask;
+		unsigned int lastUsed; //0 if never used
+
+		int nextWithSameKey; //Entries with the same lowercase name share a trie node
+	};
+
+	struct TrieNode
+	{
+		TrieNode(const std::string& label);
+
+		std::string label; //Lowercase characters on the edge leading to this node
+		std::vector<int> children; //Sorted by first character of label
+		int firstRecord; //-1 if no entry ends at this node
+	};
+
+	struct Candidate
+	{
+		const Record* record;
+		MATCH_QUALITY quality;
+	};
+
+	//Deque so that pointers handed out by Find and Match stay valid when adding entries
+	std::deque<Record> records;
+	std::vector<TrieNode> nodes; //nodes[0] is the root
+
+	unsigned int useCounter;
+
+	//Reused between calls to Match to avoid allocating
+	mutable std::string loweredText;
+	mutable std::vector<int> nodeStack;
+	mutable std::vector<Candidate> candidates;
+
+	static uint64_t GetCharacterMask(const std::string& text);
+	static bool IsSubsequence(const std::string& text, const std::string& key);
+	//Returns true if lhs should be listed before rhs
+	static bool IsBetter(const Candidate& lhs, const Candidate& rhs);
+
+	void InsertIntoTrie(int recordIndex);
+	/**
+	* Walks the trie as far as \p key goes
+	*
+	* \param key lowercase key
+	* \param exact whether \p key has to end exactly at a node
+	* \returns -1 if no node is found. If \p exact is false, the node whose subtree holds all keys beginning with \p key
+	*/
+	int FindNode(const std::string& key, bool exact) const;
+
+	void AddCandidate(const Record* record, MATCH_QUALITY quality, int maxMatches) const;
 };
 
 #endif //OPENGLWINDOW_DICTIONARY_H
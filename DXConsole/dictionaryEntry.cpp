@@ -34,7 +34,7 @@ DictionaryEntry::DictionaryEntry(const std::string& name)
 	}
 }
 
-std::string DictionaryEntry::GetName() const
+const std::string& DictionaryEntry::GetName() const
 {
 	return name;
 }
@@ -67,7 +67,10 @@ bool DictionaryEntry::Matches(const std::string& text) const
 
 	for(int i = 0, end = static_cast<int>(indexCharacters.size()); i < end; i++)
 	{
-		std::string substr = name.substr(indexCharacters[i], (i + 1 < end) ? indexCharacters[i + 1] - indexCharacters[i] : name.npos);
+		//Part of name from this index character up to the next one. Indexed directly instead of
+		//using substr since this is called for every dictionary entry when matching
+		const char* substr = name.c_str() + indexCharacters[i];
+		int substrSize = static_cast<int>(((i + 1 < end) ? indexCharacters[i + 1] : name.size()) - indexCharacters[i]);
 
 		int substrIndex = 0;
 
@@ -101,7 +104,7 @@ bool DictionaryEntry::Matches(const std::string& text) const
 				continue;
 		}
 
-		for(int j = 0, substrEnd = static_cast<int>(substr.size()); substrIndex < substrEnd; j++, substrIndex++)
+		for(int j = 0, substrEnd = substrSize; substrIndex < substrEnd; j++, substrIndex++)
 		{
 			//If any of the "substrChar = ..." or "textChar = ..." throw (possibly OutOfRange?),
 			//then make sure this code is compiled for C++11.
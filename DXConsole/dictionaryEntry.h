@@ -11,7 +11,7 @@ public:
 	DictionaryEntry(const std::string& name);
 	//~DictionaryEntry() = default;
 
-	std::string GetName() const;
+	const std::string& GetName() const;
 
 	int GetIndexCharacterSize() const;
 	char GetIndexCharacter() const;
@@ -1,10 +1,14 @@
 #include "guiContainer.h"
 
+GUIContainer::DrawCache* GUIContainer::recordingCache = nullptr;
+
 GUIContainer::GUIContainer()
 	: recieveAllEvents(false)
 	, update(false)
 	, draw(true)
 	, mouseInside(false)
+	, spatialIndex(nullptr)
+	, dirtyLayers((1 << static_cast<int>(DRAW_LAYER::COUNT)) - 1)
 {
 }
 
@@ -19,13 +23,96 @@ void GUIContainer::Init(Rect area, const std::shared_ptr<GUIStyle>& style, std::
 
 	if(this->background != nullptr)
 		this->background->Init(backgroundStyle, &this->area);
+
+	SetDirty();
+	UpdateSpatialIndex();
 }
 
 void GUIContainer::Draw(SpriteRenderer* spriteRenderer)
 {
-	DrawBackground(spriteRenderer);
-	DrawMiddle(spriteRenderer);
-	DrawForeground(spriteRenderer);
+	DrawLayer(spriteRenderer, DRAW_LAYER::BACKGROUND);
+	DrawLayer(spriteRenderer, DRAW_LAYER::MIDDLE);
+	DrawLayer(spriteRenderer, DRAW_LAYER::FOREGROUND);
+}
+
+void GUIContainer::DrawLayer(SpriteRenderer* spriteRenderer, DRAW_LAYER layer)
+{
+	//The call is recorded even if nothing is drawn, GetDraw() is checked again when replaying
+	if(recordingCache != nullptr)
+		recordingCache->calls.push_back(DrawCall{ recordingCache->sprites.GetSize(), this, layer });
+
+	if(!draw)
+		return;
+
+	CheckDirty();
+
+	int layerIndex = static_cast<int>(layer);
+	DrawCache& cache = drawCaches[layerIndex];
+	DrawCache* parentCache = recordingCache;
+
+	if((dirtyLayers & (1 << layerIndex)) != 0)
+	{
+		//Cleared before drawing so a SetDirty from inside Draw* isn't lost
+		dirtyLayers &= ~(1 << layerIndex);
+
+		cache.sprites.Clear();
+		cache.calls.clear();
+
+		recordingCache = &cache;
+		spriteRenderer->BeginRecording(&cache.sprites);
+
+		switch(layer)
+		{
+			case DRAW_LAYER::BACKGROUND:
+				DrawBackground(spriteRenderer);
+				break;
+			case DRAW_LAYER::MIDDLE:
+				DrawMiddle(spriteRenderer);
+				break;
+			case DRAW_LAYER::FOREGROUND:
+				DrawForeground(spriteRenderer);
+				break;
+			default:
+				break;
+		}
+
+		spriteRenderer->EndRecording();
+		recordingCache = parentCache;
+	}
+	else
+	{
+		//Children are replayed, not recorded. A dirty child records into its own cache
+		recordingCache = nullptr;
+
+		unsigned int spriteIndex = 0;
+		for(const DrawCall& call : cache.calls)
+		{
+			spriteRenderer->Draw(cache.sprites, spriteIndex, call.spriteIndex);
+			spriteIndex = call.spriteIndex;
+
+			call.container->DrawLayer(spriteRenderer, call.layer);
+		}
+
+		spriteRenderer->Draw(cache.sprites, spriteIndex, cache.sprites.GetSize());
+
+		recordingCache = parentCache;
+	}
+}
+
+void GUIContainer::SetDirty()
+{
+	dirtyLayers = (1 << static_cast<int>(DRAW_LAYER::COUNT)) - 1;
+}
+
+bool GUIContainer::GetDirty() const
+{
+	return dirtyLayers != 0;
+}
+
+void GUIContainer::UpdateSpatialIndex()
+{
+	if(spatialIndex != nullptr)
+		spatialIndex->Update(this);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -36,30 +123,45 @@ void GUIContainer::SetPosition(const DirectX::XMFLOAT2& newPosition)
 {
 	area.SetPos(newPosition.x, newPosition.y);
 	background->AreaChanged();
+
+	SetDirty();
+	UpdateSpatialIndex();
 }
 
 void GUIContainer::SetPosition(float x, float y)
 {
 	area.SetPos(x, y);
 	background->AreaChanged();
+
+	SetDirty();
+	UpdateSpatialIndex();
 }
 
 void GUIContainer::SetSize(const DirectX::XMFLOAT2& newSize)
 {
 	area.SetSize(newSize.x, newSize.y);
 	background->AreaChanged();
+
+	SetDirty();
+	UpdateSpatialIndex();
 }
 
 void GUIContainer::SetSize(float x, float y)
 {
 	area.SetSize(x, y);
 	background->AreaChanged();
+
+	SetDirty();
+	UpdateSpatialIndex();
 }
 
 void GUIContainer::SetArea(const Rect& newArea)
 {
 	area = newArea;
 	background->AreaChanged();
+
+	SetDirty();
+	UpdateSpatialIndex();
 }
 
 Rect GUIContainer::GetArea() const
@@ -5,13 +5,22 @@
 
 #include <DXLib/rect.h>
 #include <DXLib/spriteRenderer.h>
+#include <DXLib/spriteDrawList.h>
 #include <DXLib/keyState.h>
 
+#include <vector>
+
 #include "guiStyle.h"
 #include "guiBackground.h"
+#include "guiSpatialIndex.h"
 
 #include <DXLib/logger.h>
 
+/*Containers are retained: every layer is recorded into a SpriteDrawList the first time it's drawn
+* and replayed as-is until SetDirty is called. Anything that changes what a container draws must call SetDirty.
+* Children are drawn through DrawLayer, which records a call to the child rather than the child's sprites,
+* so a child that changes doesn't force its parent to generate its sprites again
+*/
 class GUIContainer
 {
 	friend class GUIManager;
@@ -19,6 +28,8 @@ public:
 	GUIContainer();
 	virtual ~GUIContainer();
 
+	enum class DRAW_LAYER { BACKGROUND = 0, MIDDLE, FOREGROUND, COUNT };
+
 	//************************************
 	// Method:		Init
 	// FullName:	GUIContainer::Init
@@ -34,7 +45,21 @@ public:
 	virtual void Init(Rect area, const std::shared_ptr<GUIStyle>& style, std::unique_ptr<GUIBackground>& background, const std::shared_ptr<GUIStyle>& backgroundStyle);
 
 	virtual void Update(std::chrono::nanoseconds delta) {};
+	//Draws all three layers through DrawLayer
 	virtual void Draw(SpriteRenderer* spriteRenderer);
+	//************************************
+	// Method:		DrawLayer
+	// FullName:	GUIContainer::DrawLayer
+	// Access:		public 
+	// Returns:		void
+	// Qualifier:
+	// Argument:	SpriteRenderer* spriteRenderer
+	// Argument:	DRAW_LAYER layer
+	// Description:	Replays the cached draw list of the given layer, or calls DrawBackground/DrawMiddle/DrawForeground
+	// and records a new one if the container is dirty. Parents should draw their children through this
+	// instead of calling DrawBackground etc. directly. Does nothing if GetDraw() is false
+	//************************************
+	void DrawLayer(SpriteRenderer* spriteRenderer, DRAW_LAYER layer);
 
 	virtual void DrawBackground(SpriteRenderer* spriteRenderer) {}
 	virtual void DrawMiddle(SpriteRenderer* spriteRenderer) {}
@@ -64,6 +89,17 @@ public:
 	virtual bool GetDraw() const;
 	virtual void SetDraw(bool draw);
 
+	//************************************
+	// Method:		SetDirty
+	// FullName:	GUIContainer::SetDirty
+	// Access:		public 
+	// Returns:		void
+	// Qualifier:
+	// Description:	Makes the next DrawLayer call record every layer again instead of replaying them
+	//************************************
+	void SetDirty();
+	bool GetDirty() const;
+
 	virtual bool GetUpdate() const;
 	virtual void SetUpdate(bool update);
 
@@ -170,6 +206,20 @@ protected:
 	//Essentially the hitbox of this object
 	Rect area;
 
+	//************************************
+	// Method:		CheckDirty
+	// FullName:	GUIContainer::CheckDirty
+	// Access:		virtual protected
+	// Returns:		void
+	// Qualifier:
+	// Description:	Called by DrawLayer before deciding whether to replay. Time based changes such
+	// as a blinking cursor should call SetDirty from here
+	//************************************
+	virtual void CheckDirty() {};
+
+	//Call after changing area without going through SetPosition/SetSize/SetArea
+	void UpdateSpatialIndex();
+
 	//************************************
 	// Method:		CastStyleTo
 	// Argument:	GUIStyle* style
@@ -189,6 +239,29 @@ protected:
 	}
 private:
 	bool mouseInside;
+
+	//Set by the GUIManager this container was added to
+	GUISpatialIndex* spatialIndex;
+
+	//Where a child's DrawLayer was called while recording
+	struct DrawCall
+	{
+		unsigned int spriteIndex; //Number of this container's own sprites drawn before the call
+		GUIContainer* container;
+		DRAW_LAYER layer;
+	};
+
+	struct DrawCache
+	{
+		SpriteDrawList sprites;
+		std::vector<DrawCall> calls;
+	};
+
+	DrawCache drawCaches[static_cast<int>(DRAW_LAYER::COUNT)];
+	unsigned int dirtyLayers; //One bit per DRAW_LAYER
+
+	//The cache being recorded, if any. Children add a DrawCall to it
+	static DrawCache* recordingCache;
 };
 
 #endif // GUIContainer_h__
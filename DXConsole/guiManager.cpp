@@ -1,6 +1,7 @@
 #include "guiManager.h"
 
 #include <DXLib/input.h>
+#include <DXLib/logger.h>
 
 GUIManager::GUIManager()
 {
@@ -12,36 +13,57 @@ GUIManager::~GUIManager()
 
 void GUIManager::AddContainer(GUIContainer* container)
 {
+	if(container->spatialIndex != nullptr
+		&& container->spatialIndex != &spatialIndex)
+		Logger::LogLine(LOG_TYPE::WARNING, "Adding a GUIContainer to a GUIManager when it's already part of another one. Hit testing in the other one will be out of date");
+
 	containers.push_back(container);
+
+	container->spatialIndex = &spatialIndex;
+	spatialIndex.Insert(container);
 }
 
 void GUIManager::SetContainers(std::vector<GUIContainer*> containers)
 {
-	this->containers = containers;
+	ClearContainers();
+
+	for(GUIContainer* container : containers)
+		AddContainer(container);
 }
 
 void GUIManager::Update(std::chrono::nanoseconds delta)
 {
 	DirectX::XMFLOAT2 mousePosition = Input::GetMousePosition();
-	for(GUIContainer* container : containers)
+
+	//Only containers that were under the mouse last update can be exited
+	for(int i = static_cast<int>(hoveredContainers.size()) - 1; i >= 0; --i)
 	{
-		if(container->area.Contains(mousePosition))
+		GUIContainer* container = hoveredContainers[i];
+
+		if(!container->area.Contains(mousePosition))
 		{
-			if(!container->mouseInside)
-			{
-				container->OnMouseEnter();
-				container->mouseInside = true;
-			}
+			container->OnMouseExit();
+			container->mouseInside = false;
+
+			hoveredContainers.erase(hoveredContainers.begin() + i);
 		}
-		else
+	}
+
+	//And only containers under the mouse now can be entered
+	spatialIndex.Query(mousePosition, containersUnderMouse);
+	for(GUIContainer* container : containersUnderMouse)
+	{
+		if(!container->mouseInside)
 		{
-			if(container->mouseInside)
-			{
-				container->OnMouseExit();
-				container->mouseInside = false;
-			}
+			container->OnMouseEnter();
+			container->mouseInside = true;
+
+			hoveredContainers.push_back(container);
 		}
+	}
 
+	for(GUIContainer* container : containers)
+	{
 		if(container->GetUpdate())
 			container->Update(delta);
 	}
@@ -106,5 +128,13 @@ void GUIManager::ScrollEvent(int distance)
 
 void GUIManager::ClearContainers()
 {
+	for(GUIContainer* container : containers)
+	{
+		container->spatialIndex = nullptr;
+		container->mouseInside = false;
+	}
+
 	containers.clear();
+	hoveredContainers.clear();
+	spatialIndex.Clear();
 }
@@ -6,6 +6,7 @@
 #include <DXLib/spriteRenderer.h>
 
 #include "guiContainer.h"
+#include "guiSpatialIndex.h"
 
 class GUIManager
 {
@@ -13,6 +14,18 @@ public:
 	GUIManager();
 	~GUIManager();
 
+	GUIManager(const GUIManager&) = delete;
+	GUIManager& operator=(const GUIManager&) = delete;
+
+	//************************************
+	// Method:		AddContainer
+	// FullName:	GUIManager::AddContainer
+	// Access:		public 
+	// Returns:		void
+	// Qualifier:
+	// Argument:	GUIContainer* container - must outlive this manager or be removed with ClearContainers/SetContainers
+	// Description:	A container can only be part of one manager at a time since it keeps its hit testing cells up to date
+	//************************************
 	void AddContainer(GUIContainer* container);
 	void SetContainers(std::vector<GUIContainer*> containers);
 
@@ -28,6 +41,12 @@ public:
 
 private:
 	std::vector<GUIContainer*> containers;
+
+	GUISpatialIndex spatialIndex;
+	//Containers with mouseInside == true
+	std::vector<GUIContainer*> hoveredContainers;
+	//Kept around to avoid allocating every Update
+	std::vector<GUIContainer*> containersUnderMouse;
 };
 
 #endif // GUIManager_h__
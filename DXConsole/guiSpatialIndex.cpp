@@ -0,0 +1,139 @@
+#include "guiSpatialIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "guiContainer.h"
+
+GUISpatialIndex::GUISpatialIndex(float cellSize /*= 64.0f*/)
+	: cellSize(cellSize)
+{
+}
+
+void GUISpatialIndex::Insert(GUIContainer* container)
+{
+	if(containerCells.count(container) != 0)
+	{
+		Update(container);
+		return;
+	}
+
+	CellRange range = GetCellRange(container);
+
+	AddToCells(container, range);
+	containerCells[container] = range;
+}
+
+void GUISpatialIndex::Remove(GUIContainer* container)
+{
+	auto iter = containerCells.find(container);
+	if(iter == containerCells.end())
+		return;
+
+	RemoveFromCells(container, iter->second);
+	containerCells.erase(iter);
+}
+
+void GUISpatialIndex::Update(GUIContainer* container)
+{
+	auto iter = containerCells.find(container);
+	if(iter == containerCells.end())
+		return;
+
+	CellRange range = GetCellRange(container);
+	if(range == iter->second)
+		return;
+
+	RemoveFromCells(container, iter->second);
+	AddToCells(container, range);
+
+	iter->second = range;
+}
+
+void GUISpatialIndex::Clear()
+{
+	cells.clear();
+	containerCells.clear();
+	oversizedContainers.clear();
+}
+
+void GUISpatialIndex::Query(const DirectX::XMFLOAT2& position, std::vector<GUIContainer*>& outContainers) const
+{
+	outContainers.clear();
+
+	auto iter = cells.find(GetCellKey(GetCell(position.x), GetCell(position.y)));
+	if(iter != cells.end())
+	{
+		for(GUIContainer* container : iter->second)
+			if(container->GetArea().Contains(position))
+				outContainers.push_back(container);
+	}
+
+	for(GUIContainer* container : oversizedContainers)
+		if(container->GetArea().Contains(position))
+			outContainers.push_back(container);
+}
+
+GUISpatialIndex::CellRange GUISpatialIndex::GetCellRange(const GUIContainer* container) const
+{
+	Rect area = container->GetArea();
+
+	CellRange range;
+	range.minX = GetCell(area.GetMinPosition().x);
+	range.minY = GetCell(area.GetMinPosition().y);
+	range.maxX = GetCell(area.GetMaxPosition().x);
+	range.maxY = GetCell(area.GetMaxPosition().y);
+
+	long long cellCount = static_cast<long long>(range.maxX - range.minX + 1) * (range.maxY - range.minY + 1);
+	range.oversized = cellCount > MAX_CELLS_PER_CONTAINER;
+
+	return range;
+}
+
+int GUISpatialIndex::GetCell(float position) const
+{
+	return static_cast<int>(std::floor(position / cellSize));
+}
+
+uint64_t GUISpatialIndex::GetCellKey(int x, int y)
+{
+	return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+}
+
+void GUISpatialIndex::AddToCells(GUIContainer* container, const CellRange& range)
+{
+	if(range.oversized)
+	{
+		oversizedContainers.push_back(container);
+		return;
+	}
+
+	for(int y = range.minY; y <= range.maxY; ++y)
+		for(int x = range.minX; x <= range.maxX; ++x)
+			cells[GetCellKey(x, y)].push_back(container);
+}
+
+void GUISpatialIndex::RemoveFromCells(GUIContainer* container, const CellRange& range)
+{
+	if(range.oversized)
+	{
+		oversizedContainers.erase(std::remove(oversizedContainers.begin(), oversizedContainers.end(), container), oversizedContainers.end());
+		return;
+	}
+
+	for(int y = range.minY; y <= range.maxY; ++y)
+	{
+		for(int x = range.minX; x <= range.maxX; ++x)
+		{
+			auto iter = cells.find(GetCellKey(x, y));
+			if(iter == cells.end())
+				continue;
+
+			std::vector<GUIContainer*>& cell = iter->second;
+			cell.erase(std::remove(cell.begin(), cell.end(), container), cell.end());
+
+			if(cell.empty())
+				cells.erase(iter);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+#ifndef GUISpatialIndex_h__
+#define GUISpatialIndex_h__
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include <DirectXMath.h>
+
+class GUIContainer;
+
+/*Uniform grid over the areas of GUI containers, used for hit testing.
+* A container is stored in every cell its area touches. Containers that would
+* touch more than MAX_CELLS_PER_CONTAINER cells are kept in a separate list and always tested.
+* Containers keep their index up to date through GUIContainer::SetPosition, SetSize and SetArea
+*/
+class GUISpatialIndex
+{
+public:
+	//************************************
+	// Method:		GUISpatialIndex
+	// FullName:	GUISpatialIndex::GUISpatialIndex
+	// Access:		public 
+	// Returns:		
+	// Qualifier:
+	// Argument:	float cellSize - width and height of each cell in pixels
+	//************************************
+	explicit GUISpatialIndex(float cellSize = 64.0f);
+	~GUISpatialIndex() = default;
+
+	GUISpatialIndex(const GUISpatialIndex&) = delete;
+	GUISpatialIndex& operator=(const GUISpatialIndex&) = delete;
+
+	void Insert(GUIContainer* container);
+	void Remove(GUIContainer* container);
+	//************************************
+	// Method:		Update
+	// FullName:	GUISpatialIndex::Update
+	// Access:		public 
+	// Returns:		void
+	// Qualifier:
+	// Argument:	GUIContainer* container
+	// Description:	Moves container to the cells of its current area. Does nothing if the cells are the same
+	//************************************
+	void Update(GUIContainer* container);
+	void Clear();
+
+	//************************************
+	// Method:		Query
+	// FullName:	GUISpatialIndex::Query
+	// Access:		public 
+	// Returns:		void
+	// Qualifier:	const
+	// Argument:	const DirectX::XMFLOAT2& position
+	// Argument:	std::vector<GUIContainer*>& outContainers - cleared first, then filled with every container whose area contains position
+	//************************************
+	void Query(const DirectX::XMFLOAT2& position, std::vector<GUIContainer*>& outContainers) const;
+
+private:
+	struct CellRange
+	{
+		int minX;
+		int minY;
+		int maxX;
+		int maxY;
+
+		bool oversized;
+
+		bool operator==(const CellRange& rhs) const
+		{
+			return minX == rhs.minX
+				&& minY == rhs.minY
+				&& maxX == rhs.maxX
+				&& maxY == rhs.maxY
+				&& oversized == rhs.oversized;
+		}
+	};
+
+	const static int MAX_CELLS_PER_CONTAINER = 256;
+
+	float cellSize;
+
+	std::unordered_map<uint64_t, std::vector<GUIContainer*>> cells;
+	std::unordered_map<GUIContainer*, CellRange> containerCells;
+	std::vector<GUIContainer*> oversizedContainers;
+
+	CellRange GetCellRange(const GUIContainer* container) const;
+	int GetCell(float position) const;
+	static uint64_t GetCellKey(int x, int y);
+
+	void AddToCells(GUIContainer* container, const CellRange& range);
+	void RemoveFromCells(GUIContainer* container, const CellRange& range);
+};
+
+#endif // GUISpatialIndex_h__
\ No newline at end of file
@@ -46,55 +46,35 @@ void List::Update(std::chrono::nanoseconds delta)
 		if(!ignoreMouse
 				&& !scrolling)
 		{
-			for(int i = drawBegin; i < drawEnd; i++)
-			{
-				if(elements[i]->GetArea().Contains(mousePosition))
-					HighlightElement(i);
-			}
+			int index = GetElementIndexAt(mousePosition);
+
+			if(index != -1
+				&& index != highlitElement)
+				HighlightElement(index);
 		}
 	}
 
 	scrollbar.Update(delta);
 }
 
-void List::Draw(SpriteRenderer* spriteRenderer)
-{
-	DrawBackground(spriteRenderer);
-	DrawMiddle(spriteRenderer);
-	DrawForeground(spriteRenderer);
-}
-
 void List::DrawBackground(SpriteRenderer* spriteRenderer)
 {
 	background->Draw(spriteRenderer);
 
 	for(int i = drawBegin; i < drawEnd; i++)
-	{
-		GUIContainer* container = elements[i];
-
-		if(container->GetDraw())
-			container->DrawBackground(spriteRenderer);
-	}
+		elements[i]->DrawLayer(spriteRenderer, DRAW_LAYER::BACKGROUND);
 }
 
 void List::DrawMiddle(SpriteRenderer* spriteRenderer)
 {
 	for(int i = drawBegin; i < drawEnd; i++)
-	{
-		GUIContainer* container = elements[i];
-		if(container->GetDraw())
-			container->DrawMiddle(spriteRenderer);
-	}
+		elements[i]->DrawLayer(spriteRenderer, DRAW_LAYER::MIDDLE);
 }
 
 void List::DrawForeground(SpriteRenderer* spriteRenderer)
 {
 	for(int i = drawBegin; i < drawEnd; i++)
-	{
-		GUIContainer* container = elements[i];
-		if(container->GetDraw())
-			container->DrawForeground(spriteRenderer);
-	}
+		elements[i]->DrawLayer(spriteRenderer, DRAW_LAYER::FOREGROUND);
 
 	scrollbar.Draw(spriteRenderer);
 }
@@ -139,6 +119,8 @@ void List::SetElements(const std::vector<GUIContainer*> elements)
 
 	this->elements = elements;
 
+	SetDirty();
+
 	if(this->elements.size() > 0)
 	{
 		elementHeight = static_cast<int>(this->elements.back()->GetSize().y);
@@ -168,6 +150,8 @@ void List::ClearElements()
 	UnHighlightElement();
 	elements.clear();
 
+	SetDirty();
+
 	scrollbar.SetMaxItems(0);
 	drawBegin = 0;
 	drawEnd = 0;
@@ -235,15 +219,11 @@ void List::OnMouseDown(const KeyState& keyState, const DirectX::XMFLOAT2& mouseP
 		{
 			focusOn = nullptr;
 
-			for(GUIContainer* container : elements)
+			int index = GetElementIndexAt(mousePosition);
+			if(index != -1)
 			{
-				if(container->GetDraw()
-						&& container->GetArea().Contains(mousePosition))
-				{
-					focusOn = container;
-					container->OnMouseDown(keyState, mousePosition);
-					break;
-				}
+				focusOn = elements[index];
+				focusOn->OnMouseDown(keyState, mousePosition);
 			}
 		}
 		else
@@ -302,6 +282,8 @@ void List::UpdatePositions()
 	drawBegin = scrollbar.GetMinIndex();
 	drawEnd = scrollbar.GetMaxIndex();
 
+	SetDirty();
+
 	if(elements.size() > 0)
 	{
 		DirectX::XMFLOAT2 newPosition = background->GetWorkArea().GetMinPosition();
@@ -329,6 +311,28 @@ void List::UpdatePositions()
 	}
 }
 
+int List::GetElementIndexAt(const DirectX::XMFLOAT2& position)
+{
+	if(elements.empty())
+		return -1;
+
+	float offset = position.y - background->GetWorkArea().GetMinPosition().y;
+	if(offset < 0.0f)
+		return -1;
+
+	int index = drawBegin + static_cast<int>(offset) / elementHeight;
+	if(index >= drawEnd
+		|| index >= static_cast<int>(elements.size()))
+		return -1;
+
+	GUIContainer* element = elements[index];
+	if(!element->GetDraw()
+		|| !element->GetArea().Contains(position))
+		return -1;
+
+	return index;
+}
+
 void List::ScrollFunction()
 {
 	UpdatePositions();
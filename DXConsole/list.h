@@ -24,7 +24,6 @@ public:
 	virtual void Init(Rect area, const std::shared_ptr<GUIStyle>& style, std::unique_ptr<GUIBackground>& background, const std::shared_ptr<GUIStyle>& backgroundStyle) override;
 	virtual void Update(std::chrono::nanoseconds delta) override;
 
-	virtual void Draw(SpriteRenderer* spriteRenderer) override;
 	virtual void DrawBackground(SpriteRenderer* spriteRenderer) override;
 	virtual void DrawMiddle(SpriteRenderer* spriteRenderer) override;
 	virtual void DrawForeground(SpriteRenderer* spriteRenderer) override;
@@ -85,6 +84,16 @@ private:
 	bool scrolling;
 
 	void UpdatePositions();
+	//************************************
+	// Method:		GetElementIndexAt
+	// FullName:	List::GetElementIndexAt
+	// Access:		private 
+	// Returns:		int - -1 if no visible element is at position
+	// Qualifier:
+	// Argument:	const DirectX::XMFLOAT2& position
+	// Description:	All elements are elementHeight tall and laid out top to bottom, so the row can be calculated directly
+	//************************************
+	int GetElementIndexAt(const DirectX::XMFLOAT2& position);
 
 	void ScrollFunction();
 };
@@ -58,6 +58,8 @@ void Scrollbar::Update(std::chrono::nanoseconds delta)
 		thumb.SetPos(thumb.GetMinPosition().x, Input::GetMousePosition().y - grabY);
 		ClampThumbPosition();
 		UpdateThumbIndex();
+
+		SetDirty();
 	}
 }
 
@@ -223,6 +225,8 @@ void Scrollbar::SetMaxItems(int maxItems)
 
 void Scrollbar::UpdateThumbSize()
 {
+	SetDirty();
+
 	if(maxItems > visibleItems)
 	{
 		float newHeight = area.GetHeight() * (visibleItems / static_cast<float>(maxItems));
@@ -254,6 +258,8 @@ void Scrollbar::UpdateThumbIndex()
 
 void Scrollbar::UpdateThumbPosition()
 {
+	SetDirty();
+
 	if(maxItems == 0)
 	{
 		thumb = area;
@@ -343,6 +349,7 @@ void Scrollbar::SetSize(const DirectX::XMFLOAT2& newSize)
 void Scrollbar::SetSize(float x, float y)
 {
 	area.SetSize(x, y);
+	UpdateSpatialIndex();
 
 	UpdateThumbSize();
 	UpdateThumbPosition();
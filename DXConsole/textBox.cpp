@@ -58,6 +58,8 @@ void TextBox::Update(std::chrono::nanoseconds delta)
 	{
 		if(Input::MouseMoved())
 		{
+			SetDirty();
+
 			DirectX::XMFLOAT2 mousePos = Input::GetMousePosition();
 
 			if(SelectionMade())
@@ -137,16 +139,6 @@ void TextBox::DrawForeground(SpriteRenderer* spriteRenderer)
 {
 	if(drawCursor)
 	{
-		if(cursorBlinkTimer.GetTime() >= cursorBlinkTime)
-		{
-			cursorBlinkTimer.Reset();
-
-			DirectX::XMVECTOR xmCursorColor = DirectX::XMLoadFloat4(&cursorColor);
-			DirectX::XMVECTOR xmCursorColorNormal = DirectX::XMLoadFloat4(&style->cursorColorNormal);
-
-			cursorColor = (DirectX::XMVector4Equal(xmCursorColor, xmCursorColorNormal) ? style->cursorColorBlink : style->cursorColorNormal);
-		}
-
 		DirectX::XMFLOAT2 drawPosition(background->GetWorkArea().GetMinPosition());
 		drawPosition.x += style->cursorOffset.x;
 		drawPosition.y += style->cursorOffset.y;
@@ -164,8 +156,26 @@ void TextBox::DrawForeground(SpriteRenderer* spriteRenderer)
 	}
 }
 
+void TextBox::CheckDirty()
+{
+	if(drawCursor
+		&& cursorBlinkTimer.GetTime() >= cursorBlinkTime)
+	{
+		cursorBlinkTimer.Reset();
+
+		DirectX::XMVECTOR xmCursorColor = DirectX::XMLoadFloat4(&cursorColor);
+		DirectX::XMVECTOR xmCursorColorNormal = DirectX::XMLoadFloat4(&style->cursorColorNormal);
+
+		cursorColor = (DirectX::XMVector4Equal(xmCursorColor, xmCursorColorNormal) ? style->cursorColorBlink : style->cursorColorNormal);
+
+		SetDirty();
+	}
+}
+
 void TextBox::Insert(int index, unsigned int character)
 {
+	SetDirty();
+
 	if(SelectionMade())
 		EraseSelection();
 	
@@ -177,6 +187,8 @@ void TextBox::Insert(int index, unsigned int character)
 
 void TextBox::Insert(unsigned int index, const std::string& text)
 {
+	SetDirty();
+
 	if(SelectionMade())
 		EraseSelection();
 
@@ -197,6 +209,8 @@ void TextBox::Insert(unsigned int index, const char* text)
 
 void TextBox::Erase(unsigned int startIndex, unsigned int count)
 {
+	SetDirty();
+
 	style->characterSet->Erase(constructedString, startIndex, count);
 
 	if(count > 0)
@@ -219,6 +233,8 @@ void TextBox::Activate()
 
 	drawCursor = true;
 	recieveAllEvents = true;
+
+	SetDirty();
 }
 
 void TextBox::Deactivate()
@@ -228,6 +244,8 @@ void TextBox::Deactivate()
 	drawCursor = false;
 	update = false;
 	recieveAllEvents = false;
+
+	SetDirty();
 }
 
 void TextBox::OnMouseEnter()
@@ -239,6 +257,8 @@ void TextBox::OnMouseDown(const KeyState& keyState, const DirectX::XMFLOAT2& mou
 {
 	if(keyState.key == MOUSE_BUTTON::LEFT)
 	{
+		SetDirty();
+
 		if(keyState.action == KEY_ACTION::DOWN)
 		{
 			if(!area.Contains(mousePosition))
@@ -308,6 +328,8 @@ void TextBox::OnKeyDown(const KeyState& keyState)
 		cursorBlinkTimer.Reset();
 		cursorColor = style->cursorColorNormal;
 
+		SetDirty();
+
 		switch(keyState.key)
 		{
 			case VK_BACK:
@@ -644,6 +666,8 @@ void TextBox::JumpCursorRight()
 
 void TextBox::ExtendSelectionToCursor()
 {
+	SetDirty();
+
 	if(cursorIndex > selectionIndex)
 	{
 		selectionStartIndex = selectionIndex;
@@ -664,6 +688,8 @@ void TextBox::BeginSelection()
 
 void TextBox::Deselect()
 {
+	SetDirty();
+
 	selectionEndIndex = -1;
 	selectionStartIndex = -1;
 }
@@ -685,6 +711,8 @@ bool TextBox::SelectionMade() const
 
 void TextBox::SetXOffset()
 {
+	SetDirty();
+
 	int widthAtCursor = style->characterSet->GetWidthAtIndex(constructedString, cursorIndex);
 
 	if(widthAtCursor > background->GetWorkArea().GetWidth() - (xOffset + style->cursorSize.x))
@@ -701,7 +729,7 @@ void TextBox::SetText(const std::string& text)
 		return;
 	}
 
-	constructedString = style->characterSet->ConstructString(text);
+	style->characterSet->ConstructString(text, constructedString);
 	//SetCursorIndex(static_cast<unsigned int>(utf8::unchecked::distance(text.begin(), text.end())));
 	SetCursorIndex(static_cast<unsigned int>(text.size()));
 
@@ -759,6 +787,8 @@ void TextBox::SetCursorIndex(unsigned int newIndex)
 		newIndex = constructedString.length;
 
 	cursorIndex = newIndex;
+
+	SetDirty();
 }
 
 void TextBox::SetJumpSeparators(const std::string& separators)
@@ -780,7 +810,9 @@ void TextBox::SetCharacterSet(const CharacterSet* characterSet)
 {
 	style->characterSet = characterSet;
 
-	constructedString = style->characterSet->ConstructString(constructedString.text);
+	style->characterSet->ConstructString(constructedString.text, constructedString);
+
+	SetDirty();
 }
 
 bool TextBox::GetIsEmpty() const
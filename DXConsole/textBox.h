@@ -118,6 +118,9 @@ protected:
 	bool SelectionMade() const;
 
 	void SetXOffset();
+
+	//Blinks the cursor
+	void CheckDirty() override;
 };
 
 #endif // TextBox_h__
@@ -25,6 +25,7 @@ TextField::TextField()
 	, selectionEndLineIndex(-1)
 	, visibleStringsBegin(0)
 	, visibleStringsEnd(0)
+	, maxLines(0)
 	, matchWidth(-1)
 	, jumpSeparators(" ")
 	, jumpToBeforeSeparator(true)
@@ -118,8 +119,7 @@ void TextField::DrawBackground(SpriteRenderer* spriteRenderer)
 
 	spriteRenderer->DisableScissorTest();
 
-	if(scrollbar.GetDraw())
-		scrollbar.DrawBackground(spriteRenderer);
+	scrollbar.DrawLayer(spriteRenderer, DRAW_LAYER::BACKGROUND);
 }
 
 void TextField::DrawMiddle(SpriteRenderer* spriteRenderer)
@@ -164,8 +164,7 @@ void TextField::DrawMiddle(SpriteRenderer* spriteRenderer)
 		}
 	}
 
-	if(scrollbar.GetDraw())
-		scrollbar.DrawMiddle(spriteRenderer);
+	scrollbar.DrawLayer(spriteRenderer, DRAW_LAYER::MIDDLE);
 }
 
 
@@ -173,16 +172,6 @@ void TextField::DrawForeground(SpriteRenderer* spriteRenderer)
 {
 	if(drawCursor)
 	{
-		if(cursorBlinkTimer.GetTime() >= cursorBlinkTime)
-		{
-			cursorBlinkTimer.Reset();
-
-			DirectX::XMVECTOR xmCursorColor = DirectX::XMLoadFloat4(&cursorColor);
-			DirectX::XMVECTOR xmCursorColorNormal = DirectX::XMLoadFloat4(&style->cursorColorNormal);
-
-			cursorColor = (DirectX::XMVector4Equal(xmCursorColor, xmCursorColorNormal) ? style->cursorColorBlink : style->cursorColorNormal);
-		}
-
 		DirectX::XMFLOAT2 drawPosition(cursorPosition);
 
 		drawPosition.x += style->cursorOffset.x;
@@ -191,15 +180,31 @@ void TextField::DrawForeground(SpriteRenderer* spriteRenderer)
 		spriteRenderer->Draw(Rect(drawPosition, style->cursorSize), cursorColor);
 	}
 
-	if(scrollbar.GetDraw())
-		scrollbar.DrawForeground(spriteRenderer);
+	scrollbar.DrawLayer(spriteRenderer, DRAW_LAYER::FOREGROUND);
+}
+
+void TextField::CheckDirty()
+{
+	if(drawCursor
+		&& cursorBlinkTimer.GetTime() >= cursorBlinkTime)
+	{
+		cursorBlinkTimer.Reset();
+
+		DirectX::XMVECTOR xmCursorColor = DirectX::XMLoadFloat4(&cursorColor);
+		DirectX::XMVECTOR xmCursorColorNormal = DirectX::XMLoadFloat4(&style->cursorColorNormal);
+
+		cursorColor = (DirectX::XMVector4Equal(xmCursorColor, xmCursorColorNormal) ? style->cursorColorBlink : style->cursorColorNormal);
+
+		SetDirty();
+	}
 }
 
 void TextField::AddText(std::string text)
 {
 	if(text.empty())
 	{
-		lines.emplace_back("", false);
+		lines.emplace_back("", false, true);
+		TrimLines();
 		return;
 	}
 
@@ -217,11 +222,11 @@ void TextField::AddText(std::string text)
 
 	newLines.emplace_back(text);
 
-	for(const std::string& newLine : newLines)
-	{
-		std::vector<std::tuple<std::string, bool>> newLineData = CreateLineData(newLine);
-		lines.insert(lines.end(), std::make_move_iterator(newLineData.begin()), std::make_move_iterator(newLineData.end()));
-	}
+	//Wrapped once they're visible
+	for(std::string& newLine : newLines)
+		lines.emplace_back(std::move(newLine), false, false);
+
+	TrimLines();
 
 	scrollbar.SetMaxItems(static_cast<int>(lines.size()));
 
@@ -374,6 +379,20 @@ void TextField::EraseLines(int begin, int count)
 	UpdateVisibleStrings();
 }
 
+void TextField::EraseFirstLines(int count)
+{
+	int removeCount = 0;
+	for(int i = 0; i < count && removeCount < static_cast<int>(lines.size()); ++i)
+	{
+		while(std::get<1>(lines[removeCount]) && removeCount < static_cast<int>(lines.size()) - 1)
+			++removeCount;
+
+		++removeCount;
+	}
+
+	RemoveFrontRows(removeCount);
+}
+
 int TextField::GetLineCount() const
 {
 	return static_cast<int>(lines.size());
@@ -399,6 +418,106 @@ void TextField::Clear()
 	cursorPosition.x = background->GetWorkArea().GetMinPosition().x;
 }
 
+void TextField::SetMaxLines(unsigned int maxLines)
+{
+	this->maxLines = maxLines;
+
+	TrimLines();
+}
+
+unsigned int TextField::GetMaxLines() const
+{
+	return maxLines;
+}
+
+void TextField::SetTrimCallback(std::function<void(const std::vector<std::string>&)> callback)
+{
+	trimCallback = callback;
+}
+
+void TextField::TrimLines()
+{
+	if(maxLines == 0
+		|| lines.size() <= maxLines)
+		return;
+
+	unsigned int targetLines = maxLines - maxLines / 8;
+	size_t linesToRemove = lines.size() - targetLines;
+
+	std::vector<std::string> trimmedLines;
+
+	//Only remove whole lines, and always keep the last one
+	size_t removeCount = 0;
+	while(removeCount < linesToRemove)
+	{
+		size_t lineEnd = removeCount;
+		while(std::get<1>(lines[lineEnd]) && lineEnd < lines.size() - 1)
+			++lineEnd;
+
+		if(lineEnd == lines.size() - 1)
+			break;
+
+		if(trimCallback != nullptr)
+		{
+			trimmedLines.emplace_back();
+
+			for(size_t i = removeCount; i <= lineEnd; ++i)
+				trimmedLines.back() += std::get<0>(lines[i]);
+		}
+
+		removeCount = lineEnd + 1;
+	}
+
+	if(removeCount == 0)
+		return;
+
+	RemoveFrontRows(static_cast<int>(removeCount));
+
+	if(trimCallback != nullptr)
+		trimCallback(trimmedLines);
+}
+
+void TextField::RemoveFrontRows(int count)
+{
+	if(count == 0)
+		return;
+
+	lines.erase(lines.begin(), lines.begin() + count);
+
+	cursorLineIndex -= count;
+	if(cursorLineIndex < 0)
+	{
+		cursorLineIndex = 0;
+		cursorIndex = 0;
+	}
+
+	if(SelectionMade())
+	{
+		if(selectionEndLineIndex - count < 0)
+			Deselect();
+		else
+		{
+			selectionLineIndex = std::max(selectionLineIndex - count, 0);
+			selectionEndLineIndex -= count;
+			selectionStartLineIndex -= count;
+
+			if(selectionStartLineIndex < 0)
+			{
+				selectionStartLineIndex = 0;
+				selectionStartIndex = 0;
+			}
+		}
+	}
+
+	//Keep showing the same text unless the view follows new lines
+	if(scrollbar.GetMaxIndex() != scrollbar.GetMaxItems())
+		scrollbar.Scroll(-count);
+
+	scrollbar.SetMaxItems(static_cast<int>(lines.size()));
+
+	UpdateVisibleStrings();
+}
+
 void TextField::Activate()
 {
 	focus = true;
@@ -410,6 +529,8 @@ void TextField::Activate()
 
 	drawCursor = true;
 	recieveAllEvents = true;
+
+	SetDirty();
 }
 
 void TextField::Deactivate()
@@ -420,6 +541,8 @@ void TextField::Deactivate()
 	drawCursor = false;
 	update = false;
 	recieveAllEvents = false;
+
+	SetDirty();
 }
 
 bool TextField::GetIsActive() const
@@ -432,9 +555,9 @@ int TextField::GetCursorIndex(int width, int line) const
 	if(width <= 0)
 		return 0;
 
-	ConstructedString constructedString = style->characterSet->ConstructString(std::get<0>(lines[line]));
+	style->characterSet->ConstructString(std::get<0>(lines[line]), constructedLine);
 
-	return style->characterSet->GetIndexAtWidth(constructedString, width);
+	return style->characterSet->GetIndexAtWidth(constructedLine, width);
 }
 
 void TextField::OnKeyDown(const KeyState& keyState)
@@ -444,6 +567,8 @@ void TextField::OnKeyDown(const KeyState& keyState)
 		cursorBlinkTimer.Reset();
 		cursorColor = style->cursorColorNormal;
 
+		SetDirty();
+
 		switch(keyState.key)
 		{
 			case VK_UP:
@@ -544,6 +669,8 @@ void TextField::OnMouseDown(const KeyState& keyState, const DirectX::XMFLOAT2& m
 {
 	if(keyState.key == MOUSE_BUTTON::LEFT)
 	{
+		SetDirty();
+
 		if(area.Contains(mousePosition))
 		{
 			if(lines.size() > 0)
@@ -745,6 +872,8 @@ void TextField::UpdateText(int beginAtLine)
 	lines.insert(lines.begin() + beginAtLine, std::make_move_iterator(newLines.begin()), std::make_move_iterator(newLines.end()));
 
 	scrollbar.SetMaxItems(static_cast<int>(lines.size()));
+
+	SetDirty();
 }
 
 void TextField::UpPressed(const KeyState& keyState)
@@ -1069,6 +1198,14 @@ void TextField::EndPressed(const KeyState & keyState)
 
 void TextField::SetCursorIndex(int newIndex)
 {
+	//newIndex is relative to the whole line if it hasn't been wrapped yet, so wrap it first and let the index move to its row
+	if(cursorLineIndex < static_cast<int>(lines.size()))
+	{
+		cursorIndex = newIndex;
+		WrapLine(cursorLineIndex);
+		newIndex = cursorIndex;
+	}
+
 	//Unsigned int means there's no need to check values below 0
 	scrollbar.ScrollTo(cursorLineIndex);
 	UpdateVisibleStrings();
@@ -1108,8 +1245,8 @@ void TextField::MoveCursorUp()
 			UpdateVisibleStrings();
 		}
 
-		ConstructedString constructedString = style->characterSet->ConstructString(std::get<0>(lines[cursorLineIndex]));
-		SetCursorIndex(style->characterSet->GetIndexAtWidth(constructedString, matchWidth));
+		style->characterSet->ConstructString(std::get<0>(lines[cursorLineIndex]), constructedLine);
+		SetCursorIndex(style->characterSet->GetIndexAtWidth(constructedLine, matchWidth));
 	}
 }
 
@@ -1126,8 +1263,8 @@ void TextField::MoveCursorDown()
 			UpdateVisibleStrings();
 		}
 
-		ConstructedString constructedString = style->characterSet->ConstructString(std::get<0>(lines[cursorLineIndex]));
-		SetCursorIndex(style->characterSet->GetIndexAtWidth(constructedString, matchWidth));
+		style->characterSet->ConstructString(std::get<0>(lines[cursorLineIndex]), constructedLine);
+		SetCursorIndex(style->characterSet->GetIndexAtWidth(constructedLine, matchWidth));
 	}
 }
 
@@ -1306,6 +1443,8 @@ void TextField::JumpCursorRight()
 
 void TextField::ExtendSelectionToCursor()
 {
+	SetDirty();
+
 	//Make sure selectionEndIndex is always after selectionStartIndex
 	//Same thing with selectionEndLineIndex and selectionStartLineIndex5
 	if(selectionLineIndex < cursorLineIndex)
@@ -1353,6 +1492,8 @@ void TextField::BeginSelection()
 
 void TextField::Deselect()
 {
+	SetDirty();
+
 	selectionEndIndex = -1;
 	selectionStartIndex = -1;
 
@@ -1399,6 +1540,10 @@ bool TextField::SelectionMade() const
 
 void TextField::UpdateVisibleStrings()
 {
+	SetDirty();
+
+	WrapVisibleLines();
+
 	visibleStringsBegin = scrollbar.GetMinIndex();
 	visibleStringsEnd = scrollbar.GetMaxIndex();
 
@@ -1423,15 +1568,94 @@ void TextField::UpdateVisibleStrings()
 		&& scrollbar.GetMaxItems() > scrollbar.GetVisibleItems());
 }
 
-std::vector<std::tuple<std::string, bool>> TextField::CreateLineData(const std::string& text) const
+int TextField::WrapLine(int lineIndex)
+{
+	if(std::get<2>(lines[lineIndex]))
+		return 0;
+
+	auto newLines = CreateLineData(std::get<0>(lines[lineIndex]));
+	int addedCount = static_cast<int>(newLines.size()) - 1;
+
+	std::get<1>(newLines.back()) = std::get<1>(lines[lineIndex]);
+
+	lines.erase(lines.begin() + lineIndex);
+	lines.insert(lines.begin() + lineIndex, std::make_move_iterator(newLines.begin()), std::make_move_iterator(newLines.end()));
+
+	if(addedCount == 0)
+		return 0;
+
+	//Positions on the wrapped line are moved to the row their index ended up on
+	auto movePosition = [&](int& positionLineIndex, int& positionIndex)
+	{
+		if(positionLineIndex > lineIndex)
+			positionLineIndex += addedCount;
+		else if(positionLineIndex == lineIndex)
+		{
+			while(positionLineIndex < lineIndex + addedCount
+				  && positionIndex > static_cast<int>(std::get<0>(lines[positionLineIndex]).size()))
+			{
+				positionIndex -= static_cast<int>(std::get<0>(lines[positionLineIndex]).size());
+				++positionLineIndex;
+			}
+		}
+	};
+
+	bool cursorMoved = cursorLineIndex == lineIndex;
+
+	movePosition(cursorLineIndex, cursorIndex);
+
+	if(cursorMoved)
+		cursorPosition.x = background->GetWorkArea().GetMinPosition().x + style->characterSet->GetWidthAtIndex(std::get<0>(lines[cursorLineIndex]), cursorIndex);
+
+	if(SelectionMade())
+	{
+		movePosition(selectionLineIndex, selectionIndex);
+		movePosition(selectionStartLineIndex, selectionStartIndex);
+		movePosition(selectionEndLineIndex, selectionEndIndex);
+	}
+
+	scrollbar.SetMaxItems(static_cast<int>(lines.size()));
+
+	return addedCount;
+}
+
+void TextField::WrapVisibleLines()
+{
+	//Wrapping adds rows, which can move the window if it follows the last line, so start over after every line
+	while(true)
+	{
+		int begin = scrollbar.GetMinIndex();
+		int end = std::min(scrollbar.GetMaxIndex(), static_cast<int>(lines.size()));
+
+		int lineIndex = begin;
+		while(lineIndex < end && std::get<2>(lines[lineIndex]))
+			++lineIndex;
+
+		if(lineIndex >= end)
+			break;
+
+		WrapLine(lineIndex);
+	}
+}
+
+std::vector<std::tuple<std::string, bool, bool>> TextField::CreateLineData(const std::string& text) const
 {
-	std::vector<std::tuple<std::string, bool>> returnVector;
+	std::vector<std::tuple<std::string, bool, bool>> returnVector;
+
+	//Most lines fit, and measuring them is a lot cheaper than splitting them into words
+	if(style->characterSet->GetWidthAtIndex(text, static_cast<unsigned int>(text.size())) <= background->GetWorkArea().GetWidth() - scrollbar.GetSize().x - style->scrollBarPadding)
+	{
+		returnVector.emplace_back(text, false, true);
+		return returnVector;
+	}
 
 	int width = 0;
 	int drawStartIndex = 0;
 	int drawCount = 0;
 
-	for(const CharacterBlock& block : style->characterSet->ConstructString(text).characterBlocks)
+	style->characterSet->ConstructString(text, constructedLine);
+
+	for(const CharacterBlock& block : constructedLine.characterBlocks)
 	{
 		if(width + block.width <= background->GetWorkArea().GetWidth() - scrollbar.GetSize().x - style->scrollBarPadding)
 		{
@@ -1444,7 +1668,7 @@ std::vector<std::tuple<std::string, bool>> TextField::CreateLineData(const std::
 			if(block.width > background->GetWorkArea().GetWidth() - scrollbar.GetSize().x - style->scrollBarPadding)
 			{
 				//Block needs to be split into several lines
-				for(const Character* character : block.characters)
+				for(const Character* character : constructedLine.GetGlyphs(block))
 				{
 					if(width + character->xAdvance < background->GetWorkArea().GetWidth() - scrollbar.GetSize().x - style->scrollBarPadding)
 					{
@@ -1453,7 +1677,7 @@ std::vector<std::tuple<std::string, bool>> TextField::CreateLineData(const std::
 					}
 					else
 					{
-						returnVector.emplace_back(text.substr(drawStartIndex, drawCount), true);
+						returnVector.emplace_back(text.substr(drawStartIndex, drawCount), true, true);
 
 						width = character->xAdvance;
 						drawStartIndex += drawCount;
@@ -1467,7 +1691,7 @@ std::vector<std::tuple<std::string, bool>> TextField::CreateLineData(const std::
 			else
 			{
 				//Block will fit on a new line
-				returnVector.emplace_back(text.substr(drawStartIndex, drawCount), true);
+				returnVector.emplace_back(text.substr(drawStartIndex, drawCount), true, true);
 
 				width = block.width + style->characterSet->GetSpaceXAdvance();
 				drawStartIndex += drawCount;
@@ -1476,7 +1700,7 @@ std::vector<std::tuple<std::string, bool>> TextField::CreateLineData(const std::
 		}
 	}
 
-	returnVector.emplace_back(text.substr(drawStartIndex, drawCount - 1), false); //Skip last space since it's not actually there
+	returnVector.emplace_back(text.substr(drawStartIndex, drawCount - 1), false, true); //Skip last space since it's not actually there
 
 	return returnVector;
 }
@@ -9,6 +9,8 @@
 #include "scrollbar.h"
 #include "guiManager.h"
 
+#include <deque>
+
 class TextField :
 	public GUIContainer
 {
@@ -39,12 +41,38 @@ public:
 	std::string	GetLine(int stringIndex) const;
 	std::string	GetSelectedText() const;
 	void EraseLines(int begin, int count);
+	//************************************
+	// Method:		EraseFirstLines
+	// FullName:	TextField::EraseFirstLines
+	// Access:		public 
+	// Returns:		void
+	// Qualifier:
+	// Argument:	int count - lines as they were added, not wrapped rows
+	// Description:	Removes the oldest lines. Rows are wrapped lazily so GetLineCount can't be used
+	// to know how many rows a line became
+	//************************************
+	void EraseFirstLines(int count);
 	int	GetLineCount() const;
 
 	void SetText(const std::string& text);
 
 	void Clear();
 
+	//************************************
+	// Method:		SetMaxLines
+	// FullName:	TextField::SetMaxLines
+	// Access:		public 
+	// Returns:		void
+	// Qualifier:
+	// Argument:	unsigned int maxLines - 0 for no limit
+	// Description:	Once there are more than maxLines lines the oldest ones are removed. Lines are removed
+	// maxLines / 8 at a time so a full text field doesn't trim on every AddText
+	//************************************
+	void SetMaxLines(unsigned int maxLines);
+	unsigned int GetMaxLines() const;
+	//Called with the (unwrapped) lines removed because of SetMaxLines, oldest first
+	void SetTrimCallback(std::function<void(const std::vector<std::string>&)> callback);
+
 	void Activate() override;
 	void Deactivate() override;
 
@@ -73,9 +101,13 @@ public:
 	static GUIStyle* GenerateDefaultBackgroundStyle(ContentManager* contentManager);
 
 protected:
-	//<text, whether or not the line at this index and the line at the next index is "together">
-	//I also realized now that I could've as well used std::pair. TODO
-	std::vector<std::tuple<std::string, bool>> lines;
+	//<text, whether or not the line at this index and the line at the next index is "together", whether or not the line has been wrapped>
+	//Added lines aren't wrapped until they're visible, see WrapVisibleLines
+	//A deque so the oldest lines can be dropped without moving the rest
+	std::deque<std::tuple<std::string, bool, bool>> lines;
+
+	unsigned int maxLines;
+	std::function<void(const std::vector<std::string>&)> trimCallback;
 
 	DirectX::XMFLOAT4 textColor;
 
@@ -122,6 +154,9 @@ protected:
 	std::string jumpSeparators;
 	bool jumpToBeforeSeparator;
 
+	//Scratch space for measuring lines, kept so cached layouts are copied without allocating
+	mutable ConstructedString constructedLine;
+
 	int GetCursorIndex(int width, int line) const;
 
 	void UpPressed(const KeyState& keyState);
@@ -150,10 +185,55 @@ protected:
 
 	void UpdateText(int beginAtLine);
 	void UpdateVisibleStrings();
+	//************************************
+	// Method:		TrimLines
+	// FullName:	TextField::TrimLines
+	// Access:		protected 
+	// Returns:		void
+	// Qualifier:
+	// Description:	Removes the oldest lines if there are more than maxLines. Wrapped lines are
+	// removed together and the cursor, selection and scroll position are moved along with the text
+	//************************************
+	void TrimLines();
+	//************************************
+	// Method:		RemoveFrontRows
+	// FullName:	TextField::RemoveFrontRows
+	// Access:		protected 
+	// Returns:		void
+	// Qualifier:
+	// Argument:	int count
+	// Description:	Removes the first count rows and moves the cursor, selection and scroll position along with the text
+	//************************************
+	void RemoveFrontRows(int count);
+
+	//************************************
+	// Method:		WrapLine
+	// FullName:	TextField::WrapLine
+	// Access:		protected 
+	// Returns:		int - how many rows were added
+	// Qualifier:
+	// Argument:	int lineIndex
+	// Description:	Splits a line that hasn't been wrapped yet into rows that fit the width. The cursor
+	// and selection are moved along with the text
+	//************************************
+	int WrapLine(int lineIndex);
+	//************************************
+	// Method:		WrapVisibleLines
+	// FullName:	TextField::WrapVisibleLines
+	// Access:		protected 
+	// Returns:		void
+	// Qualifier:
+	// Description:	Wraps every line in the visible window. Lines count as a single row until then, so the
+	// cost of adding text doesn't depend on how much of it wraps, and output nobody scrolls to is never measured
+	//************************************
+	void WrapVisibleLines();
 		
-	std::vector<std::tuple<std::string, bool>> CreateLineData(const std::string& text) const;
+	std::vector<std::tuple<std::string, bool, bool>> CreateLineData(const std::string& text) const;
 
 	void ScrollbarScrolled();
+
+	//Blinks the cursor
+	void CheckDirty() override;
 };
 
 #endif // TextField_h__
\ No newline at end of file
@@ -82,11 +82,24 @@ void Camera::SetPosition(DirectX::XMFLOAT3 position)
 	this->position = position;
 }
 
+void Camera::SetRotation(DirectX::XMFLOAT4 rotationQuaternion)
+{
+	this->rotationQuaternion = rotationQuaternion;
+
+	pitch = DirectX::XMQuaternionGetPitch(rotationQuaternion);
+	yaw = DirectX::XMQuaternionGetYaw(rotationQuaternion);
+}
+
 DirectX::XMFLOAT3 Camera::GetPosition() const
 {
 	return position;
 }
 
+DirectX::XMFLOAT4 Camera::GetRotation() const
+{
+	return rotationQuaternion;
+}
+
 DirectX::XMFLOAT4X4 Camera::GetProjectionMatrix() const
 {
 	return projectionMatrix;
@@ -29,8 +29,11 @@ public:
 	virtual void Rotate(DirectX::XMFLOAT2 angle);
 	
 	virtual void SetPosition(DirectX::XMFLOAT3 position);
+	//Sets the rotation directly, e.g. when replaying a recorded camera
+	void SetRotation(DirectX::XMFLOAT4 rotationQuaternion);
 
 	DirectX::XMFLOAT3 GetPosition() const;
+	DirectX::XMFLOAT4 GetRotation() const;
 	DirectX::XMFLOAT4X4 GetProjectionMatrix() const;
 	DirectX::XMFLOAT4X4 GetViewMatrix() const;
 
@@ -0,0 +1,308 @@
+#include "CameraRecording.h"
+
+#include "Logger.h"
+
+#include <fstream>
+#include <cstring>
+#include <iterator>
+
+namespace
+{
+	const char FILE_MAGIC[4] = { 'C', 'A', 'M', 'R' };
+	const uint32_t FILE_VERSION = 1;
+
+	void WriteVarint(std::vector<uint8_t>& data, uint32_t value)
+	{
+		while(value >= 0x80)
+		{
+			data.push_back(static_cast<uint8_t>(value | 0x80));
+			value >>= 7;
+		}
+
+		data.push_back(static_cast<uint8_t>(value));
+	}
+
+	bool ReadVarint(const std::vector<uint8_t>& data, size_t& offset, uint32_t& outValue)
+	{
+		outValue = 0;
+
+		for(int shift = 0; shift < 35; shift += 7)
+		{
+			if(offset >= data.size())
+				return false;
+
+			uint8_t byte = data[offset++];
+			outValue |= static_cast<uint32_t>(byte & 0x7F) << shift;
+
+			if((byte & 0x80) == 0)
+				return true;
+		}
+
+		return false;
+	}
+
+	//Maps signed values to unsigned so that small negative values also become small varints
+	uint32_t ZigZagEncode(uint32_t value)
+	{
+		return (value << 1) ^ (0u - (value >> 31));
+	}
+
+	uint32_t ZigZagDecode(uint32_t value)
+	{
+		return (value >> 1) ^ (0u - (value & 1));
+	}
+
+	void WriteUint32(std::ofstream& out, uint32_t value)
+	{
+		uint8_t bytes[4] = { static_cast<uint8_t>(value)
+			, static_cast<uint8_t>(value >> 8)
+			, static_cast<uint8_t>(value >> 16)
+			, static_cast<uint8_t>(value >> 24) };
+
+		out.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+	}
+
+	bool ReadUint32(std::ifstream& in, uint32_t& outValue)
+	{
+		uint8_t bytes[4];
+		if(!in.read(reinterpret_cast<char*>(bytes), sizeof(bytes)))
+			return false;
+
+		outValue = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+		return true;
+	}
+}
+
+CameraRecording::CameraRecording()
+{
+	Clear();
+}
+
+void CameraRecording::Clear()
+{
+	data.clear();
+	frameCount = 0;
+
+	//Matches a default constructed frame, so the first frame only stores what differs from it
+	GetFloatBits(CameraRecordingFrame(), previousBits);
+	GetFloatBits(CameraRecordingFrame(), previousPreviousBits);
+}
+
+void CameraRecording::AddFrame(const CameraRecordingFrame& frame)
+{
+	uint32_t bits[FLOAT_FIELD_COUNT];
+	GetFloatBits(frame, bits);
+
+	uint32_t residuals[FLOAT_FIELD_COUNT];
+	uint32_t mask = 0;
+
+	for(int i = 0; i < FLOAT_FIELD_COUNT; ++i)
+	{
+		residuals[i] = bits[i] - PredictBits(previousBits[i], previousPreviousBits[i]);
+
+		if(residuals[i] != 0)
+			mask |= 1 << i;
+	}
+
+	if(!frame.commands.empty())
+		mask |= COMMANDS_BIT;
+
+	WriteVarint(data, mask);
+
+	for(int i = 0; i < FLOAT_FIELD_COUNT; ++i)
+	{
+		if(mask & (1 << i))
+			WriteVarint(data, ZigZagEncode(residuals[i]));
+
+		previousPreviousBits[i] = previousBits[i];
+		previousBits[i] = bits[i];
+	}
+
+	if(mask & COMMANDS_BIT)
+	{
+		WriteVarint(data, static_cast<uint32_t>(frame.commands.size()));
+
+		for(const std::string& command : frame.commands)
+		{
+			WriteVarint(data, static_cast<uint32_t>(command.size()));
+			data.insert(data.end(), command.begin(), command.end());
+		}
+	}
+
+	++frameCount;
+}
+
+bool CameraRecording::Decode(std::vector<CameraRecordingFrame>& outFrames) const
+{
+	outFrames.clear();
+	outFrames.reserve(frameCount);
+
+	uint32_t bits[FLOAT_FIELD_COUNT];
+	uint32_t previousBits[FLOAT_FIELD_COUNT];
+	GetFloatBits(CameraRecordingFrame(), bits);
+	GetFloatBits(CameraRecordingFrame(), previousBits);
+
+	size_t offset = 0;
+	for(int frameIndex = 0; frameIndex < frameCount; ++frameIndex)
+	{
+		uint32_t mask;
+		if(!ReadVarint(data, offset, mask)
+			|| mask >= (COMMANDS_BIT << 1))
+			return false;
+
+		for(int i = 0; i < FLOAT_FIELD_COUNT; ++i)
+		{
+			uint32_t residual = 0;
+			if(mask & (1 << i))
+			{
+				if(!ReadVarint(data, offset, residual))
+					return false;
+
+				residual = ZigZagDecode(residual);
+			}
+
+			uint32_t predicted = PredictBits(bits[i], previousBits[i]);
+
+			previousBits[i] = bits[i];
+			bits[i] = predicted + residual;
+		}
+
+		CameraRecordingFrame frame;
+		SetFloatBits(bits, frame);
+
+		if(mask & COMMANDS_BIT)
+		{
+			uint32_t commandCount;
+			if(!ReadVarint(data, offset, commandCount)
+				|| commandCount > data.size() - offset)
+				return false;
+
+			frame.commands.resize(commandCount);
+
+			for(std::string& command : frame.commands)
+			{
+				uint32_t length;
+				if(!ReadVarint(data, offset, length)
+					|| length > data.size() - offset)
+					return false;
+
+				command.assign(reinterpret_cast<const char*>(data.data() + offset), length);
+				offset += length;
+			}
+		}
+
+		outFrames.push_back(std::move(frame));
+	}
+
+	return offset == data.size();
+}
+
+bool CameraRecording::Save(const std::string& path) const
+{
+	std::ofstream out(path, std::ofstream::binary | std::ofstream::trunc);
+	if(!out.is_open())
+	{
+		Logger::LogLine(LOG_TYPE::WARNING, "Couldn't open \"" + path + "\" for writing camera recording");
+		return false;
+	}
+
+	out.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+	WriteUint32(out, FILE_VERSION);
+	WriteUint32(out, static_cast<uint32_t>(frameCount));
+	out.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+	if(!out)
+	{
+		Logger::LogLine(LOG_TYPE::WARNING, "Couldn't write camera recording to \"" + path + "\"");
+		return false;
+	}
+
+	return true;
+}
+
+bool CameraRecording::Load(const std::string& path)
+{
+	std::ifstream in(path, std::ifstream::binary);
+	if(!in.is_open())
+	{
+		Logger::LogLine(LOG_TYPE::WARNING, "Couldn't open camera recording \"" + path + "\"");
+		return false;
+	}
+
+	char magic[sizeof(FILE_MAGIC)];
+	uint32_t version;
+	uint32_t fileFrameCount;
+
+	if(!in.read(magic, sizeof(magic))
+		|| std::memcmp(magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0
+		|| !ReadUint32(in, version)
+		|| !ReadUint32(in, fileFrameCount))
+	{
+		Logger::LogLine(LOG_TYPE::WARNING, "\"" + path + "\" isn't a camera recording");
+		return false;
+	}
+
+	if(version != FILE_VERSION)
+	{
+		Logger::LogLine(LOG_TYPE::WARNING, "Camera recording \"" + path + "\" has version " + std::to_string(version) + ", expected " + std::to_string(FILE_VERSION));
+		return false;
+	}
+
+	Clear();
+
+	data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	frameCount = static_cast<int>(fileFrameCount);
+
+	//Decoding validates the data and gives the last frames, which new frames are predicted from
+	std::vector<CameraRecordingFrame> frames;
+	if(fileFrameCount > data.size()
+		|| !Decode(frames))
+	{
+		Logger::LogLine(LOG_TYPE::WARNING, "Camera recording \"" + path + "\" is corrupt");
+		Clear();
+
+		return false;
+	}
+
+	if(frames.size() >= 2)
+		GetFloatBits(frames[frames.size() - 2], previousPreviousBits);
+	if(!frames.empty())
+		GetFloatBits(frames.back(), previousBits);
+
+	return true;
+}
+
+int CameraRecording::GetFrameCount() const
+{
+	return frameCount;
+}
+
+size_t CameraRecording::GetDataSize() const
+{
+	return data.size();
+}
+
+uint32_t CameraRecording::PredictBits(uint32_t previous, uint32_t previousPrevious)
+{
+	//Wraps around on overflow, which is fine since the residual wraps back the same way
+	return previous + (previous - previousPrevious);
+}
+
+void CameraRecording::GetFloatBits(const CameraRecordingFrame& frame, uint32_t (&outBits)[FLOAT_FIELD_COUNT])
+{
+	const float floats[FLOAT_FIELD_COUNT] = { frame.position.x, frame.position.y, frame.position.z
+		, frame.rotation.x, frame.rotation.y, frame.rotation.z, frame.rotation.w
+		, frame.deltaMS };
+
+	std::memcpy(outBits, floats, sizeof(floats));
+}
+
+void CameraRecording::SetFloatBits(const uint32_t (&bits)[FLOAT_FIELD_COUNT], CameraRecordingFrame& outFrame)
+{
+	float floats[FLOAT_FIELD_COUNT];
+	std::memcpy(floats, bits, sizeof(floats));
+
+	outFrame.position = DirectX::XMFLOAT3(floats[0], floats[1], floats[2]);
+	outFrame.rotation = DirectX::XMFLOAT4(floats[3], floats[4], floats[5], floats[6]);
+	outFrame.deltaMS = floats[7];
+}
@@ -0,0 +1,97 @@
+#ifndef CameraRecording_h__
+#define CameraRecording_h__
+
+#include "DXMath.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+struct CameraRecordingFrame
+{
+	DirectX::XMFLOAT3 position;
+	DirectX::XMFLOAT4 rotation;
+
+	float deltaMS;
+
+	//Console commands executed during this frame, before the camera was moved
+	std::vector<std::string> commands;
+
+	CameraRecordingFrame()
+		: position(0.0f, 0.0f, 0.0f)
+		, rotation(0.0f, 0.0f, 0.0f, 1.0f)
+		, deltaMS(0.0f)
+	{}
+};
+
+//Per frame camera poses and console commands, stored in a compact binary format.
+//
+//Each float is predicted by continuing the change between the two previous frames, which is close
+//for a camera moving smoothly. Only floats that differ from the prediction are stored, as the
+//difference between their bits and the predicted bits. Nearby floats have nearby bits, so the
+//difference is stored as a (zigzag) varint which usually needs less than 4 bytes. Frames are stored
+//losslessly, so a replay reproduces the exact poses that were recorded
+class CameraRecording
+{
+public:
+	CameraRecording();
+	~CameraRecording() = default;
+
+	void Clear();
+
+	//************************************
+	// Method:		AddFrame
+	// FullName:	CameraRecording::AddFrame
+	// Access:		public
+	// Returns:		void
+	// Qualifier:
+	// Argument:	const CameraRecordingFrame& frame
+	// Description:	Encodes and appends frame
+	//************************************
+	void AddFrame(const CameraRecordingFrame& frame);
+
+	//************************************
+	// Method:		Decode
+	// FullName:	CameraRecording::Decode
+	// Access:		public
+	// Returns:		bool - false if the data is corrupt
+	// Qualifier:	const
+	// Argument:	std::vector<CameraRecordingFrame>& outFrames - cleared and filled with every frame
+	//************************************
+	bool Decode(std::vector<CameraRecordingFrame>& outFrames) const;
+
+	bool Save(const std::string& path) const;
+	//************************************
+	// Method:		Load
+	// FullName:	CameraRecording::Load
+	// Access:		public
+	// Returns:		bool - false if the file couldn't be opened or isn't a valid recording
+	// Qualifier:
+	// Argument:	const std::string& path
+	// Description:	Replaces any recorded frames with the ones in the file. Frames can be added after the loaded ones
+	//************************************
+	bool Load(const std::string& path);
+
+	int GetFrameCount() const;
+	//Encoded size in bytes, excluding the file header
+	size_t GetDataSize() const;
+
+private:
+	//Position xyz, rotation xyzw, delta
+	static const int FLOAT_FIELD_COUNT = 8;
+	//Set in a frame's mask if it has commands. The bits below are one per mispredicted float
+	static const uint32_t COMMANDS_BIT = 1 << FLOAT_FIELD_COUNT;
+
+	std::vector<uint8_t> data;
+	int frameCount;
+
+	//Bits of the last two added frames' floats
+	uint32_t previousBits[FLOAT_FIELD_COUNT];
+	uint32_t previousPreviousBits[FLOAT_FIELD_COUNT];
+
+	static uint32_t PredictBits(uint32_t previous, uint32_t previousPrevious);
+	static void GetFloatBits(const CameraRecordingFrame& frame, uint32_t (&outBits)[FLOAT_FIELD_COUNT]);
+	static void SetFloatBits(const uint32_t (&bits)[FLOAT_FIELD_COUNT], CameraRecordingFrame& outFrame);
+};
+
+#endif // CameraRecording_h__
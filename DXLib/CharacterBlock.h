@@ -3,31 +3,32 @@
 
 #include "character.h"
 
-#include <vector>
-
+//A word in a ConstructedString. The glyphs themselves live in ConstructedString::glyphs,
+//use ConstructedString::GetGlyphs to get them
 struct CharacterBlock
 {
 	CharacterBlock()
-		: width(0)
+		: glyphOffset(0)
+		, width(0)
 		, length(0)
 	{};
-	CharacterBlock(const std::vector<const Character*>& characters, unsigned int width, unsigned int length)
-		: characters(characters)
+	CharacterBlock(unsigned int glyphOffset, unsigned int width, unsigned int length)
+		: glyphOffset(glyphOffset)
 		, width(width)
 		, length(length)
 	{};
 	~CharacterBlock() = default;
 
-	std::vector<const Character*> characters;
+	unsigned int glyphOffset; //Index of the first glyph in ConstructedString::glyphs
 	unsigned int width;
-	unsigned int length;
+	unsigned int length; //Number of glyphs
 };
 
 inline bool operator==(const CharacterBlock& lhs, const CharacterBlock& rhs)
 {
 	return lhs.length == rhs.length
 		&& lhs.width == rhs.width
-		&& lhs.characters == rhs.characters;
+		&& lhs.glyphOffset == rhs.glyphOffset;
 }
 
 inline bool operator!=(const CharacterBlock& lhs, const CharacterBlock& rhs)
@@ -4,10 +4,78 @@
 
 #include "texture2D.h"
 #include "characterBlock.h"
+#include "mappedFile.h"
 
 #include "logger.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+namespace
+{
+	//FNV-1a, same as ContentPath
+	size_t HashText(const std::string& text)
+	{
+		size_t hash = static_cast<size_t>(2166136261u);
+
+		for(char character : text)
+		{
+			hash ^= static_cast<unsigned char>(character);
+			hash *= static_cast<size_t>(16777619u);
+		}
+
+		return hash;
+	}
+
+	/*Binary font cache (.fntcache), written the first time a .fnt is parsed. Layout:
+	* FontCacheHeader
+	* FontCacheGlyph[glyphCount], sorted by id
+	* FontCacheKerningPair[kerningPairCount], sorted by first, then second
+	*/
+	const char FONT_CACHE_MAGIC[4] = { 'D', 'X', 'F', 'C' };
+	const uint32_t FONT_CACHE_VERSION = 1;
+
+	struct FontCacheHeader
+	{
+		char magic[4];
+		uint32_t version;
+		int64_t sourceSize;
+		int64_t sourceWriteTime;
+		uint32_t fontSize;
+		uint32_t lineHeight;
+		uint32_t glyphCount;
+		uint32_t kerningPairCount;
+	};
+
+	struct FontCacheGlyph
+	{
+		int32_t id;
+		uint16_t x;
+		uint16_t y;
+		uint8_t width;
+		uint8_t height;
+		int8_t xOffset;
+		int8_t yOffset;
+		int16_t xAdvance;
+		int16_t padding;
+	};
+
+	struct FontCacheKerningPair
+	{
+		uint32_t first;
+		uint32_t second;
+		int32_t amount;
+	};
+}
+
 CharacterSet::CharacterSet()
+	: errorCharacter(nullptr)
+	, texture(nullptr)
 {
 	this->name = "";
 	fontSize = 0;
@@ -15,27 +83,41 @@ CharacterSet::CharacterSet()
 
 const Character* CharacterSet::GetCharacter(unsigned int id) const
 {
-	auto iter = characters.find(id);
+	const Character* character = glyphTable.Find(glyphs, id);
+	if(character != nullptr)
+		return character;
 
-	if(iter != characters.end())
-		return &iter->second;
+	if(errorCharacter != nullptr)
+		return errorCharacter;
 	else
 	{
-		iter = characters.find(errorCharacterID);
-
-		if(iter != characters.end())
-			return &iter->second;
-		else
-		{
-			Logger::LogLine(LOG_TYPE::WARNING, "CharacterSet::errorCharacterID set to a non-existing character (make sure CharacterSet is loaded)");
-			return &characters.begin()->second;
-		}
+		Logger::LogLine(LOG_TYPE::WARNING, "CharacterSet::errorCharacterID set to a non-existing character (make sure CharacterSet is loaded)");
+		return &glyphs.front();
 	}
 }
 
-void CharacterSet::XMLSubscriber(const XMLElement& element)
+int CharacterSet::GetKerningOffset(unsigned int first, unsigned int second) const
+{
+	if(kerningPairs.empty())
+		return 0;
+
+	auto iter = std::lower_bound(kerningPairs.begin(), kerningPairs.end(), std::make_pair(first, second)
+								 , [](const KerningPair& lhs, const std::pair<unsigned int, unsigned int>& rhs)
+	{
+		return lhs.first < rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+	});
+
+	if(iter != kerningPairs.end()
+		&& iter->first == first
+		&& iter->second == second)
+		return iter->amount;
+
+	return 0;
+}
+
+void CharacterSet::XMLSubscriber(const XMLElementView& element)
 {
-	std::string elementName(element.GetName());
+	XMLStringView elementName(element.GetName());
 
 	if(elementName == "info")
 	{
@@ -47,7 +129,8 @@ void CharacterSet::XMLSubscriber(const XMLElement& element)
 	}
 	else if(elementName == "char")
 	{
-		Character newChar(element.GetAttribute("id").GetValueAsUnsignedChar()
+		//Read as unsigned int, ids outside of ASCII are perfectly valid
+		Character newChar(element.GetAttribute("id").GetValueAsUnsignedInt()
 			, element.GetAttribute("x").GetValueAsShort()
 			, element.GetAttribute("y").GetValueAsShort()
 			, element.GetAttribute("width").GetValueAsChar()
@@ -56,113 +139,281 @@ void CharacterSet::XMLSubscriber(const XMLElement& element)
 			, element.GetAttribute("yoffset").GetValueAsChar()
 			, element.GetAttribute("xadvance").GetValueAsShort());
 
-		characters.insert(std::pair<unsigned short, Character>(newChar.id, newChar));
+		glyphs.push_back(newChar);
 	}
 	else if(elementName == "kerning")
 	{
-        //unsigned char first = element.GetAttribute("first").GetValueAsUnsignedChar();
-        //unsigned char second = element.GetAttribute("second").GetValueAsUnsignedChar();
-        //char amount = element.GetAttribute("amount").GetValueAsChar();
+		KerningPair kerningPair;
+		kerningPair.first = element.GetAttribute("first").GetValueAsUnsignedInt();
+		kerningPair.second = element.GetAttribute("second").GetValueAsUnsignedInt();
+		kerningPair.amount = element.GetAttribute("amount").GetValueAsInt();
 
-		//characters[first].kerningPairs.insert(std::pair<unsigned char, char>(second, amount));
+		kerningPairs.push_back(kerningPair);
 	}
 }
 
-std::string CharacterSet::GetName() const
+void CharacterSet::BuildGlyphTables()
 {
-	return name;
-}
+	//stable_sort + unique keeps the first definition of an id, same as inserting into a map did
+	std::stable_sort(glyphs.begin(), glyphs.end(), [](const Character& lhs, const Character& rhs) { return static_cast<unsigned int>(lhs.id) < static_cast<unsigned int>(rhs.id); });
+	glyphs.erase(std::unique(glyphs.begin(), glyphs.end(), [](const Character& lhs, const Character& rhs) { return lhs.id == rhs.id; }), glyphs.end());
+	glyphs.shrink_to_fit();
 
-unsigned int CharacterSet::GetFontSize() const
-{
-	return fontSize;
+	std::stable_sort(kerningPairs.begin(), kerningPairs.end(), [](const KerningPair& lhs, const KerningPair& rhs)
+	{
+		return lhs.first < rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+	});
+	kerningPairs.erase(std::unique(kerningPairs.begin(), kerningPairs.end(), [](const KerningPair& lhs, const KerningPair& rhs)
+	{
+		return lhs.first == rhs.first && lhs.second == rhs.second;
+	}), kerningPairs.end());
+	kerningPairs.shrink_to_fit();
+
+	glyphTable.Clear();
+	errorCharacter = nullptr;
+
+	if(glyphs.empty())
+		return;
+
+	if(!glyphTable.Build(glyphs))
+		Logger::LogLine(LOG_TYPE::WARNING, "Font \"" + name + "\" has more than " + std::to_string(GlyphTable::INVALID_GLYPH_INDEX - 1) + " glyphs, every lookup will be binary searched");
+
+	//GetCharacter falls back to the error character, so ask the table directly
+	errorCharacter = glyphTable.Find(glyphs, errorCharacterID);
 }
 
-ConstructedString CharacterSet::ConstructString(const std::string& text) const
+bool CharacterSet::ReadCache(const std::string& cachePath, long long sourceSize, long long sourceWriteTime)
 {
-	ConstructedString returnString;
+	MappedFile file;
+	if(!file.Open(cachePath))
+		return false;
 
-	if(text == "")
-	{
-		std::vector<const Character*> newVector;
-		returnString.characterBlocks.emplace_back(newVector, 0, 0);
-		returnString.text = "";
-		returnString.width = 0;
-		returnString.length = 0;
+	if(file.GetSize() < sizeof(FontCacheHeader))
+		return false;
 
-		return returnString;
+	//The mapping is page aligned but the records are copied out anyway, so don't rely on it
+	FontCacheHeader header;
+	std::memcpy(&header, file.GetData(), sizeof(FontCacheHeader));
+
+	if(std::memcmp(header.magic, FONT_CACHE_MAGIC, sizeof(FONT_CACHE_MAGIC)) != 0
+		|| header.version != FONT_CACHE_VERSION)
+		return false;
+
+	//Without a .fnt there's nothing to compare against, use the cache as-is
+	if(sourceSize >= 0
+		&& (header.sourceSize != sourceSize || header.sourceWriteTime != sourceWriteTime))
+		return false;
+
+	size_t expectedSize = sizeof(FontCacheHeader)
+		+ header.glyphCount * sizeof(FontCacheGlyph)
+		+ header.kerningPairCount * sizeof(FontCacheKerningPair);
+
+	if(file.GetSize() != expectedSize)
+	{
+		Logger::LogLine(LOG_TYPE::WARNING, "Font cache \"" + cachePath + "\" is truncated or corrupt, reparsing .fnt");
+		return false;
 	}
 
-	//Split each word (and the trailing blankspace) into a character block
-	//If the string is something like "abc            def" split it into "abc" and " ... def" (ignoring a single space after abc)
-	//A space is always presumed to be after a CharacterBlock when drawing
-	bool splitAtSpace = false;
+	const char* data = file.GetData() + sizeof(FontCacheHeader);
 
-	unsigned int totalWidth = 0;
+	fontSize = header.fontSize;
+	lineHeight = header.lineHeight;
 
-	CharacterBlock characterBlock;
-	const Character* character;
+	glyphs.reserve(header.glyphCount);
+	for(uint32_t i = 0; i < header.glyphCount; ++i)
+	{
+		FontCacheGlyph glyph;
+		std::memcpy(&glyph, data, sizeof(FontCacheGlyph));
+		data += sizeof(FontCacheGlyph);
 
-	unsigned int length = 0;
+		glyphs.emplace_back(glyph.id, glyph.x, glyph.y, glyph.width, glyph.height, glyph.xOffset, glyph.yOffset, glyph.xAdvance);
+	}
 
-	auto iter = text.begin();
-	while(iter != text.end())
+	kerningPairs.reserve(header.kerningPairCount);
+	for(uint32_t i = 0; i < header.kerningPairCount; ++i)
 	{
-		character = GetCharacter(static_cast<unsigned int>(*iter));
-		++iter;
+		FontCacheKerningPair cachedPair;
+		std::memcpy(&cachedPair, data, sizeof(FontCacheKerningPair));
+		data += sizeof(FontCacheKerningPair);
+
+		KerningPair kerningPair;
+		kerningPair.first = cachedPair.first;
+		kerningPair.second = cachedPair.second;
+		kerningPair.amount = cachedPair.amount;
+
+		kerningPairs.push_back(kerningPair);
+	}
+
+	return true;
+}
 
-		if(character->id == SPACE_CHARACTER)
+void CharacterSet::WriteCache(const std::string& cachePath, long long sourceSize, long long sourceWriteTime) const
+{
+	//Write to a temporary file first so a half written cache is never picked up
+	std::string temporaryPath = cachePath + ".tmp";
+
+	{
+		std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+		if(!out.is_open())
 		{
-			if(splitAtSpace)
-			{
-				splitAtSpace = false;
+			Logger::LogLine(LOG_TYPE::WARNING, "Couldn't write font cache \"" + cachePath + "\"");
+			return;
+		}
 
-				returnString.characterBlocks.emplace_back(std::move(characterBlock));
+		FontCacheHeader header;
+		std::memset(&header, 0, sizeof(FontCacheHeader));
+		std::memcpy(header.magic, FONT_CACHE_MAGIC, sizeof(FONT_CACHE_MAGIC));
+		header.version = FONT_CACHE_VERSION;
+		header.sourceSize = sourceSize;
+		header.sourceWriteTime = sourceWriteTime;
+		header.fontSize = fontSize;
+		header.lineHeight = lineHeight;
+		header.glyphCount = static_cast<uint32_t>(glyphs.size());
+		header.kerningPairCount = static_cast<uint32_t>(kerningPairs.size());
 
-				characterBlock.characters.clear();
-				characterBlock.width = 0;
-				characterBlock.length = 0;
-				totalWidth += spaceXAdvance; //A space is always presumed to be after a character block so include it in the total width
-				length++;
-			}
-			else
-			{
-				characterBlock.width += character->xAdvance;
-				totalWidth += character->xAdvance;
-				characterBlock.characters.emplace_back(character);
-				characterBlock.length++;
-				length++;
-			}
+		out.write(reinterpret_cast<const char*>(&header), sizeof(FontCacheHeader));
+
+		for(const Character& character : glyphs)
+		{
+			FontCacheGlyph glyph;
+			glyph.id = character.id;
+			glyph.x = character.x;
+			glyph.y = character.y;
+			glyph.width = character.width;
+			glyph.height = character.height;
+			glyph.xOffset = character.xOffset;
+			glyph.yOffset = character.yOffset;
+			glyph.xAdvance = character.xAdvance;
+			glyph.padding = 0;
+
+			out.write(reinterpret_cast<const char*>(&glyph), sizeof(FontCacheGlyph));
 		}
-		else
+
+		for(const KerningPair& kerningPair : kerningPairs)
 		{
-			splitAtSpace = true;
+			FontCacheKerningPair cachedPair;
+			cachedPair.first = kerningPair.first;
+			cachedPair.second = kerningPair.second;
+			cachedPair.amount = kerningPair.amount;
 
-			characterBlock.width += character->xAdvance;
-			totalWidth += character->xAdvance;
-			characterBlock.characters.emplace_back(character);
-			characterBlock.length++;
-			length++;
+			out.write(reinterpret_cast<const char*>(&cachedPair), sizeof(FontCacheKerningPair));
+		}
+
+		if(!out.good())
+		{
+			Logger::LogLine(LOG_TYPE::WARNING, "Couldn't write font cache \"" + cachePath + "\"");
+			out.close();
+			std::remove(temporaryPath.c_str());
+			return;
 		}
 	}
 
-	returnString.characterBlocks.emplace_back(std::move(characterBlock));
+	std::remove(cachePath.c_str());
+	if(std::rename(temporaryPath.c_str(), cachePath.c_str()) != 0)
+	{
+		Logger::LogLine(LOG_TYPE::WARNING, "Couldn't write font cache \"" + cachePath + "\"");
+		std::remove(temporaryPath.c_str());
+	}
+}
 
-	returnString.width = totalWidth;
-	returnString.text = text;
-	returnString.length = length;
+size_t CharacterSet::GetLayoutCacheSize() const
+{
+	std::lock_guard<std::mutex> lock(layoutCacheMutex);
+
+	//List node and map node per entry, plus whatever each layout has allocated
+	size_t size = layoutCacheMap.bucket_count() * sizeof(void*);
+
+	for(const LayoutCacheEntry& entry : layoutCache)
+	{
+		size += sizeof(LayoutCacheEntry) + 2 * sizeof(void*)
+			+ sizeof(std::pair<const size_t, std::list<LayoutCacheEntry>::iterator>) + sizeof(void*)
+			+ entry.layout.text.capacity()
+			+ entry.layout.characterBlocks.capacity() * sizeof(CharacterBlock)
+			+ entry.layout.glyphs.capacity() * sizeof(const Character*);
+	}
+
+	return size;
+}
+
+std::string CharacterSet::GetName() const
+{
+	return name;
+}
+
+unsigned int CharacterSet::GetFontSize() const
+{
+	return fontSize;
+}
+
+ConstructedString CharacterSet::ConstructString(const std::string& text) const
+{
+	ConstructedString returnString;
+	ConstructString(text, returnString);
 
 	return returnString;
 }
 
+void CharacterSet::ConstructString(const std::string& text, ConstructedString& outString) const
+{
+	//Long strings are rarely drawn twice and would push everything else out of the cache
+	if(text.size() > MAX_CACHED_LAYOUT_LENGTH)
+	{
+		outString = LayoutString(text);
+		return;
+	}
+
+	size_t hash = HashText(text);
+
+	{
+		std::lock_guard<std::mutex> lock(layoutCacheMutex);
+
+		auto iter = layoutCacheMap.find(hash);
+		if(iter != layoutCacheMap.end()
+			&& iter->second->layout.text == text)
+		{
+			layoutCache.splice(layoutCache.begin(), layoutCache, iter->second);
+
+			//Copy assignment reuses outString's capacity
+			outString = iter->second->layout;
+			return;
+		}
+	}
+
+	//text may be outString.text, which is replaced here
+	outString = LayoutString(text);
+
+	std::lock_guard<std::mutex> lock(layoutCacheMutex);
+
+	auto iter = layoutCacheMap.find(hash);
+	if(iter != layoutCacheMap.end())
+	{
+		//Hash collision, the newest string wins
+		iter->second->layout = outString;
+		layoutCache.splice(layoutCache.begin(), layoutCache, iter->second);
+	}
+	else
+	{
+		if(layoutCache.size() >= LAYOUT_CACHE_SIZE)
+		{
+			layoutCacheMap.erase(layoutCache.back().hash);
+			layoutCache.pop_back();
+		}
+
+		layoutCache.emplace_front();
+		layoutCache.front().hash = hash;
+		layoutCache.front().layout = outString;
+
+		layoutCacheMap.insert(std::make_pair(hash, layoutCache.begin()));
+	}
+}
+
 ConstructedString CharacterSet::ConstructString(const std::string& text, const std::string& separators, const bool keepSeparators) const
 {
 	ConstructedString returnString;
 
 	if(text == "")
 	{
-		std::vector<const Character*> newVector;
-		returnString.characterBlocks.emplace_back(newVector, 0, 0);
+		returnString.characterBlocks.emplace_back(0, 0, 0);
 		returnString.text = "";
 		returnString.width = 0;
 		returnString.length = 0;
@@ -170,6 +421,8 @@ ConstructedString CharacterSet::ConstructString(const std::string& text, const s
 		return returnString;
 	}
 
+	returnString.glyphs.reserve(text.size());
+
 	unsigned int totalWidth = 0;
 
 	CharacterBlock characterBlock;
@@ -186,22 +439,22 @@ ConstructedString CharacterSet::ConstructString(const std::string& text, const s
 		if(separators.find(static_cast<unsigned char>(character->id)) != separators.npos)
 		{
 			//Emplace current block
-			returnString.characterBlocks.emplace_back(std::move(characterBlock));
+			returnString.characterBlocks.emplace_back(characterBlock);
 
 			//Emplace block with separator if they should be kept
 			if(keepSeparators)
 			{
+				characterBlock.glyphOffset = static_cast<unsigned int>(returnString.glyphs.size());
 				characterBlock.width = static_cast<unsigned int>(character->xAdvance);
 				totalWidth = static_cast<unsigned int>(character->xAdvance);
-				characterBlock.characters.clear();
-				characterBlock.characters.emplace_back(character);
+				returnString.glyphs.emplace_back(character);
 				characterBlock.length = 1;
 				length++;
 
-				returnString.characterBlocks.emplace_back(std::move(characterBlock));
+				returnString.characterBlocks.emplace_back(characterBlock);
 			}
 
-			characterBlock.characters.clear();
+			characterBlock.glyphOffset = static_cast<unsigned int>(returnString.glyphs.size());
 			characterBlock.width = 0;
 			characterBlock.length = 0;
 			totalWidth += character->xAdvance;
@@ -211,7 +464,7 @@ ConstructedString CharacterSet::ConstructString(const std::string& text, const s
 		{
 			characterBlock.width += character->xAdvance;
 			totalWidth += character->xAdvance;
-			characterBlock.characters.emplace_back(character);
+			returnString.glyphs.emplace_back(character);
 			characterBlock.length++;
 			length++;
 		}
@@ -228,11 +481,7 @@ ConstructedString CharacterSet::ConstructString(const std::string& text, const s
 
 void CharacterSet::Insert(ConstructedString& constructedString, unsigned int index, const std::string& string) const
 {
-	//Turns out, just constructing a new string is ~1000 times faster than doing elaborate inserting/erasing.
-	std::string text = constructedString.text;
-	text.insert(index, string);
-
-	constructedString = ConstructString(text);
+	Splice(constructedString, index, 0, string);
 }
 
 void CharacterSet::Insert(ConstructedString& constructedString, int index, unsigned int character) const
@@ -240,26 +489,180 @@ void CharacterSet::Insert(ConstructedString& constructedString, int index, unsig
 	if(character > static_cast<unsigned int>(std::numeric_limits<char>::max()))
 		character = '?';
 
-	std::string text = constructedString.text;
-	text.insert(static_cast<unsigned long>(index), 1, static_cast<char>(character));
-
-	constructedString = ConstructString(text);
+	Splice(constructedString, static_cast<unsigned int>(index), 0, std::string(1, static_cast<char>(character)));
 }
 
 void CharacterSet::Erase(ConstructedString& constructedString, unsigned int startIndex, unsigned int count) const
 {
-	std::string text = constructedString.text;
-	text.erase(startIndex, count);
-
-	constructedString = ConstructString(text);
+	Splice(constructedString, startIndex, count, "");
 }
 
 void CharacterSet::Replace(ConstructedString& constructedString, unsigned int begin, unsigned int end, const std::string& newText) const
 {
-	std::string text = constructedString.text;
-	text.replace(begin, end, text);
+	if(end < begin)
+		end = begin;
+
+	Splice(constructedString, begin, end - begin, newText);
+}
+
+void CharacterSet::ClearLayoutCache()
+{
+	std::lock_guard<std::mutex> lock(layoutCacheMutex);
 
-	constructedString = ConstructString(text);
+	layoutCache.clear();
+	layoutCacheMap.clear();
+}
+
+ConstructedString CharacterSet::LayoutString(const std::string& text) const
+{
+	ConstructedString returnString;
+
+	returnString.glyphs.reserve(text.size());
+	returnString.width = LayoutWords(text.data(), text.size(), returnString.characterBlocks, returnString.glyphs);
+	returnString.text = text;
+	returnString.length = static_cast<unsigned int>(text.size());
+
+	return returnString;
+}
+
+unsigned int CharacterSet::LayoutWords(const char* text, size_t length, std::vector<CharacterBlock>& outBlocks, std::vector<const Character*>& outGlyphs) const
+{
+	//Split each word (and the trailing blankspace) into a character block
+	//If the string is something like "abc            def" split it into "abc" and " ... def" (ignoring a single space after abc)
+	//A space is always presumed to be after a CharacterBlock when drawing.
+	//This means a block ends exactly where a space follows a non-space, which is what lets Splice re-layout single words
+	bool splitAtSpace = false;
+
+	unsigned int totalWidth = 0;
+
+	CharacterBlock characterBlock(static_cast<unsigned int>(outGlyphs.size()), 0, 0);
+
+	for(size_t i = 0; i < length; ++i)
+	{
+		const Character* character = GetCharacter(static_cast<unsigned int>(text[i]));
+
+		if(character->id == SPACE_CHARACTER && splitAtSpace)
+		{
+			splitAtSpace = false;
+
+			outBlocks.emplace_back(characterBlock);
+
+			characterBlock = CharacterBlock(static_cast<unsigned int>(outGlyphs.size()), 0, 0);
+			totalWidth += spaceXAdvance; //A space is always presumed to be after a character block so include it in the total width
+		}
+		else
+		{
+			if(character->id != SPACE_CHARACTER)
+				splitAtSpace = true;
+
+			characterBlock.width += character->xAdvance;
+			totalWidth += character->xAdvance;
+			outGlyphs.emplace_back(character);
+			characterBlock.length++;
+		}
+	}
+
+	outBlocks.emplace_back(characterBlock);
+
+	return totalWidth;
+}
+
+void CharacterSet::Splice(ConstructedString& constructedString, unsigned int index, unsigned int eraseCount, const std::string& insertText) const
+{
+	std::string& text = constructedString.text;
+
+	unsigned int textSize = static_cast<unsigned int>(text.size());
+
+	if(index > textSize)
+		index = textSize;
+	if(eraseCount > textSize - index)
+		eraseCount = textSize - index;
+
+	std::vector<CharacterBlock>& blocks = constructedString.characterBlocks;
+
+	//Find the first and last block touched by [index, index + eraseCount]. Blocks are separated by exactly one space
+	unsigned int eraseEnd = index + eraseCount;
+
+	size_t firstBlock = blocks.size();
+	size_t lastBlock = blocks.size();
+	unsigned int firstBlockBegin = 0;
+	unsigned int lastBlockEnd = 0;
+
+	unsigned int blockBegin = 0;
+	for(size_t i = 0; i < blocks.size(); ++i)
+	{
+		unsigned int blockEnd = blockBegin + blocks[i].length;
+
+		if(firstBlock == blocks.size()
+			&& blockEnd >= index)
+		{
+			firstBlock = i;
+			firstBlockBegin = blockBegin;
+		}
+
+		if(lastBlock == blocks.size()
+			&& (blockEnd > eraseEnd || i == blocks.size() - 1))
+		{
+			lastBlock = i;
+			lastBlockEnd = blockEnd;
+		}
+
+		blockBegin = blockEnd + 1;
+	}
+
+	//Strings built with separators (or not built at all) don't follow the word layout, so build them from scratch
+	if(blocks.empty()
+		|| blockBegin != textSize + 1
+		|| firstBlock > lastBlock
+		|| constructedString.glyphs.size() != blocks.back().glyphOffset + blocks.back().length)
+	{
+		std::string newText = text;
+		newText.replace(index, eraseCount, insertText);
+
+		constructedString = LayoutString(newText);
+		return;
+	}
+
+	//Re-layout the touched words only
+	std::string region;
+	region.reserve(lastBlockEnd - firstBlockBegin - eraseCount + insertText.size());
+	region.append(text, firstBlockBegin, index - firstBlockBegin);
+	region.append(insertText);
+	region.append(text, eraseEnd, lastBlockEnd - eraseEnd);
+
+	std::vector<CharacterBlock> newBlocks;
+	std::vector<const Character*> newGlyphs;
+	newGlyphs.reserve(region.size());
+
+	unsigned int newWidth = LayoutWords(region.data(), region.size(), newBlocks, newGlyphs);
+
+	unsigned int oldWidth = static_cast<unsigned int>(lastBlock - firstBlock) * spaceXAdvance;
+	for(size_t i = firstBlock; i <= lastBlock; ++i)
+		oldWidth += blocks[i].width;
+
+	//Swap the glyphs in place and shift the offsets of every block after the edit
+	unsigned int glyphBegin = blocks[firstBlock].glyphOffset;
+	unsigned int glyphEnd = blocks[lastBlock].glyphOffset + blocks[lastBlock].length;
+
+	std::vector<const Character*>& glyphs = constructedString.glyphs;
+	glyphs.erase(glyphs.begin() + glyphBegin, glyphs.begin() + glyphEnd);
+	glyphs.insert(glyphs.begin() + glyphBegin, newGlyphs.begin(), newGlyphs.end());
+
+	int glyphDelta = static_cast<int>(newGlyphs.size()) - static_cast<int>(glyphEnd - glyphBegin);
+
+	for(CharacterBlock& block : newBlocks)
+		block.glyphOffset += glyphBegin;
+
+	for(size_t i = lastBlock + 1; i < blocks.size(); ++i)
+		blocks[i].glyphOffset = static_cast<unsigned int>(static_cast<int>(blocks[i].glyphOffset) + glyphDelta);
+
+	blocks.erase(blocks.begin() + firstBlock, blocks.begin() + lastBlock + 1);
+	blocks.insert(blocks.begin() + firstBlock, newBlocks.begin(), newBlocks.end());
+
+	text.replace(index, eraseCount, insertText);
+
+	constructedString.width = constructedString.width - oldWidth + newWidth;
+	constructedString.length = static_cast<unsigned int>(text.size());
 }
 
 Texture2D* CharacterSet::GetTexture() const
@@ -267,25 +670,88 @@ Texture2D* CharacterSet::GetTexture() const
 	return texture;
 }
 
+size_t CharacterSet::GetCPUSize() const
+{
+	return sizeof(CharacterSet)
+		+ name.capacity()
+		+ glyphs.capacity() * sizeof(Character)
+		+ glyphTable.GetCPUSize()
+		+ kerningPairs.capacity() * sizeof(KerningPair)
+		+ GetLayoutCacheSize();
+}
+
+size_t CharacterSet::GetGPUSize() const
+{
+	return 0; //The texture is its own content
+}
+
 bool CharacterSet::Load(const std::string& path, ID3D11Device* device, ContentManager* contentManager /*= nullptr*/, ContentParameters* contentParameters /*= nullptr*/)
 {
-	characters.clear();
+	if(!LoadAsync(path, contentManager, contentParameters))
+		return false;
+
+	return FinalizeAsync(path, device, contentManager, contentParameters);
+}
+
+bool CharacterSet::FinalizeAsync(const std::string& path, ID3D11Device* device, ContentManager* contentManager, ContentParameters* contentParameters)
+{
+	texture = contentManager->Load<Texture2D>(path + ".dds");
+
+	return true;
+}
+
+bool CharacterSet::LoadAsync(const std::string& path, ContentManager* contentManager, ContentParameters* contentParameters)
+{
+	//Cached layouts point at the old glyphs
+	ClearLayoutCache();
+
+	glyphs.clear();
+	glyphTable.Clear();
+	kerningPairs.clear();
+	errorCharacter = nullptr;
 
 	this->name = path;
 
-	XMLFile xmlFile;
-	xmlFile.Open(path + ".fnt");
-	xmlFile.Parse(std::bind(&CharacterSet::XMLSubscriber, this, std::placeholders::_1));
+	//Start reading the texture while the .fnt is being parsed
+	contentManager->Prefetch<Texture2D>(path + ".dds");
 
-	texture = contentManager->Load<Texture2D>(path + ".dds");
+	std::string sourcePath = path + ".fnt";
+	std::string cachePath = path + ".fntcache";
+
+	long long sourceSize = -1;
+	long long sourceWriteTime = 0;
 
-	if(characters.size() > 0)
+	struct _stat64 sourceStat;
+	if(_stat64(sourcePath.c_str(), &sourceStat) == 0)
 	{
-		characters.insert(std::pair<unsigned short, Character>('\n', Character('\n', 0, 0, 0, fontSize + lineHeight, 0, 0, 0)));
+		sourceSize = static_cast<long long>(sourceStat.st_size);
+		sourceWriteTime = static_cast<long long>(sourceStat.st_mtime);
+	}
 
-		//If the user expects to use spaces it is expected to be in the .xml-file
-		spaceXAdvance = static_cast<unsigned int>(GetCharacter(SPACE_CHARACTER)->xAdvance);
+	if(!ReadCache(cachePath, sourceSize, sourceWriteTime))
+	{
+		glyphs.clear();
+		kerningPairs.clear();
+
+		XMLReader xmlReader;
+		if(!xmlReader.Open(sourcePath)
+			|| !xmlReader.Parse(std::bind(&CharacterSet::XMLSubscriber, this, std::placeholders::_1)))
+			return false;
+
+		if(!glyphs.empty())
+			glyphs.emplace_back('\n', 0, 0, 0, fontSize + lineHeight, 0, 0, 0);
+
+		BuildGlyphTables();
+
+		if(!glyphs.empty())
+			WriteCache(cachePath, sourceSize, sourceWriteTime);
 	}
+	else
+		BuildGlyphTables();
+
+	//If the user expects to use spaces it is expected to be in the .xml-file
+	if(!glyphs.empty())
+		spaceXAdvance = static_cast<unsigned int>(GetCharacter(SPACE_CHARACTER)->xAdvance);
 
 	return true;
 }
@@ -311,7 +777,7 @@ unsigned int CharacterSet::GetWidthAtMaxWidth(const ConstructedString& string, u
 		{
 			short characterXAdvance;
 
-			for(const Character* character : block.characters)
+			for(const Character* character : string.GetGlyphs(block))
 			{
 				characterXAdvance = character->xAdvance;
 
@@ -338,13 +804,15 @@ unsigned int CharacterSet::GetWidthAtIndex(const ConstructedString& constructedS
 
 	for(const CharacterBlock& block : constructedString.characterBlocks)
 	{
-		unsigned int blockSize = static_cast<unsigned int>(block.characters.size());
+		unsigned int blockSize = block.length;
 
 		//Is the index inside the current block?
 		if(currentIndex + blockSize > index)
 		{
+			GlyphRange blockGlyphs = constructedString.GetGlyphs(block);
+
 			for(unsigned int i = 0; i < index - currentIndex; i++)
-				currentWidth += block.characters[i]->xAdvance;
+				currentWidth += blockGlyphs[i]->xAdvance;
 
 			return currentWidth;
 		}
@@ -406,11 +874,11 @@ unsigned int CharacterSet::GetIndexAtWidth(const ConstructedString& constructedS
 		if(currentWidth + static_cast<unsigned int>(characterBlock.width) < width)
 		{
 			currentWidth += characterBlock.width;
-			currentIndex += static_cast<unsigned int>(characterBlock.characters.size());
+			currentIndex += characterBlock.length;
 		}
 		else
 		{
-			for(const Character* character : characterBlock.characters)
+			for(const Character* character : constructedString.GetGlyphs(characterBlock))
 			{
 				if(currentWidth + character->xAdvance <= width)
 				{
@@ -462,7 +930,7 @@ unsigned int CharacterSet::GetRowsAtWidth(const ConstructedString& constructedSt
 			{
 				//Block needs to be split into several lines
 
-				for(const Character* character : block.characters)
+				for(const Character* character : constructedString.GetGlyphs(block))
 				{
 					if(currentWidth + character->xAdvance < width)
 						currentWidth += character->xAdvance;
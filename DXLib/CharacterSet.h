@@ -2,13 +2,18 @@
 #define CharacterSet_h__
 
 #include "character.h"
+#include "GlyphTable.h"
 
+#include <vector>
+#include <list>
 #include <unordered_map>
+#include <mutex>
+#include <cstdint>
 
 #include "constructedString.h"
 #include "texture2D.h"
 #include "content.h"
-#include "xmlFile.h"
+#include "xmlReader.h"
 #include "contentManager.h"
 
 class CharacterSet : public Content
@@ -27,11 +32,55 @@ public:
 	unsigned int GetFontSize() const;
 	Texture2D* GetTexture() const;
 
+	size_t GetCPUSize() const override;
+	size_t GetGPUSize() const override;
+
 	int GetSpaceXAdvance() const;
 
+	//************************************
+	// Method:		GetCharacter
+	// FullName:	CharacterSet::GetCharacter
+	// Access:		public 
+	// Returns:		const Character* - the error character if id doesn't exist. Stays valid until the set is unloaded
+	// Qualifier:	const
+	// Argument:	unsigned int id
+	// Description:	\see GlyphTable::Find
+	//************************************
 	const Character* GetCharacter(unsigned int id) const;
+	//************************************
+	// Method:		GetKerningOffset
+	// FullName:	CharacterSet::GetKerningOffset
+	// Access:		public 
+	// Returns:		int - how much to move second when it's placed after first, 0 if there's no kerning pair
+	// Qualifier:	const
+	// Argument:	unsigned int first
+	// Argument:	unsigned int second
+	//************************************
+	int GetKerningOffset(unsigned int first, unsigned int second) const;
 
+	//************************************
+	// Method:		ConstructString
+	// FullName:	CharacterSet::ConstructString
+	// Access:		public 
+	// Returns:		ConstructedString
+	// Qualifier:	const
+	// Argument:	const std::string& text
+	// Description:	Splits text into words. Recently constructed strings are kept in an LRU cache
+	// so redrawing the same text every frame doesn't look up every character again
+	//************************************
 	ConstructedString ConstructString(const std::string& text) const;
+	//************************************
+	// Method:		ConstructString
+	// FullName:	CharacterSet::ConstructString
+	// Access:		public 
+	// Returns:		void
+	// Qualifier:	const
+	// Argument:	const std::string& text - may be outString.text
+	// Argument:	ConstructedString& outString
+	// Description:	Same as above, but copies into outString's existing buffers. Keep one around to
+	// construct strings without allocating whenever the layout is cached
+	//************************************
+	void ConstructString(const std::string& text, ConstructedString& outString) const;
 	ConstructedString ConstructString(const std::string& text, const std::string& separators, const bool keepSeparators) const;
 	//************************************
 	// Method:		InsertCharacter
@@ -42,16 +91,18 @@ public:
 	// Argument:	ConstructedString& constructedString
 	// Argument:	int index
 	// Argument:	unsigned int character
-	// Description:	Inserts character at the index into constructedString
+	// Description:	Inserts character at the index into constructedString. Only the words around index are laid out again
 	//************************************
     void Insert(ConstructedString& constructedString, unsigned int index, const std::string& string) const;
 	void Insert(ConstructedString& constructedString, int index, unsigned int character) const;
 
 	void Erase(ConstructedString& constructedString, unsigned int startIndex, unsigned int count) const;
 
-	//Replaces a character block
+	//Replaces the characters in [begin, end) with newText
 	void Replace(ConstructedString& constructedString, unsigned int begin, unsigned int end, const std::string& newText) const;
 
+	void ClearLayoutCache();
+
 	//************************************
 	// Method:		GetLineHeight
 	// FullName:	CharacterSet::GetLineHeight
@@ -109,14 +160,92 @@ public:
 private:
     const unsigned int errorCharacterID = 0x3F; //0x3F = "?"
 
-	void XMLSubscriber(const XMLElement& element);
-	//char GetKerningOffset(char first, char second) const; //TODO: Save kerning pairs in this class
+	const static size_t LAYOUT_CACHE_SIZE = 256;
+	const static size_t MAX_CACHED_LAYOUT_LENGTH = 256;
+
+	struct KerningPair
+	{
+		unsigned int first;
+		unsigned int second;
+		int amount;
+	};
+
+	struct LayoutCacheEntry
+	{
+		size_t hash;
+		ConstructedString layout;
+	};
+
+	void XMLSubscriber(const XMLElementView& element);
+
+	//************************************
+	// Method:		BuildGlyphTables
+	// FullName:	CharacterSet::BuildGlyphTables
+	// Access:		private 
+	// Returns:		void
+	// Qualifier:
+	// Description:	Sorts glyphs and kerningPairs and builds the flat lookup table. glyphs mustn't be resized after this
+	// since ConstructedStrings point into it
+	//************************************
+	void BuildGlyphTables();
+
+	//************************************
+	// Method:		ReadCache
+	// FullName:	CharacterSet::ReadCache
+	// Access:		private 
+	// Returns:		bool - false if there is no cache or if it's outdated or broken
+	// Qualifier:
+	// Argument:	const std::string& cachePath
+	// Argument:	long long sourceSize - size of the .fnt-file, or -1 if it doesn't exist
+	// Argument:	long long sourceWriteTime - last write time of the .fnt-file
+	//************************************
+	bool ReadCache(const std::string& cachePath, long long sourceSize, long long sourceWriteTime);
+	void WriteCache(const std::string& cachePath, long long sourceSize, long long sourceWriteTime) const;
+
+	ConstructedString LayoutString(const std::string& text) const;
+	//************************************
+	// Method:		LayoutWords
+	// FullName:	CharacterSet::LayoutWords
+	// Access:		private 
+	// Returns:		unsigned int - total width, including the spaces between blocks
+	// Qualifier:	const
+	// Argument:	const char* text
+	// Argument:	size_t length
+	// Argument:	std::vector<CharacterBlock>& outBlocks - blocks are appended, their offsets start at outGlyphs.size()
+	// Argument:	std::vector<const Character*>& outGlyphs
+	//************************************
+	unsigned int LayoutWords(const char* text, size_t length, std::vector<CharacterBlock>& outBlocks, std::vector<const Character*>& outGlyphs) const;
+	//************************************
+	// Method:		Splice
+	// FullName:	CharacterSet::Splice
+	// Access:		private 
+	// Returns:		void
+	// Qualifier:	const
+	// Argument:	ConstructedString& constructedString
+	// Argument:	unsigned int index
+	// Argument:	unsigned int eraseCount
+	// Argument:	const std::string& insertText
+	// Description:	Replaces eraseCount characters at index with insertText and lays out the words that were touched
+	//************************************
+	void Splice(ConstructedString& constructedString, unsigned int index, unsigned int eraseCount, const std::string& insertText) const;
+
+	size_t GetLayoutCacheSize() const;
 
     bool Load(const std::string& path, ID3D11Device* device, ContentManager* contentManager = nullptr, ContentParameters* contentParameters = nullptr) override;
     void Unload(ContentManager* contentManager = nullptr) override;
 
+	bool LoadAsync(const std::string& path, ContentManager* contentManager, ContentParameters* contentParameters) override;
+	bool FinalizeAsync(const std::string& path, ID3D11Device* device, ContentManager* contentManager, ContentParameters* contentParameters) override;
+
 	std::string name;
-	std::unordered_map<unsigned int, Character> characters;
+	std::vector<Character> glyphs; //Sorted by id
+	GlyphTable glyphTable;
+	std::vector<KerningPair> kerningPairs; //Sorted by first, then second
+	const Character* errorCharacter;
+
+	mutable std::list<LayoutCacheEntry> layoutCache; //Most recently used first
+	mutable std::unordered_map<size_t, std::list<LayoutCacheEntry>::iterator> layoutCacheMap;
+	mutable std::mutex layoutCacheMutex;
 
 	unsigned int fontSize;
 	unsigned int lineHeight;
@@ -2,13 +2,20 @@
 
 #include "Logger.h"
 
+#include <algorithm>
+#include <cmath>
+
 CinematicCamera::CinematicCamera()
-	: totalTime(0.0f)
+	: paused(false)
+	, distance(0.0)
 	, loop(false)
 	, lookMode(LOOK_MODE::NONE)
 	, lookAtTarget(0.0f, 0.0f, 0.0f)
 	, currentLookAtTarget(&lookAtTarget)
 	, moveTargetTime(25.0f)
+	, fixedTimeStep(0.0f)
+	, arcLengthStep(0.0f)
+	, pathLength(0.0f)
 {}
 
 CinematicCamera::~CinematicCamera()
@@ -26,23 +33,25 @@ void CinematicCamera::Update(std::chrono::nanoseconds delta)
 	if(paused)
 		return;
 
-	float deltaMS = delta.count() * 1e-6f;
+	float deltaMS = fixedTimeStep > 0.0f ? fixedTimeStep : delta.count() * 1e-6f;
 	Look(deltaMS);
 
-	if(totalTime * 0.001f >= keyFrames.size())
+	if(segments.empty())
+		return;
+
+	if(distance >= pathLength)
 	{
 		if(!loop)
 			return;
 
-		float max = static_cast<float>(keyFrames.size()) * 1000.0f;
-		totalTime = std::fmod(max + std::fmod(totalTime, max), max);
+		distance = pathLength > 0.0f ? std::fmod(distance, static_cast<double>(pathLength)) : 0.0;
 	}
-		
-	SetPosition(CalcCubicBezier(totalTime));
+	else if(distance < 0.0)
+		distance = 0.0;
 
-	float derivate = CalcCubicBezierDerivate(totalTime);
+	SetPosition(CalcCubicBezier(CalcParameter(distance)));
 
-	totalTime += moveTargetTime / derivate * deltaMS;
+	distance += static_cast<double>(moveTargetTime) * deltaMS * 0.001;
 }
 
 void CinematicCamera::LookAt(DirectX::XMFLOAT3 position)
@@ -89,7 +98,7 @@ void CinematicCamera::LookAtSlerp(DirectX::XMFLOAT3* position, float slerpTarget
 
 void CinematicCamera::AddKeyFrame(CameraKeyFrame frame)
 {
-
+	AddFrame(static_cast<int>(keyFrames.size()), frame);
 }
 
 void CinematicCamera::Look(float deltaMS)
@@ -116,60 +125,32 @@ void CinematicCamera::Look(float deltaMS)
 	}
 }
 
-DirectX::XMFLOAT3 CinematicCamera::CalcCubicBezier(float timeMS)
+DirectX::XMFLOAT3 CinematicCamera::CalcCubicBezier(float parameter) const
 {
-	auto currentFrame = GetCurrentFrame(timeMS);
-	auto nextFrame = GetNextFrame(timeMS);
+	int index = std::min(static_cast<int>(parameter), static_cast<int>(segments.size()) - 1);
+	float lambda = parameter - index;
 
-	float lambda = std::fmod(timeMS, 1000.0f) * 0.001f;
+	const BezierSegment& segment = segments[index];
 
-	auto currPos = DirectX::XMLoadFloat3(&currentFrame.position);
-	auto nextPos = DirectX::XMLoadFloat3(&nextFrame.position);
+	auto cubic = DirectX::XMLoadFloat3(&segment.cubic);
+	auto quadratic = DirectX::XMLoadFloat3(&segment.quadratic);
+	auto linear = DirectX::XMLoadFloat3(&segment.linear);
+	auto constant = DirectX::XMLoadFloat3(&segment.constant);
 
-	auto begHand = DirectX::XMLoadFloat3(&currentFrame.beginHandle);
-	auto endHand = DirectX::XMLoadFloat3(&nextFrame.endHandle);
-
-	auto cubicAddend = (lambda * lambda * lambda) * (-currPos + 3.0f * begHand - 3.0f * endHand + nextPos);
-	auto quadraticAddend = (lambda * lambda) * (3.0f * currPos - 6.0f * begHand + 3.0f * endHand);
-	auto linearAddend = lambda * (-3.0f * currPos + 3.0f * begHand);
-
-	return DirectX::XMStoreFloat3(cubicAddend + quadraticAddend + linearAddend + currPos);
+	return DirectX::XMStoreFloat3(((cubic * lambda + quadratic) * lambda + linear) * lambda + constant);
 }
 
-float CinematicCamera::CalcCubicBezierDerivate(float timeMS)
+float CinematicCamera::CalcParameter(double distance) const
 {
-	auto currentFrame = GetCurrentFrame(timeMS);
-	auto nextFrame = GetNextFrame(timeMS);
-
-	float lambda = std::fmod(timeMS, 1000.0f) * 0.001f;
-
-	auto a = DirectX::XMLoadFloat3(&currentFrame.position);
-	auto d = DirectX::XMLoadFloat3(&nextFrame.position);
+	if(arcLengthStep <= 0.0f)
+		return 0.0f;
 
-	auto b = DirectX::XMLoadFloat3(&currentFrame.beginHandle);
-	auto c = DirectX::XMLoadFloat3(&nextFrame.endHandle);
+	double tableIndex = distance / arcLengthStep;
 
-	auto quadraticAddend = (lambda * lambda) * (-3.0f * a + 9.0f * b - 9.0f * c + 3.0f * d);
-	auto linearAddend = lambda * (6.0f * a - 12.0f * b + 6.0f * c);
+	int index = std::min(static_cast<int>(tableIndex), static_cast<int>(arcLengthTable.size()) - 2);
+	float lerpAmount = std::min(static_cast<float>(tableIndex - index), 1.0f);
 
-	return DirectX::XMVectorGetX(DirectX::XMVector3Length(quadraticAddend + linearAddend + (-3.0f * a+ 3.0f * b)));
-}
-
-CameraKeyFrame CinematicCamera::GetCurrentFrame(float timeMS) const
-{
-	int index = std::floorf(timeMS * 0.001f);
-
-	return keyFrames[index];
-}
-
-CameraKeyFrame CinematicCamera::GetNextFrame(float timeMS) const
-{
-	int index = std::floorf(timeMS * 0.001f);
-
-	if(index < static_cast<int>(keyFrames.size()) - 1)
-		return keyFrames[index + 1];
-	else
-		return keyFrames.front();
+	return arcLengthTable[index] + (arcLengthTable[index + 1] - arcLengthTable[index]) * lerpAmount;
 }
 
 void CinematicCamera::SetKeyFrames(std::vector<CameraKeyFrame> keyFrames)
@@ -177,6 +158,7 @@ void CinematicCamera::SetKeyFrames(std::vector<CameraKeyFrame> keyFrames)
 	this->keyFrames = keyFrames;
 
 	CalcHandles();
+	BuildArcLengthTable();
 }
 
 void CinematicCamera::SetTargetSpeed(float targetSpeed)
@@ -189,9 +171,14 @@ void CinematicCamera::SetLoop(bool loop)
 	this->loop = loop;
 }
 
+void CinematicCamera::SetFixedTimeStep(float milliseconds)
+{
+	fixedTimeStep = milliseconds;
+}
+
 void CinematicCamera::Jump(float time)
 {
-	this->totalTime = time;
+	distance = static_cast<double>(moveTargetTime) * time * 0.001;
 }
 
 void CinematicCamera::Pause()
@@ -219,30 +206,53 @@ std::vector<CameraKeyFrame> CinematicCamera::GetFrames() const
 	return keyFrames;
 }
 
+float CinematicCamera::GetFixedTimeStep() const
+{
+	return fixedTimeStep;
+}
+
+float CinematicCamera::GetPathLength() const
+{
+	return pathLength;
+}
+
 void CinematicCamera::SetFrame(int index, CameraKeyFrame frame)
 {
+	if(index < 0
+		|| index >= static_cast<int>(keyFrames.size()))
+		return;
+
 	keyFrames[index] = frame;
+
 	CalcHandles();
+	BuildArcLengthTable();
 }
 
 void CinematicCamera::AddFrame(int index, CameraKeyFrame frame)
 {
-	if(index > keyFrames.size())
+	if(index < 0)
+		return;
+
+	//Anything past the end appends
+	if(index >= static_cast<int>(keyFrames.size()))
 		keyFrames.push_back(frame);
 	else
 		keyFrames.insert(keyFrames.begin() + index, frame);
 
 	CalcHandles();
+	BuildArcLengthTable();
 }
 
 bool CinematicCamera::RemoveFrame(int index)
 {
-	if(index > keyFrames.size()
-		||	keyFrames.size() == 0)
+	if(index < 0
+		|| index >= static_cast<int>(keyFrames.size()))
 		return false;
 
 	keyFrames.erase(keyFrames.begin() + index);
+
 	CalcHandles();
+	BuildArcLengthTable();
 
 	return true;
 }
@@ -279,3 +289,75 @@ void CinematicCamera::CalcHandles()
 	keyFrames.erase(keyFrames.end() - 1);
 	keyFrames.erase(keyFrames.begin());
 }
+
+void CinematicCamera::BuildArcLengthTable()
+{
+	segments.clear();
+	arcLengthTable.clear();
+	arcLengthStep = 0.0f;
+	pathLength = 0.0f;
+
+	if(keyFrames.empty())
+		return;
+
+	int segmentCount = static_cast<int>(keyFrames.size());
+
+	segments.resize(segmentCount);
+	for(int i = 0; i < segmentCount; ++i)
+	{
+		const CameraKeyFrame& currentFrame = keyFrames[i];
+		const CameraKeyFrame& nextFrame = keyFrames[(i + 1) % segmentCount];
+
+		auto a = DirectX::XMLoadFloat3(&currentFrame.position);
+		auto b = DirectX::XMLoadFloat3(&currentFrame.beginHandle);
+		auto c = DirectX::XMLoadFloat3(&nextFrame.endHandle);
+		auto d = DirectX::XMLoadFloat3(&nextFrame.position);
+
+		DirectX::XMStoreFloat3(&segments[i].cubic, -a + 3.0f * b - 3.0f * c + d);
+		DirectX::XMStoreFloat3(&segments[i].quadratic, 3.0f * a - 6.0f * b + 3.0f * c);
+		DirectX::XMStoreFloat3(&segments[i].linear, -3.0f * a + 3.0f * b);
+		DirectX::XMStoreFloat3(&segments[i].constant, a);
+	}
+
+	//Length along the path at evenly spaced parameters, measured with chords
+	int sampleCount = segmentCount * ARC_LENGTH_SAMPLES_PER_SEGMENT;
+
+	std::vector<double> lengths(sampleCount + 1);
+	lengths[0] = 0.0;
+
+	auto previousPosition = DirectX::XMLoadFloat3(&segments.front().constant);
+	for(int i = 1; i <= sampleCount; ++i)
+	{
+		DirectX::XMFLOAT3 position = CalcCubicBezier(static_cast<float>(i) / ARC_LENGTH_SAMPLES_PER_SEGMENT);
+		auto currentPosition = DirectX::XMLoadFloat3(&position);
+
+		lengths[i] = lengths[i - 1] + DirectX::XMVectorGetX(DirectX::XMVector3Length(currentPosition - previousPosition));
+		previousPosition = currentPosition;
+	}
+
+	pathLength = static_cast<float>(lengths.back());
+	if(pathLength <= 0.0f)
+		return;
+
+	//Invert the lengths so the parameter at any distance can be looked up directly
+	arcLengthStep = pathLength / sampleCount;
+	arcLengthTable.resize(sampleCount + 1);
+
+	int sample = 0;
+	for(int i = 0; i <= sampleCount; ++i)
+	{
+		double targetLength = static_cast<double>(i) * arcLengthStep;
+
+		while(sample < sampleCount - 1
+			  && lengths[sample + 1] < targetLength)
+			++sample;
+
+		double chordLength = lengths[sample + 1] - lengths[sample];
+		double lerpAmount = chordLength > 0.0 ? (targetLength - lengths[sample]) / chordLength : 0.0;
+		lerpAmount = std::max(0.0, std::min(lerpAmount, 1.0));
+
+		arcLengthTable[i] = static_cast<float>((sample + lerpAmount) / ARC_LENGTH_SAMPLES_PER_SEGMENT);
+	}
+
+	arcLengthTable.back() = static_cast<float>(segmentCount);
+}
@@ -52,8 +52,28 @@ public:
 	void AddKeyFrame(CameraKeyFrame frame);
 	void SetKeyFrames(std::vector<CameraKeyFrame> keyFrames);
 
+	//Speed in units per second along the path
 	void SetTargetSpeed(float targetSpeed);
 	void SetLoop(bool loop);
+	//************************************
+	// Method:		SetFixedTimeStep
+	// FullName:	CinematicCamera::SetFixedTimeStep
+	// Access:		public 
+	// Returns:		void
+	// Qualifier:
+	// Argument:	float milliseconds - time to advance each Update, 0 to use the delta given to Update
+	// Description:	With a fixed time step the camera is at the same pose after the same number of updates, regardless of frame rate
+	//************************************
+	void SetFixedTimeStep(float milliseconds);
+	//************************************
+	// Method:		Jump
+	// FullName:	CinematicCamera::Jump
+	// Access:		public 
+	// Returns:		void
+	// Qualifier:
+	// Argument:	float time - milliseconds of travel at the target speed
+	// Description:	Moves the camera to where it would be after travelling for time milliseconds from the first key frame
+	//************************************
 	void Jump(float time);
 
 	void Pause();
@@ -62,16 +82,32 @@ public:
 
 	DirectX::XMFLOAT3 GetPosition() const;
 	std::vector<CameraKeyFrame> GetFrames() const;
+	float GetFixedTimeStep() const;
+	float GetPathLength() const;
 
 	void SetFrame(int index, CameraKeyFrame frame);
 	void AddFrame(int index, CameraKeyFrame frame);
 	bool RemoveFrame(int index);
 
 private:
+	//Number of chords used to measure each segment, and number of arcLengthTable entries per segment
+	const static int ARC_LENGTH_SAMPLES_PER_SEGMENT = 256;
+
+	//Polynomial coefficients of the cubic bezier between two key frames
+	struct BezierSegment
+	{
+		DirectX::XMFLOAT3 cubic;
+		DirectX::XMFLOAT3 quadratic;
+		DirectX::XMFLOAT3 linear;
+		DirectX::XMFLOAT3 constant;
+	};
+
 	bool paused;
 
-	float totalTime;
+	//Distance travelled along the path
+	double distance;
 	float moveTargetTime;
+	float fixedTimeStep;
 
 	bool loop;
 
@@ -93,15 +129,23 @@ private:
 
 	std::vector<CameraKeyFrame> keyFrames;
 
-	void Look(float deltaMS);
+	//Segment i goes from keyFrames[i] to keyFrames[i + 1], the last one goes back to keyFrames.front()
+	std::vector<BezierSegment> segments;
+	//Curve parameter (segment index + lambda) at evenly spaced distances along the path,
+	//entry i is at distance i * arcLengthStep
+	std::vector<float> arcLengthTable;
+	float arcLengthStep;
+	float pathLength;
 
-	DirectX::XMFLOAT3 CalcCubicBezier(float timeMS);
-	float CalcCubicBezierDerivate(float timeMS);
+	void Look(float deltaMS);
 
-	CameraKeyFrame GetCurrentFrame(float timeMS) const;
-	CameraKeyFrame GetNextFrame(float timeMS) const;
+	//parameter is segment index + lambda
+	DirectX::XMFLOAT3 CalcCubicBezier(float parameter) const;
+	float CalcParameter(double distance) const;
 
 	void CalcHandles();
+	//Has to be called whenever keyFrames or their handles change
+	void BuildArcLengthTable();
 };
 
 #endif // CinematicCamera_h__
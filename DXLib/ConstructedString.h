@@ -6,6 +6,44 @@
 
 #include "characterBlock.h"
 
+//The glyphs of a single CharacterBlock. Only valid until the ConstructedString it came from is modified
+struct GlyphRange
+{
+	GlyphRange(const Character* const* first, const Character* const* last)
+		: first(first)
+		, last(last)
+	{};
+
+	const Character* const* begin() const
+	{
+		return first;
+	}
+
+	const Character* const* end() const
+	{
+		return last;
+	}
+
+	size_t size() const
+	{
+		return static_cast<size_t>(last - first);
+	}
+
+	bool empty() const
+	{
+		return first == last;
+	}
+
+	const Character* operator[](size_t index) const
+	{
+		return first[index];
+	}
+
+private:
+	const Character* const* first;
+	const Character* const* last;
+};
+
 struct ConstructedString
 {
 	ConstructedString() 
@@ -13,14 +51,23 @@ struct ConstructedString
 		, text("")
 		, length(0)
 	{};
-	ConstructedString(std::vector<CharacterBlock> characterBlocks, unsigned int width, std::string text, unsigned int length)
+	ConstructedString(std::vector<CharacterBlock> characterBlocks, std::vector<const Character*> glyphs, unsigned int width, std::string text, unsigned int length)
 		: characterBlocks(characterBlocks)
+		, glyphs(glyphs)
 		, width(width)
 		, text(text)
 		, length(length) {};
 	~ConstructedString() = default;
 
+	GlyphRange GetGlyphs(const CharacterBlock& block) const
+	{
+		const Character* const* first = glyphs.data() + block.glyphOffset;
+
+		return GlyphRange(first, first + block.length);
+	}
+
 	std::vector<CharacterBlock> characterBlocks;
+	std::vector<const Character*> glyphs; //Every block's glyphs, one after the other
 	unsigned int width;
 	std::string text;
 	unsigned int length;
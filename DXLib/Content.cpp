@@ -2,10 +2,21 @@
 
 Content::Content()
 	: path("")
+	, id()
 	, refCount(0)
 {
 }
 
 Content::~Content()
 {
+}
+
+bool Content::LoadAsync(const std::string& path, ContentManager* contentManager, ContentParameters* contentParameters)
+{
+	return true;
+}
+
+bool Content::FinalizeAsync(const std::string& path, ID3D11Device* device, ContentManager* contentManager, ContentParameters* contentParameters)
+{
+	return Load(path, device, contentManager, contentParameters);
 }
\ No newline at end of file
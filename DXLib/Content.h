@@ -6,6 +6,8 @@
 #include <string>
 
 #include "contentParameters.h"
+#include "contentPath.h"
+#include "contentID.h"
 
 #include <d3d11.h>
 
@@ -19,10 +21,34 @@ public:
 	//DO NOT USE FOR DEALLOCATION/REMOVAL! Use Unload() instead!
 	virtual ~Content();
 
-	virtual bool IsLoaded() const { return path.size() > 0; }
+	virtual bool IsLoaded() const { return !path.IsEmpty(); }
+
+	//Id this content was interned as when loaded through a ContentManager
+	ContentID GetID() const { return id; }
+
+	//************************************
+	// Method:		GetCPUSize
+	// FullName:	Content::GetCPUSize
+	// Access:		virtual public 
+	// Returns:		size_t
+	// Qualifier:	const
+	// Description:	Approximate number of bytes kept in system memory. Content loaded through the ContentManager
+	// (e.g. a CharacterSet's texture) reports its own size and shouldn't be counted here
+	//************************************
+	virtual size_t GetCPUSize() const = 0;
+	//************************************
+	// Method:		GetGPUSize
+	// FullName:	Content::GetGPUSize
+	// Access:		virtual public 
+	// Returns:		size_t
+	// Qualifier:	const
+	// Description:	Approximate number of bytes of device resources created by this content
+	//************************************
+	virtual size_t GetGPUSize() const = 0;
 
 private:
-	std::string path; //TODO: Use something else for faster hashing/access?
+	ContentPath path;
+	ContentID id;
 	int refCount; //If Unload is called and refCount == 0 it's safe to fully unload this content
 
 	//************************************
@@ -48,6 +74,34 @@ private:
 	// Description:	Unallocate/delete memory here. Called from ContentManager::Unload
 	//************************************
     virtual void Unload(ContentManager* contentManager = nullptr) = 0;
+
+	//************************************
+	// Method:		LoadAsync
+	// FullName:	Content::LoadAsync
+	// Access:		virtual private 
+	// Returns:		bool - whether or not the content was read successfully
+	// Qualifier:	
+	// Argument:	const std::string& path - path with extension e.g. "Path/To/Asset.filetype"
+	// Argument:	ContentManager* contentManager - only Prefetch may be called on it since this runs on a worker thread
+	// Argument:	ContentParameters* contentParameters - optional argument containing a subclass of contentParameters
+	// Description:	Called from a ContentManager worker thread. Do file I/O and decoding here, never touch the device.
+	// The default does nothing and leaves everything to FinalizeAsync
+	//************************************
+	virtual bool LoadAsync(const std::string& path, ContentManager* contentManager, ContentParameters* contentParameters);
+	//************************************
+	// Method:		FinalizeAsync
+	// FullName:	Content::FinalizeAsync
+	// Access:		virtual private 
+	// Returns:		bool - whether or not the content was loaded successfully
+	// Qualifier:	
+	// Argument:	const std::string& path - same path as was given to LoadAsync
+	// Argument:	ID3D11Device* device
+	// Argument:	ContentManager* contentManager
+	// Argument:	ContentParameters* contentParameters - optional argument containing a subclass of contentParameters
+	// Description:	Called on the thread that owns the ContentManager after LoadAsync has succeeded. Create device resources
+	// and resolve dependencies here. The default calls Load
+	//************************************
+	virtual bool FinalizeAsync(const std::string& path, ID3D11Device* device, ContentManager* contentManager, ContentParameters* contentParameters);
 };
 
 #endif // Content_h__
@@ -0,0 +1,69 @@
+#ifndef ContentID_h__
+#define ContentID_h__
+
+#include <cstdint>
+
+//Interned id of content loaded by a ContentManager.
+//The low 16 bits are an index into the manager's content slots and the high 16 bits are the generation of that slot.
+//The generation is bumped every time a slot is freed, so an id kept around after its content has been unloaded
+//won't resolve to whatever content reuses the slot. A slot whose generation can't be bumped any further is retired
+//instead of wrapping around, otherwise a stale id would match again after enough reuses
+struct ContentID
+{
+	static const uint32_t INDEX_BITS = 16;
+	static const uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1u;
+	static const uint32_t GENERATION_MASK = 0xFFFFu;
+	static const uint32_t INVALID_VALUE = 0xFFFFFFFFu;
+
+	ContentID()
+		: value(INVALID_VALUE)
+	{}
+	ContentID(uint32_t index, uint32_t generation)
+		: value((index & INDEX_MASK) | ((generation & GENERATION_MASK) << INDEX_BITS))
+	{}
+	~ContentID() = default;
+
+	uint32_t GetIndex() const
+	{
+		return value & INDEX_MASK;
+	}
+
+	uint32_t GetGeneration() const
+	{
+		return value >> INDEX_BITS;
+	}
+
+	bool IsValid() const
+	{
+		return value != INVALID_VALUE;
+	}
+
+	bool operator==(const ContentID& rhs) const
+	{
+		return value == rhs.value;
+	}
+
+	bool operator!=(const ContentID& rhs) const
+	{
+		return value != rhs.value;
+	}
+
+	uint32_t value;
+};
+
+//ContentID which remembers what type of content it refers to. ContentManager::Load and ContentManager::Get
+//return T* when given one of these, so there's no need to cast from Content*.
+//ContentManager::GetID checks the type, constructing one from a plain ContentID doesn't
+template<typename T>
+struct TypedContentID
+	: public ContentID
+{
+	TypedContentID()
+	{}
+	explicit TypedContentID(ContentID id)
+		: ContentID(id)
+	{}
+	~TypedContentID() = default;
+};
+
+#endif // ContentID_h__
\ No newline at end of file
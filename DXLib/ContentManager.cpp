@@ -1,83 +1,572 @@
 #include "contentManager.h"
 
 #include <string>
+#include <vector>
+#include <algorithm>
+#include <typeinfo>
 
 #include "logger.h"
 
 ContentManager::ContentManager()
+	: memoryBudget(DEFAULT_MEMORY_BUDGET)
+	, cpuMemoryUsage(0)
+	, gpuMemoryUsage(0)
+	, cachedMemoryUsage(0)
+	, overBudget(false)
+	, device(nullptr)
 {
 
 }
 
 ContentManager::~ContentManager()
 {
+	//Workers might still be reading into content that's about to be deleted
+	workers.Stop();
+
+	for(auto& pair : pendingMap)
+	{
+		delete pair.second->content;
+		pair.second->content = nullptr;
+	}
+
+	pendingMap.clear();
+
 	Unload();
 }
 
+void ContentManager::Init(ID3D11Device* device, unsigned int workerCount /*= 0*/)
+{
+	this->device = device;
+
+	workers.Init(workerCount);
+}
+
+Content* ContentManager::Request(const ContentPath& path, ContentParameters* contentParameters, const std::function<Content*()>& create, bool async, int references, std::shared_ptr<PendingContent>& pending)
+{
+	{
+		std::lock_guard<std::mutex> lock(contentMutex);
+
+		auto iter = contentMap.find(path);
+		if(iter != contentMap.end())
+		{
+			uint32_t index = iter->second.GetIndex();
+
+			if(references > 0)
+				Uncache(index);
+			else if(contentSlots[index].cached)
+				Cache(index); //Counts as a use, move it to the back
+
+			Content* content = contentSlots[index].content;
+			content->refCount += references;
+			return content;
+		}
+
+		auto pendingIter = pendingMap.find(path);
+		if(pendingIter != pendingMap.end())
+		{
+			pending = pendingIter->second;
+			pending->refCount += references;
+			return nullptr;
+		}
+
+		pending = std::make_shared<PendingContent>();
+		pending->path = path;
+		pending->content = create();
+		pending->contentParameters = contentParameters;
+		pending->refCount = references;
+
+		pendingMap.insert(std::make_pair(path, pending));
+	}
+
+	Content* content = pending->content;
+
+	if(async)
+		pending->loaded = workers.Enqueue([this, content, path, contentParameters]() { return content->LoadAsync(path.GetPath(), this, contentParameters); }).share();
+	else
+	{
+		//Nobody else has asked for this content, no reason to involve a worker
+		std::promise<bool> promise;
+		promise.set_value(content->LoadAsync(path.GetPath(), this, contentParameters));
+		pending->loaded = promise.get_future().share();
+	}
+
+	return nullptr;
+}
+
+Content* ContentManager::Finalize(const std::shared_ptr<PendingContent>& pending)
+{
+	if(pending->finalized)
+		return pending->succeeded ? pending->content : nullptr;
+
+	bool succeeded = pending->loaded.get();
+
+	//FinalizeAsync can load dependencies which might finalize this content through another handle
+	if(pending->finalized)
+		return pending->succeeded ? pending->content : nullptr;
+
+	if(succeeded)
+		succeeded = pending->content->FinalizeAsync(pending->path.GetPath(), device, this, pending->contentParameters);
+
+	{
+		std::lock_guard<std::mutex> lock(contentMutex);
+
+		pendingMap.erase(pending->path);
+
+		if(succeeded)
+		{
+			pending->content->path = pending->path;
+			pending->content->refCount = pending->refCount;
+
+			ContentID id = Intern(pending->path, pending->content);
+
+			//Only prefetched, nobody has asked for it yet
+			if(id.IsValid() && pending->refCount == 0)
+				Cache(id.GetIndex());
+		}
+	}
+
+	if(!succeeded)
+	{
+		Logger::LogLine(LOG_TYPE::WARNING, "Couldn't load content at \"" + pending->path.GetPath() + "\"");
+
+		delete pending->content;
+		pending->content = nullptr;
+	}
+
+	pending->finalized = true;
+	pending->succeeded = succeeded;
+
+	if(succeeded)
+		EnforceBudget();
+
+	Logger::FlushDeferred();
+
+	return pending->content;
+}
+
+Content* ContentManager::LoadFromParameters(Content* newContent, ContentParameters* contentParameters)
+{
+	if(newContent->Load("", device, this, contentParameters))
+	{
+		newContent->refCount = 1;
+
+		ContentCreationParameters* creationParameters = dynamic_cast<ContentCreationParameters*>(contentParameters);
+
+		if(creationParameters == nullptr)
+		{
+			Logger::LogLine(LOG_TYPE::FATAL, "Path is \"\" but couldn't cast contentParameters to ContentCreationParameters!");
+			delete newContent;
+			return nullptr;
+		}
+
+		if(creationParameters->uniqueID == "")
+		{
+			Logger::LogLine(LOG_TYPE::FATAL, "No uniqueID set for content without path!");
+			delete newContent;
+			return nullptr;
+		}
+
+		std::lock_guard<std::mutex> lock(contentMutex);
+		Intern(creationParameters->uniqueID, newContent);
+
+		return newContent;
+	}
+
+	delete newContent;
+	return nullptr;
+}
+
+void ContentManager::FinalizePending()
+{
+	std::vector<std::shared_ptr<PendingContent>> ready;
+
+	{
+		std::lock_guard<std::mutex> lock(contentMutex);
+
+		for(const auto& pair : pendingMap)
+			if(pair.second->loaded.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+				ready.push_back(pair.second);
+	}
+
+	for(const auto& pending : ready)
+		Finalize(pending);
+
+	Logger::FlushDeferred();
+}
+
+void ContentManager::WaitForPending()
+{
+	while(true)
+	{
+		std::vector<std::shared_ptr<PendingContent>> pending;
+
+		{
+			std::lock_guard<std::mutex> lock(contentMutex);
+
+			if(pendingMap.empty())
+				break;
+
+			for(const auto& pair : pendingMap)
+				pending.push_back(pair.second);
+		}
+
+		for(const auto& content : pending)
+			Finalize(content);
+	}
+
+	Logger::FlushDeferred();
+}
+
 void ContentManager::Unload()
 {
-	for(auto iter : contentMap)
+	//Take everything out of the slots first. Content unloading its own dependencies will then find nothing
+	//and leave them to this loop instead
+	std::vector<Content*> unloading;
+
 	{
-		if(iter.second->IsLoaded())
+		std::lock_guard<std::mutex> lock(contentMutex);
+
+		unloading.reserve(contentSlots.size());
+
+		for(uint32_t i = 0, end = static_cast<uint32_t>(contentSlots.size()); i < end; ++i)
 		{
-			iter.second->Unload(this);
-			iter.second->path = "";
+			if(contentSlots[i].content == nullptr)
+				continue;
+
+			unloading.push_back(contentSlots[i].content);
+
+			//Keep the generations so ids from before this call stay invalid
+			contentSlots[i].content = nullptr;
+			contentSlots[i].path = "";
+			contentSlots[i].cached = false;
+			FreeSlot(i);
 		}
+
+		contentMap.clear();
+		cachedSlots.clear();
+
+		cpuMemoryUsage = 0;
+		gpuMemoryUsage = 0;
+		cachedMemoryUsage = 0;
+		overBudget = false;
 	}
 
-	for(auto iter : contentMap)
+	for(Content* content : unloading)
 	{
-		delete iter.second;
-		iter.second = nullptr;
+		if(content->IsLoaded())
+		{
+			content->Unload(this);
+			content->path = "";
+		}
 	}
 
-	contentMap.clear();
+	for(Content* content : unloading)
+		delete content;
 }
 
-void ContentManager::Unload(const std::string& path)
+void ContentManager::Unload(const ContentPath& path)
 {
-	auto iter = contentMap.find(path);
-	if(iter->second == nullptr)
-		return; //Already unloaded
+	ContentID id;
 
-	if(!iter->second->IsLoaded())
-		return;
+	{
+		std::lock_guard<std::mutex> lock(contentMutex);
+
+		auto iter = contentMap.find(path);
+		if(iter != contentMap.end())
+			id = iter->second;
+	}
+
+	Unload(id);
+}
+
+void ContentManager::Unload(ContentID id)
+{
+	Content* content = nullptr;
 
-	if(iter == contentMap.end())
 	{
-		Logger::LogLine(LOG_TYPE::WARNING, "Trying to unload conten that has already been unloaded or hasn't been loaded at all");
+		std::lock_guard<std::mutex> lock(contentMutex);
+
+		content = Resolve(id);
+		if(content == nullptr)
+		{
+			Logger::LogLine(LOG_TYPE::WARNING, "Trying to unload conten that has already been unloaded or hasn't been loaded at all");
+			return;
+		}
+
+		if(!content->IsLoaded())
+			return;
+
+		content->refCount--;
+		if(content->refCount > 0)
+			return;
+
+		Cache(id.GetIndex());
+	}
+
+	EnforceBudget();
+}
+
+void ContentManager::Unload(Content* content)
+{
+	if(content == nullptr)
+		return;
+
+	if(content->path.IsEmpty()) //"Local" content, it's not in contentMap
 		return;
+
+	{
+		std::lock_guard<std::mutex> lock(contentMutex);
+
+		if(Resolve(content->id) != content)
+			return; //Already unloaded
+
+		content->refCount--;
+		if(content->refCount > 0)
+			return; //This content is used somewhere else
+
+		Cache(content->id.GetIndex());
+	}
+
+	EnforceBudget();
+}
+
+ContentID ContentManager::Intern(const ContentPath& path, Content* content)
+{
+	uint32_t index = 0;
+
+	if(!freeSlots.empty())
+	{
+		index = freeSlots.back();
+		freeSlots.pop_back();
+	}
+	else
+	{
+		if(contentSlots.size() >= ContentID::INDEX_MASK)
+		{
+			Logger::LogLine(LOG_TYPE::FATAL, "Out of content slots when loading \"" + path.GetPath() + "\"");
+			return ContentID();
+		}
+
+		index = static_cast<uint32_t>(contentSlots.size());
+		contentSlots.emplace_back();
 	}
 
-	iter->second->refCount--;
-	if(iter->second->refCount > 0)
+	ContentSlot& slot = contentSlots[index];
+	slot.content = content;
+	slot.path = path;
+	slot.cpuSize = content->GetCPUSize();
+	slot.gpuSize = content->GetGPUSize();
+	slot.cached = false;
+
+	cpuMemoryUsage += slot.cpuSize;
+	gpuMemoryUsage += slot.gpuSize;
+
+	ContentID id(index, slot.generation);
+	content->id = id;
+
+	contentMap.insert(std::make_pair(path, id));
+
+	return id;
+}
+
+void ContentManager::Release(ContentID id)
+{
+	uint32_t index = id.GetIndex();
+	ContentSlot& slot = contentSlots[index];
+
+	Uncache(index);
+
+	auto iter = contentMap.find(slot.path);
+	if(iter != contentMap.end()
+		&& iter->second == id)
+		contentMap.erase(iter);
+
+	cpuMemoryUsage -= slot.cpuSize;
+	gpuMemoryUsage -= slot.gpuSize;
+
+	slot.content->id = ContentID();
+	slot.content = nullptr;
+	slot.path = "";
+	slot.cpuSize = 0;
+	slot.gpuSize = 0;
+
+	FreeSlot(index);
+}
+
+void ContentManager::FreeSlot(uint32_t index)
+{
+	ContentSlot& slot = contentSlots[index];
+
+	//Wrapping around would make ids from the first generation valid again
+	if(slot.generation == ContentID::GENERATION_MASK)
 		return;
 
-	iter->second->Unload(this);
-	iter->second = nullptr;
-	delete iter->second;
+	++slot.generation;
+	freeSlots.push_back(index);
+}
 
-	contentMap.erase(iter->first);
+Content* ContentManager::Resolve(ContentID id) const
+{
+	if(!id.IsValid()
+		|| id.GetIndex() >= contentSlots.size())
+		return nullptr;
+
+	const ContentSlot& slot = contentSlots[id.GetIndex()];
+	if(slot.generation != id.GetGeneration())
+		return nullptr;
+
+	return slot.content;
 }
 
-void ContentManager::Unload(Content* content)
+Content* ContentManager::AddReference(ContentID id)
+{
+	std::lock_guard<std::mutex> lock(contentMutex);
+
+	Content* content = Resolve(id);
+	if(content == nullptr)
+	{
+		Logger::LogLine(LOG_TYPE::WARNING, "Trying to load content by an id that has been unloaded or was never loaded");
+		return nullptr;
+	}
+
+	Uncache(id.GetIndex());
+
+	content->refCount++;
+	return content;
+}
+
+void ContentManager::Cache(uint32_t index)
+{
+	ContentSlot& slot = contentSlots[index];
+
+	if(slot.cached)
+		cachedSlots.erase(slot.lruPosition);
+	else
+		cachedMemoryUsage += slot.cpuSize + slot.gpuSize;
+
+	slot.lruPosition = cachedSlots.insert(cachedSlots.end(), index);
+	slot.cached = true;
+}
+
+void ContentManager::Uncache(uint32_t index)
 {
-	std::string path = content->path;
+	ContentSlot& slot = contentSlots[index];
 
-	if(path == "") //"Local" content, it's not in contentMap
+	if(!slot.cached)
 		return;
 
-	auto iter = contentMap.find(path);
+	cachedSlots.erase(slot.lruPosition);
+	cachedMemoryUsage -= slot.cpuSize + slot.gpuSize;
+
+	slot.cached = false;
+}
+
+void ContentManager::EnforceBudget()
+{
+	while(true)
+	{
+		Content* content = nullptr;
+
+		{
+			std::lock_guard<std::mutex> lock(contentMutex);
+
+			if(cpuMemoryUsage + gpuMemoryUsage <= memoryBudget)
+			{
+				overBudget = false;
+				return;
+			}
+
+			if(cachedSlots.empty())
+			{
+				if(!overBudget)
+				{
+					Logger::LogLine(LOG_TYPE::WARNING, "Content uses " + std::to_string((cpuMemoryUsage + gpuMemoryUsage) / 1024) + " KiB which is more than the budget of " + std::to_string(memoryBudget / 1024) + " KiB, but all of it is in use");
+					overBudget = true;
+				}
+
+				return;
+			}
+
+			uint32_t index = cachedSlots.front();
+			content = contentSlots[index].content;
+
+			Release(ContentID(index, contentSlots[index].generation));
+		}
+
+		//Outside the lock since this might unload (and cache) dependencies
+		content->Unload(this);
+		delete content;
+	}
+}
+
+void ContentManager::SetMemoryBudget(size_t bytes)
+{
+	{
+		std::lock_guard<std::mutex> lock(contentMutex);
+		memoryBudget = bytes;
+	}
+
+	EnforceBudget();
+}
+
+size_t ContentManager::GetMemoryBudget() const
+{
+	std::lock_guard<std::mutex> lock(contentMutex);
+	return memoryBudget;
+}
+
+size_t ContentManager::GetCPUMemoryUsage() const
+{
+	std::lock_guard<std::mutex> lock(contentMutex);
+	return cpuMemoryUsage;
+}
 
-	if(iter->second == nullptr)
-		return; //Already unloaded
+size_t ContentManager::GetGPUMemoryUsage() const
+{
+	std::lock_guard<std::mutex> lock(contentMutex);
+	return gpuMemoryUsage;
+}
 
-	iter->second->refCount--;
-	if(iter->second->refCount > 0)
-		return; //This content is used somewhere else
+size_t ContentManager::GetCachedMemoryUsage() const
+{
+	std::lock_guard<std::mutex> lock(contentMutex);
+	return cachedMemoryUsage;
+}
 
-	iter->second->Unload(this);
-	delete contentMap[iter->first];
+std::vector<ContentMemoryUsage> ContentManager::GetMemoryUsage()
+{
+	std::vector<ContentMemoryUsage> usage;
 
-	contentMap.erase(path);
+	{
+		std::lock_guard<std::mutex> lock(contentMutex);
+
+		usage.reserve(contentSlots.size() - freeSlots.size());
+
+		for(const ContentSlot& slot : contentSlots)
+		{
+			if(slot.content == nullptr)
+				continue;
+
+			ContentMemoryUsage contentUsage;
+			contentUsage.path = slot.path.GetPath();
+			contentUsage.type = typeid(*slot.content).name();
+			contentUsage.cpuSize = slot.cpuSize;
+			contentUsage.gpuSize = slot.gpuSize;
+			contentUsage.refCount = slot.content->refCount;
+
+			usage.push_back(std::move(contentUsage));
+		}
+	}
+
+	std::sort(usage.begin(), usage.end(), [](const ContentMemoryUsage& lhs, const ContentMemoryUsage& rhs)
+	{
+		return lhs.cpuSize + lhs.gpuSize > rhs.cpuSize + rhs.gpuSize;
+	});
+
+	return usage;
+}
+
+ThreadPool& ContentManager::GetThreadPool()
+{
+	return workers;
 }
\ No newline at end of file
@@ -6,11 +6,65 @@
 #include "content.h"
 #include "contentParameters.h"
 #include "contentCreationParameters.h"
+#include "contentPath.h"
+#include "contentID.h"
+#include "threadPool.h"
 
 #include <unordered_map>
+#include <vector>
+#include <list>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <typeinfo>
 
 #include "logger.h"
 
+//Bookkeeping for content whose LoadAsync has been started but which hasn't been finalized yet
+struct PendingContent
+{
+	PendingContent()
+		: content(nullptr)
+		, contentParameters(nullptr)
+		, refCount(0)
+		, finalized(false)
+		, succeeded(false)
+	{}
+
+	ContentPath path;
+	Content* content;
+	ContentParameters* contentParameters;
+
+	int refCount; //References handed out while loading. Moved to Content::refCount when finalized
+
+	bool finalized;
+	bool succeeded;
+
+	std::shared_future<bool> loaded; //Result of Content::LoadAsync
+};
+
+//Memory used by one piece of content, see ContentManager::GetMemoryUsage
+struct ContentMemoryUsage
+{
+	ContentMemoryUsage()
+		: cpuSize(0)
+		, gpuSize(0)
+		, refCount(0)
+	{}
+
+	std::string path;
+	std::string type;
+
+	size_t cpuSize;
+	size_t gpuSize;
+
+	int refCount; //0 means it's only kept around as cache
+};
+
+template<typename T>
+class ContentHandle;
+
 class ContentManager
 {
 public:
@@ -20,10 +74,18 @@ public:
 	ContentManager& operator=(const ContentManager&) = delete;
 	virtual ~ContentManager();
 
-	void Init(ID3D11Device* device)
-	{
-		this->device = device;
-	}
+	//************************************
+	// Method:		Init
+	// FullName:	ContentManager::Init
+	// Access:		public 
+	// Returns:		void
+	// Qualifier:	
+	// Argument:	ID3D11Device* device
+	// Argument:	unsigned int workerCount - threads used by LoadAsync and Prefetch. 0 uses one per hardware thread except this one
+	// Description:	The thread calling Init becomes the owning thread. Load, Unload and anything that finalizes content
+	// must be called from it
+	//************************************
+	void Init(ID3D11Device* device, unsigned int workerCount = 0);
 
 	//************************************
 	// Method:		Load
@@ -31,63 +93,186 @@ public:
 	// Access:		public 
 	// Returns:		T*
 	// Qualifier:	
-	// Argument:	const std::string& path
+	// Argument:	const ContentPath& path
 	// Description:	Loads content. If the content at the given path has been loaded before it will return a pointer to that instance.
+	// If the content is being loaded asynchronously this waits for it and finalizes it.
 	// Use *Load<type>(path) to create a copy
 	//************************************
 	template<typename T>
-	T* Load(const std::string& path, ContentParameters* contentParameters = nullptr)
+	T* Load(const ContentPath& path, ContentParameters* contentParameters = nullptr)
 	{
 		//If path is empty a new object should be created from the content parameters, thus there's no need to look in the map
-		if(path != "")
-		{
-			auto iter = contentMap.find(path);
+		if(path.IsEmpty())
+			return static_cast<T*>(LoadFromParameters(static_cast<Content*>(new T), contentParameters));
 
-			if(iter != contentMap.end())
-			{
-				iter->second->refCount++;
-				return static_cast<T*>(iter->second);
-			}
+		std::shared_ptr<PendingContent> pending;
+		Content* content = Request(path, contentParameters, []() { return static_cast<Content*>(new T); }, false, 1, pending);
+
+		if(content == nullptr)
+			content = Finalize(pending);
+
+		return static_cast<T*>(content);
+	}
+
+	//************************************
+	// Method:		Load
+	// FullName:	ContentManager::Load
+	// Access:		public 
+	// Returns:		T* - nullptr if the content has been unloaded
+	// Qualifier:	
+	// Argument:	TypedContentID<T> id
+	// Description:	Adds a reference to already loaded content without hashing its path
+	//************************************
+	template<typename T>
+	T* Load(TypedContentID<T> id)
+	{
+		return static_cast<T*>(AddReference(id));
+	}
+
+	//************************************
+	// Method:		Load
+	// FullName:	ContentManager::Load
+	// Access:		public 
+	// Returns:		T* - nullptr if the content has been unloaded
+	// Qualifier:	
+	// Argument:	ContentID id
+	// Description:	Adds a reference to already loaded content without hashing its path. Returns nullptr and logs
+	// a warning if the content isn't a T, prefer TypedContentID which doesn't have to check
+	//************************************
+	template<typename T>
+	T* Load(ContentID id)
+	{
+		Content* content = AddReference(id);
+
+		T* typedContent = dynamic_cast<T*>(content);
+		if(content != nullptr
+			&& typedContent == nullptr)
+		{
+			Logger::LogLine(LOG_TYPE::WARNING, "Content loaded by id isn't a " + std::string(typeid(T).name()));
+			Unload(id);
 		}
 
-		Content* newContent = static_cast<Content*>(new T);
+		return typedContent;
+	}
+
+	//************************************
+	// Method:		Get
+	// FullName:	ContentManager::Get
+	// Access:		public 
+	// Returns:		T* - nullptr if the content has been unloaded
+	// Qualifier:	
+	// Argument:	TypedContentID<T> id
+	// Description:	Looks up loaded content without adding a reference
+	//************************************
+	template<typename T>
+	T* Get(TypedContentID<T> id)
+	{
+		std::lock_guard<std::mutex> lock(contentMutex);
+		return static_cast<T*>(Resolve(id));
+	}
+
+	//************************************
+	// Method:		GetID
+	// FullName:	ContentManager::GetID
+	// Access:		public 
+	// Returns:		TypedContentID<T> - invalid if the content isn't loaded or isn't a T
+	// Qualifier:	
+	// Argument:	const ContentPath& path
+	// Description:	Looks up the id content at the given path was interned as. The type is checked here once,
+	// so Load and Get can trust it afterwards
+	//************************************
+	template<typename T>
+	TypedContentID<T> GetID(const ContentPath& path)
+	{
+		std::lock_guard<std::mutex> lock(contentMutex);
 
-		if(newContent->Load(path, device, this, contentParameters))
+		auto iter = contentMap.find(path);
+		if(iter == contentMap.end())
+			return TypedContentID<T>();
+
+		if(dynamic_cast<T*>(Resolve(iter->second)) == nullptr)
 		{
-			newContent->refCount = 1;
-			if(path != "")
-			{
-				newContent->path = path;
-				contentMap.insert(std::pair<std::string, Content*>(path, newContent));
-			}
-			else
-			{
-				ContentCreationParameters* creationParameters = dynamic_cast<ContentCreationParameters*>(contentParameters);
-
-				if(creationParameters == nullptr)
-				{
-					Logger::LogLine(LOG_TYPE::FATAL, "Path is \"\" but couldn't cast contentParameters to ContentCreationParameters!");
-					delete newContent;
-					return nullptr;
-				}
-
-				if(creationParameters->uniqueID == "")
-				{
-					Logger::LogLine(LOG_TYPE::FATAL, "No uniqueID set for content without path!");
-					delete newContent;
-					return nullptr;
-				}
-
-				contentMap.insert(std::pair<std::string, Content*>(creationParameters->uniqueID, newContent));
-			}
-
-			return static_cast<T*>(newContent);
+			Logger::LogLine(LOG_TYPE::WARNING, "Content at \"" + path.GetPath() + "\" isn't a " + std::string(typeid(T).name()));
+			return TypedContentID<T>();
 		}
 
-		delete newContent;
-		return nullptr;
+		return TypedContentID<T>(iter->second);
+	}
+
+	//************************************
+	// Method:		GetID
+	// FullName:	ContentManager::GetID
+	// Access:		public 
+	// Returns:		TypedContentID<T>
+	// Qualifier:	
+	// Argument:	const T* content
+	// Description:	Typed version of Content::GetID
+	//************************************
+	template<typename T>
+	TypedContentID<T> GetID(const T* content)
+	{
+		if(content == nullptr)
+			return TypedContentID<T>();
+
+		return TypedContentID<T>(content->GetID());
 	}
 
+	//************************************
+	// Method:		LoadAsync
+	// FullName:	ContentManager::LoadAsync
+	// Access:		public 
+	// Returns:		ContentHandle<T>
+	// Qualifier:	
+	// Argument:	const ContentPath& path
+	// Argument:	ContentParameters* contentParameters - must stay alive until the content has been finalized
+	// Description:	Starts loading content on a worker thread and counts as a reference, just like Load.
+	// Several requests for the same path share the same load. Call Get on the handle (or FinalizePending/WaitForPending)
+	// from the owning thread to create device resources. Can be called from any thread
+	//************************************
+	template<typename T>
+	ContentHandle<T> LoadAsync(const ContentPath& path, ContentParameters* contentParameters = nullptr);
+
+	//************************************
+	// Method:		Prefetch
+	// FullName:	ContentManager::Prefetch
+	// Access:		public 
+	// Returns:		void
+	// Qualifier:	
+	// Argument:	const ContentPath& path
+	// Argument:	ContentParameters* contentParameters - must stay alive until the content has been finalized
+	// Description:	Starts loading content on a worker thread without taking a reference. The next Load or LoadAsync
+	// for the same path will pick up the result. Can be called from any thread, including from Content::LoadAsync
+	//************************************
+	template<typename T>
+	void Prefetch(const ContentPath& path, ContentParameters* contentParameters = nullptr)
+	{
+		if(path.IsEmpty())
+			return;
+
+		std::shared_ptr<PendingContent> pending;
+		Request(path, contentParameters, []() { return static_cast<Content*>(new T); }, true, 0, pending);
+	}
+
+	//************************************
+	// Method:		FinalizePending
+	// FullName:	ContentManager::FinalizePending
+	// Access:		public 
+	// Returns:		void
+	// Qualifier:	
+	// Description:	Finalizes all asynchronously loaded content whose worker part is done. Doesn't block.
+	// Call from the owning thread, once per frame is enough
+	//************************************
+	void FinalizePending();
+	//************************************
+	// Method:		WaitForPending
+	// FullName:	ContentManager::WaitForPending
+	// Access:		public 
+	// Returns:		void
+	// Qualifier:	
+	// Description:	Blocks until all asynchronously loaded content (including dependencies started while loading) is finalized
+	//************************************
+	void WaitForPending();
+
 	//************************************
 	// Method:		Unload
 	// FullName:	ContentManager::Unload
@@ -103,10 +288,20 @@ public:
 	// Access:		public 
 	// Returns:		void
 	// Qualifier:	
-	// Argument:	const std::string& path
+	// Argument:	const ContentPath& path
 	// Description:	Unloads the given content
 	//************************************
-	void Unload(const std::string& path);
+	void Unload(const ContentPath& path);
+	//************************************
+	// Method:		Unload
+	// FullName:	ContentManager::Unload
+	// Access:		public 
+	// Returns:		void
+	// Qualifier:	
+	// Argument:	ContentID id
+	// Description:	Unloads the given content
+	//************************************
+	void Unload(ContentID id);
 	//************************************
 	// Method:		Unload
 	// FullName:	ContentManager::Unload
@@ -117,10 +312,259 @@ public:
 	// Description:	Unloads the given content
 	//************************************
 	void Unload(Content* content);
+
+	//************************************
+	// Method:		SetMemoryBudget
+	// FullName:	ContentManager::SetMemoryBudget
+	// Access:		public 
+	// Returns:		void
+	// Qualifier:	
+	// Argument:	size_t bytes - CPU and GPU memory combined
+	// Description:	Content that isn't referenced anymore is kept around until the total size of all content exceeds
+	// this budget. It's then unloaded, least recently used first, and loaded again on demand. 0 unloads it right away
+	//************************************
+	void SetMemoryBudget(size_t bytes);
+	size_t GetMemoryBudget() const;
+
+	size_t GetCPUMemoryUsage() const;
+	size_t GetGPUMemoryUsage() const;
+	//************************************
+	// Method:		GetCachedMemoryUsage
+	// FullName:	ContentManager::GetCachedMemoryUsage
+	// Access:		public 
+	// Returns:		size_t
+	// Qualifier:	const
+	// Description:	CPU and GPU memory used by content that isn't referenced and can be evicted
+	//************************************
+	size_t GetCachedMemoryUsage() const;
+	//************************************
+	// Method:		GetMemoryUsage
+	// FullName:	ContentManager::GetMemoryUsage
+	// Access:		public 
+	// Returns:		std::vector<ContentMemoryUsage>
+	// Qualifier:	
+	// Description:	Lists all loaded content, largest first
+	//************************************
+	std::vector<ContentMemoryUsage> GetMemoryUsage();
+
+	//************************************
+	// Method:		GetThreadPool
+	// FullName:	ContentManager::GetThreadPool
+	// Access:		public 
+	// Returns:		ThreadPool&
+	// Qualifier:	
+	// Description:	The workers used for loading, for other CPU work that shouldn't start threads of its own.
+	// Long running tasks delay any content loaded asynchronously meanwhile
+	//************************************
+	ThreadPool& GetThreadPool();
+
+	const static size_t DEFAULT_MEMORY_BUDGET = 512 * 1024 * 1024;
 private:
-	std::unordered_map<std::string, Content*> contentMap; //Use map if there are memory issues
+	template<typename T>
+	friend class ContentHandle;
+
+	struct ContentSlot
+	{
+		ContentSlot()
+			: content(nullptr)
+			, generation(0)
+			, cpuSize(0)
+			, gpuSize(0)
+			, cached(false)
+		{}
+
+		Content* content;
+		uint32_t generation;
+
+		ContentPath path; //Key in contentMap. Same as Content::path except for content created from parameters
+
+		//Sizes reported when the content was interned, so totals stay consistent when it's released
+		size_t cpuSize;
+		size_t gpuSize;
+
+		bool cached; //Not referenced, lruPosition is valid
+		std::list<uint32_t>::iterator lruPosition;
+	};
+
+	//Paths are only hashed when content is loaded by path. Everything else goes through ContentID, which is an index
+	//into contentSlots
+	std::unordered_map<ContentPath, ContentID, ContentPath::Hasher> contentMap;
+	std::unordered_map<ContentPath, std::shared_ptr<PendingContent>, ContentPath::Hasher> pendingMap;
+
+	std::vector<ContentSlot> contentSlots;
+	std::vector<uint32_t> freeSlots;
+
+	//Slots of unreferenced content, least recently used first
+	std::list<uint32_t> cachedSlots;
+
+	size_t memoryBudget;
+	size_t cpuMemoryUsage;
+	size_t gpuMemoryUsage;
+	size_t cachedMemoryUsage;
+	bool overBudget; //Warning has been logged
+
+	//Guards contentMap, pendingMap and the slots since LoadAsync and Prefetch can be called from workers
+	mutable std::mutex contentMutex;
+
+	ThreadPool workers;
 
 	ID3D11Device* device;
+
+	//************************************
+	// Method:		Request
+	// FullName:	ContentManager::Request
+	// Access:		private 
+	// Returns:		Content* - the content if it's already loaded, otherwise nullptr and pending is set
+	// Qualifier:	
+	// Argument:	const ContentPath& path
+	// Argument:	ContentParameters* contentParameters
+	// Argument:	const std::function<Content*()>& create - creates an instance of the requested type
+	// Argument:	bool async - run LoadAsync on a worker instead of the calling thread
+	// Argument:	int references - how many references to add
+	// Argument:	std::shared_ptr<PendingContent>& pending - set if the content isn't loaded yet
+	// Description:	Looks up path and starts loading it if nobody else has
+	//************************************
+	Content* Request(const ContentPath& path, ContentParameters* contentParameters, const std::function<Content*()>& create, bool async, int references, std::shared_ptr<PendingContent>& pending);
+	//************************************
+	// Method:		Finalize
+	// FullName:	ContentManager::Finalize
+	// Access:		private 
+	// Returns:		Content* - nullptr if loading failed
+	// Qualifier:	
+	// Argument:	const std::shared_ptr<PendingContent>& pending
+	// Description:	Waits for LoadAsync and calls FinalizeAsync. Must be called from the owning thread
+	//************************************
+	Content* Finalize(const std::shared_ptr<PendingContent>& pending);
+
+	Content* LoadFromParameters(Content* newContent, ContentParameters* contentParameters);
+
+	//************************************
+	// Method:		Intern
+	// FullName:	ContentManager::Intern
+	// Access:		private 
+	// Returns:		ContentID
+	// Qualifier:	
+	// Argument:	const ContentPath& path
+	// Argument:	Content* content
+	// Description:	Gives content a slot and maps path to it. contentMutex must be locked
+	//************************************
+	ContentID Intern(const ContentPath& path, Content* content);
+	//************************************
+	// Method:		Release
+	// FullName:	ContentManager::Release
+	// Access:		private 
+	// Returns:		void
+	// Qualifier:	
+	// Argument:	ContentID id
+	// Description:	Frees the slot of id and removes it from contentMap. contentMutex must be locked
+	//************************************
+	void Release(ContentID id);
+	//************************************
+	// Method:		FreeSlot
+	// FullName:	ContentManager::FreeSlot
+	// Access:		private 
+	// Returns:		void
+	// Qualifier:	
+	// Argument:	uint32_t index
+	// Description:	Bumps the generation of an emptied slot and makes it reusable. Slots on their last
+	// generation are never reused. contentMutex must be locked
+	//************************************
+	void FreeSlot(uint32_t index);
+	//************************************
+	// Method:		Resolve
+	// FullName:	ContentManager::Resolve
+	// Access:		private 
+	// Returns:		Content* - nullptr if id is invalid or stale
+	// Qualifier:	const
+	// Argument:	ContentID id
+	// Description:	contentMutex must be locked
+	//************************************
+	Content* Resolve(ContentID id) const;
+	Content* AddReference(ContentID id);
+
+	//Moves content in and out of cachedSlots. contentMutex must be locked
+	void Cache(uint32_t index);
+	void Uncache(uint32_t index);
+	//************************************
+	// Method:		EnforceBudget
+	// FullName:	ContentManager::EnforceBudget
+	// Access:		private 
+	// Returns:		void
+	// Qualifier:	
+	// Description:	Unloads cached content until memory usage is within budget. contentMutex must NOT be locked
+	// since unloading content can unload its dependencies
+	//************************************
+	void EnforceBudget();
 };
 
+//Reference to content that might still be loading. Get has to be called from the ContentManager's owning thread
+template<typename T>
+class ContentHandle
+{
+public:
+	ContentHandle()
+		: contentManager(nullptr)
+		, content(nullptr)
+	{}
+	ContentHandle(ContentManager* contentManager, std::shared_ptr<PendingContent> pending, T* content)
+		: contentManager(contentManager)
+		, pending(std::move(pending))
+		, content(content)
+	{}
+	~ContentHandle() = default;
+
+	//************************************
+	// Method:		IsReady
+	// FullName:	ContentHandle::IsReady
+	// Access:		public 
+	// Returns:		bool
+	// Qualifier:	const
+	// Description:	Whether or not Get can return without waiting for a worker
+	//************************************
+	bool IsReady() const
+	{
+		if(pending == nullptr || pending->finalized)
+			return true;
+
+		return pending->loaded.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}
+
+	//************************************
+	// Method:		Get
+	// FullName:	ContentHandle::Get
+	// Access:		public 
+	// Returns:		T* - nullptr if loading failed
+	// Qualifier:	
+	// Description:	Waits for the content and finalizes it if needed
+	//************************************
+	T* Get()
+	{
+		if(pending != nullptr)
+		{
+			content = static_cast<T*>(contentManager->Finalize(pending));
+			pending.reset();
+		}
+
+		return content;
+	}
+
+private:
+	ContentManager* contentManager;
+	std::shared_ptr<PendingContent> pending;
+
+	T* content;
+};
+
+template<typename T>
+ContentHandle<T> ContentManager::LoadAsync(const ContentPath& path, ContentParameters* contentParameters /*= nullptr*/)
+{
+	if(path.IsEmpty())
+		return ContentHandle<T>(this, nullptr, Load<T>(path, contentParameters));
+
+	std::shared_ptr<PendingContent> pending;
+	Content* content = Request(path, contentParameters, []() { return static_cast<Content*>(new T); }, true, 1, pending);
+
+	return ContentHandle<T>(this, std::move(pending), static_cast<T*>(content));
+}
+
 #endif // ContentLoader_h__
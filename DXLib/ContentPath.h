@@ -0,0 +1,83 @@
+#ifndef ContentPath_h__
+#define ContentPath_h__
+
+#include <string>
+#include <cstddef>
+
+//Path to content with its hash computed once on construction.
+//Keep one around (e.g. as a static const) for content that's loaded often to skip hashing the string on every lookup
+class ContentPath
+{
+public:
+	ContentPath()
+		: hash(Hash(""))
+	{}
+	ContentPath(const char* path)
+		: path(path)
+		, hash(Hash(this->path))
+	{}
+	ContentPath(const std::string& path)
+		: path(path)
+		, hash(Hash(this->path))
+	{}
+	ContentPath(std::string&& path)
+		: path(std::move(path))
+		, hash(Hash(this->path))
+	{}
+	~ContentPath() = default;
+
+	const std::string& GetPath() const
+	{
+		return path;
+	}
+
+	std::size_t GetHash() const
+	{
+		return hash;
+	}
+
+	bool IsEmpty() const
+	{
+		return path.empty();
+	}
+
+	bool operator==(const ContentPath& rhs) const
+	{
+		//Different hashes means different strings, so most mismatches never touch the strings
+		return hash == rhs.hash && path == rhs.path;
+	}
+
+	bool operator!=(const ContentPath& rhs) const
+	{
+		return !(*this == rhs);
+	}
+
+	//For std::unordered_map
+	struct Hasher
+	{
+		std::size_t operator()(const ContentPath& contentPath) const
+		{
+			return contentPath.hash;
+		}
+	};
+
+private:
+	std::string path;
+	std::size_t hash;
+
+	//FNV-1a
+	static std::size_t Hash(const std::string& path)
+	{
+		std::size_t hash = static_cast<std::size_t>(2166136261u);
+
+		for(char character : path)
+		{
+			hash ^= static_cast<unsigned char>(character);
+			hash *= static_cast<std::size_t>(16777619u);
+		}
+
+		return hash;
+	}
+};
+
+#endif // ContentPath_h__
\ No newline at end of file
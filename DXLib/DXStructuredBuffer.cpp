@@ -23,6 +23,13 @@ bool DXStructuredBuffer::Update(ID3D11DeviceContext* deviceContext, void* newDat
 	return true;
 }
 
+void DXStructuredBuffer::Release()
+{
+	uav.reset();
+	srv.reset();
+	buffer.reset();
+}
+
 ID3D11Buffer* DXStructuredBuffer::GetBuffer() const
 {
 	return buffer.get();
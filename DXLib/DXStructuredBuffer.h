@@ -25,6 +25,8 @@ public:
 	}
 
 	bool Update(ID3D11DeviceContext* deviceContext, void* newData) const;
+	//Releases the buffer and its views, GetBuffer, GetSRV and GetUAV return nullptr until Create is called again
+	void Release();
 
 	ID3D11Buffer* GetBuffer() const;
 	ID3D11ShaderResourceView* GetSRV() const;
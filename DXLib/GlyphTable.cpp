@@ -0,0 +1,68 @@
+#include "GlyphTable.h"
+
+#include <algorithm>
+
+GlyphTable::GlyphTable()
+	: hasFlatTable(false)
+{
+}
+
+bool GlyphTable::Build(const std::vector<Character>& glyphs)
+{
+	Clear();
+
+	if(glyphs.size() >= INVALID_GLYPH_INDEX)
+		return false;
+
+	//Table only needs to reach the highest id in the BMP. For the fonts that are used that's 256 entries
+	unsigned int highestFlatID = 0;
+	for(const Character& glyph : glyphs)
+		if(static_cast<unsigned int>(glyph.id) <= MAX_FLAT_GLYPH_ID)
+			highestFlatID = static_cast<unsigned int>(glyph.id);
+
+	flatIndices.assign(highestFlatID + 1, static_cast<uint16_t>(INVALID_GLYPH_INDEX));
+
+	for(size_t i = 0; i < glyphs.size(); ++i)
+		if(static_cast<unsigned int>(glyphs[i].id) <= highestFlatID)
+			flatIndices[glyphs[i].id] = static_cast<uint16_t>(i);
+
+	flatIndices.shrink_to_fit();
+	hasFlatTable = true;
+
+	return true;
+}
+
+void GlyphTable::Clear()
+{
+	flatIndices.clear();
+	hasFlatTable = false;
+}
+
+const Character* GlyphTable::Find(const std::vector<Character>& glyphs, unsigned int id) const
+{
+	if(hasFlatTable && id <= MAX_FLAT_GLYPH_ID)
+	{
+		//The table reaches the highest id in the BMP, so anything past its end doesn't exist
+		if(id < flatIndices.size())
+		{
+			uint16_t index = flatIndices[id];
+
+			if(index != INVALID_GLYPH_INDEX)
+				return &glyphs[index];
+		}
+
+		return nullptr;
+	}
+
+	auto iter = std::lower_bound(glyphs.begin(), glyphs.end(), id, [](const Character& lhs, unsigned int rhs) { return static_cast<unsigned int>(lhs.id) < rhs; });
+
+	if(iter != glyphs.end() && static_cast<unsigned int>(iter->id) == id)
+		return &*iter;
+
+	return nullptr;
+}
+
+size_t GlyphTable::GetCPUSize() const
+{
+	return flatIndices.capacity() * sizeof(uint16_t);
+}
@@ -0,0 +1,53 @@
+#ifndef GlyphTable_h__
+#define GlyphTable_h__
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "Character.h"
+
+/*Id to glyph lookup for a CharacterSet. Ids in the BMP are looked up in a flat table of indices,
+* anything the table doesn't cover is binary searched. The glyphs are owned by the caller and
+* must be sorted by id and unique.
+* Doesn't touch D3D, so it can be tested on its own
+*/
+class GlyphTable
+{
+public:
+	GlyphTable();
+	~GlyphTable() = default;
+
+	const static uint16_t INVALID_GLYPH_INDEX = 0xFFFF;
+	const static unsigned int MAX_FLAT_GLYPH_ID = 0xFFFF; //Anything above the BMP is binary searched
+
+	//************************************
+	// Method:		Build
+	// FullName:	GlyphTable::Build
+	// Access:		public
+	// Returns:		bool - false if there are too many glyphs to index with 16 bits. Every lookup is binary searched then
+	// Qualifier:
+	// Argument:	const std::vector<Character>& glyphs - sorted by id
+	//************************************
+	bool Build(const std::vector<Character>& glyphs);
+	void Clear();
+
+	//************************************
+	// Method:		Find
+	// FullName:	GlyphTable::Find
+	// Access:		public
+	// Returns:		const Character* - nullptr if there's no glyph with the given id
+	// Qualifier:	const
+	// Argument:	const std::vector<Character>& glyphs - the same glyphs the table was built from
+	// Argument:	unsigned int id
+	//************************************
+	const Character* Find(const std::vector<Character>& glyphs, unsigned int id) const;
+
+	size_t GetCPUSize() const;
+
+private:
+	std::vector<uint16_t> flatIndices; //Index into glyphs for every id below flatIndices.size()
+	bool hasFlatTable; //If false every id is binary searched
+};
+
+#endif // GlyphTable_h__
@@ -20,6 +20,9 @@ std::ios_base::openmode Logger::openMode = std::ios_base::app;
 std::string Logger::separatorString = " ";
 
 std::function<void(std::string)> Logger::CallOnLog = nullptr;
+std::thread::id Logger::callOnLogThread;
+std::vector<std::string> Logger::deferredMessages;
+std::mutex Logger::logMutex;
 bool Logger::printStackTrace = true;
 
 void Logger::LogLineWithFileDataF(const char *file, int line, LOG_TYPE logType, const std::string& text)
@@ -72,6 +75,8 @@ void Logger::LogLine(LOG_TYPE logType, const char* text)
 
 void Logger::Log(LOG_TYPE logType, const std::string& text)
 {
+	std::unique_lock<std::mutex> lock(logMutex);
+
 	std::string message("");
 
 	switch(logType)
@@ -150,8 +155,8 @@ void Logger::Log(LOG_TYPE logType, const std::string& text)
 
 		if(consoleLogLevel &= CONSOLE_LOG_LEVEL::EXCLUSIVE)
 		{
-			if(CallOnLog != nullptr)
-				CallOnLog(message);
+			lock.unlock();
+			CallOnLogOrDefer(message);
 
 			return; //Don't write anything to file
 		}
@@ -162,8 +167,8 @@ void Logger::Log(LOG_TYPE logType, const std::string& text)
 	{
 		OutputDebugStringA(message.c_str());
 
-		if(CallOnLog != nullptr)
-			CallOnLog(message);
+		lock.unlock();
+		CallOnLogOrDefer(message);
 
 		return;
 	}
@@ -180,8 +185,8 @@ void Logger::Log(LOG_TYPE logType, const std::string& text)
 	if(message.back() == '\n')
 		message.pop_back();
 
-	if(CallOnLog != nullptr)
-		CallOnLog(message);
+	lock.unlock();
+	CallOnLogOrDefer(message);
 }
 
 #endif //NO_LOGGER
@@ -240,7 +245,46 @@ void Logger::SetConsoleLogLevel(CONSOLE_LOG_LEVEL logLevel)
 
 void Logger::SetCallOnLog(std::function<void(std::string)> function)
 {
+	std::lock_guard<std::mutex> lock(logMutex);
+
 	CallOnLog = std::move(function);
+	callOnLogThread = std::this_thread::get_id();
+}
+
+void Logger::FlushDeferred()
+{
+	std::vector<std::string> messages;
+
+	{
+		std::lock_guard<std::mutex> lock(logMutex);
+
+		if(CallOnLog == nullptr
+			|| std::this_thread::get_id() != callOnLogThread)
+			return;
+
+		messages.swap(deferredMessages);
+	}
+
+	for(const std::string& message : messages)
+		CallOnLog(message);
+}
+
+void Logger::CallOnLogOrDefer(std::string message)
+{
+	{
+		std::lock_guard<std::mutex> lock(logMutex);
+
+		if(CallOnLog == nullptr)
+			return;
+
+		if(std::this_thread::get_id() != callOnLogThread)
+		{
+			deferredMessages.push_back(std::move(message));
+			return;
+		}
+	}
+
+	CallOnLog(message);
 }
 
 void Logger::Print(std::string message)
@@ -6,6 +6,9 @@
 #include <string>
 #include <functional>
 #include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 enum class CONSOLE_LOG_LEVEL : int
 {
@@ -135,8 +138,23 @@ public:
 	//************************************
 	static void SetConsoleLogLevel(CONSOLE_LOG_LEVEL logLevel);
 
+	//************************************
+	// Method:		SetCallOnLog
+	// Argument:	std::function<void(std::string)> function
+	// Returns:		void
+	// Description:	Sets a function to call with every logged message. It is only ever called on the thread that set it,
+	//				messages logged from other threads are queued until FlushDeferred is called
+	//************************************
 	static void SetCallOnLog(std::function<void(std::string)> function);
 
+	//************************************
+	// Method:		FlushDeferred
+	// Returns:		void
+	// Description:	Passes messages logged from other threads to the function set with SetCallOnLog. Does nothing
+	//				unless called from the thread that called SetCallOnLog
+	//************************************
+	static void FlushDeferred();
+
 	//************************************
 	// Method:		PrintStackTrace
 	// Argument:	bool print
@@ -162,6 +180,13 @@ private:
 	static void Print(std::string message);
 
 	static std::function<void(std::string)> CallOnLog;
+	static std::thread::id callOnLogThread;
+	static std::vector<std::string> deferredMessages;
+
+	//Log can be called from ContentManager's workers
+	static std::mutex logMutex;
+
+	static void CallOnLogOrDefer(std::string message);
 };
 
 using T = std::underlying_type_t<CONSOLE_LOG_LEVEL>;
@@ -0,0 +1,94 @@
+#include "mappedFile.h"
+
+#include <windows.h>
+
+MappedFile::MappedFile()
+	: fileHandle(INVALID_HANDLE_VALUE)
+	, mappingHandle(nullptr)
+	, data(nullptr)
+	, size(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const std::string& path)
+{
+	Close();
+
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+		return false;
+
+	fileHandle = file;
+
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(file, &fileSize))
+	{
+		Close();
+		return false;
+	}
+
+	//Empty files can't be mapped
+	if(fileSize.QuadPart == 0)
+		return true;
+
+	mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(mappingHandle == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if(data == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	size = static_cast<size_t>(fileSize.QuadPart);
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if(data != nullptr)
+	{
+		UnmapViewOfFile(data);
+		data = nullptr;
+	}
+
+	if(mappingHandle != nullptr)
+	{
+		CloseHandle(mappingHandle);
+		mappingHandle = nullptr;
+	}
+
+	if(fileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(fileHandle);
+		fileHandle = INVALID_HANDLE_VALUE;
+	}
+
+	size = 0;
+}
+
+bool MappedFile::IsOpen() const
+{
+	return fileHandle != INVALID_HANDLE_VALUE;
+}
+
+const char* MappedFile::GetData() const
+{
+	return data;
+}
+
+size_t MappedFile::GetSize() const
+{
+	return size;
+}
\ No newline at end of file
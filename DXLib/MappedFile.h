@@ -0,0 +1,42 @@
+#ifndef MappedFile_h__
+#define MappedFile_h__
+
+#include <string>
+
+//Read-only memory mapped file. The data stays valid until Close is called or the MappedFile is destroyed
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	//************************************
+	// Method:		Open
+	// FullName:	MappedFile::Open
+	// Access:		public
+	// Returns:		bool - whether or not the file could be opened and mapped
+	// Qualifier:
+	// Argument:	const std::string& path
+	// Description:	Maps the whole file into memory. Empty files can be opened but GetData will return nullptr
+	//************************************
+	bool Open(const std::string& path);
+	void Close();
+
+	bool IsOpen() const;
+
+	const char* GetData() const;
+	size_t GetSize() const;
+
+private:
+	//HANDLEs, void* to keep windows.h out of this header
+	void* fileHandle;
+	void* mappingHandle;
+
+	const char* data;
+	size_t size;
+};
+
+#endif // MappedFile_h__
\ No newline at end of file
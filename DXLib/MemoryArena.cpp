@@ -0,0 +1,69 @@
+#include "memoryArena.h"
+
+#include <algorithm>
+
+MemoryArena::MemoryArena(size_t blockSize /*= 64 * 1024*/)
+	: blockSize(blockSize)
+	, currentOffset(0)
+	, usedSize(0)
+{
+}
+
+void* MemoryArena::Allocate(size_t size, size_t alignment)
+{
+	if(!blocks.empty())
+	{
+		Block& block = blocks.back();
+
+		size_t alignedOffset = (currentOffset + alignment - 1) & ~(alignment - 1);
+
+		if(alignedOffset + size <= block.size)
+		{
+			currentOffset = alignedOffset + size;
+			usedSize += size;
+
+			return block.memory.get() + alignedOffset;
+		}
+	}
+
+	//Large allocations get a block of their own. new[] aligns for any fundamental type
+	Block newBlock;
+	newBlock.size = std::max(blockSize, size);
+	newBlock.memory.reset(new char[newBlock.size]);
+
+	blocks.push_back(std::move(newBlock));
+
+	currentOffset = size;
+	usedSize += size;
+
+	return blocks.back().memory.get();
+}
+
+void MemoryArena::Reset()
+{
+	//Keep the first block, unless it's an oversized one
+	if(blocks.size() > 1)
+		blocks.erase(blocks.begin() + 1, blocks.end());
+
+	if(!blocks.empty()
+		&& blocks.front().size != blockSize)
+		blocks.clear();
+
+	currentOffset = 0;
+	usedSize = 0;
+}
+
+size_t MemoryArena::GetUsedSize() const
+{
+	return usedSize;
+}
+
+size_t MemoryArena::GetReservedSize() const
+{
+	size_t size = 0;
+
+	for(const Block& block : blocks)
+		size += block.size;
+
+	return size;
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#ifndef MemoryArena_h__
+#define MemoryArena_h__
+
+#include <vector>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <cstddef>
+
+//Bump allocator. Memory is handed out from large blocks and only freed all at once by Reset or the destructor,
+//so only trivially destructible types can be allocated
+class MemoryArena
+{
+public:
+	explicit MemoryArena(size_t blockSize = 64 * 1024);
+	~MemoryArena() = default;
+
+	MemoryArena(const MemoryArena&) = delete;
+	MemoryArena& operator=(const MemoryArena&) = delete;
+
+	void* Allocate(size_t size, size_t alignment);
+
+	//************************************
+	// Method:		Allocate
+	// FullName:	MemoryArena::Allocate
+	// Access:		public
+	// Returns:		T* - count default constructed instances of T
+	// Qualifier:
+	// Argument:	size_t count
+	//************************************
+	template<typename T>
+	T* Allocate(size_t count = 1)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "MemoryArena never calls destructors");
+
+		T* memory = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+
+		for(size_t i = 0; i < count; ++i)
+			new(memory + i) T();
+
+		return memory;
+	}
+
+	//************************************
+	// Method:		Reset
+	// FullName:	MemoryArena::Reset
+	// Access:		public
+	// Returns:		void
+	// Qualifier:
+	// Description:	Frees everything. The first block is kept so an arena that's reused doesn't allocate again
+	//************************************
+	void Reset();
+
+	//Bytes handed out by Allocate since the last Reset
+	size_t GetUsedSize() const;
+	//Bytes allocated from the heap
+	size_t GetReservedSize() const;
+
+private:
+	struct Block
+	{
+		std::unique_ptr<char[]> memory;
+		size_t size;
+	};
+
+	std::vector<Block> blocks;
+	size_t blockSize;
+
+	size_t currentOffset; //Offset into blocks.back()
+	size_t usedSize;
+};
+
+#endif // MemoryArena_h__
\ No newline at end of file
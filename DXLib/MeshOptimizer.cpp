@@ -0,0 +1,130 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+namespace
+{
+	//Bits per axis. Triangles in the same cell keep their file order
+	const int MORTON_BITS = 10;
+
+	//Spreads the lower 10 bits of value out to every third bit
+	uint32_t ExpandBits(uint32_t value)
+	{
+		value = (value * 0x00010001u) & 0xFF0000FFu;
+		value = (value * 0x00000101u) & 0x0F00F00Fu;
+		value = (value * 0x00000011u) & 0xC30C30C3u;
+		value = (value * 0x00000005u) & 0x49249249u;
+
+		return value;
+	}
+
+	//position is relative to the lower corner of the bounds, scale maps the bounds to [0, 1]
+	uint32_t GetMortonCode(const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT3& scale)
+	{
+		const float cellCount = static_cast<float>(1 << MORTON_BITS);
+
+		uint32_t x = static_cast<uint32_t>(std::min(std::max(position.x * scale.x * cellCount, 0.0f), cellCount - 1.0f));
+		uint32_t y = static_cast<uint32_t>(std::min(std::max(position.y * scale.y * cellCount, 0.0f), cellCount - 1.0f));
+		uint32_t z = static_cast<uint32_t>(std::min(std::max(position.z * scale.z * cellCount, 0.0f), cellCount - 1.0f));
+
+		return (ExpandBits(x) << 2) | (ExpandBits(y) << 1) | ExpandBits(z);
+	}
+
+	float GetInverseExtent(float min, float max)
+	{
+		return max > min ? 1.0f / (max - min) : 0.0f;
+	}
+}
+
+void OptimizeMeshLocality(std::vector<Mesh>& meshes)
+{
+	//Triangles may use vertices from earlier meshes, so vertices are renumbered over all of them at once
+	std::vector<OBJVertex> vertices;
+
+	size_t vertexCount = 0;
+	for(const Mesh& mesh : meshes)
+		vertexCount += mesh.vertices.size();
+
+	vertices.reserve(vertexCount);
+
+	for(Mesh& mesh : meshes)
+	{
+		vertices.insert(vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+
+		mesh.vertices.clear();
+		mesh.vertices.shrink_to_fit();
+	}
+
+	//New index of each vertex, -1 until a triangle uses it
+	std::vector<int> vertexRemap(vertices.size(), -1);
+	int newVertexCount = 0;
+
+	std::vector<uint64_t> keys;
+	std::vector<int> newIndicies;
+
+	for(Mesh& mesh : meshes)
+	{
+		int triangleCount = static_cast<int>(mesh.indicies.size() / 3);
+
+		std::vector<DirectX::XMFLOAT3> centers(triangleCount);
+
+		DirectX::XMFLOAT3 min(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+		DirectX::XMFLOAT3 max(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest());
+
+		for(int i = 0; i < triangleCount; ++i)
+		{
+			const DirectX::XMFLOAT3& v0 = vertices[mesh.indicies[i * 3]].position;
+			const DirectX::XMFLOAT3& v1 = vertices[mesh.indicies[i * 3 + 1]].position;
+			const DirectX::XMFLOAT3& v2 = vertices[mesh.indicies[i * 3 + 2]].position;
+
+			DirectX::XMFLOAT3& center = centers[i];
+			center = DirectX::XMFLOAT3((v0.x + v1.x + v2.x) / 3.0f, (v0.y + v1.y + v2.y) / 3.0f, (v0.z + v1.z + v2.z) / 3.0f);
+
+			min.x = std::min(min.x, center.x);
+			min.y = std::min(min.y, center.y);
+			min.z = std::min(min.z, center.z);
+
+			max.x = std::max(max.x, center.x);
+			max.y = std::max(max.y, center.y);
+			max.z = std::max(max.z, center.z);
+		}
+
+		DirectX::XMFLOAT3 scale(GetInverseExtent(min.x, max.x), GetInverseExtent(min.y, max.y), GetInverseExtent(min.z, max.z));
+
+		//The triangle index in the lower bits keeps the sort stable
+		keys.resize(triangleCount);
+		for(int i = 0; i < triangleCount; ++i)
+		{
+			DirectX::XMFLOAT3 position(centers[i].x - min.x, centers[i].y - min.y, centers[i].z - min.z);
+
+			keys[i] = (static_cast<uint64_t>(GetMortonCode(position, scale)) << 32) | static_cast<uint32_t>(i);
+		}
+
+		std::sort(keys.begin(), keys.end());
+
+		newIndicies.clear();
+		newIndicies.reserve(mesh.indicies.size());
+
+		for(uint64_t key : keys)
+		{
+			int triangle = static_cast<int>(key & 0xFFFFFFFFu);
+
+			for(int i = 0; i < 3; ++i)
+			{
+				int index = mesh.indicies[triangle * 3 + i];
+
+				if(vertexRemap[index] == -1)
+				{
+					vertexRemap[index] = newVertexCount++;
+					mesh.vertices.push_back(vertices[index]);
+				}
+
+				newIndicies.push_back(vertexRemap[index]);
+			}
+		}
+
+		mesh.indicies.swap(newIndicies);
+	}
+}
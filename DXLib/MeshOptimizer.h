@@ -0,0 +1,23 @@
+#ifndef MeshOptimizer_h__
+#define MeshOptimizer_h__
+
+#include <vector>
+
+#include "OBJFile.h"
+
+//************************************
+// Method:		OptimizeMeshLocality
+// Returns:		void
+// Argument:	std::vector<Mesh>& meshes - indices are counted over every mesh, same as in an OBJFile
+// Description:	Reorders each mesh's triangles along a Morton curve through their centers, then renumbers
+//				the vertices in the order the triangles first use them. Files list faces in whatever order
+//				they were modelled in, so triangles next to each other in space, and the vertices they
+//				share, usually end up far apart in memory. Afterwards a BVH leaf or any other group of
+//				nearby triangles reads a few contiguous cache lines instead of one per triangle.
+//
+//				Triangles stay in the mesh they were in, so per-mesh ranges are unchanged. A vertex is
+//				moved to the first mesh that uses it, and vertices no triangle uses are removed
+//************************************
+void OptimizeMeshLocality(std::vector<Mesh>& meshes);
+
+#endif // MeshOptimizer_h__
@@ -6,6 +6,7 @@
 #include <tuple>
 
 #include "Logger.h"
+#include "MeshOptimizer.h"
 
 namespace
 {
@@ -67,12 +68,35 @@ OBJFile::OBJFile()
 OBJFile::~OBJFile()
 {}
 
-std::vector<Mesh> OBJFile::GetMeshes() const
+const std::vector<Mesh>& OBJFile::GetMeshes() const
 {
 	return meshes;
 }
 
+size_t OBJFile::GetCPUSize() const
+{
+	size_t size = sizeof(OBJFile) + meshes.capacity() * sizeof(Mesh);
+
+	for(const Mesh& mesh : meshes)
+		size += mesh.vertices.capacity() * sizeof(OBJVertex) + mesh.indicies.capacity() * sizeof(int) + mesh.material.name.capacity();
+
+	return size;
+}
+
+size_t OBJFile::GetGPUSize() const
+{
+	return 0; //Buffers are created by whoever uses the meshes
+}
+
 bool OBJFile::Load(const std::string& path, ID3D11Device* device, ContentManager* contentManager /*= nullptr*/, ContentParameters* contentParameters /*= nullptr*/)
+{
+	if(!LoadAsync(path, contentManager, contentParameters))
+		return false;
+
+	return FinalizeAsync(path, device, contentManager, contentParameters);
+}
+
+bool OBJFile::LoadAsync(const std::string& path, ContentManager* contentManager, ContentParameters* contentParameters)
 {
 	std::ifstream in(path);
 	if(!in.is_open())
@@ -125,6 +149,60 @@ bool OBJFile::Load(const std::string& path, ID3D11Device* device, ContentManager
 		}
 	}
 
+	OptimizeMeshLocality(meshes);
+
+	return true;
+}
+
+bool OBJFile::FinalizeAsync(const std::string& path, ID3D11Device* device, ContentManager* contentManager, ContentParameters* contentParameters)
+{
+	if(!mtlLibPath.IsEmpty())
+		mtlLib = contentManager->Load<MTLLib>(mtlLibPath);
+
+	std::vector<Mesh> resolvedMeshes;
+	resolvedMeshes.reserve(meshes.size());
+
+	for(int i = 0, end = static_cast<int>(meshes.size()); i < end; ++i)
+	{
+		bool foundMaterial = false;
+
+		if(mtlLib != nullptr)
+		{
+			try
+			{
+				meshes[i].material = (*mtlLib)[meshMaterials[i]];
+				foundMaterial = true;
+			}
+			catch(std::out_of_range&)
+			{
+			}
+		}
+
+		if(foundMaterial)
+		{
+			resolvedMeshes.push_back(std::move(meshes[i]));
+			continue;
+		}
+
+		Logger::LogLine(LOG_TYPE::WARNING, "Tried to use non-existent material \"" + meshMaterials[i] + "\"");
+
+		//Indicies are counted over the whole file, so the faces can be kept by appending them to the previous mesh
+		if(resolvedMeshes.empty())
+		{
+			if(!meshes[i].indicies.empty())
+				Logger::LogLine(LOG_TYPE::FATAL, "Found f before usemtl");
+
+			continue;
+		}
+
+		Mesh& previousMesh = resolvedMeshes.back();
+		previousMesh.vertices.insert(previousMesh.vertices.end(), meshes[i].vertices.begin(), meshes[i].vertices.end());
+		previousMesh.indicies.insert(previousMesh.indicies.end(), meshes[i].indicies.begin(), meshes[i].indicies.end());
+	}
+
+	meshes = std::move(resolvedMeshes);
+	meshMaterials.clear();
+
 	return true;
 }
 
@@ -308,8 +386,11 @@ void OBJFile::ProcessM(const std::string& line, ContentManager* contentManager)
 {
 	if(line.compare(0, 6, "mtllib") == 0)
 	{
-		if(mtlLib == nullptr)
-			mtlLib = contentManager->Load<MTLLib>(line.substr(line.find_first_of("\t ") + 1));
+		if(mtlLibPath.IsEmpty())
+		{
+			mtlLibPath = line.substr(line.find_first_of("\t ") + 1);
+			contentManager->Prefetch<MTLLib>(mtlLibPath);
+		}
 		else
 			Logger::LogLine(LOG_TYPE::WARNING, "Found multiple mtllibs in OBJ-file \"" + line + "\"");
 	}
@@ -319,18 +400,8 @@ void OBJFile::ProcessU(const std::string& line)
 {
 	if(line.compare(0, 7, "usemtl ") == 0)
 	{
-		Mesh newMesh;
-
-		try
-		{
-			newMesh.material = (*mtlLib)[line.substr(line.find_first_of("\t ") + 1)];
-
-			meshes.push_back(std::move(newMesh));
-		}
-		catch(std::out_of_range&)
-		{
-			Logger::LogLine(LOG_TYPE::WARNING, "Tried to use non-existent material \"" + line.substr(line.find_first_of("\t ") + 1) + "\"");
-		}
+		meshes.emplace_back();
+		meshMaterials.push_back(line.substr(line.find_first_of("\t ") + 1));
 	}
 }
 
@@ -451,6 +522,14 @@ void OBJFile::Unload(ContentManager* contentManager /*= nullptr*/)
 }
 
 bool MTLLib::Load(const std::string& path, ID3D11Device* device, ContentManager* contentManager /*= nullptr*/, ContentParameters* contentParameters /*= nullptr*/)
+{
+	if(!LoadAsync(path, contentManager, contentParameters))
+		return false;
+
+	return FinalizeAsync(path, device, contentManager, contentParameters);
+}
+
+bool MTLLib::LoadAsync(const std::string& path, ContentManager* contentManager, ContentParameters* contentParameters)
 {
 	std::ifstream in(path);
 	if(!in.is_open())
@@ -458,7 +537,8 @@ bool MTLLib::Load(const std::string& path, ID3D11Device* device, ContentManager*
 
 	std::string line = "#";
 
-	Material newMaterial;
+	std::string materialName;
+	MaterialPaths newMaterialPaths;
 	while(getline(in, line))
 	{
 		if(line.find('#') != line.npos)
@@ -471,34 +551,74 @@ bool MTLLib::Load(const std::string& path, ID3D11Device* device, ContentManager*
 
 		if(line.compare(0, 6, "newmtl") == 0)
 		{
-			if(newMaterial.name != "")
+			if(materialName != "")
 			{
-				materials.insert(std::make_pair(newMaterial.name, newMaterial));
-				newMaterial = Material();
+				materialPaths.insert(std::make_pair(materialName, newMaterialPaths));
+				newMaterialPaths = MaterialPaths();
 			}
 
-			newMaterial.name = line.substr(line.find_first_of("\t ") + 1);
+			materialName = line.substr(line.find_first_of("\t ") + 1);
 		}
 		else if(line.compare(0, 6, "map_Kd") == 0)
 		{
-			newMaterial.diffuseTexture = contentManager->Load<Texture2D>(line.substr(line.find_first_of("\t ") + 1));
+			newMaterialPaths.diffuseTexture = line.substr(line.find_first_of("\t ") + 1);
+			contentManager->Prefetch<Texture2D>(newMaterialPaths.diffuseTexture);
+		}
+		else if(line.compare(0, 8, "map_Bump") == 0)
+		{
+			newMaterialPaths.normalTexture = line.substr(line.find_first_of("\t ") + 1);
+			contentManager->Prefetch<Texture2D>(newMaterialPaths.normalTexture);
+		}
+	}
+
+	if(materialName != "")
+		materialPaths.insert(std::make_pair(materialName, newMaterialPaths));
+
+	return true;
+}
+
+bool MTLLib::FinalizeAsync(const std::string& path, ID3D11Device* device, ContentManager* contentManager, ContentParameters* contentParameters)
+{
+	//Materials often share textures. Only the first use of each is looked up by path, the rest go straight to its slot
+	std::unordered_map<ContentPath, TypedContentID<Texture2D>, ContentPath::Hasher> textureIDs;
+
+	auto loadTexture = [&](const ContentPath& texturePath)
+	{
+		auto iter = textureIDs.find(texturePath);
+		if(iter != textureIDs.end())
+			return contentManager->Load(iter->second);
+
+		Texture2D* texture = contentManager->Load<Texture2D>(texturePath);
+		if(texture != nullptr)
+			textureIDs.insert(std::make_pair(texturePath, contentManager->GetID(texture)));
+
+		return texture;
+	};
+
+	for(const auto& pair : materialPaths)
+	{
+		Material newMaterial;
+		newMaterial.name = pair.first;
+
+		if(!pair.second.diffuseTexture.IsEmpty())
+		{
+			newMaterial.diffuseTexture = loadTexture(pair.second.diffuseTexture);
 			if(newMaterial.diffuseTexture == nullptr)
 				return false;
 		}
-		else if(line.compare(0, 8, "map_Bump") == 0)
+
+		if(!pair.second.normalTexture.IsEmpty())
 		{
-			newMaterial.normalTexture = contentManager->Load<Texture2D>(line.substr(line.find_first_of("\t ") + 1));
+			newMaterial.normalTexture = loadTexture(pair.second.normalTexture);
 			if(newMaterial.normalTexture == nullptr)
 				return false;
 		}
-	}
 
-	if(newMaterial.name != "")
-	{
 		materials.insert(std::make_pair(newMaterial.name, newMaterial));
-		newMaterial = Material();
 	}
 
+	materialPaths.clear();
+
 	return true;
 }
 
@@ -513,3 +633,18 @@ Material MTLLib::operator[](const std::string& i)
 	return materials.at(i);
 }
 
+size_t MTLLib::GetCPUSize() const
+{
+	size_t size = sizeof(MTLLib);
+
+	for(const auto& pair : materials)
+		size += sizeof(pair) + pair.first.capacity() + pair.second.name.capacity();
+
+	return size;
+}
+
+size_t MTLLib::GetGPUSize() const
+{
+	return 0; //Textures are their own content
+}
+
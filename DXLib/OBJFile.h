@@ -75,6 +75,14 @@ struct Material
 	Texture2D* normalTexture;
 };
 
+//Texture paths of a material, read in MTLLib::LoadAsync and turned into textures in MTLLib::FinalizeAsync
+struct MaterialPaths
+{
+	//Hashed once on the worker, then reused by Prefetch and Load
+	ContentPath diffuseTexture;
+	ContentPath normalTexture;
+};
+
 class MTLLib
 	: public Content
 {
@@ -89,8 +97,15 @@ public:
 	//Throws std::ouf_of_range
 	Material operator[](const std::string& i);
 
+	size_t GetCPUSize() const override;
+	size_t GetGPUSize() const override;
+
 private:
 	std::map<std::string, Material> materials;
+	std::map<std::string, MaterialPaths> materialPaths;
+
+	bool LoadAsync(const std::string& path, ContentManager* contentManager, ContentParameters* contentParameters) override;
+	bool FinalizeAsync(const std::string& path, ID3D11Device* device, ContentManager* contentManager, ContentParameters* contentParameters) override;
 };
 
 struct Mesh
@@ -112,14 +127,21 @@ public:
 	OBJFile();
 	~OBJFile();
 
-	std::vector<Mesh> GetMeshes() const;
+	//Valid until the file is unloaded
+	const std::vector<Mesh>& GetMeshes() const;
+
+	size_t GetCPUSize() const override;
+	size_t GetGPUSize() const override;
 
 private:
 	typedef std::unordered_map<int, std::unordered_map<int, std::unordered_map<int, int>>> VertexMap;
 
 	MTLLib* mtlLib;
+	ContentPath mtlLibPath;
 
 	std::vector<Mesh> meshes;
+	//Material name of each mesh. Materials are resolved in FinalizeAsync since MTLLib needs the device
+	std::vector<std::string> meshMaterials;
 
 	void ProcessF(const std::string& line, VertexMap& vertexMap, int& indexCount, const std::vector<DirectX::XMFLOAT3>& v, std::vector<DirectX::XMFLOAT3>& vn, std::vector<DirectX::XMFLOAT2>& vt);
 	void ProcessM(const std::string& line, ContentManager* contentManager);
@@ -128,6 +150,9 @@ private:
 
 	void Unload(ContentManager* contentManager = nullptr) override;
 	bool Load(const std::string& path, ID3D11Device* device, ContentManager* contentManager = nullptr, ContentParameters* contentParameters = nullptr) override;
+
+	bool LoadAsync(const std::string& path, ContentManager* contentManager, ContentParameters* contentParameters) override;
+	bool FinalizeAsync(const std::string& path, ID3D11Device* device, ContentManager* contentManager, ContentParameters* contentParameters) override;
 };
 
 #endif // OBJFile_h__
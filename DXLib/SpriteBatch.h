@@ -1,29 +1,28 @@
 #ifndef _OPENGLWINDOW_SPRITEBATCH_H_
 #define _OPENGLWINDOW_SPRITEBATCH_H_
 
-#include "batchData.h"
-
-#include <vector>
+struct ID3D11ShaderResourceView;
 
+//A range of instances drawn with the same texture
 struct SpriteBatch
 {
 public:
 	SpriteBatch()
 		: textureResourceView(nullptr)
+		, firstInstance(0)
+		, instanceCount(0)
 	{}
-	SpriteBatch(ID3D11ShaderResourceView* textureResourceView)
+	SpriteBatch(ID3D11ShaderResourceView* textureResourceView, unsigned int firstInstance, unsigned int instanceCount)
 		: textureResourceView(textureResourceView)
+		, firstInstance(firstInstance)
+		, instanceCount(instanceCount)
 	{}
-	SpriteBatch(ID3D11ShaderResourceView* texture, BatchData firstElement)
-		: SpriteBatch(texture)
-	{
-		batchData.emplace_back(firstElement);
-	}
 
 	~SpriteBatch() = default;
 
 	ID3D11ShaderResourceView* textureResourceView;
-	std::vector<BatchData> batchData;
+	unsigned int firstInstance;
+	unsigned int instanceCount;
 };
 
 #endif //_OPENGLWINDOW_SPRITEBATCH_H_
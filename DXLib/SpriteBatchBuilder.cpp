@@ -0,0 +1,107 @@
+#include "SpriteBatchBuilder.h"
+
+#include <algorithm>
+
+SpriteBatchBuilder::SpriteBatchBuilder(unsigned int maxLookback /*= 16*/)
+	: maxLookback(maxLookback)
+{
+}
+
+void SpriteBatchBuilder::Add(ID3D11ShaderResourceView* texture, const BatchData& instance)
+{
+	unsigned int batchIndex = static_cast<unsigned int>(batches.size());
+
+	//Walk backwards until a batch with the same texture is found. Anything overlapping
+	//on the way would be drawn in the wrong order if the sprite was moved past it
+	for(unsigned int i = 0; i < maxLookback && i < batches.size(); ++i)
+	{
+		unsigned int candidate = static_cast<unsigned int>(batches.size()) - 1 - i;
+
+		if(batches[candidate].texture == texture)
+		{
+			batchIndex = candidate;
+			break;
+		}
+
+		if(Overlaps(instance, batches[candidate]))
+			break;
+	}
+
+	if(batchIndex == batches.size())
+	{
+		PendingBatch newBatch;
+		newBatch.texture = texture;
+		newBatch.instanceCount = 0;
+		newBatch.boundsMin = instance.positionMin;
+		newBatch.boundsMax = instance.positionMax;
+
+		batches.push_back(newBatch);
+	}
+
+	PendingBatch& batch = batches[batchIndex];
+	batch.instanceCount++;
+	batch.boundsMin.x = std::min(batch.boundsMin.x, std::min(instance.positionMin.x, instance.positionMax.x));
+	batch.boundsMin.y = std::min(batch.boundsMin.y, std::min(instance.positionMin.y, instance.positionMax.y));
+	batch.boundsMax.x = std::max(batch.boundsMax.x, std::max(instance.positionMin.x, instance.positionMax.x));
+	batch.boundsMax.y = std::max(batch.boundsMax.y, std::max(instance.positionMin.y, instance.positionMax.y));
+
+	instances.push_back(instance);
+	instanceBatches.push_back(batchIndex);
+}
+
+void SpriteBatchBuilder::Build(std::vector<BatchData>& outInstances, std::vector<SpriteBatch>& outBatches) const
+{
+	outInstances.resize(instances.size());
+	outBatches.clear();
+
+	//Counting sort by batch, submission order is kept inside each batch
+	batchOffsets.resize(batches.size());
+
+	unsigned int offset = 0;
+	for(size_t i = 0; i < batches.size(); ++i)
+	{
+		batchOffsets[i] = offset;
+		outBatches.emplace_back(batches[i].texture, offset, batches[i].instanceCount);
+
+		offset += batches[i].instanceCount;
+	}
+
+	for(size_t i = 0; i < instances.size(); ++i)
+		outInstances[batchOffsets[instanceBatches[i]]++] = instances[i];
+}
+
+void SpriteBatchBuilder::Clear()
+{
+	instances.clear();
+	instanceBatches.clear();
+	batches.clear();
+}
+
+unsigned int SpriteBatchBuilder::GetInstanceCount() const
+{
+	return static_cast<unsigned int>(instances.size());
+}
+
+unsigned int SpriteBatchBuilder::GetBatchCount() const
+{
+	return static_cast<unsigned int>(batches.size());
+}
+
+bool SpriteBatchBuilder::IsEmpty() const
+{
+	return instances.empty();
+}
+
+bool SpriteBatchBuilder::Overlaps(const BatchData& instance, const PendingBatch& batch)
+{
+	float minX = std::min(instance.positionMin.x, instance.positionMax.x);
+	float minY = std::min(instance.positionMin.y, instance.positionMax.y);
+	float maxX = std::max(instance.positionMin.x, instance.positionMax.x);
+	float maxY = std::max(instance.positionMin.y, instance.positionMax.y);
+
+	//Touching edges don't count, characters in a string are placed right next to each other
+	return minX < batch.boundsMax.x
+		&& maxX > batch.boundsMin.x
+		&& minY < batch.boundsMax.y
+		&& maxY > batch.boundsMin.y;
+}
\ No newline at end of file
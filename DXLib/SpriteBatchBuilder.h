@@ -0,0 +1,69 @@
+#ifndef SpriteBatchBuilder_h__
+#define SpriteBatchBuilder_h__
+
+#include <vector>
+
+#include "BatchData.h"
+#include "SpriteBatch.h"
+
+/*Groups sprites into as few texture batches as possible without changing what ends up on screen.
+* A sprite is moved into an earlier batch with the same texture only if it doesn't overlap anything
+* drawn between that batch and itself, so blending and overdraw look the same as drawing in submission order.
+* Doesn't touch D3D, SpriteRenderer uploads the result
+*/
+class SpriteBatchBuilder
+{
+public:
+	//************************************
+	// Method:		SpriteBatchBuilder
+	// FullName:	SpriteBatchBuilder::SpriteBatchBuilder
+	// Access:		public 
+	// Returns:		
+	// Qualifier:
+	// Argument:	unsigned int maxLookback - how many batches back to look for one with the same texture
+	//************************************
+	explicit SpriteBatchBuilder(unsigned int maxLookback = 16);
+	~SpriteBatchBuilder() = default;
+
+	void Add(ID3D11ShaderResourceView* texture, const BatchData& instance);
+
+	//************************************
+	// Method:		Build
+	// FullName:	SpriteBatchBuilder::Build
+	// Access:		public 
+	// Returns:		void
+	// Qualifier:	const
+	// Argument:	std::vector<BatchData>& outInstances - every instance, ordered by batch
+	// Argument:	std::vector<SpriteBatch>& outBatches - batches in draw order
+	// Description:	Both vectors are cleared first. Reuse them between calls to avoid allocating
+	//************************************
+	void Build(std::vector<BatchData>& outInstances, std::vector<SpriteBatch>& outBatches) const;
+	void Clear();
+
+	unsigned int GetInstanceCount() const;
+	unsigned int GetBatchCount() const;
+	bool IsEmpty() const;
+
+private:
+	struct PendingBatch
+	{
+		ID3D11ShaderResourceView* texture;
+		unsigned int instanceCount;
+
+		//Union of every instance's rectangle
+		DirectX::XMFLOAT2 boundsMin;
+		DirectX::XMFLOAT2 boundsMax;
+	};
+
+	unsigned int maxLookback;
+
+	std::vector<BatchData> instances; //In submission order
+	std::vector<unsigned int> instanceBatches; //Batch index of every instance
+	std::vector<PendingBatch> batches;
+
+	mutable std::vector<unsigned int> batchOffsets; //Scratch for Build
+
+	static bool Overlaps(const BatchData& instance, const PendingBatch& batch);
+};
+
+#endif // SpriteBatchBuilder_h__
\ No newline at end of file
@@ -0,0 +1,56 @@
+#ifndef SpriteDrawList_h__
+#define SpriteDrawList_h__
+
+#include <vector>
+
+#include "batchData.h"
+
+struct ID3D11ShaderResourceView;
+
+//Sprites recorded by SpriteRenderer between BeginRecording and EndRecording.
+//Replaying it with SpriteRenderer::Draw skips everything that went into generating the sprites
+class SpriteDrawList
+{
+public:
+	SpriteDrawList() = default;
+	~SpriteDrawList() = default;
+
+	void Add(ID3D11ShaderResourceView* texture, const BatchData& instance)
+	{
+		textures.push_back(texture);
+		instances.push_back(instance);
+	}
+
+	//Keeps the memory so re-recording doesn't allocate
+	void Clear()
+	{
+		textures.clear();
+		instances.clear();
+	}
+
+	unsigned int GetSize() const
+	{
+		return static_cast<unsigned int>(instances.size());
+	}
+
+	bool IsEmpty() const
+	{
+		return instances.empty();
+	}
+
+	ID3D11ShaderResourceView* GetTexture(unsigned int index) const
+	{
+		return textures[index];
+	}
+
+	const BatchData& GetInstance(unsigned int index) const
+	{
+		return instances[index];
+	}
+
+private:
+	std::vector<ID3D11ShaderResourceView*> textures;
+	std::vector<BatchData> instances;
+};
+
+#endif // SpriteDrawList_h__
\ No newline at end of file
@@ -2,21 +2,20 @@
 #include "texture2DCreateParameters.h"
 #include "logger.h"
 
+#include <cstring>
+
 #include "SamplerStates.h"
 #include "DepthStencilStates.h"
 #include "BlendStates.h"
 #include "RasterizerStates.h"
 
 SpriteRenderer::SpriteRenderer()
-	: vertexBufferArrayInserts(0)
-	, bufferInserts(0)
-	, vertexDataStreamOffset(0)
-	, indexDataStreamOffset(0)
-	, drawOffset(0)
+	: instanceBufferOffset(0)
 	, vertexShader("main", "vs_5_0")
 	, pixelShader("main", "ps_5_0")
 	, vertexBuffer(nullptr)
 	, indexBuffer(nullptr)
+	, instanceBuffer(nullptr)
 	, samplerState(nullptr)
 	, rasterizerState(nullptr)
 	, blendState(nullptr)
@@ -39,7 +38,7 @@ void SpriteRenderer::Init(ID3D11Device* device, ID3D11DeviceContext* context, Co
 	defaultScissorRect.right = xRes;
 	defaultScissorRect.bottom = yRes;
 
-	vertexBufferArrayInserts = 0;
+	instanceBufferOffset = 0;
 
 	hasBegun = false;
 
@@ -92,9 +91,11 @@ void SpriteRenderer::Init(ID3D11Device* device, ID3D11DeviceContext* context, Co
 		return;
 	}
 
+	//Corner per vertex, the rest is a BatchData per instance
 	vertexShader.SetVertexData(device
-		, std::vector<VERTEX_INPUT_DATA> { VERTEX_INPUT_DATA::FLOAT2, VERTEX_INPUT_DATA::FLOAT2, VERTEX_INPUT_DATA::FLOAT4 }
-	, std::vector<std::string> { "POSITION", "TEXCOORDS", "COLOR" });
+		, std::vector<VERTEX_INPUT_DATA> { VERTEX_INPUT_DATA::FLOAT2, VERTEX_INPUT_DATA::FLOAT2, VERTEX_INPUT_DATA::FLOAT2, VERTEX_INPUT_DATA::FLOAT2, VERTEX_INPUT_DATA::FLOAT2, VERTEX_INPUT_DATA::FLOAT4 }
+		, std::vector<std::string> { "CORNER", "POSITION_MIN", "POSITION_MAX", "TEXCOORDS_MIN", "TEXCOORDS_MAX", "COLOR" }
+		, std::vector<bool> { false, true, true, true, true, true });
 
 	pixelShader.CreateFromFile("SpriteRendererPixelShader.hlsl", device);
 	if(!errorString.empty())
@@ -106,15 +107,27 @@ void SpriteRenderer::Init(ID3D11Device* device, ID3D11DeviceContext* context, Co
 	////////////////////////////////////////////////////////////
 	//Create buffers
 	////////////////////////////////////////////////////////////
+	//Top left, top right, bottom right, bottom left
+	float corners[] =
+	{
+		0.0f, 0.0f,
+		1.0f, 0.0f,
+		1.0f, 1.0f,
+		0.0f, 1.0f
+	};
+
 	D3D11_BUFFER_DESC vertexDesc;
 	ZeroMemory(&vertexDesc, sizeof(vertexDesc));
-	vertexDesc.Usage = D3D11_USAGE_DYNAMIC;
-	vertexDesc.ByteWidth = VERTEX_BUFFER_SIZE;
+	vertexDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	vertexDesc.ByteWidth = sizeof(corners);
 	vertexDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vertexDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+	D3D11_SUBRESOURCE_DATA vertexData;
+	ZeroMemory(&vertexData, sizeof(vertexData));
+	vertexData.pSysMem = &corners[0];
 
 	ID3D11Buffer* vertexBufferDumb;
-	hRes = device->CreateBuffer(&vertexDesc, nullptr, &vertexBufferDumb);
+	hRes = device->CreateBuffer(&vertexDesc, &vertexData, &vertexBufferDumb);
 	vertexBuffer.reset(vertexBufferDumb);
 	if(FAILED(hRes))
 	{
@@ -122,15 +135,24 @@ void SpriteRenderer::Init(ID3D11Device* device, ID3D11DeviceContext* context, Co
 		return;
 	}
 
+	unsigned short indices[] =
+	{
+		0, 3, 2, //Top left, bottom left, bottom right
+		2, 1, 0 //Bottom right, top right, top left
+	};
+
 	D3D11_BUFFER_DESC indexDesc;
 	ZeroMemory(&indexDesc, sizeof(indexDesc));
-	indexDesc.Usage = D3D11_USAGE_DYNAMIC;
-	indexDesc.ByteWidth = INDEX_BUFFER_SIZE;
+	indexDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	indexDesc.ByteWidth = sizeof(indices);
 	indexDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	indexDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+	D3D11_SUBRESOURCE_DATA indexData;
+	ZeroMemory(&indexData, sizeof(indexData));
+	indexData.pSysMem = &indices[0];
 
 	ID3D11Buffer* indexBufferDumb;
-	hRes = device->CreateBuffer(&indexDesc, nullptr, &indexBufferDumb);
+	hRes = device->CreateBuffer(&indexDesc, &indexData, &indexBufferDumb);
 	indexBuffer.reset(indexBufferDumb);
 	if(FAILED(hRes))
 	{
@@ -138,6 +160,25 @@ void SpriteRenderer::Init(ID3D11Device* device, ID3D11DeviceContext* context, Co
 		return;
 	}
 
+	D3D11_BUFFER_DESC instanceDesc;
+	ZeroMemory(&instanceDesc, sizeof(instanceDesc));
+	instanceDesc.Usage = D3D11_USAGE_DYNAMIC;
+	instanceDesc.ByteWidth = INSTANCE_BUFFER_SIZE;
+	instanceDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	instanceDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+	ID3D11Buffer* instanceBufferDumb;
+	hRes = device->CreateBuffer(&instanceDesc, nullptr, &instanceBufferDumb);
+	instanceBuffer.reset(instanceBufferDumb);
+	if(FAILED(hRes))
+	{
+		Logger::LogLine(LOG_TYPE::FATAL, "Couldn't create sprite renderer instance buffer");
+		return;
+	}
+
+	sortedInstances.reserve(MAX_BUFFER_INSERTS);
+	spriteBatches.reserve(MAX_BUFFER_INSERTS);
+
 	samplerState = SamplerStates::linearClamp;
 	rasterizerState = RasterizerStates::solid;
 	blendState = BlendStates::singleDefault;
@@ -166,15 +207,18 @@ void SpriteRenderer::Begin()
 	defaultStencilRef = 0;
 	context->OMGetDepthStencilState(&defaultDepthStencilState, &defaultStencilRef);
 
+	context->IAGetPrimitiveTopology(&defaultTopology);
+
 	//////////////////////////////////////////////////
 	//Set
 	//////////////////////////////////////////////////
-	UINT stride = sizeof(Vertex2D);
-	UINT offset = 0;
+	UINT strides[] = { sizeof(float) * 2, sizeof(BatchData) };
+	UINT offsets[] = { 0, 0 };
 
-	context->IASetIndexBuffer(indexBuffer.get(), DXGI_FORMAT_R32_UINT, 0);
-	ID3D11Buffer* vertexBufferDumb = vertexBuffer.get();
-	context->IASetVertexBuffers(0, 1, &vertexBufferDumb, &stride, &offset);
+	context->IASetIndexBuffer(indexBuffer.get(), DXGI_FORMAT_R16_UINT, 0);
+	ID3D11Buffer* vertexBuffersDumb[] = { vertexBuffer.get(), instanceBuffer.get() };
+	context->IASetVertexBuffers(0, 2, vertexBuffersDumb, strides, offsets);
+	context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	
 	vertexShader.Bind(context);
 	pixelShader.Bind(context);
@@ -205,8 +249,7 @@ void SpriteRenderer::Begin()
 	ID3D11Buffer* viewProjBufferDumb = viewProjBuffer.get();
 	context->VSSetConstantBuffers(0, 1, &viewProjBufferDumb);
 
-	bufferInserts = 0;
-	currentTexture = 0;
+	batchBuilder.Clear();
 
 	hasBegun = true;
 }
@@ -216,15 +259,15 @@ void SpriteRenderer::End()
 	if(!hasBegun)
 		Logger::LogLine(LOG_TYPE::WARNING, "SpriteRenderer::End called without begin");
 
-	if(spriteBatch.size() > 0)
+	if(!batchBuilder.IsEmpty())
 		Draw();
 
 	//Unbind
-	context->IASetIndexBuffer(nullptr, DXGI_FORMAT_R32_UINT, 0);
-	ID3D11Buffer* vertexBufferDumb = nullptr;
-	UINT stride = 0;
-	UINT offset = 0;
-	context->IASetVertexBuffers(0, 1, &vertexBufferDumb, &stride, &offset);
+	context->IASetIndexBuffer(nullptr, DXGI_FORMAT_R16_UINT, 0);
+	ID3D11Buffer* vertexBuffersDumb[] = { nullptr, nullptr };
+	UINT strides[] = { 0, 0 };
+	UINT offsets[] = { 0, 0 };
+	context->IASetVertexBuffers(0, 2, vertexBuffersDumb, strides, offsets);
 
 	vertexShader.Unbind(context);
 	pixelShader.Unbind(context);
@@ -242,6 +285,7 @@ void SpriteRenderer::End()
 	context->OMSetBlendState(defaultBlendState, defaultBlendFactors, defaultBlendMask);
 	context->RSSetState(defaultRasterizerState);
 	context->OMSetDepthStencilState(defaultDepthStencilState, defaultStencilRef);
+	context->IASetPrimitiveTopology(defaultTopology);
 
 	hasBegun = false;
 }
@@ -281,29 +325,13 @@ void SpriteRenderer::Draw(const Texture2D& texture2D, const DirectX::XMFLOAT2& p
 
 	DirectX::XMStoreFloat2(&clipMax, DirectX::XMVectorMultiply(xmLhs, xmRhs));
 
-	if(currentTexture == texture2D.GetTexture())
-	{
-		spriteBatch.back().batchData.emplace_back(position
+	AddSprite(texture2D.GetTextureResourceView()
+		, BatchData(
+			position
 			, texCoordsMax
 			, clipMin
 			, clipMax
-			, color);
-	}
-	else
-	{
-		currentTexture = texture2D.GetTexture();
-		spriteBatch.emplace_back(texture2D.GetTextureResourceView()
-			, BatchData(
-				position
-				, texCoordsMax
-				, clipMin
-				, clipMax
-				, color));
-	}
-
-	bufferInserts++;
-	if(bufferInserts == MAX_BUFFER_INSERTS)
-		Draw();
+			, color));
 }
 
 void SpriteRenderer::Draw(const Texture2D& texture2D, const Rect& position, const Rect& clipRect, const DirectX::XMFLOAT4& color)
@@ -326,148 +354,104 @@ void SpriteRenderer::Draw(const Texture2D& texture2D, const Rect& position, cons
 
 	DirectX::XMStoreFloat2(&clipMax, DirectX::XMVectorMultiply(xmLhs, xmRhs));
 
-	if(currentTexture == texture2D.GetTexture())
-	{
-		spriteBatch.back().batchData.emplace_back(
-				position.GetMinPosition()
+	AddSprite(texture2D.GetTextureResourceView()
+		, BatchData(
+			position.GetMinPosition()
 			, position.GetMaxPosition()
 			, clipMin
 			, clipMax
-			, color);
-	}
-	else
-	{
-		currentTexture = texture2D.GetTexture();
-		spriteBatch.emplace_back(texture2D.GetTextureResourceView()
-			, BatchData(
-				position.GetMinPosition()
-				, position.GetMaxPosition()
-				, clipMin
-				, clipMin
-				, color));
-	}
-
-	bufferInserts++;
-	if(bufferInserts == MAX_BUFFER_INSERTS)
-		Draw();
+			, color));
 }
 
 void SpriteRenderer::Draw(const Rect& drawRect, const DirectX::XMFLOAT4& color /*= DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f)*/)
 {
-	if(currentTexture == whiteTexture->GetTexture())
-	{
-		spriteBatch.back().batchData.emplace_back(
+	AddSprite(whiteTexture->GetTextureResourceView()
+		, BatchData(
 			drawRect.GetMinPosition()
 			, drawRect.GetMaxPosition()
 			, DirectX::XMFLOAT2(0.0f, 0.0f)
 			, DirectX::XMFLOAT2(1.0f, 1.0f)
-			, color);
-	}
-	else
-	{
-		currentTexture = whiteTexture->GetTexture();
-		spriteBatch.emplace_back(whiteTexture->GetTextureResourceView()
-			, BatchData(
-				drawRect.GetMinPosition()
-				, drawRect.GetMaxPosition()
-				, DirectX::XMFLOAT2(0.0f, 0.0f)
-				, DirectX::XMFLOAT2(1.0f, 1.0f), color));
-	}
+			, color));
+}
 
-	bufferInserts++;
-	if(bufferInserts == MAX_BUFFER_INSERTS)
-		Draw();
+void SpriteRenderer::Draw(const SpriteDrawList& drawList, unsigned int begin, unsigned int end)
+{
+	for(unsigned int i = begin; i < end; ++i)
+		SubmitSprite(drawList.GetTexture(i), drawList.GetInstance(i));
 }
 
-void SpriteRenderer::Draw()
+void SpriteRenderer::BeginRecording(SpriteDrawList* drawList)
+{
+	recordingDrawLists.push_back(drawList);
+}
+
+void SpriteRenderer::EndRecording()
 {
-	//Transfer to temp vectors
-	std::vector<Vertex2D> vertices;
-	vertices.reserve(bufferInserts * 4);
+	if(recordingDrawLists.empty())
+	{
+		Logger::LogLine(LOG_TYPE::WARNING, "SpriteRenderer::EndRecording called without a matching BeginRecording");
+		return;
+	}
 
-	std::vector<unsigned int> indicies;
-	vertices.reserve(bufferInserts * 6);
+	recordingDrawLists.pop_back();
+}
 
-	vertexBufferArrayInserts = 0;
+void SpriteRenderer::AddSprite(ID3D11ShaderResourceView* texture, const BatchData& instance)
+{
+	if(!recordingDrawLists.empty())
+		recordingDrawLists.back()->Add(texture, instance);
 
-	//Buffers are bound in Begin()
-	unsigned int currentInserts = 0;
-	for(const SpriteBatch& batch : spriteBatch)
-	{
-		//////////////////////////////////////////////////////////////////////////
-		//Fill buffer with data
-		//////////////////////////////////////////////////////////////////////////
-		for(const BatchData& data : batch.batchData)
-		{
-			Vertex2D vertex2D;
-			//Top left
-			vertices.emplace_back(data.positionMin, data.texCoordsMin, data.color);
+	SubmitSprite(texture, instance);
+}
 
-			//Top right
-			vertices.emplace_back(data.positionMax.x, data.positionMin.y, data.texCoordsMax.x, data.texCoordsMin.y, data.color);
+void SpriteRenderer::SubmitSprite(ID3D11ShaderResourceView* texture, const BatchData& instance)
+{
+	batchBuilder.Add(texture, instance);
 
-			//Bottom right
-			vertices.emplace_back(data.positionMax, data.texCoordsMax, data.color);
+	if(batchBuilder.GetInstanceCount() == MAX_BUFFER_INSERTS)
+		Draw();
+}
 
-			//Bottom left
-			vertices.emplace_back(data.positionMin.x, data.positionMax.y, data.texCoordsMin.x, data.texCoordsMax.y, data.color);
+void SpriteRenderer::Draw()
+{
+	if(batchBuilder.IsEmpty())
+		return;
 
-			//ELEMENT BUFFER
-			indicies.emplace_back(vertexBufferArrayInserts * 4); //Top left
-			indicies.emplace_back(vertexBufferArrayInserts * 4 + 3); //Bottom left
-			indicies.emplace_back(vertexBufferArrayInserts * 4 + 2); //Bottom right
-			indicies.emplace_back(vertexBufferArrayInserts * 4 + 2); //Bottom right
-			indicies.emplace_back(vertexBufferArrayInserts * 4 + 1); //Top right
-			indicies.emplace_back(vertexBufferArrayInserts * 4); //Top left
+	batchBuilder.Build(sortedInstances, spriteBatches);
+	batchBuilder.Clear();
 
-			currentInserts++;
-			vertexBufferArrayInserts++;
-		}
-	}
+	unsigned int instanceCount = static_cast<unsigned int>(sortedInstances.size());
 
 	//////////////////////////////////////////////////////////////////////////
 	//MAP
 	//////////////////////////////////////////////////////////////////////////
-	D3D11_MAPPED_SUBRESOURCE mappedVertexBuffer;
-	if(FAILED(context->Map(vertexBuffer.get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedVertexBuffer)))
+	//Append after whatever the GPU might still be reading. Only discard when the buffer is full
+	D3D11_MAP mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
+	if(instanceBufferOffset + instanceCount > MAX_INSTANCE_BUFFER_INSERTS)
 	{
-		Logger::LogLine(LOG_TYPE::FATAL, "Couldn't map vertex/index buffer!");
-		assert("Couldn't map vertex buffer!");
+		mapType = D3D11_MAP_WRITE_DISCARD;
+		instanceBufferOffset = 0;
 	}
 
-	D3D11_MAPPED_SUBRESOURCE mappedIndexBuffer;
-	if(FAILED(context->Map(indexBuffer.get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedIndexBuffer)))
+	D3D11_MAPPED_SUBRESOURCE mappedInstanceBuffer;
+	if(FAILED(context->Map(instanceBuffer.get(), 0, mapType, 0, &mappedInstanceBuffer)))
 	{
-		Logger::LogLine(LOG_TYPE::FATAL, "Couldn't map vertex/index buffer!");
-		assert("Couldn't map vertex buffer!");
+		Logger::LogLine(LOG_TYPE::FATAL, "Couldn't map sprite renderer instance buffer!");
+		return;
 	}
 
-	memcpy(mappedVertexBuffer.pData, &vertices[0], sizeof(Vertex2D) * vertices.size());
-	memcpy(mappedIndexBuffer.pData, &indicies[0], sizeof(unsigned int) * indicies.size());
-
-	//glUnmapBuffer(GL_ARRAY_BUFFER);
-	//glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
-
-	context->Unmap(vertexBuffer.get(), 0);
-	context->Unmap(indexBuffer.get(), 0);
+	std::memcpy(static_cast<BatchData*>(mappedInstanceBuffer.pData) + instanceBufferOffset, &sortedInstances[0], sizeof(BatchData) * instanceCount);
 
-	drawOffset = 0;
+	context->Unmap(instanceBuffer.get(), 0);
 
-	for(const SpriteBatch& batch : spriteBatch)
+	//Buffers are bound in Begin()
+	for(const SpriteBatch& batch : spriteBatches)
 	{
 		context->PSSetShaderResources(0, 1, &batch.textureResourceView);
-		context->DrawIndexed(static_cast<unsigned int>(batch.batchData.size()) * 6, drawOffset, 0);
-
-		//glBindTexture(GL_TEXTURE_2D, batch.texture);
-		//glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(batch.batchData.size()) * 6, GL_UNSIGNED_INT, reinterpret_cast<void*>(drawOffset * 6 * sizeof(GLuint)));
-
-		drawOffset += static_cast<unsigned int>(batch.batchData.size()) * 6;
+		context->DrawIndexedInstanced(6, batch.instanceCount, 0, 0, instanceBufferOffset + batch.firstInstance);
 	}
 
-	spriteBatch.clear();
-	bufferInserts = 0;
-	currentTexture = 0;
-	drawOffset = 0;
+	instanceBufferOffset += instanceCount;
 }
 
 void SpriteRenderer::Reload()
@@ -483,7 +467,7 @@ void SpriteRenderer::SetResolution(int xRes, int yRes) //TODO
 
 void SpriteRenderer::EnableScissorTest(Rect region)
 {
-	//if(bufferInserts > 0)
+	//if(!batchBuilder.IsEmpty())
 	//	Draw();
 
 	/*D3D11_RECT rect;
@@ -500,7 +484,7 @@ void SpriteRenderer::EnableScissorTest(Rect region)
 
 void SpriteRenderer::DisableScissorTest()
 {
-	//if(bufferInserts > 0)
+	//if(!batchBuilder.IsEmpty())
 	//	Draw();
 
 	//context->RSSetScissorRects(1, &defaultScissorRect);
@@ -512,7 +496,7 @@ void SpriteRenderer::DrawString(const CharacterSet* characterSet, const Construc
 {
 	for(const CharacterBlock& block : text.characterBlocks)
 	{
-		for(const Character* character : block.characters)
+		for(const Character* character : text.GetGlyphs(block))
 		{
 			DirectX::XMFLOAT2 drawPosition(position.x + character->xOffset, position.y + character->yOffset);
 
@@ -534,7 +518,7 @@ void SpriteRenderer::DrawString(const CharacterSet* characterSet, const Construc
 	{
 		if(static_cast<int>(block.width) + currentWidth <= maxWidth)
 		{
-			for(const Character* character : block.characters)
+			for(const Character* character : text.GetGlyphs(block))
 			{
 				DirectX::XMFLOAT2 drawPosition(position.x + character->xOffset, position.y + character->yOffset);
 
@@ -546,7 +530,7 @@ void SpriteRenderer::DrawString(const CharacterSet* characterSet, const Construc
 		}
 		else
 		{
-			for(const Character* character : block.characters)
+			for(const Character* character : text.GetGlyphs(block))
 			{
 				if(currentWidth + character->xAdvance > maxWidth)
 					return;
@@ -579,12 +563,12 @@ void SpriteRenderer::DrawString(const CharacterSet* characterSet, const Construc
 	auto blockIter = text.characterBlocks.begin();
 	for(; blockIter != text.characterBlocks.end(); ++blockIter)
 	{
-		if(currentIndex + blockIter->characters.size() < startIndex)
-			currentIndex += static_cast<int>(blockIter->characters.size());
-		else if(currentIndex + blockIter->characters.size() == startIndex) //startIndex is at the end of the current character block
+		if(currentIndex + blockIter->length < startIndex)
+			currentIndex += blockIter->length;
+		else if(currentIndex + blockIter->length == startIndex) //startIndex is at the end of the current character block
 		{
 			position.x += characterSet->GetSpaceXAdvance(); //"Draw" a space
-			currentIndex += static_cast<int>(blockIter->characters.size());
+			currentIndex += blockIter->length;
 		}
 		else
 			break;
@@ -594,14 +578,16 @@ void SpriteRenderer::DrawString(const CharacterSet* characterSet, const Construc
 
 	for(auto end = text.characterBlocks.end(); blockIter != end && currentIndex < startIndex + count; ++blockIter)
 	{
-		auto characterIter = blockIter->characters.begin();
+		GlyphRange blockGlyphs = text.GetGlyphs(*blockIter);
+
+		auto characterIter = blockGlyphs.begin();
 		if(currentIndex < startIndex) //TODO: Move out of loop?
 		{
 			characterIter += (startIndex - currentIndex);
 			currentIndex = startIndex;
 		}
 
-		for(; characterIter != blockIter->characters.end() && currentIndex != startIndex + count; ++characterIter)
+		for(; characterIter != blockGlyphs.end() && currentIndex != startIndex + count; ++characterIter)
 		{
 			const Character* character = *characterIter;
 
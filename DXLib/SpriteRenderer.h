@@ -7,10 +7,11 @@
 #include "rect.h"
 #include "texture2D.h"
 #include "contentManager.h"
-#include "vertex2D.h"
 
 #include "characterSet.h"
 #include "spriteBatch.h"
+#include "spriteBatchBuilder.h"
+#include "spriteDrawList.h"
 #include "texture2DCreateParameters.h"
 
 #include "VertexShader.h"
@@ -41,8 +42,33 @@ public:
 	void Draw(const Texture2D& texture2D, const DirectX::XMFLOAT2& position, const Rect& clipRect, const DirectX::XMFLOAT4& color = DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f));
 	void Draw(const Texture2D& texture2D, const Rect& position, const Rect& clipRect, const DirectX::XMFLOAT4& color = DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f));
 	void Draw(const Rect& drawRect, const DirectX::XMFLOAT4& color = DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f));
+	//************************************
+	// Method:		Draw
+	// FullName:	SpriteRenderer::Draw
+	// Access:		public 
+	// Returns:		void
+	// Qualifier:
+	// Argument:	const SpriteDrawList& drawList
+	// Argument:	unsigned int begin - first sprite to draw
+	// Argument:	unsigned int end - one past the last sprite to draw
+	// Description:	Replays sprites recorded with BeginRecording. Replayed sprites are never recorded again
+	//************************************
+	void Draw(const SpriteDrawList& drawList, unsigned int begin, unsigned int end);
 	void Draw();
 
+	//************************************
+	// Method:		BeginRecording
+	// FullName:	SpriteRenderer::BeginRecording
+	// Access:		public 
+	// Returns:		void
+	// Qualifier:
+	// Argument:	SpriteDrawList* drawList
+	// Description:	Every sprite drawn until EndRecording is also added to drawList. Recordings can be nested,
+	// sprites only go to the innermost draw list
+	//************************************
+	void BeginRecording(SpriteDrawList* drawList);
+	void EndRecording();
+
 	void Reload();
 
 	void EnableScissorTest(Rect region);
@@ -62,8 +88,9 @@ private:
 	//////////////////////////////////////////////////////////////////////////
 	ID3D11DeviceContext* context;
 
-	COMUniquePtr<ID3D11Buffer> vertexBuffer;
-	COMUniquePtr<ID3D11Buffer> indexBuffer;
+	COMUniquePtr<ID3D11Buffer> vertexBuffer; //The four corners of a sprite, never changes
+	COMUniquePtr<ID3D11Buffer> indexBuffer; //Six indices, never changes
+	COMUniquePtr<ID3D11Buffer> instanceBuffer; //One BatchData per sprite, written as a ring buffer
 	ID3D11SamplerState* samplerState;
 
 	ID3D11RasterizerState* rasterizerState;
@@ -77,6 +104,7 @@ private:
 	UINT defaultBlendMask;
 	ID3D11DepthStencilState* defaultDepthStencilState;
 	UINT defaultStencilRef;
+	D3D11_PRIMITIVE_TOPOLOGY defaultTopology;
 
 	//SimpleShaderProgram shaderProgram;
 	VertexShader vertexShader;
@@ -86,30 +114,33 @@ private:
 	COMUniquePtr<ID3D11Buffer> viewProjBuffer;
 	DirectX::XMFLOAT4X4 projectionMatrix;
 
-	const int MAX_BUFFER_INSERTS = 2048;
+	//Sprites per flush
+	const unsigned int MAX_BUFFER_INSERTS = 2048;
+
+	//Instances are appended with NO_OVERWRITE until the buffer is full, then it's discarded and writing starts over
+	const unsigned int MAX_INSTANCE_BUFFER_INSERTS = MAX_BUFFER_INSERTS * 8;
+	const unsigned int INSTANCE_BUFFER_SIZE = MAX_INSTANCE_BUFFER_INSERTS * sizeof(BatchData);
 
-	//Vertex2D = 32 bytes (with padding)
-	const unsigned int MAX_VERTEX_BUFFER_INSERTS = MAX_BUFFER_INSERTS * 4;
-	const unsigned int VERTEX_BUFFER_SIZE = MAX_VERTEX_BUFFER_INSERTS * sizeof(Vertex2D);
-	const unsigned int MAX_INDEX_BUFFER_INSERTS = MAX_BUFFER_INSERTS * 6;
-	const unsigned int INDEX_BUFFER_SIZE = MAX_INDEX_BUFFER_INSERTS * sizeof(unsigned int);
+	unsigned int instanceBufferOffset; //In instances
 
-	unsigned int vertexBufferArrayInserts;
-	unsigned int bufferInserts;
+	SpriteBatchBuilder batchBuilder;
 
-	std::vector<SpriteBatch> spriteBatch;
+	//Output of batchBuilder, kept around so flushing doesn't allocate
+	std::vector<BatchData> sortedInstances;
+	std::vector<SpriteBatch> spriteBatches;
 
-	unsigned int vertexDataStreamOffset;
-	unsigned int indexDataStreamOffset;
-	unsigned int drawOffset;
+	//Innermost recording last
+	std::vector<SpriteDrawList*> recordingDrawLists;
+
+	//Records the sprite if needed, then calls SubmitSprite
+	void AddSprite(ID3D11ShaderResourceView* texture, const BatchData& instance);
+	void SubmitSprite(ID3D11ShaderResourceView* texture, const BatchData& instance);
 
 	//For easy drawing of rectangles via Draw()
 	Texture2D* whiteTexture;
 	Rect whiteTextureClipRect;
 
 	Rect resolutionRect;
-
-	ID3D11Resource* currentTexture;
 };
 
 #endif // SpriteRenderer_h__
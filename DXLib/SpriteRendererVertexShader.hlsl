@@ -1,7 +1,13 @@
 struct VSIn
 {
-	float2 position : POSITION;
-	float2 texCoords : TEXCOORDS;
+	//Per vertex, (0, 0) is top left and (1, 1) is bottom right
+	float2 corner : CORNER;
+
+	//Per instance
+	float2 positionMin : POSITION_MIN;
+	float2 positionMax : POSITION_MAX;
+	float2 texCoordsMin : TEXCOORDS_MIN;
+	float2 texCoordsMax : TEXCOORDS_MAX;
 	float4 color : COLOR;
 };
 
@@ -21,8 +27,10 @@ VSOut main(VSIn inData)
 {
 	VSOut outData;
 
-	outData.position = mul(float4(inData.position, 0.5f, 1.0f), viewProjMatrix);
-	outData.texCoords = inData.texCoords;
+	float2 position = lerp(inData.positionMin, inData.positionMax, inData.corner);
+
+	outData.position = mul(float4(position, 0.5f, 1.0f), viewProjMatrix);
+	outData.texCoords = lerp(inData.texCoordsMin, inData.texCoordsMax, inData.corner);
 	outData.color = inData.color;
 
 	return outData;
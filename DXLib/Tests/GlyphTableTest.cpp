@@ -0,0 +1,106 @@
+//Standalone test of GlyphTable, builds without D3D. See CMakeLists.txt in this directory
+
+#include "../GlyphTable.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+	int failures = 0;
+
+	void Check(bool condition, const char* what, int line)
+	{
+		if(!condition)
+		{
+			std::printf("Line %d: %s\n", line, what);
+			++failures;
+		}
+	}
+
+#define CHECK(condition) Check((condition), #condition, __LINE__)
+
+	//xAdvance is set to the index so it's clear which glyph was found
+	Character GetGlyph(int id, int index)
+	{
+		return Character(id, 0, 0, 0, 0, 0, 0, static_cast<unsigned short>(index));
+	}
+
+	bool Finds(const GlyphTable& table, const std::vector<Character>& glyphs, unsigned int id)
+	{
+		const Character* character = table.Find(glyphs, id);
+
+		return character != nullptr && static_cast<unsigned int>(character->id) == id;
+	}
+
+	//Printable ASCII plus a couple of ids above the BMP
+	void TestSmallFont()
+	{
+		std::vector<Character> glyphs;
+		for(int id = ' '; id <= '~'; ++id)
+			glyphs.push_back(GetGlyph(id, static_cast<int>(glyphs.size())));
+		glyphs.push_back(GetGlyph(0x1F600, static_cast<int>(glyphs.size())));
+		glyphs.push_back(GetGlyph(0x1F601, static_cast<int>(glyphs.size())));
+
+		GlyphTable table;
+		CHECK(table.Build(glyphs));
+
+		CHECK(Finds(table, glyphs, 'A'));
+		CHECK(Finds(table, glyphs, '?'));
+		CHECK(Finds(table, glyphs, 0x1F600));
+		CHECK(Finds(table, glyphs, 0x1F601));
+
+		CHECK(table.Find(glyphs, '\t') == nullptr);
+		CHECK(table.Find(glyphs, 0x00E5) == nullptr);
+		CHECK(table.Find(glyphs, 0xFFFF) == nullptr);
+		CHECK(table.Find(glyphs, 0x1F602) == nullptr);
+
+		table.Clear();
+
+		//Without the flat table everything is binary searched
+		CHECK(Finds(table, glyphs, 'A'));
+		CHECK(table.Find(glyphs, '\t') == nullptr);
+	}
+
+	//Too many glyphs for 16 bit indices, BMP ids have to be found by the binary search as well
+	void TestLargeFont()
+	{
+		std::vector<Character> glyphs;
+		for(int id = 0; id < 70000; ++id)
+		{
+			//Leave a few holes, including one in the BMP
+			if(id == 0x41 || id == 0x10010)
+				continue;
+
+			glyphs.push_back(GetGlyph(id, static_cast<int>(glyphs.size())));
+		}
+
+		CHECK(glyphs.size() >= GlyphTable::INVALID_GLYPH_INDEX);
+
+		GlyphTable table;
+		CHECK(!table.Build(glyphs));
+		CHECK(table.GetCPUSize() == 0);
+
+		CHECK(Finds(table, glyphs, 0));
+		CHECK(Finds(table, glyphs, '?'));
+		CHECK(Finds(table, glyphs, 0x1234));
+		CHECK(Finds(table, glyphs, 0xFFFF));
+		CHECK(Finds(table, glyphs, 0x10000));
+		CHECK(Finds(table, glyphs, 69999));
+
+		CHECK(table.Find(glyphs, 0x41) == nullptr);
+		CHECK(table.Find(glyphs, 0x10010) == nullptr);
+		CHECK(table.Find(glyphs, 70000) == nullptr);
+	}
+}
+
+int main()
+{
+	TestSmallFont();
+	TestLargeFont();
+
+	if(failures == 0)
+		std::printf("All GlyphTable tests passed\n");
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+//Standalone test of SpriteBatchBuilder, builds without D3D. See CMakeLists.txt in this directory
+
+#include "../SpriteBatchBuilder.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+	int failures = 0;
+
+	void Check(bool condition, const char* what, int line)
+	{
+		if(!condition)
+		{
+			std::printf("Line %d: %s\n", line, what);
+			++failures;
+		}
+	}
+
+#define CHECK(condition) Check((condition), #condition, __LINE__)
+
+	//Only compared, never dereferenced
+	ID3D11ShaderResourceView* GetTexture(uintptr_t id)
+	{
+		return reinterpret_cast<ID3D11ShaderResourceView*>(id);
+	}
+
+	//Unit square at x, y. color.x identifies the sprite
+	BatchData GetSprite(float x, float y, float id)
+	{
+		return BatchData(DirectX::XMFLOAT2(x, y), DirectX::XMFLOAT2(x + 1.0f, y + 1.0f), DirectX::XMFLOAT2(0.0f, 0.0f), DirectX::XMFLOAT2(1.0f, 1.0f), DirectX::XMFLOAT4(id, 0.0f, 0.0f, 1.0f));
+	}
+
+	//Sprites that don't overlap are merged into the earlier batch with the same texture
+	void TestMerge()
+	{
+		SpriteBatchBuilder builder;
+		builder.Add(GetTexture(1), GetSprite(0.0f, 0.0f, 0.0f));
+		builder.Add(GetTexture(2), GetSprite(2.0f, 0.0f, 1.0f));
+		builder.Add(GetTexture(1), GetSprite(4.0f, 0.0f, 2.0f));
+		builder.Add(GetTexture(2), GetSprite(6.0f, 0.0f, 3.0f));
+		//Touching edges don't count as overlapping
+		builder.Add(GetTexture(1), GetSprite(1.0f, 0.0f, 4.0f));
+
+		std::vector<BatchData> instances;
+		std::vector<SpriteBatch> batches;
+		builder.Build(instances, batches);
+
+		CHECK(builder.GetInstanceCount() == 5);
+		CHECK(batches.size() == 2);
+		CHECK(instances.size() == 5);
+
+		if(batches.size() != 2 || instances.size() != 5)
+			return;
+
+		CHECK(batches[0].textureResourceView == GetTexture(1));
+		CHECK(batches[0].firstInstance == 0);
+		CHECK(batches[0].instanceCount == 3);
+		CHECK(batches[1].textureResourceView == GetTexture(2));
+		CHECK(batches[1].firstInstance == 3);
+		CHECK(batches[1].instanceCount == 2);
+
+		//Submission order is kept inside each batch
+		const float expectedOrder[] = { 0.0f, 2.0f, 4.0f, 1.0f, 3.0f };
+		for(int i = 0; i < 5; ++i)
+			CHECK(instances[i].color.x == expectedOrder[i]);
+	}
+
+	//A sprite isn't moved past anything it overlaps, so draw order is kept
+	void TestOverlap()
+	{
+		SpriteBatchBuilder builder;
+		builder.Add(GetTexture(1), GetSprite(0.0f, 0.0f, 0.0f));
+		builder.Add(GetTexture(2), GetSprite(0.5f, 0.5f, 1.0f));
+		builder.Add(GetTexture(1), GetSprite(0.25f, 0.25f, 2.0f));
+
+		std::vector<BatchData> instances;
+		std::vector<SpriteBatch> batches;
+		builder.Build(instances, batches);
+
+		CHECK(batches.size() == 3);
+		if(batches.size() != 3)
+			return;
+
+		CHECK(batches[0].textureResourceView == GetTexture(1));
+		CHECK(batches[1].textureResourceView == GetTexture(2));
+		CHECK(batches[2].textureResourceView == GetTexture(1));
+
+		for(int i = 0; i < 3; ++i)
+		{
+			CHECK(batches[i].firstInstance == static_cast<unsigned int>(i));
+			CHECK(batches[i].instanceCount == 1);
+			CHECK(instances[i].color.x == static_cast<float>(i));
+		}
+	}
+
+	//Batches further back than maxLookback aren't searched
+	void TestLookback()
+	{
+		SpriteBatchBuilder builder(2);
+		builder.Add(GetTexture(1), GetSprite(0.0f, 0.0f, 0.0f));
+		builder.Add(GetTexture(2), GetSprite(2.0f, 0.0f, 1.0f));
+		builder.Add(GetTexture(3), GetSprite(4.0f, 0.0f, 2.0f));
+		builder.Add(GetTexture(1), GetSprite(6.0f, 0.0f, 3.0f));
+
+		CHECK(builder.GetBatchCount() == 4);
+
+		builder.Add(GetTexture(3), GetSprite(8.0f, 0.0f, 4.0f));
+
+		CHECK(builder.GetBatchCount() == 4);
+	}
+
+	//Output vectors are cleared by Build and the builder is empty after Clear
+	void TestReuse()
+	{
+		SpriteBatchBuilder builder;
+		builder.Add(GetTexture(1), GetSprite(0.0f, 0.0f, 0.0f));
+
+		std::vector<BatchData> instances(10);
+		std::vector<SpriteBatch> batches(10);
+		builder.Build(instances, batches);
+
+		CHECK(instances.size() == 1);
+		CHECK(batches.size() == 1);
+
+		builder.Clear();
+
+		CHECK(builder.IsEmpty());
+		CHECK(builder.GetBatchCount() == 0);
+
+		builder.Build(instances, batches);
+
+		CHECK(instances.empty());
+		CHECK(batches.empty());
+	}
+}
+
+int main()
+{
+	TestMerge();
+	TestOverlap();
+	TestLookback();
+	TestReuse();
+
+	if(failures == 0)
+		std::printf("All SpriteBatchBuilder tests passed\n");
+
+	return failures == 0 ? 0 : 1;
+}
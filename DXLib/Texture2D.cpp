@@ -12,23 +12,151 @@
 #include <fstream>
 #include <vector>
 
+namespace
+{
+	//Estimates the size of a texture from its description. Block compressed formats store 4x4 texels per block
+	size_t GetTextureSize(const D3D11_TEXTURE2D_DESC& desc)
+	{
+		size_t blockSize = 0;
+		size_t bytesPerTexel = 4;
+
+		switch(desc.Format)
+		{
+			case DXGI_FORMAT_BC1_TYPELESS:
+			case DXGI_FORMAT_BC1_UNORM:
+			case DXGI_FORMAT_BC1_UNORM_SRGB:
+			case DXGI_FORMAT_BC4_TYPELESS:
+			case DXGI_FORMAT_BC4_UNORM:
+			case DXGI_FORMAT_BC4_SNORM:
+				blockSize = 8;
+				break;
+			case DXGI_FORMAT_BC2_TYPELESS:
+			case DXGI_FORMAT_BC2_UNORM:
+			case DXGI_FORMAT_BC2_UNORM_SRGB:
+			case DXGI_FORMAT_BC3_TYPELESS:
+			case DXGI_FORMAT_BC3_UNORM:
+			case DXGI_FORMAT_BC3_UNORM_SRGB:
+			case DXGI_FORMAT_BC5_TYPELESS:
+			case DXGI_FORMAT_BC5_UNORM:
+			case DXGI_FORMAT_BC5_SNORM:
+			case DXGI_FORMAT_BC6H_TYPELESS:
+			case DXGI_FORMAT_BC6H_UF16:
+			case DXGI_FORMAT_BC6H_SF16:
+			case DXGI_FORMAT_BC7_TYPELESS:
+			case DXGI_FORMAT_BC7_UNORM:
+			case DXGI_FORMAT_BC7_UNORM_SRGB:
+				blockSize = 16;
+				break;
+			case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+			case DXGI_FORMAT_R32G32B32A32_FLOAT:
+			case DXGI_FORMAT_R32G32B32A32_UINT:
+			case DXGI_FORMAT_R32G32B32A32_SINT:
+				bytesPerTexel = 16;
+				break;
+			case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+			case DXGI_FORMAT_R16G16B16A16_FLOAT:
+			case DXGI_FORMAT_R16G16B16A16_UNORM:
+			case DXGI_FORMAT_R16G16B16A16_UINT:
+			case DXGI_FORMAT_R16G16B16A16_SNORM:
+			case DXGI_FORMAT_R16G16B16A16_SINT:
+			case DXGI_FORMAT_R32G32_TYPELESS:
+			case DXGI_FORMAT_R32G32_FLOAT:
+			case DXGI_FORMAT_R32G32_UINT:
+			case DXGI_FORMAT_R32G32_SINT:
+				bytesPerTexel = 8;
+				break;
+			case DXGI_FORMAT_R8_TYPELESS:
+			case DXGI_FORMAT_R8_UNORM:
+			case DXGI_FORMAT_R8_UINT:
+			case DXGI_FORMAT_R8_SNORM:
+			case DXGI_FORMAT_R8_SINT:
+			case DXGI_FORMAT_A8_UNORM:
+				bytesPerTexel = 1;
+				break;
+			default:
+				break;
+		}
+
+		size_t size = 0;
+
+		unsigned int width = desc.Width;
+		unsigned int height = desc.Height;
+
+		for(unsigned int i = 0; i < desc.MipLevels; ++i)
+		{
+			if(blockSize > 0)
+				size += ((width + 3) / 4) * ((height + 3) / 4) * blockSize;
+			else
+				size += width * height * bytesPerTexel;
+
+			width = width > 1 ? width / 2 : 1;
+			height = height > 1 ? height / 2 : 1;
+		}
+
+		return size * desc.ArraySize;
+	}
+}
+
 Texture2D::Texture2D()
 	: texture(nullptr)
 	, textureResourceView(nullptr)
 	, size(0, 0)
 	, predivSize(0.0f, 0.0f)
+	, gpuSize(0)
 {
 }
 
 bool Texture2D::Load(const std::string& path, ID3D11Device* device, ContentManager* contentManager /*= nullptr*/, ContentParameters* contentParameters /*= nullptr*/)
+{
+	if(!LoadAsync(path, contentManager, contentParameters))
+		return false;
+
+	return FinalizeAsync(path, device, contentManager, contentParameters);
+}
+
+bool Texture2D::LoadAsync(const std::string& path, ContentManager* contentManager, ContentParameters* contentParameters)
+{
+	//Textures created from memory are created in FinalizeAsync
+	if(path == "")
+		return true;
+
+	std::ifstream in(path, std::ios::binary | std::ios::ate);
+	if(!in.is_open())
+	{
+		Logger::LogLine(LOG_TYPE::FATAL, "Couldn't open file at \"" + path + "\"");
+		return false;
+	}
+
+	std::streamoff fileSize = in.tellg();
+	in.seekg(0, std::ios::beg);
+
+	fileData.resize(static_cast<size_t>(fileSize));
+
+	if(fileSize > 0
+		&& !in.read(reinterpret_cast<char*>(&fileData[0]), fileSize))
+	{
+		Logger::LogLine(LOG_TYPE::FATAL, "Couldn't read file at \"" + path + "\"");
+		fileData.clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool Texture2D::FinalizeAsync(const std::string& path, ID3D11Device* device, ContentManager* contentManager, ContentParameters* contentParameters)
 {
 	if(path != "")
 	{
 		ID3D11Resource* resource = nullptr;
 
-		if(FAILED(DirectX::CreateDDSTextureFromFile(device, std::wstring(path.begin(), path.end()).c_str(), &resource, &textureResourceView)))
+		HRESULT hRes = fileData.empty() ? E_FAIL : DirectX::CreateDDSTextureFromMemory(device, &fileData[0], fileData.size(), &resource, &textureResourceView);
+
+		//The data has been uploaded to the device (or is useless), don't keep it around
+		std::vector<uint8_t>().swap(fileData);
+
+		if(FAILED(hRes))
 		{
-			Logger::LogLine(LOG_TYPE::FATAL, "Couldn't open file at \"" + path + "\"");
+			Logger::LogLine(LOG_TYPE::FATAL, "Couldn't create texture from file at \"" + path + "\"");
 			return false;
 		}
 
@@ -88,6 +216,8 @@ bool Texture2D::Load(const std::string& path, ID3D11Device* device, ContentManag
 	predivSize.x = 1.0f / size.x;
 	predivSize.y = 1.0f / size.y;
 
+	gpuSize = GetTextureSize(texDesc);
+
 	return true;
 }
 
@@ -133,4 +263,14 @@ DirectX::XMINT2 Texture2D::GetSize() const
 DirectX::XMFLOAT2 Texture2D::GetPredivSize() const
 {
 	return predivSize;
+}
+
+size_t Texture2D::GetCPUSize() const
+{
+	return sizeof(Texture2D) + fileData.capacity();
+}
+
+size_t Texture2D::GetGPUSize() const
+{
+	return gpuSize;
 }
\ No newline at end of file
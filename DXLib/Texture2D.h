@@ -5,6 +5,9 @@
 
 #include <DirectXMath.h>
 
+#include <vector>
+#include <cstdint>
+
 class Texture2D 
 	: public Content
 {
@@ -21,6 +24,9 @@ public:
 	DirectX::XMINT2 GetSize() const;
 	DirectX::XMFLOAT2 GetPredivSize() const;
 
+	size_t GetCPUSize() const override;
+	size_t GetGPUSize() const override;
+
 	friend bool operator==(const Texture2D& lhs, const Texture2D& rhs);
 	friend bool operator!=(const Texture2D& lhs, const Texture2D& rhs);
 private:
@@ -30,8 +36,16 @@ private:
 	DirectX::XMINT2 size;
 	DirectX::XMFLOAT2 predivSize;
 
+	size_t gpuSize;
+
+	//Contents of the .dds file between LoadAsync and FinalizeAsync
+	std::vector<uint8_t> fileData;
+
 	bool Load(const std::string& path, ID3D11Device* device, ContentManager* contentManager = nullptr, ContentParameters* contentParameters = nullptr) override;
 	void Unload(ContentManager* contentManager = nullptr) override;
+
+	bool LoadAsync(const std::string& path, ContentManager* contentManager, ContentParameters* contentParameters) override;
+	bool FinalizeAsync(const std::string& path, ID3D11Device* device, ContentManager* contentManager, ContentParameters* contentParameters) override;
 };
 
 inline bool operator==(const Texture2D& lhs, const Texture2D& rhs)
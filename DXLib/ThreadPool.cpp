@@ -0,0 +1,83 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool()
+	: stopping(false)
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+	Stop();
+}
+
+void ThreadPool::Init(unsigned int threadCount /*= 0*/)
+{
+	Stop();
+
+	if(threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency() - 1);
+
+	stopping = false;
+
+	workers.reserve(threadCount);
+	for(unsigned int i = 0; i < threadCount; ++i)
+		workers.emplace_back(&ThreadPool::WorkerMain, this);
+}
+
+void ThreadPool::Stop()
+{
+	if(workers.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		stopping = true;
+	}
+
+	queueCondition.notify_all();
+
+	for(std::thread& worker : workers)
+		worker.join();
+
+	workers.clear();
+}
+
+unsigned int ThreadPool::GetThreadCount() const
+{
+	return static_cast<unsigned int>(workers.size());
+}
+
+bool ThreadPool::IsWorkerThread() const
+{
+	std::thread::id currentThread = std::this_thread::get_id();
+
+	for(const std::thread& worker : workers)
+		if(worker.get_id() == currentThread)
+			return true;
+
+	return false;
+}
+
+void ThreadPool::WorkerMain()
+{
+	while(true)
+	{
+		std::function<void()> task;
+
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			queueCondition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+
+			//Drain the queue before stopping so no future is left without a value
+			if(tasks.empty())
+				return;
+
+			task = std::move(tasks.front());
+			tasks.pop();
+		}
+
+		task();
+	}
+}
@@ -0,0 +1,129 @@
+#ifndef ThreadPool_h__
+#define ThreadPool_h__
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+
+//Fixed size pool of worker threads. Tasks are run in the order they are enqueued
+class ThreadPool
+{
+public:
+	ThreadPool();
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	//************************************
+	// Method:		Init
+	// FullName:	ThreadPool::Init
+	// Access:		public 
+	// Returns:		void
+	// Qualifier:	
+	// Argument:	unsigned int threadCount - number of workers. 0 uses one worker per hardware thread except the calling one
+	// Description:	Starts the workers. Calling Init on a running pool stops it first
+	//************************************
+	void Init(unsigned int threadCount = 0);
+	//************************************
+	// Method:		Stop
+	// FullName:	ThreadPool::Stop
+	// Access:		public 
+	// Returns:		void
+	// Qualifier:	
+	// Description:	Runs every task that has already been enqueued and then joins the workers
+	//************************************
+	void Stop();
+
+	//************************************
+	// Method:		Enqueue
+	// FullName:	ThreadPool::Enqueue
+	// Access:		public 
+	// Returns:		std::future<R> - result of function
+	// Qualifier:	
+	// Argument:	F&& function - callable taking no arguments
+	// Description:	Runs function on a worker. If the pool hasn't been started the function is run on the calling thread
+	//************************************
+	template<typename F>
+	std::future<typename std::result_of<F()>::type> Enqueue(F&& function)
+	{
+		typedef typename std::result_of<F()>::type ReturnType;
+
+		auto task = std::make_shared<std::packaged_task<ReturnType()>>(std::forward<F>(function));
+		std::future<ReturnType> future = task->get_future();
+
+		if(workers.empty())
+		{
+			(*task)();
+			return future;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			tasks.emplace([task]() { (*task)(); });
+		}
+
+		queueCondition.notify_one();
+
+		return future;
+	}
+
+	//************************************
+	// Method:		ParallelFor
+	// FullName:	ThreadPool::ParallelFor
+	// Access:		public 
+	// Returns:		void
+	// Qualifier:	
+	// Argument:	int count
+	// Argument:	int grainSize - indices per task
+	// Argument:	F function - void(int begin, int end), called once for each range in [0, count)
+	// Description:	Runs the ranges on the workers and returns once all of them are done. Everything is run on the
+	//				calling thread if it's a worker, since waiting for the pool from inside it could deadlock
+	//************************************
+	template<typename F>
+	void ParallelFor(int count, int grainSize, F function)
+	{
+		if(count <= grainSize
+			|| workers.empty()
+			|| IsWorkerThread())
+		{
+			if(count > 0)
+				function(0, count);
+
+			return;
+		}
+
+		std::vector<std::future<void>> ranges;
+		ranges.reserve(count / grainSize + 1);
+
+		for(int begin = 0; begin < count; begin += grainSize)
+		{
+			int end = begin + grainSize < count ? begin + grainSize : count;
+
+			ranges.push_back(Enqueue([&function, begin, end]() { function(begin, end); }));
+		}
+
+		for(std::future<void>& range : ranges)
+			range.get();
+	}
+
+	unsigned int GetThreadCount() const;
+	bool IsWorkerThread() const;
+
+private:
+	std::vector<std::thread> workers;
+	std::queue<std::function<void()>> tasks;
+
+	std::mutex queueMutex;
+	std::condition_variable queueCondition;
+	bool stopping;
+
+	void WorkerMain();
+};
+
+#endif // ThreadPool_h__
@@ -0,0 +1,402 @@
+#include "xmlReader.h"
+
+#include <cstring>
+
+#include "Logger.h"
+
+namespace
+{
+	bool IsWhitespace(char character)
+	{
+		return character == ' ' || character == '\t' || character == '\n' || character == '\r';
+	}
+}
+
+////////////////////////////////////////////////////////////
+//XMLElementView
+////////////////////////////////////////////////////////////
+XMLStringView XMLElementView::GetName() const
+{
+	return name;
+}
+
+XMLStringView XMLElementView::GetContents() const
+{
+	return contents;
+}
+
+unsigned int XMLElementView::GetDepth() const
+{
+	return depth;
+}
+
+size_t XMLElementView::GetAttributeCount() const
+{
+	return attributeCount;
+}
+
+const XMLAttributeView& XMLElementView::GetAttribute(size_t index) const
+{
+	return attributes[index];
+}
+
+XMLStringView XMLElementView::GetAttribute(const char* name) const
+{
+	for(size_t i = 0; i < attributeCount; ++i)
+		if(attributes[i].name == name)
+			return attributes[i].value;
+
+	return XMLStringView();
+}
+
+bool XMLElementView::AttributeExists(const char* name) const
+{
+	for(size_t i = 0; i < attributeCount; ++i)
+		if(attributes[i].name == name)
+			return true;
+
+	return false;
+}
+
+////////////////////////////////////////////////////////////
+//XMLReader
+////////////////////////////////////////////////////////////
+XMLReader::XMLReader()
+	: begin(nullptr)
+	, end(nullptr)
+	, current(nullptr)
+{
+}
+
+XMLReader::~XMLReader()
+{
+}
+
+bool XMLReader::Open(const std::string& path)
+{
+	Close();
+
+	if(!file.Open(path))
+	{
+		Logger::LogLine(LOG_TYPE::FATAL, "XML-error while parsing \"" + path + "\": Couldn't open file at " + path);
+		return false;
+	}
+
+	begin = file.GetData();
+	end = begin + file.GetSize();
+	current = begin;
+
+	currentFile = path;
+
+	return true;
+}
+
+void XMLReader::Open(const char* data, size_t size)
+{
+	Close();
+
+	begin = data;
+	end = data + size;
+	current = begin;
+
+	currentFile = "memory";
+}
+
+void XMLReader::Close()
+{
+	file.Close();
+
+	begin = nullptr;
+	end = nullptr;
+	current = nullptr;
+
+	attributes.clear();
+	elementStack.clear();
+
+	currentFile = "";
+}
+
+size_t XMLReader::GetSize() const
+{
+	return static_cast<size_t>(end - begin);
+}
+
+bool XMLReader::Parse(const std::function<void(const XMLElementView&)>& onElementBegin, const std::function<void(const XMLStringView&)>& onElementEnd /*= nullptr*/)
+{
+	if(begin == end)
+		return ShowErrorWithInfo("Document is empty or hasn't been opened");
+
+	current = begin;
+	elementStack.clear();
+
+	//UTF-8 byte order mark
+	if(end - current >= 3 && std::memcmp(current, "\xEF\xBB\xBF", 3) == 0)
+		current += 3;
+
+	XMLElementView element;
+
+	while(true)
+	{
+		SkipWhitespace();
+
+		if(current == end)
+			break;
+
+		if(*current != '<')
+		{
+			//Text after a child element. Contents are only read directly after the start tag (same as XMLFile) so skip it
+			if(elementStack.empty())
+				return ShowErrorWithInfo("Unexpected character! Expected <, got '" + std::string(1, *current) + "'!");
+
+			const char* nextTag = static_cast<const char*>(std::memchr(current, '<', end - current));
+			if(nextTag == nullptr)
+				return ShowErrorWithInfo("Unexpected end of file reached!");
+
+			current = nextTag;
+		}
+
+		++current; //Skip <
+
+		if(current == end)
+			return ShowErrorWithInfo("Unexpected end of file reached!");
+
+		/*There are four cases:
+		* <? (ignored)
+		* <! (ignore until "-->", or ">" if it isn't a comment)
+		* </tag (validate)
+		* <tag ... (parse element)
+		*/
+		if(*current == '?')
+		{
+			if(!SkipPast("?>"))
+				return ShowErrorWithInfo("No end found for <?");
+		}
+		else if(*current == '!')
+		{
+			if(end - current >= 3 && current[1] == '-' && current[2] == '-')
+			{
+				if(!SkipPast("-->"))
+					return ShowErrorWithInfo("No end found for comment");
+			}
+			else if(!SkipPast(">"))
+				return ShowErrorWithInfo("No end found for <!");
+		}
+		else if(*current == '/')
+		{
+			++current;
+
+			XMLStringView closedElement;
+			if(!ParseEndTag(closedElement))
+				return false;
+
+			if(elementStack.empty())
+				return ShowErrorWithInfo("Found end tag \"" + closedElement.ToString() + "\" without a start tag!");
+
+			if(closedElement != elementStack.back())
+				return ShowErrorWithInfo("Close doesn't match open! Expected \"" + elementStack.back().ToString() + "\", got \"" + closedElement.ToString() + "\"!");
+
+			elementStack.pop_back();
+
+			if(onElementEnd != nullptr)
+				onElementEnd(closedElement);
+		}
+		else
+		{
+			bool selfClosing = false;
+			if(!ParseStartTag(element, selfClosing))
+				return false;
+
+			element.depth = static_cast<unsigned int>(elementStack.size());
+			element.contents = selfClosing ? XMLStringView() : ParseContents();
+
+			if(onElementBegin != nullptr)
+				onElementBegin(element);
+
+			if(!selfClosing)
+				elementStack.push_back(element.name);
+			else if(onElementEnd != nullptr)
+				onElementEnd(element.name);
+		}
+	}
+
+	if(!elementStack.empty())
+		return ShowErrorWithInfo("Reached end of file but \"" + elementStack.back().ToString() + "\" was never closed!");
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////
+//PARSING
+////////////////////////////////////////////////////////////
+void XMLReader::SkipWhitespace()
+{
+	while(current != end && IsWhitespace(*current))
+		++current;
+}
+
+bool XMLReader::SkipPast(const char* terminator)
+{
+	size_t terminatorLength = std::strlen(terminator);
+
+	while(true)
+	{
+		const char* found = static_cast<const char*>(std::memchr(current, terminator[0], end - current));
+
+		if(found == nullptr
+			|| static_cast<size_t>(end - found) < terminatorLength)
+		{
+			current = end;
+			return false;
+		}
+
+		if(std::memcmp(found, terminator, terminatorLength) == 0)
+		{
+			current = found + terminatorLength;
+			return true;
+		}
+
+		current = found + 1;
+	}
+}
+
+bool XMLReader::ParseStartTag(XMLElementView& outElement, bool& selfClosing)
+{
+	attributes.clear();
+
+	outElement.name = ParseName();
+	if(outElement.name.IsEmpty())
+		return ShowErrorWithInfo("New element expected but none found!");
+
+	while(true)
+	{
+		SkipWhitespace();
+
+		if(current == end)
+			return ShowErrorWithInfo("Ran out of file to read while parsing \"" + outElement.name.ToString() + "\"");
+
+		if(*current == '>')
+		{
+			++current;
+			selfClosing = false;
+			break;
+		}
+		else if(*current == '/')
+		{
+			++current;
+
+			if(current == end || *current != '>')
+				return ShowErrorWithInfo("Unexpected character! Expected > after /");
+
+			++current;
+			selfClosing = true;
+			break;
+		}
+
+		XMLAttributeView attribute;
+
+		attribute.name = ParseName();
+		if(attribute.name.IsEmpty())
+			return ShowErrorWithInfo("Unexpected character! Expected attribute name, got '" + std::string(1, *current) + "'!");
+
+		SkipWhitespace();
+		if(current == end || *current != '=')
+			return ShowErrorWithInfo("Unexpected character! Expected = after \"" + attribute.name.ToString() + "\"");
+
+		++current;
+
+		SkipWhitespace();
+		if(current == end || (*current != '\"' && *current != '\''))
+			return ShowErrorWithInfo("Unexpected character! Expected \" after \"" + attribute.name.ToString() + "=\"");
+
+		char quote = *current;
+		++current;
+
+		const char* valueEnd = static_cast<const char*>(std::memchr(current, quote, end - current));
+		if(valueEnd == nullptr)
+			return ShowErrorWithInfo("Ran out of file to read while parsing attributes for \"" + outElement.name.ToString() + "\". Did you forget a \"? The parsed attribute was \"" + attribute.name.ToString() + "\"");
+
+		attribute.value = XMLStringView(current, valueEnd - current);
+		current = valueEnd + 1;
+
+		attributes.push_back(attribute);
+	}
+
+	outElement.attributes = attributes.empty() ? nullptr : &attributes[0];
+	outElement.attributeCount = attributes.size();
+
+	return true;
+}
+
+bool XMLReader::ParseEndTag(XMLStringView& outName)
+{
+	outName = ParseName();
+
+	SkipWhitespace();
+
+	if(current == end || *current != '>')
+		return ShowErrorWithInfo("No end bracket found where one was expected!");
+
+	++current;
+
+	return true;
+}
+
+XMLStringView XMLReader::ParseName()
+{
+	const char* nameBegin = current;
+
+	while(current != end
+		&& !IsWhitespace(*current)
+		&& *current != '='
+		&& *current != '/'
+		&& *current != '>')
+		++current;
+
+	return XMLStringView(nameBegin, current - nameBegin);
+}
+
+XMLStringView XMLReader::ParseContents()
+{
+	SkipWhitespace();
+
+	const char* contentsBegin = current;
+	const char* contentsEnd = static_cast<const char*>(std::memchr(current, '<', end - current));
+
+	if(contentsEnd == nullptr)
+		contentsEnd = end;
+
+	current = contentsEnd;
+
+	while(contentsEnd > contentsBegin && IsWhitespace(contentsEnd[-1]))
+		--contentsEnd;
+
+	return XMLStringView(contentsBegin, contentsEnd - contentsBegin);
+}
+
+////////////////////////////////////////////////////////////
+//ERRORS
+////////////////////////////////////////////////////////////
+bool XMLReader::ShowErrorWithInfo(const std::string& message) const
+{
+	std::string fullMessage = "XML-error while parsing \"" + currentFile + "\": " + message;
+
+	unsigned int line = 0;
+	const char* lineBegin = begin;
+
+	for(const char* character = begin; character < current && character < end; ++character)
+	{
+		if(*character == '\n')
+		{
+			++line;
+			lineBegin = character + 1;
+		}
+	}
+
+	//0-indexed so add 1
+	fullMessage += " Line number " + std::to_string(line + 1)
+				+ ", index " + std::to_string(current - lineBegin + 1);
+
+	Logger::LogLine(LOG_TYPE::FATAL, fullMessage);
+
+	return false;
+}
\ No newline at end of file
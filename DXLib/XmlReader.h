@@ -0,0 +1,151 @@
+#ifndef XMLReader_h__
+#define XMLReader_h__
+
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "mappedFile.h"
+#include "xmlStringView.h"
+
+struct XMLAttributeView
+{
+	XMLStringView name;
+	XMLStringView value;
+};
+
+//Element handed to XMLReader::Parse's callback. Everything in it points into the reader's buffers,
+//so copy what's needed before the callback returns
+class XMLElementView
+{
+	friend class XMLReader;
+public:
+	XMLElementView()
+		: attributes(nullptr)
+		, attributeCount(0)
+		, depth(0)
+	{}
+	~XMLElementView() = default;
+
+	XMLStringView GetName() const;
+	//************************************
+	// Method:		GetContents
+	// FullName:	XMLElementView::GetContents
+	// Access:		public
+	// Returns:		XMLStringView
+	// Qualifier:	const
+	// Description:	Text between the start tag and the next tag, without surrounding whitespace
+	//************************************
+	XMLStringView GetContents() const;
+	unsigned int GetDepth() const;
+
+	size_t GetAttributeCount() const;
+	const XMLAttributeView& GetAttribute(size_t index) const;
+	//************************************
+	// Method:		GetAttribute
+	// FullName:	XMLElementView::GetAttribute
+	// Access:		public
+	// Returns:		XMLStringView - empty if the attribute doesn't exist
+	// Qualifier:	const
+	// Argument:	const char* name
+	// Description:	Linear search, elements rarely have more than a handful of attributes
+	//************************************
+	XMLStringView GetAttribute(const char* name) const;
+	bool AttributeExists(const char* name) const;
+
+private:
+	XMLStringView name;
+	XMLStringView contents;
+
+	const XMLAttributeView* attributes;
+	size_t attributeCount;
+
+	unsigned int depth;
+};
+
+/*Streaming (SAX) XML parser.
+* The file is memory mapped and parsed in place: names, attribute values and contents are
+* handed out as views into the mapping instead of being copied into strings. The only allocations
+* are the attribute and element stacks, which are reused between elements.
+* Entities (&amp; etc.) are not decoded, the same as XMLFile
+*/
+class XMLReader
+{
+public:
+	XMLReader();
+	~XMLReader();
+
+	XMLReader(const XMLReader&) = delete;
+	XMLReader& operator=(const XMLReader&) = delete;
+
+	bool Open(const std::string& path);
+	//************************************
+	// Method:		Open
+	// FullName:	XMLReader::Open
+	// Access:		public
+	// Returns:		void
+	// Qualifier:
+	// Argument:	const char* data - must stay alive for as long as any view from this reader is used
+	// Argument:	size_t size
+	// Description:	Parses a document that's already in memory
+	//************************************
+	void Open(const char* data, size_t size);
+	void Close();
+
+	//************************************
+	// Method:		Parse
+	// FullName:	XMLReader::Parse
+	// Access:		public
+	// Returns:		bool - false if the document is malformed. The error has been logged
+	// Qualifier:
+	// Argument:	const std::function<void(const XMLElementView&)>& onElementBegin - called once the start tag and contents of an element have been read
+	// Argument:	const std::function<void(const XMLStringView&)>& onElementEnd - called with the element name when an element is closed. Optional
+	// Description:	Parses the whole document. Views handed to the callbacks stay valid until Close
+	// is called, except the attribute array which is reused for the next element
+	//************************************
+	bool Parse(const std::function<void(const XMLElementView&)>& onElementBegin, const std::function<void(const XMLStringView&)>& onElementEnd = nullptr);
+
+	size_t GetSize() const;
+
+private:
+	MappedFile file;
+
+	const char* begin;
+	const char* end;
+	const char* current;
+
+	std::string currentFile;
+
+	std::vector<XMLAttributeView> attributes;
+	std::vector<XMLStringView> elementStack;
+
+	void SkipWhitespace();
+	//************************************
+	// Method:		SkipPast
+	// FullName:	XMLReader::SkipPast
+	// Access:		private
+	// Returns:		bool - false if terminator wasn't found
+	// Qualifier:
+	// Argument:	const char* terminator
+	// Description:	Moves current to the character after the next occurance of terminator
+	//************************************
+	bool SkipPast(const char* terminator);
+
+	bool ParseStartTag(XMLElementView& outElement, bool& selfClosing);
+	bool ParseEndTag(XMLStringView& outName);
+	XMLStringView ParseName();
+	XMLStringView ParseContents();
+
+	//************************************
+	// Method:		ShowErrorWithInfo
+	// FullName:	XMLReader::ShowErrorWithInfo
+	// Access:		private
+	// Returns:		bool - always false, for convenience
+	// Qualifier:
+	// Argument:	const std::string& message
+	// Description:	Logs message along with the line and index of current. Lines are only counted when an error occurs
+	//************************************
+	bool ShowErrorWithInfo(const std::string& message) const;
+};
+
+#endif // XMLReader_h__
\ No newline at end of file
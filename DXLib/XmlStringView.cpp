@@ -0,0 +1,82 @@
+#include "xmlStringView.h"
+
+#include <cstdlib>
+
+namespace
+{
+	long long ParseInteger(const char* data, size_t length)
+	{
+		size_t index = 0;
+		bool negative = false;
+
+		if(index < length
+			&& (data[index] == '-' || data[index] == '+'))
+		{
+			negative = data[index] == '-';
+			++index;
+		}
+
+		long long value = 0;
+
+		for(; index < length; ++index)
+		{
+			char character = data[index];
+
+			if(character < '0' || character > '9')
+				break;
+
+			value = value * 10 + (character - '0');
+		}
+
+		return negative ? -value : value;
+	}
+
+	double ParseFloatingPoint(const char* data, size_t length)
+	{
+		//strtod needs a null terminated string. Numbers longer than this aren't worth supporting
+		char buffer[64];
+
+		if(length >= sizeof(buffer))
+			length = sizeof(buffer) - 1;
+
+		std::memcpy(buffer, data, length);
+		buffer[length] = '\0';
+
+		return std::strtod(buffer, nullptr);
+	}
+}
+
+int XMLStringView::GetValueAsInt() const
+{
+	return static_cast<int>(ParseInteger(data, length));
+}
+
+short XMLStringView::GetValueAsShort() const
+{
+	return static_cast<short>(ParseInteger(data, length));
+}
+
+char XMLStringView::GetValueAsChar() const
+{
+	return static_cast<char>(ParseInteger(data, length));
+}
+
+unsigned int XMLStringView::GetValueAsUnsignedInt() const
+{
+	return static_cast<unsigned int>(ParseInteger(data, length));
+}
+
+unsigned char XMLStringView::GetValueAsUnsignedChar() const
+{
+	return static_cast<unsigned char>(ParseInteger(data, length));
+}
+
+float XMLStringView::GetValueAsFloat() const
+{
+	return static_cast<float>(ParseFloatingPoint(data, length));
+}
+
+double XMLStringView::GetValueAsDouble() const
+{
+	return ParseFloatingPoint(data, length);
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#ifndef XMLStringView_h__
+#define XMLStringView_h__
+
+#include <string>
+#include <cstring>
+
+//Non-owning view of characters in an XML document. Only valid as long as the XMLReader or XMLTree
+//it came from keeps the document open
+class XMLStringView
+{
+public:
+	XMLStringView()
+		: data(nullptr)
+		, length(0)
+	{}
+	XMLStringView(const char* data, size_t length)
+		: data(data)
+		, length(length)
+	{}
+	~XMLStringView() = default;
+
+	const char* GetData() const
+	{
+		return data;
+	}
+
+	size_t GetLength() const
+	{
+		return length;
+	}
+
+	bool IsEmpty() const
+	{
+		return length == 0;
+	}
+
+	std::string ToString() const
+	{
+		return std::string(data, length);
+	}
+
+	bool operator==(const XMLStringView& rhs) const
+	{
+		return length == rhs.length && (length == 0 || std::memcmp(data, rhs.data, length) == 0);
+	}
+
+	bool operator==(const char* rhs) const
+	{
+		if(length == 0)
+			return rhs[0] == '\0';
+
+		return std::strncmp(data, rhs, length) == 0 && rhs[length] == '\0';
+	}
+
+	bool operator==(const std::string& rhs) const
+	{
+		return *this == XMLStringView(rhs.data(), rhs.size());
+	}
+
+	template<typename T>
+	bool operator!=(const T& rhs) const
+	{
+		return !(*this == rhs);
+	}
+
+	//************************************
+	// Method:		GetValueAsInt
+	// FullName:	XMLStringView::GetValueAsInt
+	// Access:		public
+	// Returns:		int - 0 if the view doesn't start with a number
+	// Qualifier:	const
+	// Description:	Converts without allocating. Unlike XMLAttribute this doesn't throw
+	//************************************
+	int GetValueAsInt() const;
+	short GetValueAsShort() const;
+	char GetValueAsChar() const;
+	unsigned int GetValueAsUnsignedInt() const;
+	unsigned char GetValueAsUnsignedChar() const;
+	float GetValueAsFloat() const;
+	double GetValueAsDouble() const;
+
+private:
+	const char* data;
+	size_t length;
+};
+
+inline bool operator==(const char* lhs, const XMLStringView& rhs)
+{
+	return rhs == lhs;
+}
+
+inline bool operator==(const std::string& lhs, const XMLStringView& rhs)
+{
+	return rhs == lhs;
+}
+
+#endif // XMLStringView_h__
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include "xmlTree.h"
+
+#include "Logger.h"
+
+////////////////////////////////////////////////////////////
+//XMLNode
+////////////////////////////////////////////////////////////
+XMLStringView XMLNode::GetAttribute(const char* name) const
+{
+	for(size_t i = 0; i < attributeCount; ++i)
+		if(attributes[i].name == name)
+			return attributes[i].value;
+
+	return XMLStringView();
+}
+
+bool XMLNode::AttributeExists(const char* name) const
+{
+	for(size_t i = 0; i < attributeCount; ++i)
+		if(attributes[i].name == name)
+			return true;
+
+	return false;
+}
+
+const XMLNode* XMLNode::GetFirstChild(const char* name /*= nullptr*/) const
+{
+	if(firstChild == nullptr
+		|| name == nullptr
+		|| firstChild->name == name)
+		return firstChild;
+
+	return firstChild->GetNextSibling(name);
+}
+
+const XMLNode* XMLNode::GetNextSibling(const char* name /*= nullptr*/) const
+{
+	for(const XMLNode* node = nextSibling; node != nullptr; node = node->nextSibling)
+		if(name == nullptr || node->name == name)
+			return node;
+
+	return nullptr;
+}
+
+////////////////////////////////////////////////////////////
+//XMLTree
+////////////////////////////////////////////////////////////
+XMLTree::XMLTree()
+	: root(nullptr)
+	, nodeCount(0)
+{
+}
+
+XMLTree::~XMLTree()
+{
+}
+
+bool XMLTree::Open(const std::string& path)
+{
+	Close();
+
+	if(!reader.Open(path))
+		return false;
+
+	if(!BuildTree(path))
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void XMLTree::Close()
+{
+	reader.Close();
+	arena.Reset();
+
+	root = nullptr;
+	nodeCount = 0;
+}
+
+bool XMLTree::BuildTree(const std::string& path)
+{
+	XMLNode* parent = nullptr;
+	XMLNode* extraRoot = nullptr;
+
+	auto onElementBegin = [&](const XMLElementView& element)
+	{
+		XMLNode* node = arena.Allocate<XMLNode>();
+		node->name = element.GetName();
+		node->contents = element.GetContents();
+
+		//The reader reuses its attribute array, so they have to be copied
+		node->attributeCount = element.GetAttributeCount();
+		if(node->attributeCount > 0)
+		{
+			XMLAttributeView* attributes = arena.Allocate<XMLAttributeView>(node->attributeCount);
+
+			for(size_t i = 0; i < node->attributeCount; ++i)
+				attributes[i] = element.GetAttribute(i);
+
+			node->attributes = attributes;
+		}
+
+		node->parent = parent;
+
+		if(parent == nullptr)
+		{
+			//GetRoot can only return one of them, so the rest would be dropped without anyone knowing
+			if(root == nullptr)
+				root = node;
+			else if(extraRoot == nullptr)
+				extraRoot = node;
+		}
+		else if(parent->lastChild == nullptr)
+		{
+			parent->firstChild = node;
+			parent->lastChild = node;
+		}
+		else
+		{
+			parent->lastChild->nextSibling = node;
+			parent->lastChild = node;
+		}
+
+		++nodeCount;
+		parent = node;
+	};
+
+	auto onElementEnd = [&](const XMLStringView&)
+	{
+		parent = parent->parent;
+	};
+
+	if(!reader.Parse(onElementBegin, onElementEnd))
+		return false;
+
+	if(extraRoot != nullptr)
+	{
+		Logger::LogLine(LOG_TYPE::FATAL, "XML-error while parsing \"" + path + "\": Found top-level element \"" + extraRoot->name.ToString() + "\" after \"" + root->name.ToString() + "\", only one is allowed");
+		return false;
+	}
+
+	return true;
+}
+
+const XMLNode* XMLTree::GetRoot() const
+{
+	return root;
+}
+
+size_t XMLTree::GetNodeCount() const
+{
+	return nodeCount;
+}
+
+size_t XMLTree::GetArenaSize() const
+{
+	return arena.GetUsedSize();
+}
\ No newline at end of file
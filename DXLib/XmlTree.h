@@ -0,0 +1,94 @@
+#ifndef XMLTree_h__
+#define XMLTree_h__
+
+#include <string>
+
+#include "xmlReader.h"
+#include "memoryArena.h"
+
+//Element in an XMLTree. Nodes, their attributes and their links all live in the tree's arena
+//and the strings point into the tree's file
+struct XMLNode
+{
+	XMLNode()
+		: attributes(nullptr)
+		, attributeCount(0)
+		, parent(nullptr)
+		, firstChild(nullptr)
+		, lastChild(nullptr)
+		, nextSibling(nullptr)
+	{}
+
+	XMLStringView name;
+	XMLStringView contents;
+
+	const XMLAttributeView* attributes;
+	size_t attributeCount;
+
+	XMLNode* parent;
+	XMLNode* firstChild;
+	XMLNode* lastChild;
+	XMLNode* nextSibling;
+
+	XMLStringView GetAttribute(const char* name) const;
+	bool AttributeExists(const char* name) const;
+
+	//************************************
+	// Method:		GetFirstChild
+	// FullName:	XMLNode::GetFirstChild
+	// Access:		public
+	// Returns:		const XMLNode* - nullptr if there is no such child
+	// Qualifier:	const
+	// Argument:	const char* name - nullptr matches any child
+	//************************************
+	const XMLNode* GetFirstChild(const char* name = nullptr) const;
+	//************************************
+	// Method:		GetNextSibling
+	// FullName:	XMLNode::GetNextSibling
+	// Access:		public
+	// Returns:		const XMLNode* - nullptr if there is no such sibling
+	// Qualifier:	const
+	// Argument:	const char* name - nullptr matches any sibling
+	//************************************
+	const XMLNode* GetNextSibling(const char* name = nullptr) const;
+};
+
+//DOM built on top of XMLReader. Keeps the file mapped for as long as the tree is open
+class XMLTree
+{
+public:
+	XMLTree();
+	~XMLTree();
+
+	XMLTree(const XMLTree&) = delete;
+	XMLTree& operator=(const XMLTree&) = delete;
+
+	//************************************
+	// Method:		Open
+	// FullName:	XMLTree::Open
+	// Access:		public
+	// Returns:		bool - false if the file couldn't be opened or parsed, or if it has more than one top-level element.
+	// The error has been logged
+	// Qualifier:
+	// Argument:	const std::string& path
+	// Description:	Parses the whole file. Nodes from a previously opened file are invalidated
+	//************************************
+	bool Open(const std::string& path);
+	void Close();
+
+	const XMLNode* GetRoot() const;
+
+	size_t GetNodeCount() const;
+	size_t GetArenaSize() const;
+
+private:
+	XMLReader reader;
+	MemoryArena arena;
+
+	XMLNode* root;
+	size_t nodeCount;
+
+	bool BuildTree(const std::string& path);
+};
+
+#endif // XMLTree_h__
\ No newline at end of file
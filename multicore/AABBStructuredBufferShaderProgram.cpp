@@ -29,14 +29,27 @@ bool AABBStructuredBufferShaderProgram::InitBuffers(ID3D11UnorderedAccessView* d
 	if(!ShaderProgram::InitBuffers(depthBufferUAV, backBufferUAV))
 		return false;
 
+	//WriteScene reallocates the arrays sceneQuery reads from, so any running query has to finish first
+	sceneQuery.Clear();
+	WriteScene();
+
 	if(!sphereBufferData.empty())
 		LogErrorReturnFalse(sphereBuffer.Create<AABBStructuredBufferSharedBuffers::Sphere>(device, D3D11_USAGE_DEFAULT, static_cast<D3D11_CPU_ACCESS_FLAG>(0), true, false, static_cast<int>(sphereBufferData.size()), sphereBufferData.empty() ? nullptr : &sphereBufferData[0]), "Couldn't create sphere buffer: ");
+	else
+		sphereBuffer.Release(); //Left over from a previous scene
 	LogErrorReturnFalse(triangleVertexBuffer.Create<AABBStructuredBufferSharedBuffers::Vertex>(device, D3D11_USAGE_DEFAULT, static_cast<D3D11_CPU_ACCESS_FLAG>(0), true, false, static_cast<int>(vertexBufferData.size()), vertexBufferData.empty() ? nullptr : &vertexBufferData[0]), "Couldn't create triangle vertex buffer: ");
 	LogErrorReturnFalse(triangleBuffer.Create<AABBStructuredBufferSharedBuffers::Triangle>(device, D3D11_USAGE_DEFAULT, static_cast<D3D11_CPU_ACCESS_FLAG>(0), true, false, static_cast<int>(triangleBufferData.size()), triangleBufferData.empty() ? nullptr : &triangleBufferData[0]), "Couldn't create triangle index buffer: ");
 	LogErrorReturnFalse(modelsBuffer.Create<AABBStructuredBufferSharedBuffers::Model>(device, D3D11_USAGE_DEFAULT, static_cast<D3D11_CPU_ACCESS_FLAG>(0), true, false, static_cast<int>(modelsBufferData.size()), modelsBufferData.empty() ? nullptr : &modelsBufferData[0]), "Couldn't create model buffer: ");
 
 	LogErrorReturnFalse(viewProjInverseBuffer.Create<DirectX::XMFLOAT4X4>(device, D3D11_BIND_CONSTANT_BUFFER, D3D11_USAGE_DYNAMIC, D3D11_CPU_ACCESS_WRITE), "Couldn't create view proj inverse buffer: ");
 
+	SceneGeometry sceneGeometry;
+	sceneGeometry.spheres = MakeStridedView<DirectX::XMFLOAT4>(sphereBufferData, &AABBStructuredBufferSharedBuffers::Sphere::position);
+	sceneGeometry.vertices = MakeStridedView<DirectX::XMFLOAT3>(vertexBufferData, &AABBStructuredBufferSharedBuffers::Vertex::position);
+	sceneGeometry.triangles = MakeStridedView<DirectX::XMINT3>(triangleBufferData, &AABBStructuredBufferSharedBuffers::Triangle::indicies);
+	sceneGeometry.modelEndIndices = MakeStridedView<int>(modelsBufferData, &AABBStructuredBufferSharedBuffers::Model::endIndex);
+	sceneQuery.Build(sceneGeometry, &contentManager->GetThreadPool());
+
 	if(!InitUAVSRV())
 		return false;
 	if(!InitShaders())
@@ -73,6 +86,16 @@ bool AABBStructuredBufferShaderProgram::InitUAVSRV()
 
 bool AABBStructuredBufferShaderProgram::InitShaders()
 {
+	//Only a single texture is supported, the one used by the last model added. A scene with only spheres has no model to take it from
+	const auto& models = sceneBuilder.GetModels();
+	if(models.empty() || models.back().material.diffuseTexture == nullptr)
+	{
+		Logger::LogLine(LOG_TYPE::FATAL, "The scene needs at least one model with a diffuse texture");
+		return false;
+	}
+
+	Texture2D* diffuseTexture = models.back().material.diffuseTexture;
+
 	//////////////////////////////////////////////////
 	//Primary rays
 	//////////////////////////////////////////////////
@@ -109,7 +132,7 @@ bool AABBStructuredBufferShaderProgram::InitShaders()
 	//SRVs
 	traceResourceBindInitial.AddResource(rayPositionSRV[0].get(), 0);
 	traceResourceBindInitial.AddResource(rayDirectionSRV[0].get(), 1);
-	traceResourceBindInitial.AddResource(objFile->GetMeshes().front().material.diffuseTexture->GetTextureResourceView(), 2);
+	traceResourceBindInitial.AddResource(diffuseTexture->GetTextureResourceView(), 2);
 
 	//Samplers
 	traceResourceBindInitial.AddResource(SamplerStates::linearClamp, 0);
@@ -133,7 +156,7 @@ bool AABBStructuredBufferShaderProgram::InitShaders()
 	//SRVs
 	traceResourceBinds0.AddResource(rayPositionSRV[0].get(), 0);
 	traceResourceBinds0.AddResource(rayDirectionSRV[0].get(), 1);
-	traceResourceBinds0.AddResource(objFile->GetMeshes().front().material.diffuseTexture->GetTextureResourceView(), 2);
+	traceResourceBinds0.AddResource(diffuseTexture->GetTextureResourceView(), 2);
 
 	//Samplers
 	traceResourceBinds0.AddResource(SamplerStates::linearClamp, 0);
@@ -155,7 +178,7 @@ bool AABBStructuredBufferShaderProgram::InitShaders()
 	//SRVs
 	traceResourceBinds1.AddResource(rayPositionSRV[1].get(), 0);
 	traceResourceBinds1.AddResource(rayDirectionSRV[1].get(), 1);
-	traceResourceBinds1.AddResource(objFile->GetMeshes().front().material.diffuseTexture->GetTextureResourceView(), 2);
+	traceResourceBinds1.AddResource(diffuseTexture->GetTextureResourceView(), 2);
 
 	//Samplers
 	traceResourceBinds1.AddResource(SamplerStates::linearClamp, 0);
@@ -283,81 +306,53 @@ void AABBStructuredBufferShaderProgram::DrawComposit(int config)
 	compositShader.Unbind(deviceContext);
 }
 
-void AABBStructuredBufferShaderProgram::AddOBJ(const std::string& path, DirectX::XMFLOAT3 position, float scale)
+size_t AABBStructuredBufferShaderProgram::GetSceneMemoryUsage() const
 {
-	objFile = contentManager->Load<OBJFile>(path);
-	if(objFile == nullptr)
-		return;
-
-	DirectX::XMFLOAT3 aabbMin(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
-	DirectX::XMFLOAT3 aabbMax(std::numeric_limits<float>::min(), std::numeric_limits<float>::min(), std::numeric_limits<float>::min());
-
-	auto xmAABBMin = DirectX::XMLoadFloat3(&aabbMin);
-	auto xmAABBMax = DirectX::XMLoadFloat3(&aabbMax);
-
-	Mesh mesh = objFile->GetMeshes().front();
+	return sphereBufferData.size() * sizeof(AABBStructuredBufferSharedBuffers::Sphere)
+		+ vertexBufferData.size() * sizeof(AABBStructuredBufferSharedBuffers::Vertex)
+		+ triangleBufferData.size() * sizeof(AABBStructuredBufferSharedBuffers::Triangle)
+		+ modelsBufferData.size() * sizeof(AABBStructuredBufferSharedBuffers::Model);
+}
 
-	int vertexOffset = 0;
+void AABBStructuredBufferShaderProgram::WriteScene()
+{
+	ThreadPool* threadPool = &contentManager->GetThreadPool();
 
-	for(const auto& triangle : triangleBufferData)
+	const auto& spheres = sceneBuilder.GetSpheres();
+	sphereBufferData.resize(spheres.size());
+	for(int i = 0, end = static_cast<int>(spheres.size()); i < end; ++i)
 	{
-		vertexOffset = std::max(vertexOffset, triangle.indicies.x + 1);
-		vertexOffset = std::max(vertexOffset, triangle.indicies.y + 1);
-		vertexOffset = std::max(vertexOffset, triangle.indicies.z + 1);
+		sphereBufferData[i].position = spheres[i].position;
+		sphereBufferData[i].color = spheres[i].color;
 	}
 
-	for(int i = 0, end = static_cast<int>(mesh.vertices.size()); i < end; ++i)
+	vertexBufferData.resize(sceneBuilder.GetVertexCount());
+	sceneBuilder.WriteVertices(vertexBufferData.data(), [](const OBJVertex& vertex, AABBStructuredBufferSharedBuffers::Vertex& outVertex)
 	{
-		AABBStructuredBufferSharedBuffers::Vertex newVertex;
-
-		newVertex.position.x = mesh.vertices[i].position.x + position.x;
-		newVertex.position.y = mesh.vertices[i].position.y + position.y;
-		newVertex.position.z = mesh.vertices[i].position.z + position.z;
+		outVertex.position = vertex.position;
 
-		int u = mesh.vertices[i].texCoord.x * 0xFFFF;
-		int v = mesh.vertices[i].texCoord.y * 0xFFFF;
+		int u = vertex.texCoord.x * 0xFFFF;
+		int v = vertex.texCoord.y * 0xFFFF;
 
-		newVertex.texCoord = (u << 16) | v;
+		outVertex.texCoord = (u << 16) | v;
+	}, threadPool);
 
-		auto xmNewVertexPosition = DirectX::XMLoadFloat3(&newVertex.position);
-		xmAABBMin = DirectX::XMVectorMin(xmNewVertexPosition, xmAABBMin);
-		xmAABBMax = DirectX::XMVectorMax(xmNewVertexPosition, xmAABBMax);
-
-		vertexBufferData.push_back(std::move(newVertex));
-	}
-
-	int triangleCount = static_cast<int>(triangleBufferData.size());
-
-	for(int i = 0, end = static_cast<int>(mesh.indicies.size()) / 3; i < end; ++i)
+	triangleBufferData.resize(sceneBuilder.GetTriangleCount());
+	sceneBuilder.WriteTriangles(triangleBufferData.data(), [](const DirectX::XMINT3& indicies, int modelIndex, AABBStructuredBufferSharedBuffers::Triangle& outTriangle)
 	{
-		AABBStructuredBufferSharedBuffers::Triangle newTriangle;
+		outTriangle.indicies = DirectX::XMINT4(indicies.x, indicies.y, indicies.z, 0);
+	}, threadPool);
 
-		newTriangle.indicies.x = vertexOffset + mesh.indicies[i * 3];
-		newTriangle.indicies.y = vertexOffset + mesh.indicies[i * 3 + 1];
-		newTriangle.indicies.z = vertexOffset + mesh.indicies[i * 3 + 2];
-		newTriangle.indicies.w = 0;
+	const auto& models = sceneBuilder.GetModels();
 
-		triangleBufferData.push_back(std::move(newTriangle));
+	modelsBufferData.resize(models.size());
+	for(int i = 0, end = static_cast<int>(models.size()); i < end; ++i)
+	{
+		modelsBufferData[i].aabb.min = models[i].aabbMin;
+		modelsBufferData[i].aabb.max = models[i].aabbMax;
+		modelsBufferData[i].beginIndex = models[i].beginIndex;
+		modelsBufferData[i].endIndex = models[i].endIndex;
 	}
-
-	AABBStructuredBufferSharedBuffers::Model newModel;
-	DirectX::XMStoreFloat3(&newModel.aabb.min, xmAABBMin);
-	DirectX::XMStoreFloat3(&newModel.aabb.max, xmAABBMax);
-
-	newModel.beginIndex = triangleCount;
-	newModel.endIndex = static_cast<int>(triangleBufferData.size()) - 1;
-
-	modelsBufferData.push_back(std::move(newModel));
-}
-
-void AABBStructuredBufferShaderProgram::AddSphere(DirectX::XMFLOAT4 sphere, DirectX::XMFLOAT4 color)
-{
-	AABBStructuredBufferSharedBuffers::Sphere newSphere;
-
-	newSphere.position = sphere;
-	newSphere.color = color;
-
-	sphereBufferData.push_back(std::move(newSphere));
 }
 
 std::string AABBStructuredBufferShaderProgram::ReloadShadersInternal()
@@ -0,0 +1,821 @@
+#include "BVH.h"
+
+#include <DXLib/ThreadPool.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace
+{
+	//Morton codes are 10 bits per axis, sorted this many bits at a time
+	const int RADIX_BITS = 10;
+	//Keys per task when sorting, sorting has to write a histogram per task
+	const int SORT_GRAIN_SIZE = 1 << 18;
+
+	float GetAxis(const DirectX::XMFLOAT3& vector, int axis)
+	{
+		return axis == 0 ? vector.x : (axis == 1 ? vector.y : vector.z);
+	}
+
+	//Half the surface area, only ever compared to other areas
+	float GetHalfArea(DirectX::FXMVECTOR min, DirectX::FXMVECTOR max)
+	{
+		DirectX::XMFLOAT4 extent;
+		DirectX::XMStoreFloat4(&extent, DirectX::XMVectorSubtract(max, min));
+
+		return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+	}
+
+	float GetHalfArea(const DirectX::XMFLOAT3& min, const DirectX::XMFLOAT3& max)
+	{
+		return GetHalfArea(DirectX::XMLoadFloat3(&min), DirectX::XMLoadFloat3(&max));
+	}
+
+	BVH::AABB ToAABB(DirectX::FXMVECTOR min, DirectX::FXMVECTOR max)
+	{
+		BVH::AABB aabb;
+		DirectX::XMStoreFloat3(&aabb.min, min);
+		DirectX::XMStoreFloat3(&aabb.max, max);
+
+		return aabb;
+	}
+
+	DirectX::XMVECTOR GetEmptyMin()
+	{
+		return DirectX::XMVectorReplicate(std::numeric_limits<float>::max());
+	}
+
+	DirectX::XMVECTOR GetEmptyMax()
+	{
+		return DirectX::XMVectorReplicate(std::numeric_limits<float>::lowest());
+	}
+
+	//Spreads the lowest 10 bits out so there are two zeroes between each of them
+	uint32_t ExpandBits(uint32_t value)
+	{
+		value = (value * 0x00010001u) & 0xFF0000FFu;
+		value = (value * 0x00000101u) & 0x0F00F00Fu;
+		value = (value * 0x00000011u) & 0xC30C30C3u;
+		value = (value * 0x00000005u) & 0x49249249u;
+
+		return value;
+	}
+
+	uint32_t GetMortonCode(const DirectX::XMFLOAT3& center, const BVH::AABB& centerBounds)
+	{
+		uint32_t code = 0;
+
+		for(int axis = 0; axis < 3; ++axis)
+		{
+			float min = GetAxis(centerBounds.min, axis);
+			float extent = GetAxis(centerBounds.max, axis) - min;
+
+			float normalized = extent > 0.0f ? (GetAxis(center, axis) - min) / extent : 0.0f;
+			uint32_t quantized = static_cast<uint32_t>(std::min(std::max(normalized * 1024.0f, 0.0f), 1023.0f));
+
+			code |= ExpandBits(quantized) << (2 - axis);
+		}
+
+		return code;
+	}
+
+	//Calls function(begin, end) for ranges of at most grainSize, on threadPool's workers if there is one
+	template<typename Function>
+	void ParallelRanges(ThreadPool* threadPool, int count, int grainSize, Function function)
+	{
+		if(threadPool == nullptr)
+		{
+			if(count > 0)
+				function(0, count);
+		}
+		else
+			threadPool->ParallelFor(count, grainSize, function);
+	}
+
+	//************************************
+	// Method:		SortByMortonCode
+	// Returns:		void
+	// Argument:	std::vector<uint64_t>& keys - Morton code in the upper 32 bits, index in the lower
+	// Argument:	ThreadPool* threadPool
+	// Description:	Least significant digit radix sort. Each pass counts digits per task, which gives every task
+	//				its own place to write to, so the scatter can be split across threads and stay stable
+	//************************************
+	void SortByMortonCode(std::vector<uint64_t>& keys, ThreadPool* threadPool)
+	{
+		const int DIGIT_COUNT = 1 << RADIX_BITS;
+
+		int keyCount = static_cast<int>(keys.size());
+		int taskCount = (keyCount + SORT_GRAIN_SIZE - 1) / SORT_GRAIN_SIZE;
+
+		std::vector<uint64_t> sorted(keys.size());
+		std::vector<int> offsets(taskCount * DIGIT_COUNT);
+
+		for(int shift = 32; shift < 62; shift += RADIX_BITS)
+		{
+			std::fill(offsets.begin(), offsets.end(), 0);
+
+			ParallelRanges(threadPool, keyCount, SORT_GRAIN_SIZE, [&](int begin, int end)
+			{
+				int* counts = &offsets[begin / SORT_GRAIN_SIZE * DIGIT_COUNT];
+
+				for(int i = begin; i < end; ++i)
+					++counts[(keys[i] >> shift) & (DIGIT_COUNT - 1)];
+			});
+
+			//Ordered by digit first and task second, so tasks write their keys in the order they're in
+			int offset = 0;
+			for(int digit = 0; digit < DIGIT_COUNT; ++digit)
+			{
+				for(int task = 0; task < taskCount; ++task)
+				{
+					int count = offsets[task * DIGIT_COUNT + digit];
+					offsets[task * DIGIT_COUNT + digit] = offset;
+					offset += count;
+				}
+			}
+
+			ParallelRanges(threadPool, keyCount, SORT_GRAIN_SIZE, [&](int begin, int end)
+			{
+				int* taskOffsets = &offsets[begin / SORT_GRAIN_SIZE * DIGIT_COUNT];
+
+				for(int i = begin; i < end; ++i)
+					sorted[taskOffsets[(keys[i] >> shift) & (DIGIT_COUNT - 1)]++] = keys[i];
+			});
+
+			keys.swap(sorted);
+		}
+	}
+}
+
+const float BVH::TRAVERSAL_COST = 1.0f;
+
+//Bounds of a single primitive while building. Primitives are moved around a lot, so they are kept
+//small and carry their index along
+struct BVH::BuildPrimitive
+{
+	DirectX::XMFLOAT3 min;
+	//Between min and max so both can be loaded as four floats
+	int index;
+	DirectX::XMFLOAT3 max;
+	int padding;
+
+	//w is masked off since index read as a float is usually denormal, which makes any arithmetic on it very slow
+	DirectX::XMVECTOR GetMin() const
+	{
+		return DirectX::XMVectorAndInt(DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(&min)), DirectX::g_XMMask3);
+	}
+
+	DirectX::XMVECTOR GetMax() const
+	{
+		return DirectX::XMVectorAndInt(DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(&max)), DirectX::g_XMMask3);
+	}
+
+	DirectX::XMVECTOR GetCenter() const
+	{
+		return DirectX::XMVectorScale(DirectX::XMVectorAdd(GetMin(), GetMax()), 0.5f);
+	}
+};
+
+struct BVH::Split
+{
+	int axis;
+	//Primitives in a bin below this one go to the left child
+	int bin;
+	float cost;
+
+	AABB leftBounds;
+	AABB rightBounds;
+
+	//Bin of a center along each axis is (center - binOrigin) * binScale
+	DirectX::XMFLOAT4 binOrigin;
+	DirectX::XMFLOAT4 binScale;
+
+	//Returns false if every center is in the same place, then there's nothing to split
+	bool SetBinning(const AABB& centerBounds)
+	{
+		bool splittable = false;
+
+		float scale[3];
+		for(int i = 0; i < 3; ++i)
+		{
+			float extent = GetAxis(centerBounds.max, i) - GetAxis(centerBounds.min, i);
+
+			//Slightly less than BIN_COUNT so the largest center doesn't end up in a bin of its own
+			scale[i] = extent > 0.0f ? BIN_COUNT * (1.0f - 1e-5f) / extent : 0.0f;
+			splittable |= extent > 0.0f;
+		}
+
+		binOrigin = DirectX::XMFLOAT4(centerBounds.min.x, centerBounds.min.y, centerBounds.min.z, 0.0f);
+		binScale = DirectX::XMFLOAT4(scale[0], scale[1], scale[2], 0.0f);
+
+		return splittable;
+	}
+
+	//Bin along every axis at once
+	DirectX::XMFLOAT4 GetBins(DirectX::FXMVECTOR center) const
+	{
+		DirectX::XMVECTOR bins = DirectX::XMVectorMultiply(DirectX::XMVectorSubtract(center, DirectX::XMLoadFloat4(&binOrigin)), DirectX::XMLoadFloat4(&binScale));
+		bins = DirectX::XMVectorMax(DirectX::XMVectorZero(), DirectX::XMVectorMin(bins, DirectX::XMVectorReplicate(static_cast<float>(BIN_COUNT - 1))));
+
+		DirectX::XMFLOAT4 result;
+		DirectX::XMStoreFloat4(&result, bins);
+
+		return result;
+	}
+
+	bool IsLeft(DirectX::FXMVECTOR center) const
+	{
+		DirectX::XMFLOAT4 bins = GetBins(center);
+
+		return static_cast<int>(axis == 0 ? bins.x : (axis == 1 ? bins.y : bins.z)) < bin;
+	}
+};
+
+//Bounds and primitive count of every bin along every axis
+struct BVH::Bins
+{
+	Bins()
+	{
+		for(int axis = 0; axis < 3; ++axis)
+		{
+			for(int i = 0; i < BIN_COUNT; ++i)
+			{
+				min[axis][i] = GetEmptyMin();
+				max[axis][i] = GetEmptyMax();
+				count[axis][i] = 0;
+			}
+		}
+	}
+
+	DirectX::XMVECTOR min[3][BIN_COUNT];
+	DirectX::XMVECTOR max[3][BIN_COUNT];
+	int count[3][BIN_COUNT];
+
+	void Add(const BuildPrimitive& primitive, const Split& split)
+	{
+		DirectX::XMVECTOR primitiveMin = primitive.GetMin();
+		DirectX::XMVECTOR primitiveMax = primitive.GetMax();
+
+		DirectX::XMFLOAT4 bins = split.GetBins(DirectX::XMVectorScale(DirectX::XMVectorAdd(primitiveMin, primitiveMax), 0.5f));
+
+		int binIndices[3] = { static_cast<int>(bins.x), static_cast<int>(bins.y), static_cast<int>(bins.z) };
+		for(int axis = 0; axis < 3; ++axis)
+		{
+			int bin = binIndices[axis];
+
+			min[axis][bin] = DirectX::XMVectorMin(min[axis][bin], primitiveMin);
+			max[axis][bin] = DirectX::XMVectorMax(max[axis][bin], primitiveMax);
+			++count[axis][bin];
+		}
+	}
+
+	void Merge(const Bins& other)
+	{
+		for(int axis = 0; axis < 3; ++axis)
+		{
+			for(int i = 0; i < BIN_COUNT; ++i)
+			{
+				min[axis][i] = DirectX::XMVectorMin(min[axis][i], other.min[axis][i]);
+				max[axis][i] = DirectX::XMVectorMax(max[axis][i], other.max[axis][i]);
+				count[axis][i] += other.count[axis][i];
+			}
+		}
+	}
+};
+
+
+BVH::AABB::AABB()
+	: min(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max())
+	, max(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest())
+{}
+
+BVH::AABB::AABB(const DirectX::XMFLOAT3& min, const DirectX::XMFLOAT3& max)
+	: min(min)
+	, max(max)
+{}
+
+void BVH::AABB::Grow(const DirectX::XMFLOAT3& point)
+{
+	min.x = std::min(min.x, point.x);
+	min.y = std::min(min.y, point.y);
+	min.z = std::min(min.z, point.z);
+
+	max.x = std::max(max.x, point.x);
+	max.y = std::max(max.y, point.y);
+	max.z = std::max(max.z, point.z);
+}
+
+void BVH::AABB::Grow(const AABB& aabb)
+{
+	//Not Grow(aabb.min) and Grow(aabb.max), an empty aabb would then grow to cover everything
+	min.x = std::min(min.x, aabb.min.x);
+	min.y = std::min(min.y, aabb.min.y);
+	min.z = std::min(min.z, aabb.min.z);
+
+	max.x = std::max(max.x, aabb.max.x);
+	max.y = std::max(max.y, aabb.max.y);
+	max.z = std::max(max.z, aabb.max.z);
+}
+
+DirectX::XMFLOAT3 BVH::AABB::GetCenter() const
+{
+	return DirectX::XMFLOAT3((min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f, (min.z + max.z) * 0.5f);
+}
+
+BVH::BVH()
+	: depth(0)
+	, sahCost(0.0f)
+{}
+
+void BVH::Build(const std::vector<AABB>& primitiveBounds, ThreadPool* threadPool)
+{
+	Clear();
+
+	if(primitiveBounds.empty())
+		return;
+
+	int primitiveCount = static_cast<int>(primitiveBounds.size());
+	int taskCount = (primitiveCount + GRAIN_SIZE - 1) / GRAIN_SIZE;
+
+	std::vector<AABB> taskBounds(taskCount);
+	std::vector<AABB> taskCenterBounds(taskCount);
+
+	ParallelRanges(threadPool, primitiveCount, GRAIN_SIZE, [&](int begin, int end)
+	{
+		AABB& bounds = taskBounds[begin / GRAIN_SIZE];
+		AABB& centerBounds = taskCenterBounds[begin / GRAIN_SIZE];
+
+		for(int i = begin; i < end; ++i)
+		{
+			bounds.Grow(primitiveBounds[i]);
+			centerBounds.Grow(primitiveBounds[i].GetCenter());
+		}
+	});
+
+	AABB bounds;
+	AABB centerBounds;
+	for(int i = 0; i < taskCount; ++i)
+	{
+		bounds.Grow(taskBounds[i]);
+		centerBounds.Grow(taskCenterBounds[i]);
+	}
+
+	//Primitives that are close to each other end up close to each other along a Morton curve, so after
+	//sorting most nodes' primitives are already next to each other and partitioning them moves little
+	std::vector<uint64_t> keys(primitiveCount);
+	ParallelRanges(threadPool, primitiveCount, GRAIN_SIZE, [&](int begin, int end)
+	{
+		for(int i = begin; i < end; ++i)
+			keys[i] = static_cast<uint64_t>(GetMortonCode(primitiveBounds[i].GetCenter(), centerBounds)) << 32 | static_cast<uint32_t>(i);
+	});
+
+	SortByMortonCode(keys, threadPool);
+
+	std::vector<BuildPrimitive> primitives(primitiveCount);
+	ParallelRanges(threadPool, primitiveCount, GRAIN_SIZE, [&](int begin, int end)
+	{
+		for(int i = begin; i < end; ++i)
+		{
+			int index = static_cast<int>(keys[i] & 0xFFFFFFFF);
+
+			primitives[i].min = primitiveBounds[index].min;
+			primitives[i].index = index;
+			primitives[i].max = primitiveBounds[index].max;
+			primitives[i].padding = 0;
+		}
+	});
+
+	std::vector<uint64_t>().swap(keys);
+
+	Node root;
+	root.min = bounds.min;
+	root.max = bounds.max;
+	root.firstIndex = 0;
+	root.primitiveCount = primitiveCount;
+	nodes.push_back(root);
+
+	struct PendingNode
+	{
+		int nodeIndex;
+		AABB centerBounds;
+		int depth;
+	};
+
+	//Nodes this small or smaller are built as a subtree by a single task. Several per worker
+	//so workers that get small subtrees can pick up more of them
+	int subtreeSize = primitiveCount;
+	if(threadPool != nullptr)
+		subtreeSize = std::max(static_cast<int>(MIN_SUBTREE_SIZE), primitiveCount / static_cast<int>(std::max(1u, threadPool->GetThreadCount()) * 8));
+
+	std::vector<BuildPrimitive> scratch;
+	if(primitiveCount > subtreeSize)
+		scratch.resize(primitiveCount);
+
+	//Everything above the subtrees is split one node at a time, with every worker helping
+	std::vector<PendingNode> pendingNodes(1, PendingNode{ 0, centerBounds, 1 });
+	std::vector<PendingNode> subtrees;
+	while(!pendingNodes.empty())
+	{
+		PendingNode pendingNode = pendingNodes.back();
+		pendingNodes.pop_back();
+
+		depth = std::max(depth, pendingNode.depth);
+
+		if(nodes[pendingNode.nodeIndex].primitiveCount <= subtreeSize)
+		{
+			subtrees.push_back(pendingNode);
+			continue;
+		}
+
+		AABB leftCenterBounds;
+		AABB rightCenterBounds;
+		if(!SplitNode(nodes, pendingNode.nodeIndex, primitives.data(), scratch.data(), pendingNode.centerBounds, pendingNode.depth, threadPool, leftCenterBounds, rightCenterBounds))
+			continue;
+
+		int firstChild = nodes[pendingNode.nodeIndex].firstIndex;
+
+		pendingNodes.push_back(PendingNode{ firstChild, leftCenterBounds, pendingNode.depth + 1 });
+		pendingNodes.push_back(PendingNode{ firstChild + 1, rightCenterBounds, pendingNode.depth + 1 });
+	}
+
+	std::vector<BuildPrimitive>().swap(scratch);
+
+	//Each subtree is built into its own array with its root first, and then appended to nodes
+	int subtreeCount = static_cast<int>(subtrees.size());
+
+	std::vector<std::vector<Node>> subtreeNodes(subtreeCount);
+	std::vector<int> subtreeDepths(subtreeCount, 0);
+
+	ParallelRanges(threadPool, subtreeCount, 1, [&](int begin, int end)
+	{
+		for(int i = begin; i < end; ++i)
+		{
+			subtreeNodes[i].push_back(nodes[subtrees[i].nodeIndex]);
+			Subdivide(subtreeNodes[i], 0, primitives.data(), subtrees[i].centerBounds, subtrees[i].depth, subtreeDepths[i]);
+		}
+	});
+
+	size_t nodeCount = nodes.size();
+	for(const std::vector<Node>& subtree : subtreeNodes)
+		nodeCount += subtree.size() - 1;
+
+	nodes.reserve(nodeCount);
+
+	for(int i = 0; i < subtreeCount; ++i)
+	{
+		std::vector<Node>& subtree = subtreeNodes[i];
+
+		//Subtree node j ends up at offset + j, except for the root which replaces the node it was built from
+		int offset = static_cast<int>(nodes.size()) - 1;
+		for(Node& node : subtree)
+		{
+			if(node.primitiveCount == 0)
+				node.firstIndex += offset;
+		}
+
+		nodes[subtrees[i].nodeIndex] = subtree.front();
+		nodes.insert(nodes.end(), subtree.begin() + 1, subtree.end());
+
+		depth = std::max(depth, subtreeDepths[i]);
+
+		std::vector<Node>().swap(subtree);
+	}
+
+	primitiveIndices.resize(primitiveCount);
+	ParallelRanges(threadPool, primitiveCount, GRAIN_SIZE, [&](int begin, int end)
+	{
+		for(int i = begin; i < end; ++i)
+			primitiveIndices[i] = primitives[i].index;
+	});
+
+	//A ray hitting the root hits any other node with a probability of that node's area over the root's
+	float rootArea = GetHalfArea(nodes[0].min, nodes[0].max);
+
+	double cost = 0.0;
+	for(const Node& node : nodes)
+		cost += GetHalfArea(node.min, node.max) * (node.primitiveCount > 0 ? node.primitiveCount : TRAVERSAL_COST);
+
+	sahCost = rootArea > 0.0f ? static_cast<float>(cost / rootArea) : 0.0f;
+}
+
+void BVH::Clear()
+{
+	nodes.clear();
+	primitiveIndices.clear();
+	depth = 0;
+	sahCost = 0.0f;
+}
+
+bool BVH::IsEmpty() const
+{
+	return nodes.empty();
+}
+
+int BVH::GetNodeCount() const
+{
+	return static_cast<int>(nodes.size());
+}
+
+int BVH::GetDepth() const
+{
+	return depth;
+}
+
+float BVH::GetSAHCost() const
+{
+	return sahCost;
+}
+
+size_t BVH::GetMemoryUsage() const
+{
+	return nodes.size() * sizeof(Node) + primitiveIndices.size() * sizeof(int);
+}
+
+const std::vector<BVH::Node>& BVH::GetNodes() const
+{
+	return nodes;
+}
+
+const std::vector<int>& BVH::GetPrimitiveIndices() const
+{
+	return primitiveIndices;
+}
+
+bool BVH::SplitNode(std::vector<Node>& nodes, int nodeIndex, BuildPrimitive* primitives, BuildPrimitive* scratch, const AABB& centerBounds, int currentDepth, ThreadPool* threadPool, AABB& outLeftCenterBounds, AABB& outRightCenterBounds)
+{
+	Node node = nodes[nodeIndex];
+
+	if(node.primitiveCount <= MAX_LEAF_SIZE
+		|| currentDepth >= MAX_DEPTH)
+		return false;
+
+	Split split;
+	if(!FindSplit(primitives + node.firstIndex, node.primitiveCount, AABB(node.min, node.max), centerBounds, threadPool, split))
+		return false;
+
+	//Intersecting every primitive in a leaf costs one each
+	if(node.primitiveCount <= MAX_SAH_LEAF_SIZE
+		&& split.cost >= static_cast<float>(node.primitiveCount))
+		return false;
+
+	int leftCount = Partition(primitives + node.firstIndex, scratch == nullptr ? nullptr : scratch + node.firstIndex, node.primitiveCount, split, threadPool, outLeftCenterBounds, outRightCenterBounds);
+
+	//Only if binning and partitioning disagree, which they shouldn't
+	if(leftCount == 0
+		|| leftCount == node.primitiveCount)
+		return false;
+
+	Node left;
+	left.min = split.leftBounds.min;
+	left.max = split.leftBounds.max;
+	left.firstIndex = node.firstIndex;
+	left.primitiveCount = leftCount;
+
+	Node right;
+	right.min = split.rightBounds.min;
+	right.max = split.rightBounds.max;
+	right.firstIndex = node.firstIndex + leftCount;
+	right.primitiveCount = node.primitiveCount - leftCount;
+
+	nodes[nodeIndex].firstIndex = static_cast<int>(nodes.size());
+	nodes[nodeIndex].primitiveCount = 0;
+
+	nodes.push_back(left);
+	nodes.push_back(right);
+
+	return true;
+}
+
+bool BVH::FindSplit(const BuildPrimitive* primitives, int count, const AABB& bounds, const AABB& centerBounds, ThreadPool* threadPool, Split& outSplit)
+{
+	if(!outSplit.SetBinning(centerBounds))
+		return false;
+
+	Bins bins;
+	if(threadPool == nullptr
+		|| count <= GRAIN_SIZE)
+	{
+		for(int i = 0; i < count; ++i)
+			bins.Add(primitives[i], outSplit);
+	}
+	else
+	{
+		std::vector<Bins> taskBins((count + GRAIN_SIZE - 1) / GRAIN_SIZE);
+
+		threadPool->ParallelFor(count, GRAIN_SIZE, [&](int begin, int end)
+		{
+			Bins& currentBins = taskBins[begin / GRAIN_SIZE];
+
+			for(int i = begin; i < end; ++i)
+				currentBins.Add(primitives[i], outSplit);
+		});
+
+		for(const Bins& currentBins : taskBins)
+			bins.Merge(currentBins);
+	}
+
+	float area = GetHalfArea(bounds.min, bounds.max);
+	float areaInv = area > 0.0f ? 1.0f / area : 0.0f;
+
+	outSplit.cost = std::numeric_limits<float>::max();
+	outSplit.bin = -1;
+
+	float binScale[3] = { outSplit.binScale.x, outSplit.binScale.y, outSplit.binScale.z };
+	for(int axis = 0; axis < 3; ++axis)
+	{
+		//Everything is in the first bin
+		if(binScale[axis] <= 0.0f)
+			continue;
+
+		//Bounds of every bin from i and up, for the right child of a split before bin i
+		DirectX::XMVECTOR rightMin[BIN_COUNT];
+		DirectX::XMVECTOR rightMax[BIN_COUNT];
+		int rightCount[BIN_COUNT];
+
+		DirectX::XMVECTOR min = GetEmptyMin();
+		DirectX::XMVECTOR max = GetEmptyMax();
+		int binCount = 0;
+		for(int i = BIN_COUNT - 1; i > 0; --i)
+		{
+			min = DirectX::XMVectorMin(min, bins.min[axis][i]);
+			max = DirectX::XMVectorMax(max, bins.max[axis][i]);
+			binCount += bins.count[axis][i];
+
+			rightMin[i] = min;
+			rightMax[i] = max;
+			rightCount[i] = binCount;
+		}
+
+		min = GetEmptyMin();
+		max = GetEmptyMax();
+		binCount = 0;
+		for(int i = 1; i < BIN_COUNT; ++i)
+		{
+			//Splitting after an empty bin gives the same children as splitting before it. Most bins
+			//of the many small nodes near the leaves are empty
+			if(bins.count[axis][i - 1] == 0)
+				continue;
+
+			min = DirectX::XMVectorMin(min, bins.min[axis][i - 1]);
+			max = DirectX::XMVectorMax(max, bins.max[axis][i - 1]);
+			binCount += bins.count[axis][i - 1];
+
+			if(rightCount[i] == 0)
+				break;
+
+			float cost = TRAVERSAL_COST + (GetHalfArea(min, max) * binCount + GetHalfArea(rightMin[i], rightMax[i]) * rightCount[i]) * areaInv;
+			if(cost < outSplit.cost)
+			{
+				outSplit.axis = axis;
+				outSplit.bin = i;
+				outSplit.cost = cost;
+				outSplit.leftBounds = ToAABB(min, max);
+				outSplit.rightBounds = ToAABB(rightMin[i], rightMax[i]);
+			}
+		}
+	}
+
+	return outSplit.bin != -1;
+}
+
+int BVH::Partition(BuildPrimitive* primitives, BuildPrimitive* scratch, int count, const Split& split, ThreadPool* threadPool, AABB& outLeftCenterBounds, AABB& outRightCenterBounds)
+{
+	//Both ways put the same primitives on each side, which is all binning looks at, but only the parallel one is stable
+	if(threadPool == nullptr
+		|| scratch == nullptr
+		|| count <= GRAIN_SIZE)
+	{
+		DirectX::XMVECTOR leftMin = GetEmptyMin();
+		DirectX::XMVECTOR leftMax = GetEmptyMax();
+		DirectX::XMVECTOR rightMin = GetEmptyMin();
+		DirectX::XMVECTOR rightMax = GetEmptyMax();
+
+		int left = 0;
+		int right = count;
+		while(left < right)
+		{
+			DirectX::XMVECTOR center = primitives[left].GetCenter();
+
+			if(split.IsLeft(center))
+			{
+				leftMin = DirectX::XMVectorMin(leftMin, center);
+				leftMax = DirectX::XMVectorMax(leftMax, center);
+				++left;
+			}
+			else
+			{
+				rightMin = DirectX::XMVectorMin(rightMin, center);
+				rightMax = DirectX::XMVectorMax(rightMax, center);
+				std::swap(primitives[left], primitives[--right]);
+			}
+		}
+
+		outLeftCenterBounds = ToAABB(leftMin, leftMax);
+		outRightCenterBounds = ToAABB(rightMin, rightMax);
+
+		return left;
+	}
+
+	//Every task counts its primitives on each side, which tells it where to write them in scratch
+	int taskCount = (count + GRAIN_SIZE - 1) / GRAIN_SIZE;
+
+	std::vector<int> leftOffsets(taskCount, 0);
+	std::vector<int> rightOffsets(taskCount, 0);
+	std::vector<AABB> leftCenterBounds(taskCount);
+	std::vector<AABB> rightCenterBounds(taskCount);
+
+	threadPool->ParallelFor(count, GRAIN_SIZE, [&](int begin, int end)
+	{
+		int task = begin / GRAIN_SIZE;
+
+		DirectX::XMVECTOR leftMin = GetEmptyMin();
+		DirectX::XMVECTOR leftMax = GetEmptyMax();
+		DirectX::XMVECTOR rightMin = GetEmptyMin();
+		DirectX::XMVECTOR rightMax = GetEmptyMax();
+
+		int leftCount = 0;
+		for(int i = begin; i < end; ++i)
+		{
+			DirectX::XMVECTOR center = primitives[i].GetCenter();
+
+			if(split.IsLeft(center))
+			{
+				leftMin = DirectX::XMVectorMin(leftMin, center);
+				leftMax = DirectX::XMVectorMax(leftMax, center);
+				++leftCount;
+			}
+			else
+			{
+				rightMin = DirectX::XMVectorMin(rightMin, center);
+				rightMax = DirectX::XMVectorMax(rightMax, center);
+			}
+		}
+
+		leftOffsets[task] = leftCount;
+		rightOffsets[task] = end - begin - leftCount;
+		leftCenterBounds[task] = ToAABB(leftMin, leftMax);
+		rightCenterBounds[task] = ToAABB(rightMin, rightMax);
+	});
+
+	int leftTotal = 0;
+	for(int i = 0; i < taskCount; ++i)
+		leftTotal += leftOffsets[i];
+
+	outLeftCenterBounds = AABB();
+	outRightCenterBounds = AABB();
+
+	int leftOffset = 0;
+	int rightOffset = leftTotal;
+	for(int i = 0; i < taskCount; ++i)
+	{
+		int leftCount = leftOffsets[i];
+		int rightCount = rightOffsets[i];
+
+		leftOffsets[i] = leftOffset;
+		rightOffsets[i] = rightOffset;
+
+		leftOffset += leftCount;
+		rightOffset += rightCount;
+
+		outLeftCenterBounds.Grow(leftCenterBounds[i]);
+		outRightCenterBounds.Grow(rightCenterBounds[i]);
+	}
+
+	threadPool->ParallelFor(count, GRAIN_SIZE, [&](int begin, int end)
+	{
+		int task = begin / GRAIN_SIZE;
+
+		int left = leftOffsets[task];
+		int right = rightOffsets[task];
+
+		for(int i = begin; i < end; ++i)
+		{
+			if(split.IsLeft(primitives[i].GetCenter()))
+				scratch[left++] = primitives[i];
+			else
+				scratch[right++] = primitives[i];
+		}
+	});
+
+	threadPool->ParallelFor(count, GRAIN_SIZE, [&](int begin, int end)
+	{
+		std::copy(scratch + begin, scratch + end, primitives + begin);
+	});
+
+	return leftTotal;
+}
+
+void BVH::Subdivide(std::vector<Node>& nodes, int nodeIndex, BuildPrimitive* primitives, const AABB& centerBounds, int currentDepth, int& depth)
+{
+	depth = std::max(depth, currentDepth);
+
+	AABB leftCenterBounds;
+	AABB rightCenterBounds;
+	if(!SplitNode(nodes, nodeIndex, primitives, nullptr, centerBounds, currentDepth, nullptr, leftCenterBounds, rightCenterBounds))
+		return;
+
+	int firstChild = nodes[nodeIndex].firstIndex;
+
+	Subdivide(nodes, firstChild, primitives, leftCenterBounds, currentDepth + 1, depth);
+	Subdivide(nodes, firstChild + 1, primitives, rightCenterBounds, currentDepth + 1, depth);
+}
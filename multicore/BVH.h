@@ -0,0 +1,269 @@
+#ifndef BVH_h__
+#define BVH_h__
+
+#include <DXLib/DXMath.h>
+
+#include <vector>
+#include <limits>
+
+#include "RayIntersection.h"
+
+class ThreadPool;
+
+//Bounding volume hierarchy over any kind of primitive.
+//
+//Only the primitives' bounds are given when building, so the BVH never holds a copy of the
+//geometry. Queries are given a function which intersects a single primitive against the ray
+//using whatever data the caller already has, e.g. SuperSampledShaderProgram's CPU buffers.
+//
+//Nodes are split with a binned surface area heuristic. The primitives are sorted along a Morton
+//curve before building so each node's primitives stay close together in memory, and given a
+//ThreadPool the top of the tree is split with every worker binning and partitioning before the
+//rest is built as independent subtrees, one per task
+class BVH
+{
+public:
+	struct AABB
+	{
+		AABB();
+		AABB(const DirectX::XMFLOAT3& min, const DirectX::XMFLOAT3& max);
+
+		DirectX::XMFLOAT3 min;
+		DirectX::XMFLOAT3 max;
+
+		void Grow(const DirectX::XMFLOAT3& point);
+		void Grow(const AABB& aabb);
+
+		DirectX::XMFLOAT3 GetCenter() const;
+	};
+
+	//32 bytes, two per cache line
+	struct Node
+	{
+		DirectX::XMFLOAT3 min;
+		//First primitive in primitiveIndices if this is a leaf, otherwise index of the first child.
+		//The second child always directly follows the first
+		int firstIndex;
+		DirectX::XMFLOAT3 max;
+		//Number of primitives, 0 if this isn't a leaf
+		int primitiveCount;
+	};
+
+	BVH();
+	~BVH() = default;
+
+	BVH(BVH&& other) = default;
+	BVH& operator=(BVH&& other) = default;
+
+	//************************************
+	// Method:		Build
+	// FullName:	BVH::Build
+	// Access:		public
+	// Returns:		void
+	// Qualifier:
+	// Argument:	const std::vector<AABB>& primitiveBounds - bounds of each primitive, the index is passed to the intersection function
+	// Argument:	ThreadPool* threadPool - builds on the pool's workers if given. Everything is run on the calling
+	//				thread if it's one of the workers, see ThreadPool::ParallelFor
+	// Description:	Replaces any previously built hierarchy. Split planes, and so the shape of the tree, are the same
+	//				with or without a threadPool. Node numbering and the order of the primitives in a leaf aren't:
+	//				the pool's workers partition through a scratch array and keep the order, a single thread
+	//				partitions in place by swapping
+	//************************************
+	void Build(const std::vector<AABB>& primitiveBounds, ThreadPool* threadPool = nullptr);
+	void Clear();
+
+	//************************************
+	// Method:		Intersect
+	// FullName:	BVH::Intersect
+	// Access:		public
+	// Returns:		bool - true if intersectPrimitive returned true for any primitive
+	// Qualifier:	const
+	// Argument:	const DirectX::XMFLOAT3& rayPosition
+	// Argument:	const DirectX::XMFLOAT3& rayDirection
+	// Argument:	float& maxDistance - only hits closer than this are considered. Set to the closest hit's distance
+	// Argument:	IntersectFunction intersectPrimitive - bool(int primitiveIndex, float& maxDistance). Should return
+	//				true and set maxDistance if the primitive is hit closer than maxDistance
+	// Description:	Finds the closest hit. Nodes are visited front to back, so most primitives behind the closest
+	//				hit are never tested. Safe to call from several threads at once
+	//************************************
+	template<typename IntersectFunction>
+	bool Intersect(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float& maxDistance, IntersectFunction intersectPrimitive) const;
+	//************************************
+	// Method:		IntersectAny
+	// FullName:	BVH::IntersectAny
+	// Access:		public
+	// Returns:		bool - true if intersectPrimitive returned true for any primitive
+	// Qualifier:	const
+	// Argument:	const DirectX::XMFLOAT3& rayPosition
+	// Argument:	const DirectX::XMFLOAT3& rayDirection
+	// Argument:	float maxDistance - only hits closer than this are considered
+	// Argument:	IntersectFunction intersectPrimitive - same as for Intersect
+	// Description:	Stops at the first hit instead of looking for the closest one, for occlusion tests.
+	//				Safe to call from several threads at once
+	//************************************
+	template<typename IntersectFunction>
+	bool IntersectAny(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float maxDistance, IntersectFunction intersectPrimitive) const;
+
+	bool IsEmpty() const;
+	int GetNodeCount() const;
+	int GetDepth() const;
+	//Expected cost of a ray visiting every node it hits, relative to intersecting one primitive. Lower is better
+	float GetSAHCost() const;
+	//Bytes used by nodes and primitive indices
+	size_t GetMemoryUsage() const;
+
+	//For building other layouts from this one, see WideBVH
+	const std::vector<Node>& GetNodes() const;
+	const std::vector<int>& GetPrimitiveIndices() const;
+
+private:
+	//Leaves with this many primitives or fewer aren't split
+	static const int MAX_LEAF_SIZE = 4;
+	//Leaves with this many primitives or fewer aren't split if the surface area heuristic says it isn't worth it
+	static const int MAX_SAH_LEAF_SIZE = 16;
+	//Deeper than any balanced tree can get with 32 bit indices, so the traversal stack never overflows
+	static const int MAX_DEPTH = 64;
+	//Split candidates per axis, one between each bin
+	static const int BIN_COUNT = 16;
+	//Primitives per task when a pass over them is split across a ThreadPool
+	static const int GRAIN_SIZE = 16384;
+	//Subtrees smaller than this are never split across several tasks
+	static const int MIN_SUBTREE_SIZE = 4096;
+	//Cost of visiting a node relative to intersecting a primitive
+	static const float TRAVERSAL_COST;
+
+	struct BuildPrimitive;
+	struct Split;
+	struct Bins;
+
+	std::vector<Node> nodes;
+	std::vector<int> primitiveIndices;
+
+	int depth;
+	float sahCost;
+
+	//************************************
+	// Method:		SplitNode
+	// FullName:	BVH::SplitNode
+	// Access:		private static
+	// Returns:		bool - false if the node should be a leaf
+	// Qualifier:
+	// Argument:	std::vector<Node>& nodes - both children are appended if the node is split
+	// Argument:	int nodeIndex
+	// Argument:	BuildPrimitive* primitives - reordered so each child's primitives are contiguous
+	// Argument:	BuildPrimitive* scratch - as many elements as primitives, only needed with a threadPool
+	// Argument:	const AABB& centerBounds - bounds of the node's primitives' centers
+	// Argument:	int currentDepth
+	// Argument:	ThreadPool* threadPool - bins and partitions across the pool's workers if given
+	// Argument:	AABB& outLeftCenterBounds
+	// Argument:	AABB& outRightCenterBounds
+	//************************************
+	static bool SplitNode(std::vector<Node>& nodes, int nodeIndex, BuildPrimitive* primitives, BuildPrimitive* scratch, const AABB& centerBounds, int currentDepth, ThreadPool* threadPool, AABB& outLeftCenterBounds, AABB& outRightCenterBounds);
+	static bool FindSplit(const BuildPrimitive* primitives, int count, const AABB& bounds, const AABB& centerBounds, ThreadPool* threadPool, Split& outSplit);
+	//Returns the number of primitives that went to the left child
+	static int Partition(BuildPrimitive* primitives, BuildPrimitive* scratch, int count, const Split& split, ThreadPool* threadPool, AABB& outLeftCenterBounds, AABB& outRightCenterBounds);
+	//Builds everything below nodeIndex on the calling thread
+	static void Subdivide(std::vector<Node>& nodes, int nodeIndex, BuildPrimitive* primitives, const AABB& centerBounds, int currentDepth, int& depth);
+
+	template<bool ANY_HIT, typename IntersectFunction>
+	bool Traverse(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float& maxDistance, IntersectFunction& intersectPrimitive) const;
+};
+
+template<typename IntersectFunction>
+bool BVH::Intersect(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float& maxDistance, IntersectFunction intersectPrimitive) const
+{
+	return Traverse<false>(rayPosition, rayDirection, maxDistance, intersectPrimitive);
+}
+
+template<typename IntersectFunction>
+bool BVH::IntersectAny(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float maxDistance, IntersectFunction intersectPrimitive) const
+{
+	return Traverse<true>(rayPosition, rayDirection, maxDistance, intersectPrimitive);
+}
+
+template<bool ANY_HIT, typename IntersectFunction>
+bool BVH::Traverse(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float& maxDistance, IntersectFunction& intersectPrimitive) const
+{
+	if(nodes.empty())
+		return false;
+
+	DirectX::XMFLOAT3 inverseDirection(1.0f / rayDirection.x, 1.0f / rayDirection.y, 1.0f / rayDirection.z);
+
+	float distance;
+	if(!RayAABBIntersection(rayPosition, inverseDirection, nodes[0].min, nodes[0].max, maxDistance, distance))
+		return false;
+
+	bool hit = false;
+
+	int stack[MAX_DEPTH + 1];
+	int stackSize = 0;
+
+	int nodeIndex = 0;
+	while(true)
+	{
+		const Node& node = nodes[nodeIndex];
+
+		if(node.primitiveCount > 0)
+		{
+			for(int i = node.firstIndex, end = node.firstIndex + node.primitiveCount; i < end; ++i)
+			{
+				if(intersectPrimitive(primitiveIndices[i], maxDistance))
+				{
+					if(ANY_HIT)
+						return true;
+
+					hit = true;
+				}
+			}
+		}
+		else
+		{
+			int nearIndex = node.firstIndex;
+			int farIndex = node.firstIndex + 1;
+
+			float nearDistance;
+			float farDistance;
+
+			bool nearHit = RayAABBIntersection(rayPosition, inverseDirection, nodes[nearIndex].min, nodes[nearIndex].max, maxDistance, nearDistance);
+			bool farHit = RayAABBIntersection(rayPosition, inverseDirection, nodes[farIndex].min, nodes[farIndex].max, maxDistance, farDistance);
+
+			if(nearHit && farHit)
+			{
+				if(farDistance < nearDistance)
+					std::swap(nearIndex, farIndex);
+
+				stack[stackSize++] = farIndex;
+				nodeIndex = nearIndex;
+
+				continue;
+			}
+			else if(nearHit)
+			{
+				nodeIndex = nearIndex;
+				continue;
+			}
+			else if(farHit)
+			{
+				nodeIndex = farIndex;
+				continue;
+			}
+		}
+
+		if(stackSize == 0)
+			break;
+
+		//The closest hit might have moved in front of nodes that were pushed earlier
+		nodeIndex = stack[--stackSize];
+		while(!RayAABBIntersection(rayPosition, inverseDirection, nodes[nodeIndex].min, nodes[nodeIndex].max, maxDistance, distance))
+		{
+			if(stackSize == 0)
+				return hit;
+
+			nodeIndex = stack[--stackSize];
+		}
+	}
+
+	return hit;
+}
+
+#endif // BVH_h__
@@ -33,11 +33,22 @@ bool ConstantBufferShaderProgram::InitBuffers(ID3D11UnorderedAccessView* depthBu
 	if(!ShaderProgram::InitBuffers(depthBufferUAV, backBufferUAV))
 		return false;
 
+	//WriteScene reallocates the arrays sceneQuery reads from, so any running query has to finish first
+	sceneQuery.Clear();
+	WriteScene();
+
 	LogErrorReturnFalse(sphereBuffer.Create<ConstantBufferSharedBuffers::SphereBuffer>(device, D3D11_BIND_CONSTANT_BUFFER, D3D11_USAGE_DEFAULT, static_cast<D3D11_CPU_ACCESS_FLAG>(0), &sphereBufferData), "Couldn't create sphere buffer: ");
 	LogErrorReturnFalse(triangleVertexBuffer.Create<ConstantBufferSharedBuffers::VertexBuffer>(device, D3D11_BIND_CONSTANT_BUFFER, D3D11_USAGE_DEFAULT, static_cast<D3D11_CPU_ACCESS_FLAG>(0), &vertexBufferData), "Couldn't create triangle vertex buffer: ");
 	LogErrorReturnFalse(triangleBuffer.Create<ConstantBufferSharedBuffers::TriangleBuffer>(device, D3D11_BIND_CONSTANT_BUFFER, D3D11_USAGE_DEFAULT, static_cast<D3D11_CPU_ACCESS_FLAG>(0), &triangleBufferData), "Couldn't create triangle index buffer: ");
 	LogErrorReturnFalse(viewProjInverseBuffer.Create<DirectX::XMFLOAT4X4>(device, D3D11_BIND_CONSTANT_BUFFER, D3D11_USAGE_DYNAMIC, D3D11_CPU_ACCESS_WRITE), "Couldn't create triangle index buffer: ");
 
+	//Every vertex is viewed since the buffer doesn't keep a count, only the ones referenced by triangles are read
+	SceneGeometry sceneGeometry;
+	sceneGeometry.spheres = StridedView<DirectX::XMFLOAT4>(sphereBufferData.spheres.position, sizeof(DirectX::XMFLOAT4), sphereBufferData.sphereCount);
+	sceneGeometry.vertices = StridedView<DirectX::XMFLOAT3>(&vertexBufferData.vertices[0].position, sizeof(ConstantBufferSharedBuffers::VertexBufferData), MAX_VERTICES);
+	sceneGeometry.triangles = StridedView<DirectX::XMINT3>(triangleBufferData.triangles.indicies, sizeof(DirectX::XMINT4), triangleBufferData.triangleCount);
+	sceneQuery.Build(sceneGeometry, &contentManager->GetThreadPool());
+
 	if(!InitUAVSRV())
 		return false;
 	if(!InitShaders())
@@ -74,6 +85,16 @@ bool ConstantBufferShaderProgram::InitUAVSRV()
 
 bool ConstantBufferShaderProgram::InitShaders()
 {
+	//Only a single texture is supported, the one used by the last model added. A scene with only spheres has no model to take it from
+	const auto& models = sceneBuilder.GetModels();
+	if(models.empty() || models.back().material.diffuseTexture == nullptr)
+	{
+		Logger::LogLine(LOG_TYPE::FATAL, "The scene needs at least one model with a diffuse texture");
+		return false;
+	}
+
+	Texture2D* diffuseTexture = models.back().material.diffuseTexture;
+
 	//////////////////////////////////////////////////
 	//Primary rays
 	//////////////////////////////////////////////////
@@ -109,7 +130,7 @@ bool ConstantBufferShaderProgram::InitShaders()
 	//SRVs
 	traceResourceBindInitial.AddResource(rayPositionSRV[0].get(), 0);
 	traceResourceBindInitial.AddResource(rayDirectionSRV[0].get(), 1);
-	traceResourceBindInitial.AddResource(objFile->GetMeshes().front().material.diffuseTexture->GetTextureResourceView(), 2);
+	traceResourceBindInitial.AddResource(diffuseTexture->GetTextureResourceView(), 2);
 
 	//Samplers
 	traceResourceBindInitial.AddResource(SamplerStates::linearClamp, 0);
@@ -132,7 +153,7 @@ bool ConstantBufferShaderProgram::InitShaders()
 	//SRVs
 	traceResourceBinds0.AddResource(rayPositionSRV[0].get(), 0);
 	traceResourceBinds0.AddResource(rayDirectionSRV[0].get(), 1);
-	traceResourceBinds0.AddResource(objFile->GetMeshes().front().material.diffuseTexture->GetTextureResourceView(), 2);
+	traceResourceBinds0.AddResource(diffuseTexture->GetTextureResourceView(), 2);
 
 	//Samplers
 	traceResourceBinds0.AddResource(SamplerStates::linearClamp, 0);
@@ -153,7 +174,7 @@ bool ConstantBufferShaderProgram::InitShaders()
 	//SRVs
 	traceResourceBinds1.AddResource(rayPositionSRV[1].get(), 0);
 	traceResourceBinds1.AddResource(rayDirectionSRV[1].get(), 1);
-	traceResourceBinds1.AddResource(objFile->GetMeshes().front().material.diffuseTexture->GetTextureResourceView(), 2);
+	traceResourceBinds1.AddResource(diffuseTexture->GetTextureResourceView(), 2);
 
 	//Samplers
 	traceResourceBinds1.AddResource(SamplerStates::linearClamp, 0);
@@ -279,74 +300,65 @@ void ConstantBufferShaderProgram::DrawComposit(int config)
 	compositShader.Unbind(deviceContext);
 }
 
-void ConstantBufferShaderProgram::AddOBJ(const std::string& path, DirectX::XMFLOAT3 position, float scale)
+size_t ConstantBufferShaderProgram::GetSceneMemoryUsage() const
 {
-	objFile = contentManager->Load<OBJFile>(path);
-	if(objFile == nullptr)
-		return;
+	//Constant buffers are always their full size
+	return sizeof(sphereBufferData) + sizeof(vertexBufferData) + sizeof(triangleBufferData);
+}
 
-	Mesh mesh = objFile->GetMeshes().front();
+void ConstantBufferShaderProgram::WriteScene()
+{
+	const auto& spheres = sceneBuilder.GetSpheres();
 
-	if(mesh.vertices.size() > MAX_VERTICES)
-		Logger::LogLine(LOG_TYPE::WARNING, path + " has " + std::to_string(mesh.vertices.size()) + " vertices which is larger than MAX_VERTICES (" + std::to_string(MAX_VERTICES) + "). Only the first " + std::to_string(MAX_VERTICES) + " will be used");
+	if(spheres.size() > MAX_SPHERES)
+		Logger::LogLine(LOG_TYPE::WARNING, "Tried to add more sphere than " + std::to_string(MAX_SPHERES) + " (MAX_SPHERES)");
 
-	if(triangleBufferData.triangleCount + mesh.indicies.size() / 3 > MAX_INDICIES)
+	sphereBufferData.sphereCount = std::min(static_cast<int>(spheres.size()), MAX_SPHERES);
+	for(int i = 0; i < sphereBufferData.sphereCount; ++i)
 	{
-		Logger::LogLine(LOG_TYPE::WARNING, path + " has " + std::to_string(mesh.indicies.size()) + " indicies and the buffer currently contains " + std::to_string(triangleBufferData.triangleCount) + " indicies. Can't add the model's indicies since it would overflow the buffer");
-		return;
+		sphereBufferData.spheres.position[i] = spheres[i].position;
+		sphereBufferData.spheres.color[i] = spheres[i].color;
 	}
 
-	int vertexOffset = 0;
-
-	for(int i = 0; i < triangleBufferData.triangleCount; i++)
-	{
-		vertexOffset = std::max(vertexOffset, triangleBufferData.triangles.indicies[i].x + 1);
-		vertexOffset = std::max(vertexOffset, triangleBufferData.triangles.indicies[i].y + 1);
-		vertexOffset = std::max(vertexOffset, triangleBufferData.triangles.indicies[i].z + 1);
-	}
+	//Only whole models are kept, up to the first one that doesn't fit in the buffers
+	const auto& models = sceneBuilder.GetModels();
 
-	if(vertexOffset + mesh.vertices.size() > MAX_VERTICES)
+	int modelCount = 0;
+	for(const auto& model : models)
 	{
-		Logger::LogLine(LOG_TYPE::WARNING, "sword.obj has " + std::to_string(mesh.vertices.size()) + " vertices and the buffer currently contains " + std::to_string(mesh.vertices.size()) + " vertices. Can't add the model's vertices since it would overflow the buffer");
-		return;
+		if(model.endVertex > MAX_VERTICES
+			|| model.endIndex > MAX_TRIANGLES)
+		{
+			Logger::LogLine(LOG_TYPE::WARNING, "The scene has " + std::to_string(sceneBuilder.GetVertexCount()) + " vertices and " + std::to_string(sceneBuilder.GetTriangleCount()) + " triangles, only the first " + std::to_string(modelCount) + " of " + std::to_string(models.size()) + " models fit in the buffers");
+			break;
+		}
+
+		++modelCount;
 	}
 
-	for(int i = 0, end = static_cast<int>(mesh.vertices.size()); i < end; ++i)
+	//The buffers are too small to be worth splitting across threads
+	std::vector<ConstantBufferSharedBuffers::VertexBufferData> vertices(sceneBuilder.GetVertexCount());
+	sceneBuilder.WriteVertices(vertices.data(), [](const OBJVertex& vertex, ConstantBufferSharedBuffers::VertexBufferData& outVertex)
 	{
-		vertexBufferData.vertices[vertexOffset + i].position.x = mesh.vertices[i].position.x + position.x;
-		vertexBufferData.vertices[vertexOffset + i].position.y = mesh.vertices[i].position.y + position.y;
-		vertexBufferData.vertices[vertexOffset + i].position.z = mesh.vertices[i].position.z + position.z;
-
-		int u = mesh.vertices[i].texCoord.x * 0xFFFF;
-		int v = mesh.vertices[i].texCoord.y * 0xFFFF;
+		outVertex.position = vertex.position;
 
-		vertexBufferData.vertices[vertexOffset + i].texCoord = ((u << 16) | v);
-	}
+		int u = vertex.texCoord.x * 0xFFFF;
+		int v = vertex.texCoord.y * 0xFFFF;
 
-	int triangleOffset = triangleBufferData.triangleCount;
+		outVertex.texCoord = (u << 16) | v;
+	});
 
-	for(int i = 0, end = static_cast<int>(mesh.indicies.size()) / 3; i < end; ++i)
+	std::vector<DirectX::XMINT4> triangles(sceneBuilder.GetTriangleCount());
+	sceneBuilder.WriteTriangles(triangles.data(), [](const DirectX::XMINT3& indicies, int modelIndex, DirectX::XMINT4& outTriangle)
 	{
-		triangleBufferData.triangles.indicies[triangleOffset + i].x = vertexOffset + mesh.indicies[i * 3];
-		triangleBufferData.triangles.indicies[triangleOffset + i].y = vertexOffset + mesh.indicies[i * 3 + 1];
-		triangleBufferData.triangles.indicies[triangleOffset + i].z = vertexOffset + mesh.indicies[i * 3 + 2];
-		triangleBufferData.triangles.indicies[triangleOffset + i].w = 0;
+		outTriangle = DirectX::XMINT4(indicies.x, indicies.y, indicies.z, 0);
+	});
 
-		++triangleBufferData.triangleCount;
-	}
-}
-
-void ConstantBufferShaderProgram::AddSphere(DirectX::XMFLOAT4 sphere, DirectX::XMFLOAT4 color)
-{
-	if(sphereBufferData.sphereCount == MAX_SPHERES)
-	{
-		Logger::LogLine(LOG_TYPE::WARNING, "Tried to add more sphere than " + std::to_string(MAX_SPHERES) + " (MAX_SPHERES)");
-		return;
-	}
+	int vertexCount = modelCount == 0 ? 0 : models[modelCount - 1].endVertex;
+	triangleBufferData.triangleCount = modelCount == 0 ? 0 : models[modelCount - 1].endIndex;
 
-	sphereBufferData.spheres.position[sphereBufferData.sphereCount] = sphere;
-	sphereBufferData.spheres.color[sphereBufferData.sphereCount] = color;
-	++sphereBufferData.sphereCount;
+	std::copy(vertices.begin(), vertices.begin() + vertexCount, vertexBufferData.vertices);
+	std::copy(triangles.begin(), triangles.begin() + triangleBufferData.triangleCount, triangleBufferData.triangles.indicies);
 }
 
 std::string ConstantBufferShaderProgram::ReloadShadersInternal()
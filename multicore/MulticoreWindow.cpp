@@ -4,11 +4,19 @@
 #include <vector>
 #include <functional>
 #include <cmath>
+#include <sstream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <algorithm>
 
 #include <DXLib/Logger.h>
 #include <DXLib/input.h>
 #include <DXLib/States.h>
 #include <DXLib/SamplerStates.h>
+#include <DXLib/XmlFile.h>
+#include <DXLib/XmlReader.h>
+#include <DXLib/XmlTree.h>
 
 #include <DXConsole/console.h>
 #include <DXConsole/commandGetSet.h>
@@ -39,9 +47,16 @@ MulticoreWindow::MulticoreWindow(HINSTANCE hInstance, int nCmdShow, UINT width,
 	, bezierDomainShader("main", "ds_5_0")
 	, drawConsole(false)
 	, cinematicCameraMode(false)
+	, recordingCamera(false)
+	, replayingCamera(false)
+	, quitAfterReplay(false)
+	, replaySpeed(1.0)
+	, replayPosition(0.0)
+	, replayFrameIndex(-1)
 	, bezierVertexCount(0)
 	, lightSinVal(0.0f)
 	, lightOtherSinVal(0.0f)
+	, scenePath("scenes/room.scene")
 	, cameraSpeed(0.005f)
 {
 }
@@ -51,10 +66,13 @@ MulticoreWindow::~MulticoreWindow()
 
 bool MulticoreWindow::Init()
 {
-	srand(static_cast<unsigned int>(time(nullptr)));
-
 	//Content manager
 	contentManager.Init(device.get());
+
+	//The scene is read first so its meshes are prefetched along with everything else
+	LogErrorReturnFalse(scene.Load(scenePath), "Couldn't load scene: ");
+	PrefetchContent();
+
 	calibri16 = contentManager.Load<CharacterSet>("calibri16");
 
 	//Sprite renderer
@@ -72,6 +90,18 @@ bool MulticoreWindow::Init()
 	auto printCameraFrames = new CommandCallMethod("PrintCameraFrames", std::bind(&MulticoreWindow::PrintCameraFrames, this, std::placeholders::_1));
 	auto setCameraTargetSpeed = new CommandCallMethod("SetCameraTargetSpeed", std::bind(&MulticoreWindow::SetCameraTargetSpeed, this, std::placeholders::_1));
 	auto reloadShaders = new CommandCallMethod("ReloadShaders", std::bind(&MulticoreWindow::ReloadShaders, this, std::placeholders::_1));
+	auto printContentMemory = new CommandCallMethod("PrintContentMemory", std::bind(&MulticoreWindow::PrintContentMemory, this, std::placeholders::_1));
+	auto benchmarkXML = new CommandCallMethod("BenchmarkXML", std::bind(&MulticoreWindow::BenchmarkXML, this, std::placeholders::_1), true);
+	auto compileScene = new CommandCallMethod("CompileScene", std::bind(&MulticoreWindow::CompileScene, this, std::placeholders::_1), true);
+	auto loadScene = new CommandCallMethod("LoadScene", std::bind(&MulticoreWindow::LoadScene, this, std::placeholders::_1), true);
+	auto startSweep = new CommandCallMethod("StartSweep", std::bind(&MulticoreWindow::StartSweep, this, std::placeholders::_1), true);
+	auto stopSweep = new CommandCallMethod("StopSweep", std::bind(&MulticoreWindow::StopSweep, this, std::placeholders::_1));
+	auto startStressBenchmark = new CommandCallMethod("StartStressBenchmark", std::bind(&MulticoreWindow::StartStressBenchmark, this, std::placeholders::_1), true);
+	auto stopStressBenchmark = new CommandCallMethod("StopStressBenchmark", std::bind(&MulticoreWindow::StopStressBenchmark, this, std::placeholders::_1));
+	auto startCameraRecording = new CommandCallMethod("StartCameraRecording", std::bind(&MulticoreWindow::StartCameraRecording, this, std::placeholders::_1));
+	auto stopCameraRecording = new CommandCallMethod("StopCameraRecording", std::bind(&MulticoreWindow::StopCameraRecording, this, std::placeholders::_1), true);
+	auto replayCameraRecording = new CommandCallMethod("ReplayCameraRecording", std::bind(&MulticoreWindow::ReplayCameraRecording, this, std::placeholders::_1), true);
+	auto stopCameraReplay = new CommandCallMethod("StopCameraReplay", std::bind(&MulticoreWindow::StopCameraReplay, this, std::placeholders::_1));
 
 	console.AddCommand(resetCamera);
 	console.AddCommand(pauseCamera);
@@ -82,16 +112,39 @@ bool MulticoreWindow::Init()
 	console.AddCommand(printCameraFrames);
 	console.AddCommand(setCameraTargetSpeed);
 	console.AddCommand(reloadShaders);
+	console.AddCommand(printContentMemory);
+	console.AddCommand(benchmarkXML);
+	console.AddCommand(compileScene);
+	console.AddCommand(loadScene);
+	console.AddCommand(startSweep);
+	console.AddCommand(stopSweep);
+	console.AddCommand(startStressBenchmark);
+	console.AddCommand(stopStressBenchmark);
+	console.AddCommand(startCameraRecording);
+	console.AddCommand(stopCameraRecording);
+	console.AddCommand(replayCameraRecording);
+	console.AddCommand(stopCameraReplay);
+
+	console.SetCommandExecutedCallback(std::bind(&MulticoreWindow::CommandExecuted, this, std::placeholders::_1));
 
 	auto rayBounces = new CommandGetterSetter<int>("rayBounces", std::bind(&MulticoreWindow::GetRayBounces, this), std::bind(&MulticoreWindow::SetRayBounces, this, std::placeholders::_1));
 	auto lightAttenuation = new CommandGetterSetter<LightAttenuation>("lightAttenuationFactors", std::bind(&MulticoreWindow::GetLightAttenuationFactors, this), std::bind(&MulticoreWindow::SetLightAttenuationFactors, this, std::placeholders::_1));
 
+	auto contentMemoryBudget = new CommandGetterSetter<int>("contentMemoryBudget", std::bind(&MulticoreWindow::GetContentMemoryBudget, this), std::bind(&MulticoreWindow::SetContentMemoryBudget, this, std::placeholders::_1));
+	auto sceneQueryBVHWidth = new CommandGetterSetter<int>("sceneQueryBVHWidth", std::bind(&MulticoreWindow::GetSceneQueryBVHWidth, this), std::bind(&MulticoreWindow::SetSceneQueryBVHWidth, this, std::placeholders::_1));
+
 	console.AddCommand(rayBounces);
 	console.AddCommand(lightAttenuation);
+	console.AddCommand(contentMemoryBudget);
+	console.AddCommand(sceneQueryBVHWidth);
 
 	auto cameraSpeedCommand = new CommandGetSet<float>("cameraSpeed", &cameraSpeed);
 	console.AddCommand(cameraSpeedCommand);
 
+	//Set to e.g. 16.67 so that benchmarks see the same camera path at the same frame regardless of frame rate
+	auto cameraFixedTimeStep = new CommandGetterSetter<float>("cameraFixedTimeStep", std::bind(&CinematicCamera::GetFixedTimeStep, &cinematicCamera), std::bind(&CinematicCamera::SetFixedTimeStep, &cinematicCamera, std::placeholders::_1));
+	console.AddCommand(cameraFixedTimeStep);
+
 #if USE_ALL_SHADER_PROGRAMS
 	auto setShaderProgram = new CommandCallMethod("SetShaderProgram", std::bind(&MulticoreWindow::SetShaderProgram, this, std::placeholders::_1));
 	console.AddCommand(setShaderProgram);
@@ -146,7 +199,7 @@ bool MulticoreWindow::Init()
 
 	if(!InitUAVs())
 		return false;
-	if(!InitRoom())
+	if(!InitScene())
 		return false;
 	if(!InitPointLights())
 		return false;
@@ -161,28 +214,8 @@ bool MulticoreWindow::Init()
 	if(!InitGraphs())
 		return false;
 
-#if USE_ALL_SHADER_PROGRAMS
-	if(!constantBufferShaderProgram->InitBuffers(depthBufferUAV.get(), backBufferUAV.get()))
-		return false;
-	if(!structuredBufferShaderProgram->InitBuffers(depthBufferUAV.get(), backBufferUAV.get()))
-		return false;
-	if(!aabbStructuredBufferShaderProgram->InitBuffers(depthBufferUAV.get(), backBufferUAV.get()))
-		return false;
-	if(!superSampledShaderProgram->InitBuffers(depthBufferUAV.get(), backBufferUAV.get()))
-		return false;
-#elif USE_CONSTANT_BUFFER_SHADER_PROGRAM
-	if(!constantBufferShaderProgram->InitBuffers(depthBufferUAV.get(), backBufferUAV.get()))
-		return false;
-#elif USE_STRUCTURED_BUFFER_SHADER_PROGRAM
-	if(!structuredBufferShaderProgram->InitBuffers(depthBufferUAV.get(), backBufferUAV.get()))
-		return false;
-#elif USE_AABBSTRUCTUREDBUFFER_SHADER_PROGRAM
-	if(!aabbStructuredBufferShaderProgram->InitBuffers(depthBufferUAV.get(), backBufferUAV.get()))
-		return false;
-#elif USE_SUPER_SAMPLED_SHADER_PROGRAM
-	if(!superSampledShaderProgram->InitBuffers(depthBufferUAV.get(), backBufferUAV.get()))
+	if(!InitSceneBuffers())
 		return false;
-#endif
 
 	if(cinematicCameraMode)
 		currentCamera = &cinematicCamera;
@@ -193,44 +226,10 @@ bool MulticoreWindow::Init()
 	fpsCamera.InitFovHorizontal(DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), DirectX::XMFLOAT3(0.0f, 0.0f, 1.0f), DirectX::XMConvertToRadians(90.0f), static_cast<float>(width) / static_cast<float>(height), 0.01f, 1000.0f);
 	cinematicCamera.InitFovHorizontal(DirectX::XMFLOAT3(0.0f, 3.0f, -7.0f), DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), DirectX::XMConvertToRadians(90.0f), static_cast<float>(width) / static_cast<float>(height), 0.01f, 100.0f);
 	cinematicCamera.LookAt(DirectX::XMFLOAT3(0.0f, 3.5f, 0.0f));
-
-	std::vector<CameraKeyFrame> cinematicKeyFrames;
-	CameraKeyFrame newFrame;
-
-	/*newFrame.position = DirectX::XMFLOAT3(-1.85f, 3.45f, -0.0f);
-	cinematicKeyFrames.push_back(newFrame);
-
-	newFrame.position = DirectX::XMFLOAT3(-0.0f, 3.5f, -2.5f);
-	cinematicKeyFrames.push_back(newFrame);
-
-	newFrame.position = DirectX::XMFLOAT3(2.5f, 3.45f, 0.0f);
-	cinematicKeyFrames.push_back(newFrame);
-
-	newFrame.position = DirectX::XMFLOAT3(2.5f, 4.5f, 4.2f);
-	cinematicKeyFrames.push_back(newFrame);
-
-	newFrame.position = DirectX::XMFLOAT3(-1.8f, 4.75f, 4.5f);
-	cinematicKeyFrames.push_back(newFrame);
-
-	newFrame.position = DirectX::XMFLOAT3(-4.0f, 5.0f, 2.65f);
-	cinematicKeyFrames.push_back(newFrame);*/
-
-	newFrame.position = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
-	cinematicKeyFrames.push_back(newFrame);
-
-	newFrame.position = DirectX::XMFLOAT3(1.0f, 0.0f, 0.0f);
-	cinematicKeyFrames.push_back(newFrame);
-
-	newFrame.position = DirectX::XMFLOAT3(0.0f, 0.0f, 1.0f);
-	cinematicKeyFrames.push_back(newFrame);
-
-	cinematicCamera.SetKeyFrames(cinematicKeyFrames);
+	replayCamera.InitFovHorizontal(DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), DirectX::XMFLOAT3(0.0f, 0.0f, 1.0f), DirectX::XMConvertToRadians(90.0f), static_cast<float>(width) / static_cast<float>(height), 0.01f, 1000.0f);
 
 	InitBezier();
-
-	cinematicCamera.SetLoop(true);
-	cinematicCamera.Reset();
-	cinematicCamera.Start();
+	ApplySceneCameraPath();
 
 	POINT midPoint;
 	midPoint.x = 640;
@@ -239,11 +238,21 @@ bool MulticoreWindow::Init()
 	ClientToScreen(hWnd, &midPoint);
 	SetCursorPos(midPoint.x, midPoint.y);
 
+	//Anything that was prefetched but never loaded
+	contentManager.WaitForPending();
+
 	console.Autoexec();
 
+	controlPipe.Start("multicore");
+
 	return true;
 }
 
+void MulticoreWindow::SetScenePath(const std::string& path)
+{
+	scenePath = path;
+}
+
 void MulticoreWindow::Run()
 {
 	if(!Init())
@@ -261,22 +270,46 @@ void MulticoreWindow::Run()
 		run = PeekMessages();
 		Input::Update();
 
+		contentManager.FinalizePending();
+
+		//Commands from the control pipe are run between frames, even when paused
+		controlPipe.ExecutePending(&console);
+
 		if(!paused)
 		{
 			gameTimer.UpdateDelta();
 
 			perFrameGraph.AddValueToTrack("Delta", gameTimer.GetDeltaMillisecondsFraction());
 
+			sweepRunner.BeginFrame();
+			stressBenchmark.BeginFrame();
+			AddFrameTiming("Delta", gameTimer.GetDeltaMillisecondsFraction());
+
+			std::chrono::nanoseconds delta = gameTimer.GetDelta();
+			if(replayingCamera)
+				delta = StepCameraReplay();
+
 			//updateTimer.Reset();
 			//updateTimer.Start();
-			Update(gameTimer.GetDelta());
+			Update(delta);
 			//updateTimer.Stop();
 
+			if(recordingCamera)
+				RecordCameraFrame(delta);
+
 			//drawTimer.Reset();
 			//drawTimer.Start();
 			Draw();
 			//drawTimer.Stop();
 
+			sweepRunner.EndFrame();
+			stressBenchmark.EndFrame();
+			controlPipe.EndFrame();
+
+			if(replayingCamera
+				&& replayPosition >= replayFrames.size())
+				EndCameraReplay();
+
 			//cpuGraph.AddValueToTrack("Update", updateTimer.GetTimeMillisecondsFraction());
 			//cpuGraph.AddValueToTrack("Draw", drawTimer.GetTimeMillisecondsFraction());
 
@@ -313,7 +346,11 @@ void MulticoreWindow::Update(std::chrono::nanoseconds delta)
 
 	float sensitivity = 0.001f;
 
-	if(cinematicCameraMode)
+	if(replayingCamera)
+	{
+		//The camera is moved by StepCameraReplay
+	}
+	else if(cinematicCameraMode)
 		cinematicCamera.Update(delta);
 	else if(!drawConsole)
 	{
@@ -338,7 +375,7 @@ void MulticoreWindow::Update(std::chrono::nanoseconds delta)
 			fpsCamera.MoveUp(-cameraSpeed);
 	}
 
-	if(!drawConsole && !cinematicCameraMode)
+	if(!drawConsole && !cinematicCameraMode && !replayingCamera)
 	{
 		currentCamera->Rotate(DirectX::XMFLOAT2(xDelta * sensitivity, yDelta * sensitivity));
 		ClientToScreen(hWnd, &midPoint);
@@ -372,6 +409,8 @@ void MulticoreWindow::Draw()
 
 	for(const auto& pair : d3d11Times)
 	{
+		AddFrameTiming(pair.first, pair.second);
+
 		if(pair.first.compare(0, 9, "Intersect") == 0)
 			intersectionTime += static_cast<float>(pair.second);
 		else if(pair.first.compare(0, 5, "Shade") == 0)
@@ -388,6 +427,9 @@ void MulticoreWindow::Draw()
 	perFrameGraph.AddValueToTrack("Shade", shadeTime);
 	perSecondGraph.AddValueToTrack("Shade", shadeTime);
 
+	AddFrameTiming("Intersect", intersectionTime);
+	AddFrameTiming("Shade", shadeTime);
+
 	//////////////////////////////////////////////////
 	//Forward rendering
 	//////////////////////////////////////////////////
@@ -652,6 +694,377 @@ Argument MulticoreWindow::ReloadShaders(const std::vector<Argument>& argument)
 #endif
 }
 
+Argument MulticoreWindow::PrintContentMemory(const std::vector<Argument>& argument)
+{
+	const float bytesPerKiB = 1024.0f;
+
+	std::stringstream stream;
+	stream << std::fixed << std::setprecision(1);
+
+	stream << "CPU: " << contentManager.GetCPUMemoryUsage() / bytesPerKiB << " KiB"
+		<< ", GPU: " << contentManager.GetGPUMemoryUsage() / bytesPerKiB << " KiB"
+		<< ", cached: " << contentManager.GetCachedMemoryUsage() / bytesPerKiB << " KiB"
+		<< ", budget: " << contentManager.GetMemoryBudget() / bytesPerKiB << " KiB";
+
+	for(const ContentMemoryUsage& usage : contentManager.GetMemoryUsage())
+	{
+		stream << "\n" << usage.path << " (" << usage.type << ")"
+			<< " CPU: " << usage.cpuSize / bytesPerKiB << " KiB"
+			<< ", GPU: " << usage.gpuSize / bytesPerKiB << " KiB"
+			<< ", references: " << usage.refCount;
+	}
+
+	return stream.str();
+}
+
+Argument MulticoreWindow::BenchmarkXML(const std::vector<Argument>& argument)
+{
+	if(argument.size() > 2)
+		return "Expected at most 2 arguments: path and iterations";
+
+	std::string path = "Calibri16.fnt";
+	int iterations = 100;
+
+	if(argument.size() >= 1)
+		argument[0] >> path;
+	if(argument.size() == 2)
+	{
+		if(!argument[1].IsNumber())
+			return "Iterations must be a number";
+
+		argument[1] >> iterations;
+	}
+
+	if(iterations <= 0)
+		return "Iterations must be greater than 0";
+
+	std::ifstream in(path, std::ios::binary | std::ios::ate);
+	if(!in.is_open())
+		return "Couldn't open \"" + path + "\"";
+
+	double megabytes = static_cast<double>(in.tellg()) * iterations / (1024.0 * 1024.0);
+	in.close();
+
+	//Count elements so all parsers can be checked against each other
+	size_t xmlFileElements = 0;
+	size_t xmlReaderElements = 0;
+	size_t xmlTreeElements = 0;
+
+	auto begin = std::chrono::high_resolution_clock::now();
+	for(int i = 0; i < iterations; ++i)
+	{
+		XMLFile xmlFile;
+		xmlFile.Open(path);
+		xmlFile.Parse([&](const XMLElement&) { ++xmlFileElements; });
+	}
+	auto xmlFileTime = std::chrono::high_resolution_clock::now() - begin;
+
+	begin = std::chrono::high_resolution_clock::now();
+	for(int i = 0; i < iterations; ++i)
+	{
+		XMLReader xmlReader;
+		xmlReader.Open(path);
+		xmlReader.Parse([&](const XMLElementView&) { ++xmlReaderElements; });
+	}
+	auto xmlReaderTime = std::chrono::high_resolution_clock::now() - begin;
+
+	begin = std::chrono::high_resolution_clock::now();
+	for(int i = 0; i < iterations; ++i)
+	{
+		XMLTree xmlTree;
+		xmlTree.Open(path);
+		xmlTreeElements += xmlTree.GetNodeCount();
+	}
+	auto xmlTreeTime = std::chrono::high_resolution_clock::now() - begin;
+
+	auto toMilliseconds = [](std::chrono::high_resolution_clock::duration duration)
+	{
+		return std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(duration).count();
+	};
+
+	std::stringstream stream;
+	stream << std::fixed << std::setprecision(2);
+
+	stream << "Parsed \"" << path << "\" " << iterations << " times";
+	stream << "\nXMLFile:   " << toMilliseconds(xmlFileTime) << " ms, " << megabytes / (toMilliseconds(xmlFileTime) / 1000.0) << " MiB/s, " << xmlFileElements / iterations << " elements";
+	stream << "\nXMLReader: " << toMilliseconds(xmlReaderTime) << " ms, " << megabytes / (toMilliseconds(xmlReaderTime) / 1000.0) << " MiB/s, " << xmlReaderElements / iterations << " elements";
+	stream << "\nXMLTree:   " << toMilliseconds(xmlTreeTime) << " ms, " << megabytes / (toMilliseconds(xmlTreeTime) / 1000.0) << " MiB/s, " << xmlTreeElements / iterations << " elements";
+
+	return stream.str();
+}
+
+Argument MulticoreWindow::CompileScene(const std::vector<Argument>& argument)
+{
+	if(argument.size() != 1)
+		return "Expected 1 argument: path to .scene";
+
+	std::string path;
+	argument.front() >> path;
+
+	//Loading writes the .scenecache if it's missing or out of date. The current scene is left alone
+	SceneFile compiledScene;
+
+	std::string errorString = compiledScene.Load(path);
+	if(!errorString.empty())
+		return errorString;
+
+	return "Compiled \"" + path + "\": " + std::to_string(compiledScene.GetMeshPaths().size()) + " meshes, "
+		+ std::to_string(compiledScene.GetInstances().size()) + " instances, " + std::to_string(compiledScene.GetSpheres().size()) + " spheres";
+}
+
+Argument MulticoreWindow::LoadScene(const std::vector<Argument>& argument)
+{
+	if(argument.size() != 1)
+		return "Expected 1 argument: path to .scene";
+
+	if(stressBenchmark.IsRunning())
+		return "Can't load a scene while a stress benchmark is running";
+
+	std::string path;
+	argument.front() >> path;
+
+	//Loaded on the side so a broken scene leaves the current one alone
+	SceneFile newScene;
+
+	std::string errorString = newScene.Load(path);
+	if(!errorString.empty())
+		return errorString;
+
+	scene = newScene;
+	scenePath = path;
+
+	for(const std::string& meshPath : scene.GetMeshPaths())
+		contentManager.Prefetch<OBJFile>(meshPath);
+
+	errorString = ReloadScene();
+	if(!errorString.empty())
+		return errorString;
+
+	return "Loaded \"" + path + "\"";
+}
+
+Argument MulticoreWindow::StartSweep(const std::vector<Argument>& argument)
+{
+	if(argument.size() != 1)
+		return "Expected 1 argument: path to sweep script";
+
+	std::string path;
+	argument.front() >> path;
+
+	std::string errorString = sweepRunner.Start(path, &console);
+	if(!errorString.empty())
+		return errorString;
+
+	return "";
+}
+
+Argument MulticoreWindow::StopSweep(const std::vector<Argument>& argument)
+{
+	if(!sweepRunner.IsRunning())
+		return "No sweep is running";
+
+	sweepRunner.Stop();
+
+	return "";
+}
+
+Argument MulticoreWindow::StartStressBenchmark(const std::vector<Argument>& argument)
+{
+	if(argument.size() != 1)
+		return "Expected 1 argument: path to stress benchmark script";
+
+	std::string path;
+	argument.front() >> path;
+
+	ShaderProgram* previousShaderProgram = currentShaderProgram;
+
+	auto loadScene = std::bind(&MulticoreWindow::LoadStressScene, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
+	auto finished = [this, previousShaderProgram]()
+	{
+		currentShaderProgram = previousShaderProgram;
+
+		std::string errorString = ReloadScene();
+		if(!errorString.empty())
+			Logger::LogLine(LOG_TYPE::FATAL, "Couldn't restore scene after stress benchmark: " + errorString);
+	};
+
+	std::string errorString = stressBenchmark.Start(path, GetShaderProgramNames(), loadScene, finished, &console);
+	if(!errorString.empty())
+		return errorString;
+
+	return "";
+}
+
+Argument MulticoreWindow::StopStressBenchmark(const std::vector<Argument>& argument)
+{
+	if(!stressBenchmark.IsRunning())
+		return "No stress benchmark is running";
+
+	stressBenchmark.Stop();
+
+	return "";
+}
+
+Argument MulticoreWindow::StartCameraRecording(const std::vector<Argument>& argument)
+{
+	if(replayingCamera)
+		return "Can't record while replaying";
+
+	cameraRecording.Clear();
+	recordedCommands.clear();
+	recordingCamera = true;
+
+	return "Recording camera";
+}
+
+Argument MulticoreWindow::StopCameraRecording(const std::vector<Argument>& argument)
+{
+	if(argument.size() != 1)
+		return "Expected 1 argument: path to save recording to";
+
+	if(!recordingCamera)
+		return "Not recording";
+
+	recordingCamera = false;
+
+	std::string path;
+	argument.front() >> path;
+
+	if(!cameraRecording.Save(path))
+		return "Couldn't save recording to \"" + path + "\", recording is kept until the next StartCameraRecording";
+
+	return "Saved " + std::to_string(cameraRecording.GetFrameCount()) + " frames (" + std::to_string(cameraRecording.GetDataSize()) + " bytes) to \"" + path + "\"";
+}
+
+Argument MulticoreWindow::ReplayCameraRecording(const std::vector<Argument>& argument)
+{
+	if(argument.empty() || argument.size() > 3)
+		return "Expected 1 to 3 arguments: path, speed (recorded frames per drawn frame), and whether to quit when done";
+
+	if(recordingCamera)
+		return "Can't replay while recording";
+
+	std::string path;
+	argument[0] >> path;
+
+	double speed = 1.0;
+	bool quit = false;
+
+	if(argument.size() >= 2)
+	{
+		if(!argument[1].IsNumber())
+			return "Speed must be a number";
+
+		argument[1] >> speed;
+	}
+
+	if(argument.size() == 3)
+	{
+		if(!argument[2].IsNumber())
+			return "Quit must be a number";
+
+		argument[2] >> quit;
+	}
+
+	if(!(speed > 0.0))
+		return "Speed must be greater than 0";
+
+	CameraRecording recording;
+	if(!recording.Load(path))
+		return "Couldn't load recording \"" + path + "\", see log for details";
+
+	if(!recording.Decode(replayFrames)
+		|| replayFrames.empty())
+		return "\"" + path + "\" doesn't have any frames";
+
+	replaySpeed = speed;
+	replayPosition = 0.0;
+	replayFrameIndex = -1;
+	quitAfterReplay = quit;
+	replayingCamera = true;
+
+	return "Replaying " + std::to_string(replayFrames.size()) + " frames";
+}
+
+Argument MulticoreWindow::StopCameraReplay(const std::vector<Argument>& argument)
+{
+	if(!replayingCamera)
+		return "Not replaying";
+
+	quitAfterReplay = false;
+	EndCameraReplay();
+
+	return "";
+}
+
+void MulticoreWindow::CommandExecuted(const std::string& command)
+{
+	if(!recordingCamera)
+		return;
+
+	//Replaying these would interfere with the replay itself
+	if(command.compare(0, 20, "StartCameraRecording") == 0
+		|| command.compare(0, 19, "StopCameraRecording") == 0)
+		return;
+
+	recordedCommands.push_back(command);
+}
+
+void MulticoreWindow::RecordCameraFrame(std::chrono::nanoseconds delta)
+{
+	CameraRecordingFrame frame;
+	frame.position = currentCamera->GetPosition();
+	frame.rotation = currentCamera->GetRotation();
+	frame.deltaMS = delta.count() * 1e-6f;
+	frame.commands.swap(recordedCommands);
+
+	cameraRecording.AddFrame(frame);
+}
+
+std::chrono::nanoseconds MulticoreWindow::StepCameraReplay()
+{
+	int targetIndex = static_cast<int>(replayPosition);
+	replayPosition += replaySpeed;
+
+	//The replay ends after this step, so catch up on every frame that's left. At speeds above 1 the last
+	//whole step can otherwise land before the last frame
+	if(replayPosition >= replayFrames.size())
+		targetIndex = static_cast<int>(replayFrames.size()) - 1;
+
+	//Frames that are skipped at speeds above 1 still have their commands executed and their time accumulated
+	double deltaMS = 0.0;
+	while(replayFrameIndex < targetIndex)
+	{
+		++replayFrameIndex;
+
+		const CameraRecordingFrame& frame = replayFrames[replayFrameIndex];
+		for(const std::string& command : frame.commands)
+			console.ExecuteCommand(command);
+
+		deltaMS += frame.deltaMS;
+	}
+
+	const CameraRecordingFrame& frame = replayFrames[replayFrameIndex];
+	replayCamera.SetPosition(frame.position);
+	replayCamera.SetRotation(frame.rotation);
+	currentCamera = &replayCamera;
+
+	return std::chrono::nanoseconds(static_cast<long long>(deltaMS * 1e6));
+}
+
+void MulticoreWindow::EndCameraReplay()
+{
+	replayingCamera = false;
+	replayFrames.clear();
+
+	Logger::LogLine(LOG_TYPE::INFO, "Camera replay finished");
+
+	if(quitAfterReplay)
+		PostQuitMessage(0);
+	else
+		currentCamera = cinematicCameraMode ? static_cast<Camera*>(&cinematicCamera) : &fpsCamera;
+}
+
 void MulticoreWindow::SetRayBounces(int bounces)
 {
 #ifdef USE_ALL_SHADER_PROGRAMS
@@ -672,6 +1085,25 @@ void MulticoreWindow::SetLightAttenuationFactors(const LightAttenuation& lightAt
 #endif
 }
 
+void MulticoreWindow::SetContentMemoryBudget(int megabytes)
+{
+	if(megabytes < 0)
+		megabytes = 0;
+
+	contentManager.SetMemoryBudget(static_cast<size_t>(megabytes) * 1024 * 1024);
+}
+
+//Takes effect the next time a scene is loaded, e.g. with LoadScene
+void MulticoreWindow::SetSceneQueryBVHWidth(int width)
+{
+#ifdef USE_ALL_SHADER_PROGRAMS
+	for(ShaderProgram* program : shaderPrograms)
+		program->SetSceneQueryBVHWidth(width);
+#else
+	currentShaderProgram->SetSceneQueryBVHWidth(width);
+#endif
+}
+
 int MulticoreWindow::GetRayBounces() const
 {
 	return currentShaderProgram->GetRayBounces();
@@ -682,27 +1114,75 @@ LightAttenuation MulticoreWindow::GetLightAttenuationFactors() const
 	return currentShaderProgram->GetLightAttenuationFactors();
 }
 
+int MulticoreWindow::GetContentMemoryBudget() const
+{
+	return static_cast<int>(contentManager.GetMemoryBudget() / (1024 * 1024));
+}
+
+int MulticoreWindow::GetSceneQueryBVHWidth() const
+{
+	return currentShaderProgram->GetSceneQueryBVHWidth();
+}
+
 #if USE_ALL_SHADER_PROGRAMS
 Argument MulticoreWindow::SetShaderProgram(const std::vector<Argument>& argument)
 {
 	if(argument.size() != 1)
 		return "Expected 1 argument";
 
-	if(argument.front().values.front() == "cbuffer")
-		currentShaderProgram = constantBufferShaderProgram.get();
-	else if(argument.front().values.front() == "sbuffer")
-		currentShaderProgram = structuredBufferShaderProgram.get();
-	else if(argument.front().values.front() == "aabbsbuffer")
-		currentShaderProgram = aabbStructuredBufferShaderProgram.get();
-	else if(argument.front().values.front() == "supersampled")
-		currentShaderProgram = superSampledShaderProgram.get();
-	else
+	ShaderProgram* shaderProgram = GetShaderProgram(std::string(argument.front()));
+	if(shaderProgram == nullptr)
 		return "Couldn't find shader program";
 
+	currentShaderProgram = shaderProgram;
+
 	return "Shader program set";
 }
 #endif
 
+std::vector<std::string> MulticoreWindow::GetShaderProgramNames() const
+{
+#if USE_ALL_SHADER_PROGRAMS
+	return std::vector<std::string>{ "cbuffer", "sbuffer", "aabbsbuffer", "supersampled" };
+#elif USE_CONSTANT_BUFFER_SHADER_PROGRAM
+	return std::vector<std::string>{ "cbuffer" };
+#elif USE_STRUCTURED_BUFFER_SHADER_PROGRAM
+	return std::vector<std::string>{ "sbuffer" };
+#elif USE_AABBSTRUCTUREDBUFFER_SHADER_PROGRAM
+	return std::vector<std::string>{ "aabbsbuffer" };
+#elif USE_SUPER_SAMPLED_SHADER_PROGRAM
+	return std::vector<std::string>{ "supersampled" };
+#endif
+}
+
+ShaderProgram* MulticoreWindow::GetShaderProgram(const std::string& name) const
+{
+#if USE_ALL_SHADER_PROGRAMS
+	if(name == "cbuffer")
+		return constantBufferShaderProgram.get();
+	else if(name == "sbuffer")
+		return structuredBufferShaderProgram.get();
+	else if(name == "aabbsbuffer")
+		return aabbStructuredBufferShaderProgram.get();
+	else if(name == "supersampled")
+		return superSampledShaderProgram.get();
+#elif USE_CONSTANT_BUFFER_SHADER_PROGRAM
+	if(name == "cbuffer")
+		return constantBufferShaderProgram.get();
+#elif USE_STRUCTURED_BUFFER_SHADER_PROGRAM
+	if(name == "sbuffer")
+		return structuredBufferShaderProgram.get();
+#elif USE_AABBSTRUCTUREDBUFFER_SHADER_PROGRAM
+	if(name == "aabbsbuffer")
+		return aabbStructuredBufferShaderProgram.get();
+#elif USE_SUPER_SAMPLED_SHADER_PROGRAM
+	if(name == "supersampled")
+		return superSampledShaderProgram.get();
+#endif
+
+	return nullptr;
+}
+
 void MulticoreWindow::PickingCallback(const PickedObjectData& data)
 {
 	if(data.triangleIndex != -1)
@@ -820,38 +1300,7 @@ bool MulticoreWindow::InitBulb()
 
 bool MulticoreWindow::InitPointLights()
 {
-	LightAttenuation lightAttenuation;
-
-	lightAttenuation.factors[0] = 2.5f;
-	lightAttenuation.factors[1] = 0.2f;
-	lightAttenuation.factors[2] = 1.0f;
-
-#if USE_ALL_SHADER_PROGRAMS
-	for(ShaderProgram* program : shaderPrograms)
-		program->SetLightAttenuationFactors(lightAttenuation);
-#else
-	currentShaderProgram->SetLightAttenuationFactors(lightAttenuation);
-#endif
-
-	PointLights pointlights;
-
-	lightIntensity = 15.0f;
-
-	pointlights.lightCount = 1;
-	for(int i = 0; i < MAX_POINT_LIGHTS; i++)
-		pointlights.lights[i].w = lightIntensity;
-
-	lightRotationRadius = 5.0f;
-	lightMinHeight = 1.0f;
-	lightMaxHeight = 9.5f;
-
-	lightVerticalSpeed = 0.0005f;
-	lightHorizontalSpeed = 0.0005f;
-
-	lightSinValMult = 2.0f;
-	lightOtherSinValMult = 1.0f;
-
-	numberOfLights = 1;
+	ApplySceneLights();
 
 	auto numberOfLightsCommand = new CommandGetSet<int>("numberOfLights", &numberOfLights);
 	auto lightRotationRadiusCommand = new CommandGetSet<float>("lightRotationRadius", &lightRotationRadius);
@@ -901,74 +1350,199 @@ bool MulticoreWindow::InitGraphs()
 	return true;
 }
 
-bool MulticoreWindow::InitRoom()
+void MulticoreWindow::PrefetchContent()
 {
-	//////////////////////////////////////////////////
-	//Spheres
-	//////////////////////////////////////////////////
-	std::vector<DirectX::XMFLOAT4> spheres;
-	std::vector<DirectX::XMFLOAT4> sphereColors;
-
-	float heightIncrease = 0.1f;
+	//Everything Init loads, so the file I/O overlaps instead of happening one file at a time
+	contentManager.Prefetch<CharacterSet>("calibri16");
+	contentManager.Prefetch<CharacterSet>("Calibri16");
+	contentManager.Prefetch<CharacterSet>("Calibri12");
+	contentManager.Prefetch<Texture2D>("Bulb.dds");
+
+	//Every mesh is read and parsed on its own worker
+	for(const std::string& meshPath : scene.GetMeshPaths())
+		contentManager.Prefetch<OBJFile>(meshPath);
+}
 
-	float rotationValue = 0.0f;
-	float heightValue = 0.0f;
+bool MulticoreWindow::InitScene()
+{
+	if(scene.HasGenerator())
+		sceneGenerator.Generate(scene.GetGeneratorSettings(), &contentManager);
+	else
+		sceneGenerator.Clear();
 
-	float radius = 3.0f;
+	const std::vector<std::string>& meshPaths = scene.GetMeshPaths();
 
-	for(int i = 0; i < 64; ++i)
+	//Meshes were prefetched by PrefetchContent, so AddOBJ only waits for the ones that are still loading
+	auto addScene = [&](ShaderProgram* program)
 	{
-		DirectX::XMFLOAT4 newSphere;
-		DirectX::XMFLOAT4 newColor;
+		for(const SceneSphere& sphere : scene.GetSpheres())
+			program->AddSphere(sphere.position, sphere.color);
 
-		newSphere = DirectX::XMFLOAT4(std::cosf(rotationValue) * radius, -3.0f + (rand() / static_cast<float>(RAND_MAX)) * 6.0f, std::sinf(rotationValue) * radius, 0.5f);
-		if(i % 3 == 0)
-			newColor = DirectX::XMFLOAT4(1.0f, 0.0f, 0.0f, 0.8f);
-		else if(i % 3 == 1)
-			newColor = DirectX::XMFLOAT4(0.0f, 1.0f, 0.0f, 0.8f);
-		else if(i % 3 == 2)
-			newColor = DirectX::XMFLOAT4(0.0f, 0.0f, 1.0f, 0.8f);
+		for(const SceneInstance& instance : scene.GetInstances())
+			program->AddOBJ(meshPaths[instance.mesh], instance.position, instance.scale);
 
-		rotationValue += DirectX::XM_2PI / 64.0f;
-		heightValue += heightIncrease;
+		AddGeneratedScene(program);
+	};
 
 #if USE_ALL_SHADER_PROGRAMS
-		for(ShaderProgram* program : shaderPrograms)
-			program->AddSphere(newSphere, newColor);
+	for(ShaderProgram* program : shaderPrograms)
+		addScene(program);
 #else
-		currentShaderProgram->AddSphere(newSphere, newColor);
+	addScene(currentShaderProgram);
 #endif
-	}
 
-	//////////////////////////////////////////////////
-	//Triangles
-	//////////////////////////////////////////////////
-	/*for(int z = 0; z < 1; z++)
-	{
-		for(int y = 0; y < 1; y++)
-		{
-			for(int x = 0; x < 0; x++)
+	return true;
+}
+
+bool MulticoreWindow::InitSceneBuffers()
+{
+#if USE_ALL_SHADER_PROGRAMS
+	if(!constantBufferShaderProgram->InitBuffers(depthBufferUAV.get(), backBufferUAV.get()))
+		return false;
+	if(!structuredBufferShaderProgram->InitBuffers(depthBufferUAV.get(), backBufferUAV.get()))
+		return false;
+	if(!aabbStructuredBufferShaderProgram->InitBuffers(depthBufferUAV.get(), backBufferUAV.get()))
+		return false;
+	if(!superSampledShaderProgram->InitBuffers(depthBufferUAV.get(), backBufferUAV.get()))
+		return false;
+#elif USE_CONSTANT_BUFFER_SHADER_PROGRAM
+	if(!constantBufferShaderProgram->InitBuffers(depthBufferUAV.get(), backBufferUAV.get()))
+		return false;
+#elif USE_STRUCTURED_BUFFER_SHADER_PROGRAM
+	if(!structuredBufferShaderProgram->InitBuffers(depthBufferUAV.get(), backBufferUAV.get()))
+		return false;
+#elif USE_AABBSTRUCTUREDBUFFER_SHADER_PROGRAM
+	if(!aabbStructuredBufferShaderProgram->InitBuffers(depthBufferUAV.get(), backBufferUAV.get()))
+		return false;
+#elif USE_SUPER_SAMPLED_SHADER_PROGRAM
+	if(!superSampledShaderProgram->InitBuffers(depthBufferUAV.get(), backBufferUAV.get()))
+		return false;
+#endif
+
+	return true;
+}
+
+void MulticoreWindow::AddGeneratedScene(ShaderProgram* program)
+{
+	for(const SceneSphere& sphere : sceneGenerator.GetSpheres())
+		program->AddSphere(sphere.position, sphere.color);
+
+	const std::vector<Mesh>& meshes = sceneGenerator.GetMeshes();
+	for(const SceneInstance& instance : sceneGenerator.GetInstances())
+		program->AddMesh(meshes[instance.mesh], instance.position, instance.scale);
+}
+
+void MulticoreWindow::ApplySceneLights()
+{
+	const SceneLights& sceneLights = scene.GetLights();
+
+	LightAttenuation lightAttenuation;
+
+	lightAttenuation.factors[0] = sceneLights.attenuation[0];
+	lightAttenuation.factors[1] = sceneLights.attenuation[1];
+	lightAttenuation.factors[2] = sceneLights.attenuation[2];
+
 #if USE_ALL_SHADER_PROGRAMS
-				for(ShaderProgram* program : shaderPrograms)
-					program->AddOBJ("sword.obj", DirectX::XMFLOAT3(-1.0f + x * 2.0f, -1.0f + y * 2.0f, -2.5f + z * 5.0f));
-			//program->AddOBJ("sword.obj", DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f));
+	for(ShaderProgram* program : shaderPrograms)
+		program->SetLightAttenuationFactors(lightAttenuation);
 #else
-				//currentShaderProgram->AddOBJ("sword.obj", DirectX::XMFLOAT3(-1.0f + x * 2.0f, -1.0f + y * 2.0f, -2.5f + z * 5.0f));
+	currentShaderProgram->SetLightAttenuationFactors(lightAttenuation);
 #endif
-		}
-	}*/
 
+	lightIntensity = sceneLights.intensity;
+
+	lightRotationRadius = sceneLights.rotationRadius;
+	lightMinHeight = sceneLights.minHeight;
+	lightMaxHeight = sceneLights.maxHeight;
+
+	lightVerticalSpeed = sceneLights.verticalSpeed;
+	lightHorizontalSpeed = sceneLights.horizontalSpeed;
+
+	lightSinValMult = sceneLights.sinValMult;
+	lightOtherSinValMult = sceneLights.otherSinValMult;
+
+	int lightCount = sceneGenerator.IsEmpty() ? sceneLights.count : sceneGenerator.GetSettings().lightCount;
+
+	numberOfLights = std::max(0, std::min(lightCount, MAX_POINT_LIGHTS));
+	if(numberOfLights != lightCount)
+		Logger::LogLine(LOG_TYPE::WARNING, "Scene has " + std::to_string(lightCount) + " lights, using " + std::to_string(numberOfLights));
+}
+
+void MulticoreWindow::ApplySceneCameraPath()
+{
+	const SceneCameraPath& cameraPath = scene.GetCameraPath();
+
+	cinematicCamera.SetKeyFrames(cameraPath.keyFrames);
+	if(cameraPath.speed > 0.0f)
+		cinematicCamera.SetTargetSpeed(cameraPath.speed);
+
+	UploadBezierFrames();
+
+	cinematicCamera.SetLoop(cameraPath.loop);
+	cinematicCamera.Reset();
+	cinematicCamera.Start();
+}
+
+std::string MulticoreWindow::ReloadScene()
+{
 #if USE_ALL_SHADER_PROGRAMS
 	for(ShaderProgram* program : shaderPrograms)
-		program->AddOBJ("SpecNorm.obj", DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), 1.0f);
+		program->ClearScene();
 #else
-	//currentShaderProgram->AddOBJ("cube.obj", DirectX::XMFLOAT3(0.0f, -2.0f, 0.0f));
-	currentShaderProgram->AddOBJ("meshes/sword.obj", DirectX::XMFLOAT3(0.0f, -2.0f, 0.0f), 0.1f);
-	currentShaderProgram->AddOBJ("meshes/cube.obj", DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), 10.0f);
-	//currentShaderProgram->AddOBJ("sword.obj", DirectX::XMFLOAT3(0.0f, 2.0f, 0.0f));
+	currentShaderProgram->ClearScene();
 #endif
 
-	return true;
+	if(!InitScene())
+		return "Couldn't initialize scene";
+	if(!InitSceneBuffers())
+		return "Couldn't initialize scene buffers, see log";
+
+	ApplySceneLights();
+	ApplySceneCameraPath();
+
+	return "";
+}
+
+std::string MulticoreWindow::LoadStressScene(const SceneGeneratorSettings& settings, const std::string& backend, StressBenchmark::SceneStatistics& outStatistics)
+{
+	ShaderProgram* program = GetShaderProgram(backend);
+	if(program == nullptr)
+		return "Couldn't find shader program \"" + backend + "\"";
+
+	//Only one backend has to hold the scene at a time, which keeps the largest scenes within memory
+#if USE_ALL_SHADER_PROGRAMS
+	for(ShaderProgram* shaderProgram : shaderPrograms)
+		shaderProgram->ClearScene();
+#else
+	program->ClearScene();
+#endif
+
+	sceneGenerator.Generate(settings, &contentManager);
+
+	auto buildStart = std::chrono::high_resolution_clock::now();
+
+	AddGeneratedScene(program);
+	if(!program->InitBuffers(depthBufferUAV.get(), backBufferUAV.get()))
+		return "Couldn't initialize buffers, see log";
+
+	std::chrono::duration<double, std::milli> buildTime = std::chrono::high_resolution_clock::now() - buildStart;
+
+	currentShaderProgram = program;
+	ApplySceneLights();
+
+	outStatistics.generateTime = sceneGenerator.GetGenerateTime();
+	outStatistics.buildTime = buildTime.count();
+	outStatistics.memoryUsage = program->GetSceneMemoryUsage();
+
+	SceneQuery::BuildStatistics bvhStatistics = program->GetSceneQuery().GetBuildStatistics();
+	outStatistics.bvhBuildTime = bvhStatistics.buildTime;
+	outStatistics.bvhNodeCount = bvhStatistics.nodeCount;
+	outStatistics.bvhSAHCost = bvhStatistics.sahCost;
+	outStatistics.bvhMemoryUsage = bvhStatistics.memoryUsage;
+	outStatistics.triangleCount = sceneGenerator.GetTriangleCount();
+	outStatistics.lightCount = numberOfLights;
+
+	return "";
 }
 
 bool MulticoreWindow::InitBezier()
@@ -1032,6 +1606,13 @@ void MulticoreWindow::InitConsole()
 	Logger::SetCallOnLog(std::bind(&Console::AddText, &console, std::placeholders::_1));
 }
 
+void MulticoreWindow::AddFrameTiming(const std::string& name, double milliseconds)
+{
+	sweepRunner.AddTiming(name, milliseconds);
+	stressBenchmark.AddTiming(name, milliseconds);
+	controlPipe.AddFrameStat(name, milliseconds);
+}
+
 void MulticoreWindow::DrawUpdatePointlights()
 {
 	PointLights newData;
@@ -16,6 +16,7 @@
 #include <DXLib/DXConstantBuffer.h>
 #include <DXLib/FPSCamera.h>
 #include <DXLib/CinematicCamera.h>
+#include <DXLib/CameraRecording.h>
 #include <DXLib/OBJFile.h>
 #include <DXLib/DXMath.h>
 
@@ -23,9 +24,14 @@
 
 #include <DXConsole/guiManager.h>
 #include <DXConsole/Console.h>
+#include <DXConsole/consoleSweepRunner.h>
+#include <DXConsole/consoleControlPipe.h>
 
 #include "Graph.h"
 #include "ShaderProgram.h"
+#include "SceneFile.h"
+#include "SceneGenerator.h"
+#include "StressBenchmark.h"
 
 //#define USE_CONSTANT_BUFFER_SHADER_PROGRAM true
 //#define USE_STRUCTURED_BUFFER_SHADER_PROGRAM true
@@ -101,6 +107,17 @@ public:
 
 	void Run();
 
+	//************************************
+	// Method:		SetScenePath
+	// FullName:	MulticoreWindow::SetScenePath
+	// Access:		public
+	// Returns:		void
+	// Qualifier:
+	// Argument:	const std::string& path - .scene to load. Has to be called before Run
+	// Description:
+	//************************************
+	void SetScenePath(const std::string& path);
+
 	bool Init();
 	void Update(std::chrono::nanoseconds delta);
 	void Draw();
@@ -129,6 +146,26 @@ private:
 	DirectX::XMFLOAT3 cameraLookAt;
 	std::vector<DirectX::XMFLOAT3> cameraAnchors;
 
+	////////////////////
+	//Camera recording
+	////////////////////
+	bool recordingCamera;
+	CameraRecording cameraRecording;
+	//Commands executed since the last recorded frame
+	std::vector<std::string> recordedCommands;
+
+	//A replay overrides currentCamera and the frame delta with the recorded ones, so
+	//that a recorded session can be profiled without any input
+	bool replayingCamera;
+	bool quitAfterReplay;
+	std::vector<CameraRecordingFrame> replayFrames;
+	//Recorded frames to advance per rendered frame
+	double replaySpeed;
+	double replayPosition;
+	//Index of the last frame whose commands have been executed
+	int replayFrameIndex;
+	Camera replayCamera;
+
 	//////////////////////////////////////////////////
 	//Ray tracing
 	//////////////////////////////////////////////////
@@ -208,6 +245,16 @@ private:
 	void UploadBezierFrames();
 	Argument SetBezierTessFactors(const std::vector<Argument>& argument);
 
+	//////////////////////////////////////////////////
+	//Scene
+	//////////////////////////////////////////////////
+	std::string scenePath;
+	SceneFile scene;
+	//The scene's <generate> content, or the scene being measured by stressBenchmark
+	SceneGenerator sceneGenerator;
+
+	StressBenchmark stressBenchmark;
+
 	//////////////////////////////////////////////////
 	//Etc
 	//////////////////////////////////////////////////
@@ -226,6 +273,9 @@ private:
 	Console console;
 	bool drawConsole;
 
+	ConsoleSweepRunner sweepRunner;
+	ConsoleControlPipe controlPipe;
+
 	float cameraSpeed;
 
 	ShaderProgram* currentShaderProgram;
@@ -259,30 +309,93 @@ private:
 
 	Argument ReloadShaders(const std::vector<Argument>& argument);
 
+	Argument PrintContentMemory(const std::vector<Argument>& argument);
+	Argument BenchmarkXML(const std::vector<Argument>& argument);
+	Argument CompileScene(const std::vector<Argument>& argument);
+	Argument LoadScene(const std::vector<Argument>& argument);
+
+	Argument StartSweep(const std::vector<Argument>& argument);
+	Argument StopSweep(const std::vector<Argument>& argument);
+
+	Argument StartStressBenchmark(const std::vector<Argument>& argument);
+	Argument StopStressBenchmark(const std::vector<Argument>& argument);
+
+	Argument StartCameraRecording(const std::vector<Argument>& argument);
+	Argument StopCameraRecording(const std::vector<Argument>& argument);
+	Argument ReplayCameraRecording(const std::vector<Argument>& argument);
+	Argument StopCameraReplay(const std::vector<Argument>& argument);
+
+	void CommandExecuted(const std::string& command);
+	void RecordCameraFrame(std::chrono::nanoseconds delta);
+	//Moves replayCamera to the next frame of the replay and returns the recorded delta
+	std::chrono::nanoseconds StepCameraReplay();
+	void EndCameraReplay();
+
 	void SetRayBounces(int bounces);
 	void SetLightAttenuationFactors(const LightAttenuation& lightAttenuation);
+	void SetContentMemoryBudget(int megabytes);
+	void SetSceneQueryBVHWidth(int width);
 
 	int GetRayBounces() const;
 	LightAttenuation GetLightAttenuationFactors() const;
+	int GetContentMemoryBudget() const;
+	int GetSceneQueryBVHWidth() const;
 
 #if USE_ALL_SHADER_PROGRAMS
 	Argument SetShaderProgram(const std::vector<Argument>& argument);
 #endif
+	//Names used by SetShaderProgram and stress benchmark scripts, only the programs that are compiled in
+	std::vector<std::string> GetShaderProgramNames() const;
+	//nullptr if there's no such program
+	ShaderProgram* GetShaderProgram(const std::string& name) const;
 
 	void PickingCallback(const PickedObjectData& data);
 
+	void PrefetchContent();
+
 	bool InitUAVs();
 
 	bool InitFullscreenQuad();
 	bool InitBulb();
 	bool InitPointLights();
 	bool InitGraphs();
-	bool InitRoom();
+	bool InitScene();
+	//Writes the added scene to every program's buffers, see ShaderProgram::InitBuffers
+	bool InitSceneBuffers();
 	bool InitBezier();
 
+	void AddGeneratedScene(ShaderProgram* program);
+	//Light and camera path settings of the current scene, overwriting any changes made through the console
+	void ApplySceneLights();
+	void ApplySceneCameraPath();
+	//************************************
+	// Method:		ReloadScene
+	// FullName:	MulticoreWindow::ReloadScene
+	// Access:		private
+	// Returns:		std::string - empty on success, otherwise an error message
+	// Qualifier:
+	// Description:	Replaces every program's scene with the current one, regenerating its generated content
+	//************************************
+	std::string ReloadScene();
+	//************************************
+	// Method:		LoadStressScene
+	// FullName:	MulticoreWindow::LoadStressScene
+	// Access:		private
+	// Returns:		std::string - empty on success, otherwise an error message
+	// Qualifier:
+	// Argument:	const SceneGeneratorSettings& settings
+	// Argument:	const std::string& backend - name of the program to load the scene into and draw with
+	// Argument:	StressBenchmark::SceneStatistics& outStatistics
+	// Description:	StressBenchmark::LoadFunction. The other programs are left without a scene until ReloadScene
+	//************************************
+	std::string LoadStressScene(const SceneGeneratorSettings& settings, const std::string& backend, StressBenchmark::SceneStatistics& outStatistics);
+
 	void InitInput();
 	void InitConsole();
 
+	//Sends a timing to everything that records per frame timings
+	void AddFrameTiming(const std::string& name, double milliseconds);
+
 	void DrawUpdatePointlights();
 
 	void DrawUpdateMVP();
@@ -0,0 +1,161 @@
+#ifndef RayIntersection_h__
+#define RayIntersection_h__
+
+#include <DXLib/DXMath.h>
+
+#include <cmath>
+#include <algorithm>
+
+//CPU versions of the intersection functions in SharedShaderConstants.h, with the same results.
+//Plain floats rather than XMVECTOR since they're called once per primitive on small data.
+//RayAABBIntersection4 is the exception, it tests four of a WideBVH node's children at once
+
+inline DirectX::XMFLOAT3 RaySub(const DirectX::XMFLOAT3& lhs, const DirectX::XMFLOAT3& rhs)
+{
+	return DirectX::XMFLOAT3(lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z);
+}
+
+inline float RayDot(const DirectX::XMFLOAT3& lhs, const DirectX::XMFLOAT3& rhs)
+{
+	return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
+}
+
+inline DirectX::XMFLOAT3 RayCross(const DirectX::XMFLOAT3& lhs, const DirectX::XMFLOAT3& rhs)
+{
+	return DirectX::XMFLOAT3(lhs.y * rhs.z - lhs.z * rhs.y
+							 , lhs.z * rhs.x - lhs.x * rhs.z
+							 , lhs.x * rhs.y - lhs.y * rhs.x);
+}
+
+//************************************
+// Method:		RayAABBIntersection
+// Returns:		bool - true if the ray hits the box between 0 and maxDistance
+// Argument:	const DirectX::XMFLOAT3& rayInverseDirection - 1.0f / direction, per component
+// Argument:	float& outDistance - distance to where the ray enters the box, 0 if it starts inside
+//************************************
+inline bool RayAABBIntersection(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayInverseDirection, const DirectX::XMFLOAT3& aabbMin, const DirectX::XMFLOAT3& aabbMax, float maxDistance, float& outDistance)
+{
+	float t1 = (aabbMin.x - rayPosition.x) * rayInverseDirection.x;
+	float t2 = (aabbMax.x - rayPosition.x) * rayInverseDirection.x;
+	float t3 = (aabbMin.y - rayPosition.y) * rayInverseDirection.y;
+	float t4 = (aabbMax.y - rayPosition.y) * rayInverseDirection.y;
+	float t5 = (aabbMin.z - rayPosition.z) * rayInverseDirection.z;
+	float t6 = (aabbMax.z - rayPosition.z) * rayInverseDirection.z;
+
+	float tmin = std::max(std::max(std::min(t1, t2), std::min(t3, t4)), std::min(t5, t6));
+	float tmax = std::min(std::min(std::max(t1, t2), std::max(t3, t4)), std::max(t5, t6));
+
+	if(tmax < 0.0f || tmin > tmax || tmin > maxDistance)
+		return false;
+
+	outDistance = std::max(tmin, 0.0f);
+
+	return true;
+}
+
+//************************************
+// Method:		RayAABBIntersection4
+// Returns:		int - bit i is set if the ray hits box i between 0 and maxDistance
+// Argument:	const DirectX::XMVECTOR rayPosition[3] - x, y and z, each replicated to every component
+// Argument:	const DirectX::XMVECTOR rayInverseDirection[3] - same as rayPosition
+// Argument:	const DirectX::XMVECTOR aabbMin[3] - x, y and z of four boxes
+// Argument:	const DirectX::XMVECTOR aabbMax[3]
+// Argument:	DirectX::XMFLOAT4& outDistances - same as RayAABBIntersection's outDistance for each box that is hit
+// Description:	Same slab test as RayAABBIntersection, on four boxes at once
+//************************************
+inline int RayAABBIntersection4(const DirectX::XMVECTOR rayPosition[3], const DirectX::XMVECTOR rayInverseDirection[3], const DirectX::XMVECTOR aabbMin[3], const DirectX::XMVECTOR aabbMax[3], float maxDistance, DirectX::XMFLOAT4& outDistances)
+{
+	DirectX::XMVECTOR t1 = DirectX::XMVectorMultiply(DirectX::XMVectorSubtract(aabbMin[0], rayPosition[0]), rayInverseDirection[0]);
+	DirectX::XMVECTOR t2 = DirectX::XMVectorMultiply(DirectX::XMVectorSubtract(aabbMax[0], rayPosition[0]), rayInverseDirection[0]);
+	DirectX::XMVECTOR t3 = DirectX::XMVectorMultiply(DirectX::XMVectorSubtract(aabbMin[1], rayPosition[1]), rayInverseDirection[1]);
+	DirectX::XMVECTOR t4 = DirectX::XMVectorMultiply(DirectX::XMVectorSubtract(aabbMax[1], rayPosition[1]), rayInverseDirection[1]);
+	DirectX::XMVECTOR t5 = DirectX::XMVectorMultiply(DirectX::XMVectorSubtract(aabbMin[2], rayPosition[2]), rayInverseDirection[2]);
+	DirectX::XMVECTOR t6 = DirectX::XMVectorMultiply(DirectX::XMVectorSubtract(aabbMax[2], rayPosition[2]), rayInverseDirection[2]);
+
+	DirectX::XMVECTOR tmin = DirectX::XMVectorMax(DirectX::XMVectorMax(DirectX::XMVectorMin(t1, t2), DirectX::XMVectorMin(t3, t4)), DirectX::XMVectorMin(t5, t6));
+	DirectX::XMVECTOR tmax = DirectX::XMVectorMin(DirectX::XMVectorMin(DirectX::XMVectorMax(t1, t2), DirectX::XMVectorMax(t3, t4)), DirectX::XMVectorMax(t5, t6));
+
+	DirectX::XMFLOAT4 tminValues;
+	DirectX::XMFLOAT4 tmaxValues;
+	DirectX::XMStoreFloat4(&tminValues, tmin);
+	DirectX::XMStoreFloat4(&tmaxValues, tmax);
+	DirectX::XMStoreFloat4(&outDistances, DirectX::XMVectorMax(tmin, DirectX::XMVectorZero()));
+
+	const float* entryDistances = &tminValues.x;
+	const float* exitDistances = &tmaxValues.x;
+
+	int hitMask = 0;
+	for(int i = 0; i < 4; ++i)
+	{
+		if(!(exitDistances[i] < 0.0f || entryDistances[i] > exitDistances[i] || entryDistances[i] > maxDistance))
+			hitMask |= 1 << i;
+	}
+
+	return hitMask;
+}
+
+//************************************
+// Method:		RaySphereIntersection
+// Returns:		bool
+// Argument:	const DirectX::XMFLOAT3& rayDirection - normalized
+// Argument:	float& outDistance - distance to the first intersection, negative if the ray starts inside the sphere
+//************************************
+inline bool RaySphereIntersection(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, const DirectX::XMFLOAT3& spherePosition, float sphereRadius, float& outDistance)
+{
+	DirectX::XMFLOAT3 dirToSphere = RaySub(rayPosition, spherePosition);
+
+	float a = RayDot(rayDirection, dirToSphere);
+	float b = RayDot(dirToSphere, dirToSphere);
+
+	float root = (a * a) - b + (sphereRadius * sphereRadius);
+
+	if(root < 0.0f)
+		return false;
+
+	outDistance = -a - std::sqrt(root);
+
+	return true;
+}
+
+//************************************
+// Method:		RayTriangleIntersection
+// Returns:		bool - false if the ray misses the triangle or hits its back side
+// Argument:	float& outU - barycentric coordinate of v1
+// Argument:	float& outV - barycentric coordinate of v2
+// Argument:	float& outDistance
+//************************************
+inline bool RayTriangleIntersection(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, const DirectX::XMFLOAT3& v0, const DirectX::XMFLOAT3& v1, const DirectX::XMFLOAT3& v2, float& outU, float& outV, float& outDistance)
+{
+	DirectX::XMFLOAT3 e0 = RaySub(v1, v0);
+	DirectX::XMFLOAT3 e1 = RaySub(v2, v0);
+
+	//Same as checking against the normalized normal, without the normalization
+	if(RayDot(rayDirection, RayCross(e0, e1)) >= 0.0f)
+		return false;
+
+	DirectX::XMFLOAT3 detCross = RayCross(rayDirection, e1);
+	float det = RayDot(e0, detCross);
+
+	float detInv = 1.0f / det;
+
+	DirectX::XMFLOAT3 rayDist = RaySub(rayPosition, v0);
+	float u = RayDot(rayDist, detCross) * detInv;
+
+	if(u < 0.0f || u > 1.0f)
+		return false;
+
+	DirectX::XMFLOAT3 vPrep = RayCross(rayDist, e0);
+	float v = RayDot(rayDirection, vPrep) * detInv;
+
+	if(v < 0.0f || u + v > 1.0f)
+		return false;
+
+	outDistance = RayDot(e1, vPrep) * detInv;
+
+	outU = u;
+	outV = v;
+
+	return true;
+}
+
+#endif // RayIntersection_h__
@@ -0,0 +1,130 @@
+#include "SceneBuilder.h"
+
+#include <algorithm>
+#include <limits>
+
+SceneBuilder::SceneBuilder()
+	: vertexCount(0)
+	, triangleCount(0)
+{}
+
+void SceneBuilder::Reserve(int sphereCount, int meshCount)
+{
+	spheres.reserve(sphereCount);
+	instances.reserve(meshCount);
+	models.reserve(meshCount);
+}
+
+void SceneBuilder::AddSphere(const DirectX::XMFLOAT4& sphere, const DirectX::XMFLOAT4& color)
+{
+	Sphere newSphere;
+	newSphere.position = sphere;
+	newSphere.color = color;
+
+	spheres.push_back(newSphere);
+}
+
+void SceneBuilder::AddMeshes(const std::vector<Mesh>& meshes, const DirectX::XMFLOAT3& position, float scale)
+{
+	int indexOffset = vertexCount;
+
+	for(const Mesh& mesh : meshes)
+		AddInstance(mesh, position, scale, indexOffset);
+}
+
+void SceneBuilder::AddMesh(Mesh&& mesh, const DirectX::XMFLOAT3& position, float scale)
+{
+	ownedMeshes.emplace_back(new Mesh(std::move(mesh)));
+
+	AddInstance(*ownedMeshes.back(), position, scale, vertexCount);
+}
+
+void SceneBuilder::AddMeshInstance(const Mesh& mesh, const DirectX::XMFLOAT3& position, float scale)
+{
+	AddInstance(mesh, position, scale, vertexCount);
+}
+
+void SceneBuilder::Clear()
+{
+	spheres.clear();
+	instances.clear();
+	models.clear();
+	ownedMeshes.clear();
+	meshBounds.clear();
+
+	vertexCount = 0;
+	triangleCount = 0;
+}
+
+const std::vector<SceneBuilder::Sphere>& SceneBuilder::GetSpheres() const
+{
+	return spheres;
+}
+
+const std::vector<SceneBuilder::Model>& SceneBuilder::GetModels() const
+{
+	return models;
+}
+
+int SceneBuilder::GetVertexCount() const
+{
+	return vertexCount;
+}
+
+int SceneBuilder::GetTriangleCount() const
+{
+	return triangleCount;
+}
+
+void SceneBuilder::AddInstance(const Mesh& mesh, const DirectX::XMFLOAT3& position, float scale, int indexOffset)
+{
+	auto boundsIter = meshBounds.find(&mesh);
+	if(boundsIter == meshBounds.end())
+	{
+		DirectX::XMFLOAT3 min(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+		DirectX::XMFLOAT3 max(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest());
+
+		for(const OBJVertex& vertex : mesh.vertices)
+		{
+			min.x = std::min(min.x, vertex.position.x);
+			min.y = std::min(min.y, vertex.position.y);
+			min.z = std::min(min.z, vertex.position.z);
+
+			max.x = std::max(max.x, vertex.position.x);
+			max.y = std::max(max.y, vertex.position.y);
+			max.z = std::max(max.z, vertex.position.z);
+		}
+
+		boundsIter = meshBounds.emplace(&mesh, std::make_pair(min, max)).first;
+	}
+
+	Instance instance;
+	instance.mesh = &mesh;
+	instance.position = position;
+	instance.scale = scale;
+	instance.indexOffset = indexOffset;
+
+	instances.push_back(instance);
+
+	//Scaling and translating a box gives the box around the scaled and translated vertices,
+	//as long as min and max swap places for negative scales
+	const DirectX::XMFLOAT3& meshMin = boundsIter->second.first;
+	const DirectX::XMFLOAT3& meshMax = boundsIter->second.second;
+
+	DirectX::XMFLOAT3 scaledMin(meshMin.x * scale + position.x, meshMin.y * scale + position.y, meshMin.z * scale + position.z);
+	DirectX::XMFLOAT3 scaledMax(meshMax.x * scale + position.x, meshMax.y * scale + position.y, meshMax.z * scale + position.z);
+
+	Model model;
+	model.aabbMin = DirectX::XMFLOAT3(std::min(scaledMin.x, scaledMax.x), std::min(scaledMin.y, scaledMax.y), std::min(scaledMin.z, scaledMax.z));
+	model.aabbMax = DirectX::XMFLOAT3(std::max(scaledMin.x, scaledMax.x), std::max(scaledMin.y, scaledMax.y), std::max(scaledMin.z, scaledMax.z));
+	model.beginVertex = vertexCount;
+	model.endVertex = vertexCount + static_cast<int>(mesh.vertices.size());
+	model.beginIndex = triangleCount;
+	model.endIndex = triangleCount + static_cast<int>(mesh.indicies.size()) / 3;
+	model.material = mesh.material;
+
+	models.push_back(model);
+
+	vertexCount = model.endVertex;
+	triangleCount = model.endIndex;
+}
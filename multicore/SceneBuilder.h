@@ -0,0 +1,245 @@
+#ifndef SceneBuilder_h__
+#define SceneBuilder_h__
+
+#include <DXLib/DXMath.h>
+#include <DXLib/OBJFile.h>
+#include <DXLib/ThreadPool.h>
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+//Collects the spheres and meshes given to ShaderProgram::AddSphere and AddOBJ. Each shader program
+//then writes the whole scene out in its own GPU layout at once, through WriteVertices and WriteTriangles.
+//
+//Meshes are referenced rather than copied when added, so adding is only bookkeeping. Vertices are
+//transformed when written, in parallel and straight into the program's buffer
+class SceneBuilder
+{
+public:
+	struct Sphere
+	{
+		DirectX::XMFLOAT4 position; //position + radius
+		DirectX::XMFLOAT4 color; //color + reflectivity
+	};
+
+	//One per added mesh
+	struct Model
+	{
+		DirectX::XMFLOAT3 aabbMin;
+		DirectX::XMFLOAT3 aabbMax;
+
+		int beginVertex;
+		int endVertex;
+		//Triangles, not indices
+		int beginIndex;
+		int endIndex;
+
+		Material material;
+	};
+
+	SceneBuilder();
+	~SceneBuilder() = default;
+
+	SceneBuilder(const SceneBuilder&) = delete;
+	SceneBuilder& operator=(const SceneBuilder&) = delete;
+
+	//************************************
+	// Method:		Reserve
+	// FullName:	SceneBuilder::Reserve
+	// Access:		public
+	// Returns:		void
+	// Qualifier:
+	// Argument:	int sphereCount
+	// Argument:	int meshCount
+	// Description:	Avoids reallocating when the number of spheres and meshes is known up front
+	//************************************
+	void Reserve(int sphereCount, int meshCount);
+
+	void AddSphere(const DirectX::XMFLOAT4& sphere, const DirectX::XMFLOAT4& color);
+	//************************************
+	// Method:		AddMeshes
+	// FullName:	SceneBuilder::AddMeshes
+	// Access:		public
+	// Returns:		void
+	// Qualifier:
+	// Argument:	const std::vector<Mesh>& meshes - referenced, not copied. Has to stay alive until the builder
+	//				is cleared, which is the case for OBJFile::GetMeshes as long as the OBJFile is loaded
+	// Argument:	const DirectX::XMFLOAT3& position
+	// Argument:	float scale
+	// Description:	Indices are counted over every mesh in meshes, same as in an OBJFile
+	//************************************
+	void AddMeshes(const std::vector<Mesh>& meshes, const DirectX::XMFLOAT3& position, float scale);
+	//************************************
+	// Method:		AddMesh
+	// FullName:	SceneBuilder::AddMesh
+	// Access:		public
+	// Returns:		void
+	// Qualifier:
+	// Argument:	Mesh&& mesh - generated geometry which nothing else owns. Indices start at 0
+	// Argument:	const DirectX::XMFLOAT3& position
+	// Argument:	float scale
+	// Description:
+	//************************************
+	void AddMesh(Mesh&& mesh, const DirectX::XMFLOAT3& position, float scale);
+	//************************************
+	// Method:		AddMeshInstance
+	// FullName:	SceneBuilder::AddMeshInstance
+	// Access:		public
+	// Returns:		void
+	// Qualifier:
+	// Argument:	const Mesh& mesh - referenced, not copied, same as for AddMeshes. Indices start at 0
+	// Argument:	const DirectX::XMFLOAT3& position
+	// Argument:	float scale
+	// Description:	For generated meshes that are placed many times, see SceneGenerator
+	//************************************
+	void AddMeshInstance(const Mesh& mesh, const DirectX::XMFLOAT3& position, float scale);
+	void Clear();
+
+	const std::vector<Sphere>& GetSpheres() const;
+	const std::vector<Model>& GetModels() const;
+	int GetVertexCount() const;
+	int GetTriangleCount() const;
+
+	//************************************
+	// Method:		WriteVertices
+	// FullName:	SceneBuilder::WriteVertices
+	// Access:		public
+	// Returns:		void
+	// Qualifier:	const
+	// Argument:	Vertex* outVertices - room for GetVertexCount vertices
+	// Argument:	ConvertVertex convertVertex - void(const OBJVertex& vertex, Vertex& outVertex). Given the
+	//				transformed vertex, called from several threads at once
+	// Argument:	ThreadPool* threadPool - the vertices are split across the pool's workers if given
+	// Description:
+	//************************************
+	template<typename Vertex, typename ConvertVertex>
+	void WriteVertices(Vertex* outVertices, ConvertVertex convertVertex, ThreadPool* threadPool = nullptr) const;
+	//************************************
+	// Method:		WriteTriangles
+	// FullName:	SceneBuilder::WriteTriangles
+	// Access:		public
+	// Returns:		void
+	// Qualifier:	const
+	// Argument:	Triangle* outTriangles - room for GetTriangleCount triangles
+	// Argument:	ConvertTriangle convertTriangle - void(const DirectX::XMINT3& indicies, int modelIndex, Triangle& outTriangle).
+	//				indicies are already offset to the model's vertices. Called from several threads at once
+	// Argument:	ThreadPool* threadPool - same as for WriteVertices
+	// Description:
+	//************************************
+	template<typename Triangle, typename ConvertTriangle>
+	void WriteTriangles(Triangle* outTriangles, ConvertTriangle convertTriangle, ThreadPool* threadPool = nullptr) const;
+
+private:
+	//Vertices or triangles per task when writing
+	static const int GRAIN_SIZE = 4096;
+
+	struct Instance
+	{
+		const Mesh* mesh;
+
+		DirectX::XMFLOAT3 position;
+		float scale;
+
+		//Added to every index of the mesh
+		int indexOffset;
+	};
+
+	std::vector<Sphere> spheres;
+	//Same order as models
+	std::vector<Instance> instances;
+	std::vector<Model> models;
+
+	//Meshes given to AddMesh
+	std::vector<std::unique_ptr<Mesh>> ownedMeshes;
+	//Untransformed bounds of every mesh seen so far, so meshes placed many times are only scanned once
+	std::unordered_map<const Mesh*, std::pair<DirectX::XMFLOAT3, DirectX::XMFLOAT3>> meshBounds;
+
+	int vertexCount;
+	int triangleCount;
+
+	void AddInstance(const Mesh& mesh, const DirectX::XMFLOAT3& position, float scale, int indexOffset);
+
+	//Calls function(modelIndex, begin, end) for ranges of at most GRAIN_SIZE elements, where elements are
+	//vertices or triangles depending on beginMember/endMember
+	template<typename RangeFunction>
+	void ForEachRange(int Model::* beginMember, int Model::* endMember, ThreadPool* threadPool, RangeFunction function) const;
+};
+
+template<typename RangeFunction>
+void SceneBuilder::ForEachRange(int Model::* beginMember, int Model::* endMember, ThreadPool* threadPool, RangeFunction function) const
+{
+	//Models are split up so a single huge mesh is spread across the workers as well
+	struct Range
+	{
+		int modelIndex;
+		int begin;
+		int end;
+	};
+
+	std::vector<Range> ranges;
+	for(int i = 0, modelCount = static_cast<int>(models.size()); i < modelCount; ++i)
+	{
+		for(int begin = models[i].*beginMember, end = models[i].*endMember; begin < end; begin += GRAIN_SIZE)
+			ranges.push_back(Range{ i, begin, begin + GRAIN_SIZE < end ? begin + GRAIN_SIZE : end });
+	}
+
+	auto runRanges = [&](int begin, int end)
+	{
+		for(int i = begin; i < end; ++i)
+			function(ranges[i].modelIndex, ranges[i].begin, ranges[i].end);
+	};
+
+	if(threadPool == nullptr)
+		runRanges(0, static_cast<int>(ranges.size()));
+	else
+		threadPool->ParallelFor(static_cast<int>(ranges.size()), 1, runRanges);
+}
+
+template<typename Vertex, typename ConvertVertex>
+void SceneBuilder::WriteVertices(Vertex* outVertices, ConvertVertex convertVertex, ThreadPool* threadPool) const
+{
+	ForEachRange(&Model::beginVertex, &Model::endVertex, threadPool, [&](int modelIndex, int begin, int end)
+	{
+		const Instance& instance = instances[modelIndex];
+		const std::vector<OBJVertex>& meshVertices = instance.mesh->vertices;
+
+		int meshBegin = models[modelIndex].beginVertex;
+
+		for(int i = begin; i < end; ++i)
+		{
+			OBJVertex vertex = meshVertices[i - meshBegin];
+
+			vertex.position.x = vertex.position.x * instance.scale + instance.position.x;
+			vertex.position.y = vertex.position.y * instance.scale + instance.position.y;
+			vertex.position.z = vertex.position.z * instance.scale + instance.position.z;
+
+			convertVertex(vertex, outVertices[i]);
+		}
+	});
+}
+
+template<typename Triangle, typename ConvertTriangle>
+void SceneBuilder::WriteTriangles(Triangle* outTriangles, ConvertTriangle convertTriangle, ThreadPool* threadPool) const
+{
+	ForEachRange(&Model::beginIndex, &Model::endIndex, threadPool, [&](int modelIndex, int begin, int end)
+	{
+		const Instance& instance = instances[modelIndex];
+		const std::vector<int>& meshIndicies = instance.mesh->indicies;
+
+		int meshBegin = models[modelIndex].beginIndex;
+
+		for(int i = begin; i < end; ++i)
+		{
+			int first = (i - meshBegin) * 3;
+
+			DirectX::XMINT3 indicies(instance.indexOffset + meshIndicies[first]
+									 , instance.indexOffset + meshIndicies[first + 1]
+									 , instance.indexOffset + meshIndicies[first + 2]);
+
+			convertTriangle(indicies, modelIndex, outTriangles[i]);
+		}
+	});
+}
+
+#endif // SceneBuilder_h__
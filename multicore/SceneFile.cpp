@@ -0,0 +1,618 @@
+#include "SceneFile.h"
+
+#include <DXLib/XmlReader.h>
+#include <DXLib/MappedFile.h>
+#include <DXLib/Logger.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <type_traits>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+namespace
+{
+	/*Compiled scene (.scenecache). Layout:
+	* SceneCacheHeader
+	* char[meshPathBytes], every mesh path followed by a null terminator
+	* SceneInstance[instanceCount]
+	* SceneSphere[sphereCount]
+	* SceneCacheKeyFrame[keyFrameCount]
+	*/
+	const char SCENE_CACHE_MAGIC[4] = { 'D', 'X', 'S', 'C' };
+	const uint32_t SCENE_CACHE_VERSION = 2;
+
+	struct SceneCacheHeader
+	{
+		char magic[4];
+		uint32_t version;
+		int64_t sourceSize;
+		int64_t sourceWriteTime;
+		uint32_t meshCount;
+		uint32_t meshPathBytes;
+		uint32_t instanceCount;
+		uint32_t sphereCount;
+		uint32_t keyFrameCount;
+		uint32_t cameraLoop;
+		float cameraSpeed;
+		SceneLights lights;
+		uint32_t hasGenerator;
+		SceneGeneratorSettings generatorSettings;
+	};
+
+	//The handles are calculated by CinematicCamera, so they aren't stored
+	struct SceneCacheKeyFrame
+	{
+		DirectX::XMFLOAT3 position;
+		DirectX::XMFLOAT3 lookAt;
+		int32_t lookMode;
+		float slerpTargetTime;
+		float lerpSpeed;
+	};
+
+	static_assert(std::is_trivially_copyable<SceneCacheHeader>::value, "SceneCacheHeader is written to and read from the scene cache as raw bytes");
+	static_assert(sizeof(SceneInstance) == 20, "SceneInstance is written to the scene cache as-is");
+	static_assert(sizeof(SceneSphere) == 32, "SceneSphere is written to the scene cache as-is");
+
+	//room.scene -> room.scenecache
+	std::string GetCachePath(const std::string& path)
+	{
+		const std::string extension = ".scene";
+
+		if(path.size() >= extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0)
+			return path + "cache";
+
+		return path + ".scenecache";
+	}
+
+	//************************************
+	// Method:		ParseFloats
+	// Returns:		bool - false if value doesn't contain count numbers, in which case out is left untouched
+	// Argument:	const XMLStringView& value - whitespace separated numbers, e.g. "1 0.5 -2"
+	// Argument:	float* out
+	// Argument:	int count - at most 4
+	//************************************
+	bool ParseFloats(const XMLStringView& value, float* out, int count)
+	{
+		std::string text = value.ToString();
+		const char* current = text.c_str();
+
+		float parsed[4];
+		for(int i = 0; i < count; ++i)
+		{
+			char* end;
+			parsed[i] = std::strtof(current, &end);
+			if(end == current)
+				return false;
+
+			current = end;
+		}
+
+		std::memcpy(out, parsed, count * sizeof(float));
+		return true;
+	}
+
+	float GetFloat(const XMLElementView& element, const char* name, float defaultValue)
+	{
+		return element.AttributeExists(name) ? element.GetAttribute(name).GetValueAsFloat() : defaultValue;
+	}
+
+	bool ParseLookMode(const XMLStringView& value, LOOK_MODE& outLookMode)
+	{
+		if(value == "none")
+			outLookMode = LOOK_MODE::NONE;
+		else if(value == "glance")
+			outLookMode = LOOK_MODE::GLANCE;
+		else if(value == "normal")
+			outLookMode = LOOK_MODE::NORMAL;
+		else if(value == "slerp")
+			outLookMode = LOOK_MODE::SLERP;
+		else
+			return false;
+
+		return true;
+	}
+}
+
+SceneLights::SceneLights()
+	: count(1)
+	, intensity(15.0f)
+	, rotationRadius(5.0f)
+	, minHeight(1.0f)
+	, maxHeight(9.5f)
+	, verticalSpeed(0.0005f)
+	, horizontalSpeed(0.0005f)
+	, sinValMult(2.0f)
+	, otherSinValMult(1.0f)
+{
+	attenuation[0] = 2.5f;
+	attenuation[1] = 0.2f;
+	attenuation[2] = 1.0f;
+}
+
+SceneGeneratorSettings::SceneGeneratorSettings()
+	: seed(1)
+	, sphereCount(64)
+	, triangleCount(1024)
+	, lightCount(1)
+	, instanceCount(1)
+	, textureCount(1)
+{}
+
+SceneCameraPath::SceneCameraPath()
+	: loop(true)
+	, speed(0.0f)
+{}
+
+SceneFile::SceneFile()
+	: hasGenerator(false)
+{}
+
+std::string SceneFile::Load(const std::string& path)
+{
+	Clear();
+
+	auto loadStart = std::chrono::high_resolution_clock::now();
+
+	std::string cachePath = GetCachePath(path);
+
+	long long sourceSize = -1;
+	long long sourceWriteTime = 0;
+
+	struct _stat64 sourceStat;
+	if(_stat64(path.c_str(), &sourceStat) == 0)
+	{
+		sourceSize = static_cast<long long>(sourceStat.st_size);
+		sourceWriteTime = static_cast<long long>(sourceStat.st_mtime);
+	}
+
+	bool fromCache = ReadCache(cachePath, sourceSize, sourceWriteTime);
+	if(!fromCache)
+	{
+		Clear();
+
+		if(sourceSize < 0)
+			return "Couldn't find \"" + path + "\"";
+
+		std::string errorString = Parse(path);
+		if(!errorString.empty())
+		{
+			Clear();
+			return errorString;
+		}
+
+		WriteCache(cachePath, sourceSize, sourceWriteTime);
+	}
+
+	this->path = path;
+
+	std::chrono::duration<double, std::milli> loadTime = std::chrono::high_resolution_clock::now() - loadStart;
+
+	Logger::LogLine(LOG_TYPE::INFO, "Loaded scene \"" + path + "\"" + (fromCache ? " from cache" : "") + " in " + std::to_string(loadTime.count()) + " ms, "
+					+ std::to_string(meshPaths.size()) + " meshes, " + std::to_string(instances.size()) + " instances, " + std::to_string(spheres.size()) + " spheres" + (hasGenerator ? ", generated content" : ""));
+
+	return "";
+}
+
+void SceneFile::Clear()
+{
+	path.clear();
+
+	meshPaths.clear();
+	instances.clear();
+	spheres.clear();
+	lights = SceneLights();
+	cameraPath = SceneCameraPath();
+	hasGenerator = false;
+	generatorSettings = SceneGeneratorSettings();
+
+	materials.clear();
+	meshIndices.clear();
+	parseError.clear();
+}
+
+const std::string& SceneFile::GetPath() const
+{
+	return path;
+}
+
+const std::vector<std::string>& SceneFile::GetMeshPaths() const
+{
+	return meshPaths;
+}
+
+const std::vector<SceneInstance>& SceneFile::GetInstances() const
+{
+	return instances;
+}
+
+const std::vector<SceneSphere>& SceneFile::GetSpheres() const
+{
+	return spheres;
+}
+
+const SceneLights& SceneFile::GetLights() const
+{
+	return lights;
+}
+
+const SceneCameraPath& SceneFile::GetCameraPath() const
+{
+	return cameraPath;
+}
+
+bool SceneFile::HasGenerator() const
+{
+	return hasGenerator;
+}
+
+const SceneGeneratorSettings& SceneFile::GetGeneratorSettings() const
+{
+	return generatorSettings;
+}
+
+std::string SceneFile::Parse(const std::string& sourcePath)
+{
+	XMLReader xmlReader;
+	if(!xmlReader.Open(sourcePath))
+		return "Couldn't open \"" + sourcePath + "\"";
+
+	bool parsed = xmlReader.Parse(std::bind(&SceneFile::XMLSubscriber, this, std::placeholders::_1));
+
+	materials.clear();
+	meshIndices.clear();
+
+	if(!parsed)
+		return "\"" + sourcePath + "\" isn't valid XML, see the log";
+
+	if(!parseError.empty())
+		return "Error in \"" + sourcePath + "\": " + parseError;
+
+	return "";
+}
+
+void SceneFile::XMLSubscriber(const XMLElementView& element)
+{
+	//Only the first error is reported, anything after it is likely caused by it
+	if(!parseError.empty())
+		return;
+
+	XMLStringView elementName = element.GetName();
+
+	if(elementName == "material")
+	{
+		std::string name = element.GetAttribute("name").ToString();
+		if(name.empty())
+		{
+			parseError = "<material> without a name";
+			return;
+		}
+
+		DirectX::XMFLOAT4 color(1.0f, 1.0f, 1.0f, GetFloat(element, "reflectivity", 0.0f));
+		if(element.AttributeExists("color") && !ParseFloats(element.GetAttribute("color"), &color.x, 3))
+		{
+			parseError = "<material> \"" + name + "\" needs three numbers for color";
+			return;
+		}
+
+		materials[name] = color;
+	}
+	else if(elementName == "mesh")
+	{
+		std::string name = element.GetAttribute("name").ToString();
+		std::string meshPath = element.GetAttribute("path").ToString();
+		if(name.empty() || meshPath.empty())
+		{
+			parseError = "<mesh> needs both a name and a path";
+			return;
+		}
+
+		if(!meshIndices.emplace(name, static_cast<int>(meshPaths.size())).second)
+		{
+			parseError = "<mesh> \"" + name + "\" is declared twice";
+			return;
+		}
+
+		meshPaths.push_back(meshPath);
+	}
+	else if(elementName == "instance")
+	{
+		std::string meshName = element.GetAttribute("mesh").ToString();
+
+		auto iter = meshIndices.find(meshName);
+		if(iter == meshIndices.end())
+		{
+			parseError = "<instance> of undeclared mesh \"" + meshName + "\"";
+			return;
+		}
+
+		SceneInstance instance;
+		instance.mesh = iter->second;
+		instance.position = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+		instance.scale = GetFloat(element, "scale", 1.0f);
+
+		if(element.AttributeExists("position") && !ParseFloats(element.GetAttribute("position"), &instance.position.x, 3))
+		{
+			parseError = "<instance> of \"" + meshName + "\" needs three numbers for position";
+			return;
+		}
+
+		instances.push_back(instance);
+	}
+	else if(elementName == "sphere")
+	{
+		SceneSphere sphere;
+		sphere.position = DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, GetFloat(element, "radius", 1.0f));
+		sphere.color = DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 0.0f);
+
+		if(!ParseFloats(element.GetAttribute("position"), &sphere.position.x, 3))
+		{
+			parseError = "<sphere> " + std::to_string(spheres.size()) + " needs three numbers for position";
+			return;
+		}
+
+		if(element.AttributeExists("material"))
+		{
+			std::string materialName = element.GetAttribute("material").ToString();
+
+			auto iter = materials.find(materialName);
+			if(iter == materials.end())
+			{
+				parseError = "<sphere> " + std::to_string(spheres.size()) + " uses undeclared material \"" + materialName + "\"";
+				return;
+			}
+
+			sphere.color = iter->second;
+		}
+
+		spheres.push_back(sphere);
+	}
+	else if(elementName == "lights")
+	{
+		if(element.AttributeExists("count"))
+			lights.count = element.GetAttribute("count").GetValueAsInt();
+
+		lights.intensity = GetFloat(element, "intensity", lights.intensity);
+		lights.rotationRadius = GetFloat(element, "rotationRadius", lights.rotationRadius);
+		lights.minHeight = GetFloat(element, "minHeight", lights.minHeight);
+		lights.maxHeight = GetFloat(element, "maxHeight", lights.maxHeight);
+		lights.verticalSpeed = GetFloat(element, "verticalSpeed", lights.verticalSpeed);
+		lights.horizontalSpeed = GetFloat(element, "horizontalSpeed", lights.horizontalSpeed);
+		lights.sinValMult = GetFloat(element, "sinValMult", lights.sinValMult);
+		lights.otherSinValMult = GetFloat(element, "otherSinValMult", lights.otherSinValMult);
+
+		if(element.AttributeExists("attenuation") && !ParseFloats(element.GetAttribute("attenuation"), lights.attenuation, 3))
+		{
+			parseError = "<lights> needs three numbers for attenuation";
+			return;
+		}
+	}
+	else if(elementName == "generate")
+	{
+		if(hasGenerator)
+		{
+			parseError = "<generate> can only be used once";
+			return;
+		}
+
+		hasGenerator = true;
+
+		if(element.AttributeExists("seed"))
+			generatorSettings.seed = static_cast<uint32_t>(element.GetAttribute("seed").GetValueAsInt());
+		if(element.AttributeExists("spheres"))
+			generatorSettings.sphereCount = element.GetAttribute("spheres").GetValueAsInt();
+		if(element.AttributeExists("triangles"))
+			generatorSettings.triangleCount = element.GetAttribute("triangles").GetValueAsInt();
+		if(element.AttributeExists("lights"))
+			generatorSettings.lightCount = element.GetAttribute("lights").GetValueAsInt();
+		if(element.AttributeExists("instances"))
+			generatorSettings.instanceCount = element.GetAttribute("instances").GetValueAsInt();
+		if(element.AttributeExists("textures"))
+			generatorSettings.textureCount = element.GetAttribute("textures").GetValueAsInt();
+	}
+	else if(elementName == "cameraPath")
+	{
+		if(element.AttributeExists("loop"))
+			cameraPath.loop = element.GetAttribute("loop") == "true" || element.GetAttribute("loop") == "1";
+
+		cameraPath.speed = GetFloat(element, "speed", cameraPath.speed);
+	}
+	else if(elementName == "keyFrame")
+	{
+		CameraKeyFrame keyFrame;
+
+		if(!ParseFloats(element.GetAttribute("position"), &keyFrame.position.x, 3))
+		{
+			parseError = "<keyFrame> " + std::to_string(cameraPath.keyFrames.size()) + " needs three numbers for position";
+			return;
+		}
+
+		if(element.AttributeExists("lookAt"))
+		{
+			if(!ParseFloats(element.GetAttribute("lookAt"), &keyFrame.lookAt.x, 3))
+			{
+				parseError = "<keyFrame> " + std::to_string(cameraPath.keyFrames.size()) + " needs three numbers for lookAt";
+				return;
+			}
+
+			keyFrame.lookMode = LOOK_MODE::NORMAL;
+		}
+
+		if(element.AttributeExists("lookMode") && !ParseLookMode(element.GetAttribute("lookMode"), keyFrame.lookMode))
+		{
+			parseError = "<keyFrame> " + std::to_string(cameraPath.keyFrames.size()) + " has unknown lookMode \"" + element.GetAttribute("lookMode").ToString() + "\"";
+			return;
+		}
+
+		keyFrame.slerpTargetTime = GetFloat(element, "slerpTargetTime", keyFrame.slerpTargetTime);
+		keyFrame.lerpSpeed = GetFloat(element, "lerpSpeed", keyFrame.lerpSpeed);
+
+		cameraPath.keyFrames.push_back(keyFrame);
+	}
+}
+
+bool SceneFile::ReadCache(const std::string& cachePath, long long sourceSize, long long sourceWriteTime)
+{
+	MappedFile file;
+	if(!file.Open(cachePath))
+		return false;
+
+	if(file.GetSize() < sizeof(SceneCacheHeader))
+		return false;
+
+	SceneCacheHeader header;
+	std::memcpy(&header, file.GetData(), sizeof(SceneCacheHeader));
+
+	if(std::memcmp(header.magic, SCENE_CACHE_MAGIC, sizeof(SCENE_CACHE_MAGIC)) != 0
+		|| header.version != SCENE_CACHE_VERSION)
+		return false;
+
+	//Without a .scene there's nothing to compare against, use the cache as-is
+	if(sourceSize >= 0
+		&& (header.sourceSize != sourceSize || header.sourceWriteTime != sourceWriteTime))
+		return false;
+
+	size_t expectedSize = sizeof(SceneCacheHeader)
+		+ header.meshPathBytes
+		+ static_cast<size_t>(header.instanceCount) * sizeof(SceneInstance)
+		+ static_cast<size_t>(header.sphereCount) * sizeof(SceneSphere)
+		+ static_cast<size_t>(header.keyFrameCount) * sizeof(SceneCacheKeyFrame);
+
+	if(file.GetSize() != expectedSize)
+	{
+		Logger::LogLine(LOG_TYPE::WARNING, "Scene cache \"" + cachePath + "\" is truncated or corrupt, reparsing scene");
+		return false;
+	}
+
+	const char* data = file.GetData() + sizeof(SceneCacheHeader);
+
+	//Paths are null terminated, so the last byte has to be one
+	if(header.meshPathBytes > 0 && data[header.meshPathBytes - 1] != '\0')
+	{
+		Logger::LogLine(LOG_TYPE::WARNING, "Scene cache \"" + cachePath + "\" is truncated or corrupt, reparsing scene");
+		return false;
+	}
+
+	meshPaths.reserve(header.meshCount);
+	for(const char* meshPath = data, *pathsEnd = data + header.meshPathBytes; meshPath < pathsEnd; meshPath += meshPaths.back().size() + 1)
+		meshPaths.emplace_back(meshPath);
+	data += header.meshPathBytes;
+
+	instances.resize(header.instanceCount);
+	if(!instances.empty())
+		std::memcpy(instances.data(), data, instances.size() * sizeof(SceneInstance));
+	data += instances.size() * sizeof(SceneInstance);
+
+	spheres.resize(header.sphereCount);
+	if(!spheres.empty())
+		std::memcpy(spheres.data(), data, spheres.size() * sizeof(SceneSphere));
+	data += spheres.size() * sizeof(SceneSphere);
+
+	cameraPath.loop = header.cameraLoop != 0;
+	cameraPath.speed = header.cameraSpeed;
+	cameraPath.keyFrames.resize(header.keyFrameCount);
+	for(CameraKeyFrame& keyFrame : cameraPath.keyFrames)
+	{
+		SceneCacheKeyFrame cachedKeyFrame;
+		std::memcpy(&cachedKeyFrame, data, sizeof(SceneCacheKeyFrame));
+		data += sizeof(SceneCacheKeyFrame);
+
+		keyFrame.position = cachedKeyFrame.position;
+		keyFrame.lookAt = cachedKeyFrame.lookAt;
+		keyFrame.lookMode = static_cast<LOOK_MODE>(cachedKeyFrame.lookMode);
+		keyFrame.slerpTargetTime = cachedKeyFrame.slerpTargetTime;
+		keyFrame.lerpSpeed = cachedKeyFrame.lerpSpeed;
+	}
+
+	lights = header.lights;
+	hasGenerator = header.hasGenerator != 0;
+	generatorSettings = header.generatorSettings;
+
+	bool valid = meshPaths.size() == header.meshCount;
+	for(const SceneInstance& instance : instances)
+		valid = valid && instance.mesh >= 0 && instance.mesh < static_cast<int32_t>(meshPaths.size());
+
+	if(!valid)
+	{
+		Logger::LogLine(LOG_TYPE::WARNING, "Scene cache \"" + cachePath + "\" is truncated or corrupt, reparsing scene");
+		return false;
+	}
+
+	return true;
+}
+
+void SceneFile::WriteCache(const std::string& cachePath, long long sourceSize, long long sourceWriteTime) const
+{
+	//Write to a temporary file first so a half written cache is never picked up
+	std::string temporaryPath = cachePath + ".tmp";
+
+	{
+		std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+		if(!out.is_open())
+		{
+			Logger::LogLine(LOG_TYPE::WARNING, "Couldn't write scene cache \"" + cachePath + "\"");
+			return;
+		}
+
+		uint32_t meshPathBytes = 0;
+		for(const std::string& meshPath : meshPaths)
+			meshPathBytes += static_cast<uint32_t>(meshPath.size()) + 1;
+
+		SceneCacheHeader header = {};
+		std::memcpy(header.magic, SCENE_CACHE_MAGIC, sizeof(SCENE_CACHE_MAGIC));
+		header.version = SCENE_CACHE_VERSION;
+		header.sourceSize = sourceSize;
+		header.sourceWriteTime = sourceWriteTime;
+		header.meshCount = static_cast<uint32_t>(meshPaths.size());
+		header.meshPathBytes = meshPathBytes;
+		header.instanceCount = static_cast<uint32_t>(instances.size());
+		header.sphereCount = static_cast<uint32_t>(spheres.size());
+		header.keyFrameCount = static_cast<uint32_t>(cameraPath.keyFrames.size());
+		header.cameraLoop = cameraPath.loop ? 1 : 0;
+		header.cameraSpeed = cameraPath.speed;
+		header.lights = lights;
+		header.hasGenerator = hasGenerator ? 1 : 0;
+		header.generatorSettings = generatorSettings;
+
+		out.write(reinterpret_cast<const char*>(&header), sizeof(SceneCacheHeader));
+
+		for(const std::string& meshPath : meshPaths)
+			out.write(meshPath.c_str(), meshPath.size() + 1);
+
+		if(!instances.empty())
+			out.write(reinterpret_cast<const char*>(instances.data()), instances.size() * sizeof(SceneInstance));
+		if(!spheres.empty())
+			out.write(reinterpret_cast<const char*>(spheres.data()), spheres.size() * sizeof(SceneSphere));
+
+		for(const CameraKeyFrame& keyFrame : cameraPath.keyFrames)
+		{
+			SceneCacheKeyFrame cachedKeyFrame;
+			cachedKeyFrame.position = keyFrame.position;
+			cachedKeyFrame.lookAt = keyFrame.lookAt;
+			cachedKeyFrame.lookMode = static_cast<int32_t>(keyFrame.lookMode);
+			cachedKeyFrame.slerpTargetTime = keyFrame.slerpTargetTime;
+			cachedKeyFrame.lerpSpeed = keyFrame.lerpSpeed;
+
+			out.write(reinterpret_cast<const char*>(&cachedKeyFrame), sizeof(SceneCacheKeyFrame));
+		}
+
+		if(!out.good())
+		{
+			Logger::LogLine(LOG_TYPE::WARNING, "Couldn't write scene cache \"" + cachePath + "\"");
+			out.close();
+			std::remove(temporaryPath.c_str());
+			return;
+		}
+	}
+
+	std::remove(cachePath.c_str());
+	if(std::rename(temporaryPath.c_str(), cachePath.c_str()) != 0)
+	{
+		Logger::LogLine(LOG_TYPE::WARNING, "Couldn't write scene cache \"" + cachePath + "\"");
+		std::remove(temporaryPath.c_str());
+	}
+}
@@ -0,0 +1,166 @@
+#ifndef SceneFile_h__
+#define SceneFile_h__
+
+#include <DXLib/DXMath.h>
+#include <DXLib/CinematicCamera.h>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+class XMLElementView;
+
+struct SceneInstance
+{
+	//Index into SceneFile::GetMeshPaths
+	int32_t mesh;
+
+	DirectX::XMFLOAT3 position;
+	float scale;
+};
+
+struct SceneSphere
+{
+	DirectX::XMFLOAT4 position; //position + radius
+	DirectX::XMFLOAT4 color; //color + reflectivity, resolved from the sphere's material
+};
+
+//Parameters of the orbiting point lights, see MulticoreWindow::InitPointLights.
+//Defaults are used for anything the scene doesn't set
+struct SceneLights
+{
+	SceneLights();
+
+	int32_t count;
+	float intensity;
+	float attenuation[3];
+
+	float rotationRadius;
+	float minHeight;
+	float maxHeight;
+
+	float verticalSpeed;
+	float horizontalSpeed;
+
+	float sinValMult;
+	float otherSinValMult;
+};
+
+//Parameters of a procedurally generated scene, see SceneGenerator
+struct SceneGeneratorSettings
+{
+	SceneGeneratorSettings();
+
+	uint32_t seed;
+
+	int32_t sphereCount;
+	//Spread over every instance, so each mesh has about triangleCount / instanceCount triangles
+	int32_t triangleCount;
+	//Replaces SceneLights::count
+	int32_t lightCount;
+	int32_t instanceCount;
+	//Number of distinct meshes, each with its own diffuse texture. At most instanceCount are used
+	int32_t textureCount;
+};
+
+struct SceneCameraPath
+{
+	SceneCameraPath();
+
+	bool loop;
+	//Units per second, 0 keeps the camera's default
+	float speed;
+
+	std::vector<CameraKeyFrame> keyFrames;
+};
+
+/*Everything MulticoreWindow used to hardcode: meshes, instances of them, spheres, materials,
+* lights and the cinematic camera's path.
+*
+* Scenes are written as XML (.scene):
+* <scene>
+*	<material name="red" color="1 0 0" reflectivity="0.8"/>
+*	<mesh name="sword" path="meshes/sword.obj"/>
+*	<instance mesh="sword" position="0 -2 0" scale="0.1"/>
+*	<sphere position="3 0 0" radius="0.5" material="red"/>
+*	<lights count="1" intensity="15" attenuation="2.5 0.2 1"/>
+*	<generate seed="1" spheres="64" triangles="1024" lights="1" instances="1" textures="1"/>
+*	<cameraPath loop="true" speed="0">
+*		<keyFrame position="0 0 0" lookAt="0 3.5 0" lookMode="normal"/>
+*	</cameraPath>
+* </scene>
+*
+* Materials and meshes have to be declared before they are referenced. Triangle materials come from
+* each mesh's .mtl, scene materials only apply to spheres. <generate> adds a SceneGenerator scene on
+* top of everything else, only its settings are stored.
+*
+* The first time a .scene is loaded it's compiled into a .scenecache next to it, which later loads
+* read instead as long as the .scene hasn't changed. The cache is a header followed by the arrays
+* as they are laid out in memory, so reading it is a handful of memcpys
+*/
+class SceneFile
+{
+public:
+	SceneFile();
+	~SceneFile() = default;
+
+	//************************************
+	// Method:		Load
+	// FullName:	SceneFile::Load
+	// Access:		public
+	// Returns:		std::string - empty on success, otherwise why the scene couldn't be loaded
+	// Qualifier:
+	// Argument:	const std::string& path - path to a .scene
+	// Description:	Reads the .scenecache if it's up to date, otherwise parses the .scene and writes the cache.
+	//				If only the .scenecache exists it is used as-is
+	//************************************
+	std::string Load(const std::string& path);
+	void Clear();
+
+	const std::string& GetPath() const;
+
+	//Paths of every mesh declared in the scene, whether or not it's instanced
+	const std::vector<std::string>& GetMeshPaths() const;
+	const std::vector<SceneInstance>& GetInstances() const;
+	const std::vector<SceneSphere>& GetSpheres() const;
+	const SceneLights& GetLights() const;
+	const SceneCameraPath& GetCameraPath() const;
+	//Whether the scene has a <generate> element
+	bool HasGenerator() const;
+	const SceneGeneratorSettings& GetGeneratorSettings() const;
+
+private:
+	std::string path;
+
+	std::vector<std::string> meshPaths;
+	std::vector<SceneInstance> instances;
+	std::vector<SceneSphere> spheres;
+	SceneLights lights;
+	SceneCameraPath cameraPath;
+	bool hasGenerator;
+	SceneGeneratorSettings generatorSettings;
+
+	//Only used while parsing
+	std::unordered_map<std::string, DirectX::XMFLOAT4> materials;
+	std::unordered_map<std::string, int> meshIndices;
+	std::string parseError;
+
+	std::string Parse(const std::string& sourcePath);
+	void XMLSubscriber(const XMLElementView& element);
+
+	//************************************
+	// Method:		ReadCache
+	// FullName:	SceneFile::ReadCache
+	// Access:		private
+	// Returns:		bool - false if the cache is missing, stale or corrupt
+	// Qualifier:
+	// Argument:	const std::string& cachePath
+	// Argument:	long long sourceSize - -1 if there is no source to compare against
+	// Argument:	long long sourceWriteTime
+	//************************************
+	bool ReadCache(const std::string& cachePath, long long sourceSize, long long sourceWriteTime);
+	void WriteCache(const std::string& cachePath, long long sourceSize, long long sourceWriteTime) const;
+};
+
+#endif // SceneFile_h__
@@ -0,0 +1,327 @@
+#include "SceneGenerator.h"
+
+#include <DXLib/ContentManager.h>
+#include <DXLib/Texture2D.h>
+#include <DXLib/Texture2DCreateParameters.h>
+#include <DXLib/ThreadPool.h>
+#include <DXLib/Logger.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+	enum class RANDOM_STREAM : uint32_t
+	{
+		SPHERE,
+		INSTANCE,
+		MESH,
+		TEXTURE
+	};
+
+	//Random numbers drawn per element, element i uses components [0, COMPONENTS)
+	const uint32_t COMPONENTS = 8;
+
+	const float PI = 3.14159265f;
+
+	uint32_t Hash(uint32_t value)
+	{
+		value ^= value >> 16;
+		value *= 0x7FEB352Du;
+		value ^= value >> 15;
+		value *= 0x846CA68Bu;
+		value ^= value >> 16;
+
+		return value;
+	}
+
+	//Uniform in [min, max)
+	float Random(uint32_t seed, RANDOM_STREAM stream, uint32_t element, uint32_t component, float min = 0.0f, float max = 1.0f)
+	{
+		uint32_t streamSeed = Hash(seed ^ ((static_cast<uint32_t>(stream) + 1) * 0x9E3779B9u));
+		float value = (Hash(streamSeed ^ Hash(element * COMPONENTS + component)) >> 8) / 16777216.0f;
+
+		return min + (max - min) * value;
+	}
+
+	//Each mesh is a tile of the height field h(x, z) = amplitude * sin(fx * x + px) * sin(fz * z + pz) over [-1, 1]
+	struct HeightField
+	{
+		float amplitude;
+		float frequency[2];
+		float phase[2];
+
+		HeightField(uint32_t seed, int meshIndex)
+		{
+			amplitude = Random(seed, RANDOM_STREAM::MESH, meshIndex, 0, 0.05f, 0.2f);
+			frequency[0] = Random(seed, RANDOM_STREAM::MESH, meshIndex, 1, 1.0f, 4.0f) * PI;
+			frequency[1] = Random(seed, RANDOM_STREAM::MESH, meshIndex, 2, 1.0f, 4.0f) * PI;
+			phase[0] = Random(seed, RANDOM_STREAM::MESH, meshIndex, 3, 0.0f, 2.0f * PI);
+			phase[1] = Random(seed, RANDOM_STREAM::MESH, meshIndex, 4, 0.0f, 2.0f * PI);
+		}
+
+		OBJVertex GetVertex(float u, float v) const
+		{
+			float x = u * 2.0f - 1.0f;
+			float z = v * 2.0f - 1.0f;
+
+			float sinX = std::sin(frequency[0] * x + phase[0]);
+			float sinZ = std::sin(frequency[1] * z + phase[1]);
+
+			float dX = amplitude * frequency[0] * std::cos(frequency[0] * x + phase[0]) * sinZ;
+			float dZ = amplitude * frequency[1] * sinX * std::cos(frequency[1] * z + phase[1]);
+
+			DirectX::XMFLOAT3 normal(-dX, 1.0f, -dZ);
+			float normalLength = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+
+			//Texture u runs along x
+			DirectX::XMFLOAT3 tangent(1.0f, dX, 0.0f);
+			float tangentLength = std::sqrt(tangent.x * tangent.x + tangent.y * tangent.y);
+
+			return OBJVertex(DirectX::XMFLOAT3(x, amplitude * sinX * sinZ, z)
+							 , DirectX::XMFLOAT3(normal.x / normalLength, normal.y / normalLength, normal.z / normalLength)
+							 , DirectX::XMFLOAT2(u, v)
+							 , DirectX::XMFLOAT3(tangent.x / tangentLength, tangent.y / tangentLength, 0.0f));
+		}
+	};
+}
+
+const float SceneGenerator::INSTANCE_SPACING = 2.5f;
+const float SceneGenerator::SPHERE_SPACING = 1.5f;
+
+SceneGenerator::SceneGenerator()
+	: normalTexture(nullptr)
+	, triangleCount(0)
+	, generateTime(0.0)
+{}
+
+void SceneGenerator::Generate(const SceneGeneratorSettings& settings, ContentManager* contentManager)
+{
+	auto generateStart = std::chrono::high_resolution_clock::now();
+
+	Clear();
+
+	//Every program needs at least one mesh with a texture to bind
+	this->settings = settings;
+	this->settings.sphereCount = std::max(0, settings.sphereCount);
+	this->settings.instanceCount = std::max(1, settings.instanceCount);
+	this->settings.triangleCount = std::max(2 * this->settings.instanceCount, settings.triangleCount);
+	this->settings.textureCount = std::min(std::max(1, settings.textureCount), this->settings.instanceCount);
+	this->settings.lightCount = std::max(0, settings.lightCount);
+
+	CreateTextures(this->settings.textureCount, contentManager);
+
+	GenerateSpheres();
+	GenerateInstances();
+
+	//As close to a square as possible without going over the triangle count
+	int cellsPerMesh = this->settings.triangleCount / this->settings.instanceCount / 2;
+	int columns = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(cellsPerMesh))));
+	int rows = std::max(1, cellsPerMesh / columns);
+
+	ThreadPool* threadPool = &contentManager->GetThreadPool();
+
+	meshes.resize(this->settings.textureCount);
+	for(int i = 0; i < this->settings.textureCount; ++i)
+		GenerateMesh(i, columns, rows, threadPool);
+
+	triangleCount = 2ll * columns * rows * this->settings.instanceCount;
+
+	std::chrono::duration<double, std::milli> duration = std::chrono::high_resolution_clock::now() - generateStart;
+	generateTime = duration.count();
+
+	Logger::LogLine(LOG_TYPE::INFO, "Generated scene with seed " + std::to_string(this->settings.seed) + " in " + std::to_string(generateTime) + " ms: "
+					+ std::to_string(spheres.size()) + " spheres, "
+					+ std::to_string(triangleCount) + " triangles over "
+					+ std::to_string(instances.size()) + " instances of "
+					+ std::to_string(meshes.size()) + " meshes");
+}
+
+void SceneGenerator::Clear()
+{
+	spheres.clear();
+	meshes.clear();
+	instances.clear();
+
+	triangleCount = 0;
+}
+
+bool SceneGenerator::IsEmpty() const
+{
+	return spheres.empty() && instances.empty();
+}
+
+const SceneGeneratorSettings& SceneGenerator::GetSettings() const
+{
+	return settings;
+}
+
+const std::vector<SceneSphere>& SceneGenerator::GetSpheres() const
+{
+	return spheres;
+}
+
+const std::vector<Mesh>& SceneGenerator::GetMeshes() const
+{
+	return meshes;
+}
+
+const std::vector<SceneInstance>& SceneGenerator::GetInstances() const
+{
+	return instances;
+}
+
+long long SceneGenerator::GetTriangleCount() const
+{
+	return triangleCount;
+}
+
+double SceneGenerator::GetGenerateTime() const
+{
+	return generateTime;
+}
+
+void SceneGenerator::GenerateSpheres()
+{
+	//A cube resting on top of the meshes
+	float side = SPHERE_SPACING * std::cbrt(static_cast<float>(settings.sphereCount));
+
+	spheres.resize(settings.sphereCount);
+	for(int i = 0; i < settings.sphereCount; ++i)
+	{
+		SceneSphere& sphere = spheres[i];
+
+		sphere.position.x = Random(settings.seed, RANDOM_STREAM::SPHERE, i, 0, -0.5f, 0.5f) * side;
+		sphere.position.y = Random(settings.seed, RANDOM_STREAM::SPHERE, i, 1, 0.0f, 1.0f) * side + 1.0f;
+		sphere.position.z = Random(settings.seed, RANDOM_STREAM::SPHERE, i, 2, -0.5f, 0.5f) * side;
+		sphere.position.w = Random(settings.seed, RANDOM_STREAM::SPHERE, i, 3, 0.2f, 0.45f);
+
+		sphere.color.x = Random(settings.seed, RANDOM_STREAM::SPHERE, i, 4, 0.2f, 1.0f);
+		sphere.color.y = Random(settings.seed, RANDOM_STREAM::SPHERE, i, 5, 0.2f, 1.0f);
+		sphere.color.z = Random(settings.seed, RANDOM_STREAM::SPHERE, i, 6, 0.2f, 1.0f);
+		sphere.color.w = Random(settings.seed, RANDOM_STREAM::SPHERE, i, 7, 0.0f, 0.8f);
+	}
+}
+
+void SceneGenerator::GenerateInstances()
+{
+	//A jittered square grid, filled row by row
+	int gridSize = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(settings.instanceCount))));
+	float gridOffset = (gridSize - 1) * 0.5f;
+
+	instances.resize(settings.instanceCount);
+	for(int i = 0; i < settings.instanceCount; ++i)
+	{
+		SceneInstance& instance = instances[i];
+
+		//Spread the meshes evenly rather than randomly so every one of them is used
+		instance.mesh = i % settings.textureCount;
+
+		instance.position.x = (i % gridSize - gridOffset) * INSTANCE_SPACING + Random(settings.seed, RANDOM_STREAM::INSTANCE, i, 0, -0.1f, 0.1f);
+		instance.position.y = Random(settings.seed, RANDOM_STREAM::INSTANCE, i, 1, -0.1f, 0.1f);
+		instance.position.z = (i / gridSize - gridOffset) * INSTANCE_SPACING + Random(settings.seed, RANDOM_STREAM::INSTANCE, i, 2, -0.1f, 0.1f);
+		instance.scale = Random(settings.seed, RANDOM_STREAM::INSTANCE, i, 3, 0.9f, 1.1f);
+	}
+}
+
+void SceneGenerator::GenerateMesh(int meshIndex, int columns, int rows, ThreadPool* threadPool)
+{
+	HeightField heightField(settings.seed, meshIndex);
+
+	Mesh& mesh = meshes[meshIndex];
+	mesh.material.name = "Generated" + std::to_string(meshIndex);
+	mesh.material.diffuseTexture = diffuseTextures[meshIndex];
+	mesh.material.normalTexture = normalTexture;
+
+	int vertexColumns = columns + 1;
+
+	mesh.vertices.resize(static_cast<size_t>(vertexColumns) * (rows + 1));
+	mesh.indicies.resize(static_cast<size_t>(columns) * rows * 6);
+
+	//Every vertex and index only depends on its row and column, so rows can be written in any order
+	threadPool->ParallelFor(rows + 1, GRAIN_SIZE, [&](int begin, int end)
+	{
+		for(int row = begin; row < end; ++row)
+		{
+			float v = row / static_cast<float>(rows);
+
+			for(int column = 0; column <= columns; ++column)
+				mesh.vertices[static_cast<size_t>(row) * vertexColumns + column] = heightField.GetVertex(column / static_cast<float>(columns), v);
+
+			if(row == rows)
+				continue;
+
+			int* indicies = &mesh.indicies[static_cast<size_t>(row) * columns * 6];
+			for(int column = 0; column < columns; ++column)
+			{
+				int first = row * vertexColumns + column;
+				int right = first + 1;
+				int up = first + vertexColumns;
+				int upRight = up + 1;
+
+				//Counter-clockwise seen from above, so the front faces point up
+				*indicies++ = first;
+				*indicies++ = up;
+				*indicies++ = right;
+
+				*indicies++ = right;
+				*indicies++ = up;
+				*indicies++ = upRight;
+			}
+		}
+	});
+}
+
+void SceneGenerator::CreateTextures(int count, ContentManager* contentManager)
+{
+	if(normalTexture == nullptr)
+	{
+		//Tangent space (0, 0, 1)
+		uint8_t flatNormalData[] =
+		{
+			128, 128, 255, 255, 128, 128, 255, 255,
+			128, 128, 255, 255, 128, 128, 255, 255
+		};
+
+		Texture2DCreateParameters normalParameters;
+		normalParameters.data = &flatNormalData[0];
+		normalParameters.width = 2;
+		normalParameters.height = 2;
+		normalParameters.uniqueID = "SceneGeneratorNormal";
+
+		normalTexture = contentManager->Load<Texture2D>("", &normalParameters);
+	}
+
+	std::vector<uint8_t> data(TEXTURE_SIZE * TEXTURE_SIZE * 4);
+
+	for(int i = static_cast<int>(diffuseTextures.size()); i < count; ++i)
+	{
+		//A checkerboard of two colors. Alpha is the reflectivity
+		uint8_t colors[2][4];
+		for(int j = 0; j < 2; ++j)
+		{
+			for(int k = 0; k < 3; ++k)
+				colors[j][k] = static_cast<uint8_t>(Random(0, RANDOM_STREAM::TEXTURE, i, j * 3 + k, 32.0f, 256.0f));
+
+			colors[j][3] = 51;
+		}
+
+		for(int y = 0; y < TEXTURE_SIZE; ++y)
+		{
+			for(int x = 0; x < TEXTURE_SIZE; ++x)
+			{
+				const uint8_t* color = colors[(x / CHECKER_SIZE + y / CHECKER_SIZE) % 2];
+				std::copy(color, color + 4, &data[(y * TEXTURE_SIZE + x) * 4]);
+			}
+		}
+
+		Texture2DCreateParameters diffuseParameters;
+		diffuseParameters.data = data.data();
+		diffuseParameters.width = TEXTURE_SIZE;
+		diffuseParameters.height = TEXTURE_SIZE;
+		diffuseParameters.uniqueID = "SceneGeneratorDiffuse" + std::to_string(i);
+
+		diffuseTextures.push_back(contentManager->Load<Texture2D>("", &diffuseParameters));
+	}
+}
@@ -0,0 +1,91 @@
+#ifndef SceneGenerator_h__
+#define SceneGenerator_h__
+
+#include <DXLib/DXMath.h>
+#include <DXLib/OBJFile.h>
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "SceneFile.h"
+
+class ContentManager;
+class ThreadPool;
+class Texture2D;
+
+//Generates stress test scenes: spheres in a cube above a grid of instanced height field tiles.
+//
+//Everything is derived from a hash of the seed and the index of what's being generated, never from
+//a running random state, so the same settings give the same scene no matter how generation is
+//split across threads. The volume the spheres and instances are spread over grows with their count, so the density and
+//what a ray has to get through stays about the same as the scene grows
+class SceneGenerator
+{
+public:
+	SceneGenerator();
+	~SceneGenerator() = default;
+
+	SceneGenerator(const SceneGenerator&) = delete;
+	SceneGenerator& operator=(const SceneGenerator&) = delete;
+
+	//************************************
+	// Method:		Generate
+	// FullName:	SceneGenerator::Generate
+	// Access:		public
+	// Returns:		void
+	// Qualifier:
+	// Argument:	const SceneGeneratorSettings& settings
+	// Argument:	ContentManager* contentManager - creates the textures, so this has to be called from its owning
+	//				thread. Meshes are generated on its thread pool
+	// Description:	Replaces the previously generated scene. Meshes given to a SceneBuilder have to be removed
+	//				from it before calling this
+	//************************************
+	void Generate(const SceneGeneratorSettings& settings, ContentManager* contentManager);
+	//Textures are kept, they are owned by the ContentManager
+	void Clear();
+
+	bool IsEmpty() const;
+
+	const SceneGeneratorSettings& GetSettings() const;
+	const std::vector<SceneSphere>& GetSpheres() const;
+	const std::vector<Mesh>& GetMeshes() const;
+	//SceneInstance::mesh is an index into GetMeshes
+	const std::vector<SceneInstance>& GetInstances() const;
+
+	//Triangles over every instance. Meshes are whole grids, so this is usually a bit below SceneGeneratorSettings::triangleCount
+	long long GetTriangleCount() const;
+	double GetGenerateTime() const;
+
+private:
+	static const int TEXTURE_SIZE = 64;
+	static const int CHECKER_SIZE = 8;
+	//Rows of a mesh generated per task
+	static const int GRAIN_SIZE = 64;
+
+	//Distance between instance centers. Meshes span [-1, 1] on x and z
+	static const float INSTANCE_SPACING;
+	//Distance between sphere centers, on average
+	static const float SPHERE_SPACING;
+
+	SceneGeneratorSettings settings;
+
+	std::vector<SceneSphere> spheres;
+	std::vector<Mesh> meshes;
+	std::vector<SceneInstance> instances;
+
+	//Texture i only depends on i, so they are kept between generations and only created when more are needed.
+	//Content created without a path can't be unloaded before the ContentManager is, so recreating them would leak
+	std::vector<Texture2D*> diffuseTextures;
+	Texture2D* normalTexture;
+
+	long long triangleCount;
+	double generateTime;
+
+	void GenerateSpheres();
+	void GenerateInstances();
+	void GenerateMesh(int meshIndex, int columns, int rows, ThreadPool* threadPool);
+	void CreateTextures(int count, ContentManager* contentManager);
+};
+
+#endif // SceneGenerator_h__
@@ -0,0 +1,393 @@
+#include "SceneQuery.h"
+
+#include <DXLib/Logger.h>
+#include <DXLib/ThreadPool.h>
+
+#include <chrono>
+
+SceneHit::SceneHit()
+	: sphereIndex(-1)
+	, triangleIndex(-1)
+	, modelIndex(-1)
+	, distance(-1.0f)
+	, u(0.0f)
+	, v(0.0f)
+	, position(0.0f, 0.0f, 0.0f)
+{}
+
+bool SceneHit::IsHit() const
+{
+	return sphereIndex != -1 || triangleIndex != -1;
+}
+
+SceneQuery::BuildStatistics::BuildStatistics()
+	: buildTime(0.0)
+	, primitiveCount(0)
+	, bvhWidth(2)
+	, nodeCount(0)
+	, depth(0)
+	, sahCost(0.0f)
+	, memoryUsage(0)
+{}
+
+SceneSegment::SceneSegment()
+	: begin(0.0f, 0.0f, 0.0f)
+	, end(0.0f, 0.0f, 0.0f)
+{}
+
+SceneSegment::SceneSegment(const DirectX::XMFLOAT3& begin, const DirectX::XMFLOAT3& end)
+	: begin(begin)
+	, end(end)
+{}
+
+namespace
+{
+	//Returns false for zero length segments, which can't hit anything
+	bool SegmentToRay(const SceneSegment& segment, DirectX::XMFLOAT3& outDirection, float& outLength)
+	{
+		DirectX::XMFLOAT3 difference = RaySub(segment.end, segment.begin);
+
+		outLength = std::sqrt(RayDot(difference, difference));
+		if(outLength <= 0.0f)
+			return false;
+
+		float lengthInv = 1.0f / outLength;
+		outDirection = DirectX::XMFLOAT3(difference.x * lengthInv, difference.y * lengthInv, difference.z * lengthInv);
+
+		return true;
+	}
+}
+
+SceneQuery::SceneQuery()
+	: bvhWidth(2)
+{}
+
+template<typename IntersectFunction>
+bool SceneQuery::Intersect(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float& maxDistance, IntersectFunction intersectPrimitive) const
+{
+	if(!bvh4.IsEmpty())
+		return bvh4.Intersect(rayPosition, rayDirection, maxDistance, intersectPrimitive);
+	else if(!bvh8.IsEmpty())
+		return bvh8.Intersect(rayPosition, rayDirection, maxDistance, intersectPrimitive);
+
+	return bvh.Intersect(rayPosition, rayDirection, maxDistance, intersectPrimitive);
+}
+
+template<typename IntersectFunction>
+bool SceneQuery::IntersectAny(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float maxDistance, IntersectFunction intersectPrimitive) const
+{
+	if(!bvh4.IsEmpty())
+		return bvh4.IntersectAny(rayPosition, rayDirection, maxDistance, intersectPrimitive);
+	else if(!bvh8.IsEmpty())
+		return bvh8.IntersectAny(rayPosition, rayDirection, maxDistance, intersectPrimitive);
+
+	return bvh.IntersectAny(rayPosition, rayDirection, maxDistance, intersectPrimitive);
+}
+
+template<typename SegmentFunction>
+void SceneQuery::ForEachSegment(int segmentCount, ThreadPool* threadPool, SegmentFunction function) const
+{
+	auto range = [&function](int begin, int end)
+	{
+		for(int i = begin; i < end; ++i)
+			function(i);
+	};
+
+	if(threadPool == nullptr)
+		range(0, segmentCount);
+	else
+		threadPool->ParallelFor(segmentCount, BATCH_SIZE, range);
+}
+
+void SceneQuery::Build(const SceneGeometry& geometry, ThreadPool* threadPool)
+{
+	auto buildStart = std::chrono::high_resolution_clock::now();
+
+	//Read straight from the vertex and index arrays the geometry views
+	std::vector<BVH::AABB> primitiveBounds(geometry.spheres.count + geometry.triangles.count);
+
+	auto addBounds = [&](int begin, int end)
+	{
+		for(int i = begin; i < end; ++i)
+		{
+			if(i < geometry.spheres.count)
+			{
+				const DirectX::XMFLOAT4& sphere = geometry.spheres[i];
+
+				primitiveBounds[i] = BVH::AABB(DirectX::XMFLOAT3(sphere.x - sphere.w, sphere.y - sphere.w, sphere.z - sphere.w)
+											   , DirectX::XMFLOAT3(sphere.x + sphere.w, sphere.y + sphere.w, sphere.z + sphere.w));
+			}
+			else
+			{
+				const DirectX::XMINT3& triangle = geometry.triangles[i - geometry.spheres.count];
+
+				BVH::AABB& bounds = primitiveBounds[i];
+				bounds.Grow(geometry.vertices[triangle.x]);
+				bounds.Grow(geometry.vertices[triangle.y]);
+				bounds.Grow(geometry.vertices[triangle.z]);
+			}
+		}
+	};
+
+	if(threadPool == nullptr)
+		addBounds(0, static_cast<int>(primitiveBounds.size()));
+	else
+		threadPool->ParallelFor(static_cast<int>(primitiveBounds.size()), BUILD_BATCH_SIZE, addBounds);
+
+	//Built before locking so queries only wait for the swap
+	BVH newBVH;
+	newBVH.Build(primitiveBounds, threadPool);
+
+	BuildStatistics newBuildStatistics;
+	newBuildStatistics.primitiveCount = static_cast<int>(primitiveBounds.size());
+	newBuildStatistics.bvhWidth = bvhWidth;
+	newBuildStatistics.sahCost = newBVH.GetSAHCost();
+
+	//Collapsing is a single pass over the binary BVH, not worth splitting across the pool
+	WideBVH<4> newBVH4;
+	WideBVH<8> newBVH8;
+
+	if(bvhWidth == 4)
+	{
+		newBVH4.Build(newBVH);
+		//Clear would keep the memory
+		newBVH = BVH();
+
+		newBuildStatistics.nodeCount = newBVH4.GetNodeCount();
+		newBuildStatistics.depth = newBVH4.GetDepth();
+		newBuildStatistics.memoryUsage = newBVH4.GetMemoryUsage();
+	}
+	else if(bvhWidth == 8)
+	{
+		newBVH8.Build(newBVH);
+		newBVH = BVH();
+
+		newBuildStatistics.nodeCount = newBVH8.GetNodeCount();
+		newBuildStatistics.depth = newBVH8.GetDepth();
+		newBuildStatistics.memoryUsage = newBVH8.GetMemoryUsage();
+	}
+	else
+	{
+		newBuildStatistics.nodeCount = newBVH.GetNodeCount();
+		newBuildStatistics.depth = newBVH.GetDepth();
+		newBuildStatistics.memoryUsage = newBVH.GetMemoryUsage();
+	}
+
+	std::chrono::duration<double, std::milli> buildTime = std::chrono::high_resolution_clock::now() - buildStart;
+	newBuildStatistics.buildTime = buildTime.count();
+
+	Logger::LogLine(LOG_TYPE::INFO, "Built scene query BVH" + (bvhWidth == 2 ? "" : std::to_string(bvhWidth)) + " over " + std::to_string(newBuildStatistics.primitiveCount) + " primitives in " + std::to_string(newBuildStatistics.buildTime) + " ms"
+					+ (threadPool == nullptr ? "" : " on " + std::to_string(threadPool->GetThreadCount()) + " threads") + ", "
+					+ std::to_string(newBuildStatistics.nodeCount) + " nodes, depth " + std::to_string(newBuildStatistics.depth) + ", SAH cost " + std::to_string(newBuildStatistics.sahCost)
+					+ ", " + std::to_string(newBuildStatistics.memoryUsage / 1024) + " KiB");
+
+	std::unique_lock<std::shared_timed_mutex> lock(mutex);
+
+	this->geometry = geometry;
+	bvh = std::move(newBVH);
+	bvh4 = std::move(newBVH4);
+	bvh8 = std::move(newBVH8);
+	buildStatistics = newBuildStatistics;
+}
+
+void SceneQuery::Clear()
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mutex);
+
+	geometry = SceneGeometry();
+	bvh.Clear();
+	bvh4.Clear();
+	bvh8.Clear();
+	buildStatistics = BuildStatistics();
+}
+
+void SceneQuery::SetBVHWidth(int width)
+{
+	if(width != 2
+		&& width != 4
+		&& width != 8)
+	{
+		Logger::LogLine(LOG_TYPE::WARNING, "Can't set BVH width to " + std::to_string(width) + ", has to be 2, 4 or 8");
+		return;
+	}
+
+	bvhWidth = width;
+}
+
+int SceneQuery::GetBVHWidth() const
+{
+	return bvhWidth;
+}
+
+bool SceneQuery::ClosestHit(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float maxDistance, SceneHit& outHit) const
+{
+	std::shared_lock<std::shared_timed_mutex> lock(mutex);
+
+	return ClosestHitInternal(rayPosition, rayDirection, maxDistance, outHit);
+}
+
+bool SceneQuery::AnyHit(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float maxDistance) const
+{
+	std::shared_lock<std::shared_timed_mutex> lock(mutex);
+
+	return AnyHitInternal(rayPosition, rayDirection, maxDistance);
+}
+
+bool SceneQuery::IsOccluded(const SceneSegment& segment) const
+{
+	DirectX::XMFLOAT3 direction;
+	float length;
+	if(!SegmentToRay(segment, direction, length))
+		return false;
+
+	return AnyHit(segment.begin, direction, length);
+}
+
+void SceneQuery::IsOccluded(const std::vector<SceneSegment>& segments, std::vector<uint8_t>& outOccluded, ThreadPool* threadPool) const
+{
+	outOccluded.resize(segments.size());
+
+	std::shared_lock<std::shared_timed_mutex> lock(mutex);
+
+	ForEachSegment(static_cast<int>(segments.size()), threadPool, [&](int index)
+	{
+		DirectX::XMFLOAT3 direction;
+		float length;
+
+		outOccluded[index] = SegmentToRay(segments[index], direction, length) && AnyHitInternal(segments[index].begin, direction, length);
+	});
+}
+
+void SceneQuery::ClosestHits(const std::vector<SceneSegment>& segments, std::vector<SceneHit>& outHits, ThreadPool* threadPool) const
+{
+	outHits.resize(segments.size());
+
+	std::shared_lock<std::shared_timed_mutex> lock(mutex);
+
+	ForEachSegment(static_cast<int>(segments.size()), threadPool, [&](int index)
+	{
+		outHits[index] = SceneHit();
+
+		DirectX::XMFLOAT3 direction;
+		float length;
+
+		if(SegmentToRay(segments[index], direction, length))
+			ClosestHitInternal(segments[index].begin, direction, length, outHits[index]);
+	});
+}
+
+bool SceneQuery::IsEmpty() const
+{
+	std::shared_lock<std::shared_timed_mutex> lock(mutex);
+
+	return bvh.IsEmpty() && bvh4.IsEmpty() && bvh8.IsEmpty();
+}
+
+SceneQuery::BuildStatistics SceneQuery::GetBuildStatistics() const
+{
+	std::shared_lock<std::shared_timed_mutex> lock(mutex);
+
+	return buildStatistics;
+}
+
+bool SceneQuery::ClosestHitInternal(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float maxDistance, SceneHit& outHit) const
+{
+	outHit = SceneHit();
+
+	int hitIndex = -1;
+	float hitU = 0.0f;
+	float hitV = 0.0f;
+
+	float hitDistance = maxDistance;
+
+	Intersect(rayPosition, rayDirection, hitDistance, [&](int primitiveIndex, float& maxDistance)
+	{
+		float distance;
+		float u;
+		float v;
+
+		if(!IntersectPrimitive(primitiveIndex, rayPosition, rayDirection, maxDistance, distance, u, v))
+			return false;
+
+		maxDistance = distance;
+
+		hitIndex = primitiveIndex;
+		hitU = u;
+		hitV = v;
+
+		return true;
+	});
+
+	if(hitIndex == -1)
+		return false;
+
+	outHit.distance = hitDistance;
+	outHit.position = DirectX::XMFLOAT3(rayPosition.x + rayDirection.x * hitDistance
+										, rayPosition.y + rayDirection.y * hitDistance
+										, rayPosition.z + rayDirection.z * hitDistance);
+
+	if(hitIndex < geometry.spheres.count)
+		outHit.sphereIndex = hitIndex;
+	else
+	{
+		outHit.triangleIndex = hitIndex - geometry.spheres.count;
+		outHit.u = hitU;
+		outHit.v = hitV;
+
+		//Models are stored in the same order as their triangles, find the first one ending after the triangle
+		int first = 0;
+		int last = geometry.modelEndIndices.count;
+		while(first < last)
+		{
+			int middle = first + (last - first) / 2;
+
+			if(geometry.modelEndIndices[middle] <= outHit.triangleIndex)
+				first = middle + 1;
+			else
+				last = middle;
+		}
+
+		outHit.modelIndex = first == geometry.modelEndIndices.count ? -1 : first;
+	}
+
+	return true;
+}
+
+bool SceneQuery::AnyHitInternal(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float maxDistance) const
+{
+	return IntersectAny(rayPosition, rayDirection, maxDistance, [&](int primitiveIndex, float& maxDistance)
+	{
+		float distance;
+		float u;
+		float v;
+
+		return IntersectPrimitive(primitiveIndex, rayPosition, rayDirection, maxDistance, distance, u, v);
+	});
+}
+
+bool SceneQuery::IntersectPrimitive(int primitiveIndex, const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float maxDistance, float& outDistance, float& outU, float& outV) const
+{
+	if(primitiveIndex < geometry.spheres.count)
+	{
+		const DirectX::XMFLOAT4& sphere = geometry.spheres[primitiveIndex];
+
+		if(!RaySphereIntersection(rayPosition, rayDirection, DirectX::XMFLOAT3(sphere.x, sphere.y, sphere.z), sphere.w, outDistance))
+			return false;
+
+		outU = 0.0f;
+		outV = 0.0f;
+	}
+	else
+	{
+		const DirectX::XMINT3& triangle = geometry.triangles[primitiveIndex - geometry.spheres.count];
+
+		if(!RayTriangleIntersection(rayPosition, rayDirection
+									, geometry.vertices[triangle.x]
+									, geometry.vertices[triangle.y]
+									, geometry.vertices[triangle.z]
+									, outU, outV, outDistance))
+			return false;
+	}
+
+	return outDistance >= 0.0f && outDistance < maxDistance;
+}
@@ -0,0 +1,257 @@
+#ifndef SceneQuery_h__
+#define SceneQuery_h__
+
+#include <DXLib/DXMath.h>
+
+#include <vector>
+#include <shared_mutex>
+#include <cstdint>
+
+#include "BVH.h"
+#include "WideBVH.h"
+
+class ThreadPool;
+
+//Read-only view of one member of every element in an array, e.g. the position of every vertex.
+//Lets SceneQuery read the shader programs' CPU buffers directly whatever their layout is
+template<typename T>
+struct StridedView
+{
+	StridedView()
+		: data(nullptr)
+		, stride(0)
+		, count(0)
+	{}
+	StridedView(const void* data, int stride, int count)
+		: data(static_cast<const char*>(data))
+		, stride(stride)
+		, count(count)
+	{}
+
+	const T& operator[](int index) const
+	{
+		return *reinterpret_cast<const T*>(data + static_cast<size_t>(index) * stride);
+	}
+
+	const char* data;
+	int stride;
+	int count;
+};
+
+//************************************
+// Method:		MakeStridedView
+// Returns:		StridedView<T>
+// Argument:	const std::vector<Element>& elements
+// Argument:	const Member Element::* member - member to view. May be larger than T, e.g. an int4 viewed as an int3
+//************************************
+template<typename T, typename Element, typename Member>
+StridedView<T> MakeStridedView(const std::vector<Element>& elements, const Member Element::* member)
+{
+	static_assert(sizeof(Member) >= sizeof(T), "Member is too small to be viewed as T");
+
+	if(elements.empty())
+		return StridedView<T>();
+
+	return StridedView<T>(&(elements.front().*member), sizeof(Element), static_cast<int>(elements.size()));
+}
+
+//The arrays a SceneQuery reads from. They're owned by someone else, usually a ShaderProgram,
+//and must stay alive and unchanged until SceneQuery::Clear or SceneQuery::Build is called again.
+//Call Clear before changing them, Build only locks while it replaces the hierarchy
+struct SceneGeometry
+{
+	StridedView<DirectX::XMFLOAT4> spheres; //position + radius
+	StridedView<DirectX::XMFLOAT3> vertices;
+	StridedView<DirectX::XMINT3> triangles; //vertex indices
+	//One past the last triangle of each model, in ascending order. May be empty
+	StridedView<int> modelEndIndices;
+};
+
+struct SceneHit
+{
+	SceneHit();
+
+	//-1 if a triangle was hit
+	int sphereIndex;
+	//-1 if a sphere was hit
+	int triangleIndex;
+	//Model which triangleIndex belongs to, -1 if a sphere was hit or the scene has no models
+	int modelIndex;
+
+	float distance;
+	//Barycentric coordinates of the triangle's second and third vertex
+	float u;
+	float v;
+
+	DirectX::XMFLOAT3 position;
+
+	bool IsHit() const;
+};
+
+struct SceneSegment
+{
+	SceneSegment();
+	SceneSegment(const DirectX::XMFLOAT3& begin, const DirectX::XMFLOAT3& end);
+
+	DirectX::XMFLOAT3 begin;
+	DirectX::XMFLOAT3 end;
+};
+
+//Ray queries against the spheres and triangles a ShaderProgram renders, for anything that isn't
+//rendering: picking, line of sight, audio occlusion etc.
+//
+//Every query is const and keeps all of its state on the stack, so any number of threads may
+//query at once. Clear and Build may also be called while other threads are querying, they wait
+//for them to finish. Each query locks once, so when casting many rays prefer the batched versions which
+//only lock once per batch
+class SceneQuery
+{
+public:
+	//What the last Build did
+	struct BuildStatistics
+	{
+		BuildStatistics();
+
+		double buildTime;
+		int primitiveCount;
+		//See SetBVHWidth
+		int bvhWidth;
+		int nodeCount;
+		int depth;
+		//See BVH::GetSAHCost. Of the binary BVH even if it was collapsed into a wide one
+		float sahCost;
+		//Bytes used by nodes and primitive indices
+		size_t memoryUsage;
+	};
+
+	SceneQuery();
+	~SceneQuery() = default;
+
+	SceneQuery(const SceneQuery&) = delete;
+	SceneQuery& operator=(const SceneQuery&) = delete;
+
+	//************************************
+	// Method:		Build
+	// FullName:	SceneQuery::Build
+	// Access:		public
+	// Returns:		void
+	// Qualifier:
+	// Argument:	const SceneGeometry& geometry - isn't copied, see SceneGeometry
+	// Argument:	ThreadPool* threadPool - builds on the pool's workers if given
+	// Description:	Builds a BVH over geometry. Has to be called again whenever the geometry changes
+	//************************************
+	void Build(const SceneGeometry& geometry, ThreadPool* threadPool = nullptr);
+	void Clear();
+
+	//************************************
+	// Method:		SetBVHWidth
+	// FullName:	SceneQuery::SetBVHWidth
+	// Access:		public
+	// Returns:		void
+	// Qualifier:
+	// Argument:	int width - 2 for a binary BVH, 4 or 8 for a WideBVH collapsed from it. Wide BVHs use less than
+	//				half the node memory and take about as long to traverse
+	// Description:	Used from the next Build, call it from the same thread as Build
+	//************************************
+	void SetBVHWidth(int width);
+	int GetBVHWidth() const;
+
+	//************************************
+	// Method:		ClosestHit
+	// FullName:	SceneQuery::ClosestHit
+	// Access:		public
+	// Returns:		bool - true if anything was hit
+	// Qualifier:	const
+	// Argument:	const DirectX::XMFLOAT3& rayPosition
+	// Argument:	const DirectX::XMFLOAT3& rayDirection - normalized
+	// Argument:	float maxDistance - hits at or beyond this distance are ignored
+	// Argument:	SceneHit& outHit - left as a miss if nothing was hit
+	// Description:	Triangles are only hit from the front, spheres only from the outside, same as on the GPU
+	//************************************
+	bool ClosestHit(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float maxDistance, SceneHit& outHit) const;
+	//************************************
+	// Method:		AnyHit
+	// FullName:	SceneQuery::AnyHit
+	// Access:		public
+	// Returns:		bool - true if anything is hit closer than maxDistance
+	// Qualifier:	const
+	// Argument:	const DirectX::XMFLOAT3& rayPosition
+	// Argument:	const DirectX::XMFLOAT3& rayDirection - normalized
+	// Argument:	float maxDistance
+	// Description:	Cheaper than ClosestHit since it stops at the first hit
+	//************************************
+	bool AnyHit(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float maxDistance) const;
+
+	//************************************
+	// Method:		IsOccluded
+	// FullName:	SceneQuery::IsOccluded
+	// Access:		public
+	// Returns:		bool - true if anything is between segment.begin and segment.end
+	// Qualifier:	const
+	// Argument:	const SceneSegment& segment
+	// Description:	Line of sight test. Zero length segments are never occluded
+	//************************************
+	bool IsOccluded(const SceneSegment& segment) const;
+	//************************************
+	// Method:		IsOccluded
+	// FullName:	SceneQuery::IsOccluded
+	// Access:		public
+	// Returns:		void
+	// Qualifier:	const
+	// Argument:	const std::vector<SceneSegment>& segments
+	// Argument:	std::vector<uint8_t>& outOccluded - resized to segments.size(), 1 where the segment is occluded
+	// Argument:	ThreadPool* threadPool - splits the segments across the pool's workers if given
+	// Description:	Tests every segment under a single lock. Runs on the calling thread if it's one of
+	//				threadPool's workers, since waiting for the pool from inside it could deadlock
+	//************************************
+	void IsOccluded(const std::vector<SceneSegment>& segments, std::vector<uint8_t>& outOccluded, ThreadPool* threadPool = nullptr) const;
+	//************************************
+	// Method:		ClosestHits
+	// FullName:	SceneQuery::ClosestHits
+	// Access:		public
+	// Returns:		void
+	// Qualifier:	const
+	// Argument:	const std::vector<SceneSegment>& segments
+	// Argument:	std::vector<SceneHit>& outHits - resized to segments.size(), closest hit between each segment's begin and end
+	// Argument:	ThreadPool* threadPool - same as for IsOccluded
+	// Description:
+	//************************************
+	void ClosestHits(const std::vector<SceneSegment>& segments, std::vector<SceneHit>& outHits, ThreadPool* threadPool = nullptr) const;
+
+	bool IsEmpty() const;
+	BuildStatistics GetBuildStatistics() const;
+
+private:
+	//Segments per task when a batch is split across a ThreadPool
+	static const int BATCH_SIZE = 1024;
+	//Primitives per task when computing bounds for Build
+	static const int BUILD_BATCH_SIZE = 16384;
+
+	//Shared by queries, exclusive while building
+	mutable std::shared_timed_mutex mutex;
+
+	SceneGeometry geometry;
+	//Over every sphere followed by every triangle. Only the one matching bvhWidth at the last Build isn't empty
+	BVH bvh;
+	WideBVH<4> bvh4;
+	WideBVH<8> bvh8;
+	BuildStatistics buildStatistics;
+
+	int bvhWidth;
+
+	//These expect mutex to already be locked
+	bool ClosestHitInternal(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float maxDistance, SceneHit& outHit) const;
+	bool AnyHitInternal(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float maxDistance) const;
+	bool IntersectPrimitive(int primitiveIndex, const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float maxDistance, float& outDistance, float& outU, float& outV) const;
+
+	//Traverse whichever BVH was built, see BVH::Intersect and BVH::IntersectAny
+	template<typename IntersectFunction>
+	bool Intersect(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float& maxDistance, IntersectFunction intersectPrimitive) const;
+	template<typename IntersectFunction>
+	bool IntersectAny(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float maxDistance, IntersectFunction intersectPrimitive) const;
+
+	template<typename SegmentFunction>
+	void ForEachSegment(int segmentCount, ThreadPool* threadPool, SegmentFunction function) const;
+};
+
+#endif // SceneQuery_h__
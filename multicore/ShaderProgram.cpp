@@ -6,6 +6,7 @@
 #include <DXConsole/commandGetterSetter.h>
 
 #include <DXLib/ContentManager.h>
+#include <DXLib/OBJFile.h>
 
 ShaderProgram::ShaderProgram()
 	: device(nullptr)
@@ -47,6 +48,30 @@ bool ShaderProgram::InitBuffers(ID3D11UnorderedAccessView* depthBufferUAV, ID3D1
 	return true;
 }
 
+void ShaderProgram::AddOBJ(const std::string& path, DirectX::XMFLOAT3 position, float scale)
+{
+	OBJFile* objFile = contentManager->Load<OBJFile>(path);
+	if(objFile == nullptr)
+		return;
+
+	sceneBuilder.AddMeshes(objFile->GetMeshes(), position, scale);
+}
+
+void ShaderProgram::AddMesh(const Mesh& mesh, DirectX::XMFLOAT3 position, float scale)
+{
+	sceneBuilder.AddMeshInstance(mesh, position, scale);
+}
+
+void ShaderProgram::AddSphere(DirectX::XMFLOAT4 sphere, DirectX::XMFLOAT4 color)
+{
+	sceneBuilder.AddSphere(sphere, color);
+}
+
+void ShaderProgram::ClearScene()
+{
+	sceneBuilder.Clear();
+}
+
 void ShaderProgram::Update(std::chrono::nanoseconds delta)
 {
 }
@@ -80,6 +105,11 @@ void ShaderProgram::SetCameraPosition(DirectX::XMFLOAT3 cameraPosition)
 	this->cameraPosition = cameraPosition;
 }
 
+void ShaderProgram::SetSceneQueryBVHWidth(int width)
+{
+	sceneQuery.SetBVHWidth(width);
+}
+
 int ShaderProgram::GetRayBounces() const
 {
 	return rayBounces;
@@ -95,6 +125,31 @@ PointLights ShaderProgram::GetPointLights() const
 	return pointLightBufferData;
 }
 
+int ShaderProgram::GetSceneQueryBVHWidth() const
+{
+	return sceneQuery.GetBVHWidth();
+}
+
+const SceneQuery& ShaderProgram::GetSceneQuery() const
+{
+	return sceneQuery;
+}
+
+void ShaderProgram::CalcPickingRay(const DirectX::XMINT2& mousePosition, DirectX::XMFLOAT3& outPosition, DirectX::XMFLOAT3& outDirection) const
+{
+	float ndcX = mousePosition.x / static_cast<float>(backBufferWidth) * 2.0f - 1.0f;
+	float ndcY = 1.0f - mousePosition.y / static_cast<float>(backBufferHeight) * 2.0f;
+
+	auto xmViewProjInverse = DirectX::XMMatrixInverse(nullptr, DirectX::XMLoadFloat4x4(&viewProjMatrix));
+
+	//Reversed depth buffer, the near plane is at 1
+	auto xmOrigin = DirectX::XMVector3TransformCoord(DirectX::XMLoadFloat3(ndcX, ndcY, 1.0f), xmViewProjInverse);
+	auto xmFar = DirectX::XMVector3TransformCoord(DirectX::XMLoadFloat3(ndcX, ndcY, 0.0f), xmViewProjInverse);
+
+	outPosition = DirectX::XMStoreFloat3(xmOrigin);
+	outDirection = DirectX::XMStoreFloat3(DirectX::XMVector3Normalize(xmFar - xmOrigin));
+}
+
 std::string ShaderProgram::CreateUAVSRVCombo(int width, int height, COMUniquePtr<ID3D11UnorderedAccessView>& uav, COMUniquePtr<ID3D11ShaderResourceView>& srv, DXGI_FORMAT format /*= DXGI_FORMAT_R32G32B32A32_FLOAT*/)
 {
 	uav.reset();
@@ -13,6 +13,8 @@
 
 #include "SharedShaderConstants.h"
 #include "Graph.h"
+#include "SceneBuilder.h"
+#include "SceneQuery.h"
 
 #define LogErrorReturnFalse(functionCall, messagePrefix)				\
 {																		\
@@ -65,17 +67,29 @@ public:
 	virtual bool Init(ID3D11Device* device, ID3D11DeviceContext* deviceContext, UINT backBufferWidth, UINT backBufferHeight, Console* console, ContentManager* contentManager);
 	virtual bool InitBuffers(ID3D11UnorderedAccessView* depthBufferUAV, ID3D11UnorderedAccessView* backBufferUAV);
 
-	virtual void AddOBJ(const std::string& path, DirectX::XMFLOAT3 position, float scale) = 0;
-	virtual void AddSphere(DirectX::XMFLOAT4 sphere, DirectX::XMFLOAT4 color) = 0;
+	//The scene is written to the GPU in InitBuffers, so everything has to be added before then
+	void AddOBJ(const std::string& path, DirectX::XMFLOAT3 position, float scale);
+	//mesh is referenced until ClearScene is called
+	void AddMesh(const Mesh& mesh, DirectX::XMFLOAT3 position, float scale);
+	void AddSphere(DirectX::XMFLOAT4 sphere, DirectX::XMFLOAT4 color);
+	//Removes everything that has been added. The GPU buffers are kept until InitBuffers is called again
+	void ClearScene();
 
 	virtual void Update(std::chrono::nanoseconds delta);
 	virtual std::map<std::string, double> Draw() = 0;
 
+	//Bytes of scene data uploaded to the GPU in the last InitBuffers
+	virtual size_t GetSceneMemoryUsage() const = 0;
+
 	std::string ReloadShaders();
 
+	//Calls callback with whatever is under mousePosition, if picking is supported
 	virtual void Pick(const DirectX::XMINT2& mousePosition, std::function<void(const PickedObjectData&)> callback)
+	{}
+	//Picks everything under mousePositions at once, returns an empty vector if picking isn't supported
+	virtual std::vector<PickedObjectData> Pick(const std::vector<DirectX::XMINT2>& mousePositions)
 	{
-		pickingCallback = callback;
+		return std::vector<PickedObjectData>();
 	}
 
 	void SetRayBounces(int bounces);
@@ -83,19 +97,32 @@ public:
 	void SetPointLights(PointLights pointLights);
 	void SetViewProjMatrix(DirectX::XMFLOAT4X4 viewProjMatrix);
 	void SetCameraPosition(DirectX::XMFLOAT3 cameraPosition);
+	//See SceneQuery::SetBVHWidth, used from the next InitBuffers
+	void SetSceneQueryBVHWidth(int width);
 
 	int GetRayBounces() const;
 	LightAttenuation GetLightAttenuationFactors() const;
 	PointLights GetPointLights() const;
+	int GetSceneQueryBVHWidth() const;
+	//Ray queries against the same spheres and triangles this program renders, built in InitBuffers
+	const SceneQuery& GetSceneQuery() const;
 
 protected:
 	std::string CreateUAVSRVCombo(int width, int height, COMUniquePtr<ID3D11UnorderedAccessView>& uav, COMUniquePtr<ID3D11ShaderResourceView>& srv, DXGI_FORMAT format = DXGI_FORMAT_R32G32B32A32_FLOAT);
 	std::string CreateUAV(int width, int height, COMUniquePtr<ID3D11UnorderedAccessView>& uav, DXGI_FORMAT format = DXGI_FORMAT_R32G32B32A32_FLOAT);
 	std::string CreateSRV(int width, int height, COMUniquePtr<ID3D11ShaderResourceView>& srv, DXGI_FORMAT format = DXGI_FORMAT_R32G32B32A32_FLOAT);
 
+	//Calculates the same ray as the primary ray generator does for the pixel at mousePosition,
+	//using the last view projection matrix given to SetViewProjMatrix
+	void CalcPickingRay(const DirectX::XMINT2& mousePosition, DirectX::XMFLOAT3& outPosition, DirectX::XMFLOAT3& outDirection) const;
+
 	DirectX::XMFLOAT4X4 viewProjMatrix;
 	DirectX::XMFLOAT3 cameraPosition;
 
+	//Everything given to AddOBJ and AddSphere. Each program writes it out in its own layout in InitBuffers
+	SceneBuilder sceneBuilder;
+	SceneQuery sceneQuery;
+
 	Console* console;
 	ContentManager* contentManager;
 
@@ -112,8 +139,6 @@ protected:
 	UINT backBufferWidth;
 	UINT backBufferHeight;
 
-	std::function<void(const PickedObjectData&)> pickingCallback;
-
 	const static int MAX_BOUNCES = 20;
 	int rayBounces;
 
@@ -138,7 +163,12 @@ protected:
 
 inline bool operator>>(const LightAttenuation& lhs, Argument& rhs)
 {
-	rhs.values.push_back("[" + std::to_string(lhs.factors[0]) + ", " + std::to_string(lhs.factors[1]) + ", " + std::to_string(lhs.factors[2]) + "]");
+	rhs.values.clear();
+
+	rhs.type = Argument::TYPE::FLOAT;
+
+	for(int i = 0; i < 3; ++i)
+		rhs.values.emplace_back(lhs.factors[i]);
 
 	return true;
 }
@@ -148,25 +178,15 @@ inline bool operator>>(const Argument& lhs, LightAttenuation& rhs)
 	if(lhs.values.size() != 3)
 		return false;
 
-	std::stringstream sstream;
-	sstream << lhs.values[0];
-	sstream >> rhs.factors[0];
-	if(sstream.fail())
-		return false;
-
-	sstream.str(std::string());
-	sstream.clear();
-	sstream << lhs.values[1];
-	sstream >> rhs.factors[1];
-	if(sstream.fail())
-		return false;
+	for(int i = 0; i < 3; ++i)
+	{
+		//Only numbers, same as when the values were extracted through a stringstream
+		if(lhs.values[i].GetType() == Argument::TYPE::STRING
+			|| lhs.values[i].GetType() == Argument::TYPE::NONE)
+			return false;
 
-	sstream.str(std::string());
-	sstream.clear();
-	sstream << lhs.values[2];
-	sstream >> rhs.factors[2];
-	if(sstream.fail())
-		return false;
+		rhs.factors[i] = lhs.values[i].As<float>();
+	}
 
 	return true;
 }
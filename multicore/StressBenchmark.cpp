@@ -0,0 +1,586 @@
+#include "StressBenchmark.h"
+
+#include <DXConsole/console.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <set>
+#include <sstream>
+
+namespace
+{
+	struct Axis
+	{
+		const char* name;
+		int32_t SceneGeneratorSettings::* member;
+	};
+
+	const Axis AXES[] =
+	{
+		{ "spheres", &SceneGeneratorSettings::sphereCount },
+		{ "triangles", &SceneGeneratorSettings::triangleCount },
+		{ "lights", &SceneGeneratorSettings::lightCount },
+		{ "instances", &SceneGeneratorSettings::instanceCount },
+		{ "textures", &SceneGeneratorSettings::textureCount }
+	};
+
+	const int AXIS_COUNT = sizeof(AXES) / sizeof(AXES[0]);
+
+	int FindAxis(const std::string& name)
+	{
+		for(int i = 0; i < AXIS_COUNT; ++i)
+		{
+			if(name == AXES[i].name)
+				return i;
+		}
+
+		return -1;
+	}
+
+	bool ParseCount(const std::string& text, long long& out)
+	{
+		const char* begin = text.c_str();
+		char* end = nullptr;
+
+		out = std::strtoll(begin, &end, 10);
+
+		return !text.empty()
+			&& end == begin + text.size()
+			&& out >= 0
+			&& out <= std::numeric_limits<int32_t>::max();
+	}
+
+	//1536 -> 1.5K
+	std::string FormatCount(double value)
+	{
+		const char* suffixes[] = { "", "K", "M", "G" };
+
+		int suffix = 0;
+		while(std::abs(value) >= 1000.0 && suffix < 3)
+		{
+			value /= 1000.0;
+			++suffix;
+		}
+
+		std::ostringstream stream;
+		stream << std::setprecision(3) << value << suffixes[suffix];
+
+		return stream.str();
+	}
+
+	struct ChartSeries
+	{
+		std::string name;
+		std::vector<std::pair<double, double>> points;
+	};
+
+	//A line chart with a logarithmic x axis, since swept values grow geometrically
+	void WriteChart(std::ostream& out, const std::string& title, const std::string& xLabel, const std::vector<ChartSeries>& series)
+	{
+		const char* colors[] = { "#1f77b4", "#ff7f0e", "#2ca02c", "#d62728", "#9467bd", "#8c564b", "#e377c2", "#7f7f7f" };
+		const int colorCount = sizeof(colors) / sizeof(colors[0]);
+
+		const double width = 480.0;
+		const double height = 300.0;
+		const double left = 60.0;
+		const double right = 20.0;
+		const double top = 30.0;
+		const double bottom = 60.0;
+
+		double minX = std::numeric_limits<double>::max();
+		double maxX = std::numeric_limits<double>::lowest();
+		double maxY = 0.0;
+
+		for(const ChartSeries& line : series)
+		{
+			for(const auto& point : line.points)
+			{
+				minX = std::min(minX, point.first);
+				maxX = std::max(maxX, point.first);
+				maxY = std::max(maxY, point.second);
+			}
+		}
+
+		if(minX > maxX)
+			return;
+
+		double logMinX = std::log10(std::max(minX, 1.0));
+		double logMaxX = std::log10(std::max(maxX, 1.0));
+		if(logMaxX - logMinX < 1e-6)
+			logMaxX = logMinX + 1.0;
+
+		if(maxY <= 0.0)
+			maxY = 1.0;
+
+		auto toX = [&](double value) { return left + (std::log10(std::max(value, 1.0)) - logMinX) / (logMaxX - logMinX) * (width - left - right); };
+		auto toY = [&](double value) { return height - bottom - value / maxY * (height - top - bottom); };
+
+		out << "<svg width=\"" << width << "\" height=\"" << height << "\" font-family=\"sans-serif\" font-size=\"11\">\n";
+		out << "<text x=\"" << width * 0.5 << "\" y=\"18\" text-anchor=\"middle\" font-size=\"13\">" << title << "</text>\n";
+		out << "<text x=\"" << width * 0.5 << "\" y=\"" << height - bottom + 32 << "\" text-anchor=\"middle\">" << xLabel << "</text>\n";
+		out << "<rect x=\"" << left << "\" y=\"" << top << "\" width=\"" << width - left - right << "\" height=\"" << height - top - bottom << "\" fill=\"none\" stroke=\"#888\"/>\n";
+
+		for(int i = 0; i <= 4; ++i)
+		{
+			double value = maxY * i / 4.0;
+			out << "<line x1=\"" << left << "\" x2=\"" << width - right << "\" y1=\"" << toY(value) << "\" y2=\"" << toY(value) << "\" stroke=\"#ddd\"/>";
+			out << "<text x=\"" << left - 4 << "\" y=\"" << toY(value) + 4 << "\" text-anchor=\"end\">" << FormatCount(value) << "</text>\n";
+		}
+
+		for(int power = static_cast<int>(std::ceil(logMinX - 1e-6)); power <= static_cast<int>(std::floor(logMaxX + 1e-6)); ++power)
+		{
+			double x = toX(std::pow(10.0, power));
+			out << "<line x1=\"" << x << "\" x2=\"" << x << "\" y1=\"" << top << "\" y2=\"" << height - bottom << "\" stroke=\"#ddd\"/>";
+			out << "<text x=\"" << x << "\" y=\"" << height - bottom + 14 << "\" text-anchor=\"middle\">" << FormatCount(std::pow(10.0, power)) << "</text>\n";
+		}
+
+		for(int i = 0, end = static_cast<int>(series.size()); i < end; ++i)
+		{
+			const char* color = colors[i % colorCount];
+
+			out << "<polyline fill=\"none\" stroke=\"" << color << "\" stroke-width=\"2\" points=\"";
+			for(const auto& point : series[i].points)
+				out << toX(point.first) << ',' << toY(point.second) << ' ';
+			out << "\"/>\n";
+
+			for(const auto& point : series[i].points)
+				out << "<circle cx=\"" << toX(point.first) << "\" cy=\"" << toY(point.second) << "\" r=\"2.5\" fill=\"" << color << "\"/>";
+
+			out << "<text x=\"" << left + 8 + i * 100 << "\" y=\"" << height - 10 << "\" fill=\"" << color << "\">" << series[i].name << "</text>\n";
+		}
+
+		out << "</svg>\n";
+	}
+}
+
+const std::string StressBenchmark::FRAME_TIMING = "Delta";
+
+StressBenchmark::SceneStatistics::SceneStatistics()
+	: generateTime(0.0)
+	, buildTime(0.0)
+	, memoryUsage(0)
+	, bvhBuildTime(0.0)
+	, bvhNodeCount(0)
+	, bvhSAHCost(0.0f)
+	, bvhMemoryUsage(0)
+	, triangleCount(0)
+	, lightCount(0)
+{}
+
+StressBenchmark::StressBenchmark()
+	: console(nullptr)
+	, maxFrameTime(std::numeric_limits<double>::max())
+	, running(false)
+	, currentRun(0)
+{}
+
+std::string StressBenchmark::Start(const std::string& path, const std::vector<std::string>& backends, LoadFunction loadScene, std::function<void()> finished, Console* console)
+{
+	if(running)
+		return "A stress benchmark is already running, stop it before starting a new one";
+
+	this->console = console;
+	this->loadScene = loadScene;
+	this->finished = finished;
+
+	this->backends = backends;
+	baseSettings = SceneGeneratorSettings();
+	sweeps.clear();
+	maxFrameTime = std::numeric_limits<double>::max();
+
+	std::string errorString = script.Parse(path, "stress benchmark script", std::bind(&StressBenchmark::ParseDirective, this, std::placeholders::_1, std::placeholders::_2, backends));
+	if(!errorString.empty())
+		return errorString;
+
+	if(sweeps.empty())
+		return "\"" + path + "\" doesn't declare any axes to sweep";
+
+	if(this->backends.empty())
+		return "There are no backends to benchmark";
+
+	runs.clear();
+	results.clear();
+
+	for(int sweep = 0, sweepCount = static_cast<int>(sweeps.size()); sweep < sweepCount; ++sweep)
+	{
+		for(int value = 0, valueCount = static_cast<int>(sweeps[sweep].values.size()); value < valueCount; ++value)
+		{
+			for(int backend = 0, backendCount = static_cast<int>(this->backends.size()); backend < backendCount; ++backend)
+				runs.push_back(Run{ sweep, value, backend });
+		}
+	}
+
+	skipped.assign(sweeps.size(), std::vector<bool>(this->backends.size(), false));
+	results.reserve(runs.size());
+
+	currentRun = 0;
+	running = true;
+
+	console->AddText("Starting stress benchmark of " + std::to_string(runs.size()) + " scenes, "
+					 + std::to_string(script.GetWarmupFrames()) + " warmup and " + std::to_string(script.GetMeasureFrames()) + " measured frames each");
+
+	return "";
+}
+
+void StressBenchmark::Stop()
+{
+	if(!running)
+		return;
+
+	//Only keep finished scenes
+	if(!script.IsFirstFrame() && !results.empty())
+		results.pop_back();
+
+	Finish("Stress benchmark stopped");
+}
+
+bool StressBenchmark::IsRunning() const
+{
+	return running;
+}
+
+void StressBenchmark::BeginFrame()
+{
+	if(!running)
+		return;
+
+	if(script.IsFirstFrame())
+		StartRun();
+}
+
+void StressBenchmark::AddTiming(const std::string& name, double milliseconds)
+{
+	if(!running
+		|| results.empty())
+		return;
+
+	script.AddTiming(results.back().timings, name, milliseconds);
+}
+
+void StressBenchmark::EndFrame()
+{
+	if(!running)
+		return;
+
+	if(!script.EndFrame())
+		return;
+
+	const Result& result = results.back();
+
+	auto iter = result.timings.find(FRAME_TIMING);
+	if(iter != result.timings.end()
+		&& iter->second.GetAverage() > maxFrameTime)
+	{
+		skipped[result.run.sweep][result.run.backend] = true;
+
+		console->AddText(backends[result.run.backend] + " is slower than " + std::to_string(maxFrameTime) + " ms per frame, skipping the rest of "
+						 + AXES[sweeps[result.run.sweep].axis].name);
+	}
+
+	++currentRun;
+	if(currentRun >= static_cast<int>(runs.size()))
+		Finish("Stress benchmark finished");
+}
+
+std::string StressBenchmark::ParseDirective(const std::string& directive, const std::string& arguments, const std::vector<std::string>& availableBackends)
+{
+	std::string errorString;
+
+	if(directive == "seed")
+	{
+		long long number = 0;
+
+		if(!ParseCount(arguments, number))
+			errorString = "Expected a positive number after \"seed\"";
+		else
+			baseSettings.seed = static_cast<uint32_t>(number);
+	}
+	else if(directive == "maxFrameTime")
+	{
+		char* end = nullptr;
+		maxFrameTime = std::strtod(arguments.c_str(), &end);
+
+		if(end != arguments.c_str() + arguments.size() || maxFrameTime <= 0.0)
+			errorString = "Expected a positive number of milliseconds after \"maxFrameTime\"";
+	}
+	else if(directive == "backends")
+	{
+		backends.clear();
+
+		std::istringstream stream(arguments);
+		std::string backend;
+		while(std::getline(stream, backend, ','))
+		{
+			backend = BenchmarkScript::TrimTextFrontBack(backend);
+
+			if(std::find(availableBackends.begin(), availableBackends.end(), backend) == availableBackends.end())
+			{
+				errorString = "Unknown backend \"" + backend + "\"";
+				break;
+			}
+
+			backends.push_back(backend);
+		}
+	}
+	else if(directive == "base")
+	{
+		std::istringstream stream(arguments);
+
+		std::string axisName;
+		std::string valueText;
+		std::string rest;
+
+		stream >> axisName >> valueText >> rest;
+
+		int axis = FindAxis(axisName);
+		long long value = 0;
+
+		if(axis == -1)
+			errorString = "Unknown axis \"" + axisName + "\"";
+		else if(!rest.empty() || !ParseCount(valueText, value))
+			errorString = "Expected \"base <axis> <value>\"";
+		else
+			baseSettings.*AXES[axis].member = static_cast<int32_t>(value);
+	}
+	else if(directive == "sweep")
+	{
+		Sweep sweep;
+
+		errorString = ParseSweep(arguments, sweep);
+
+		for(const Sweep& existingSweep : sweeps)
+		{
+			if(errorString.empty() && existingSweep.axis == sweep.axis)
+				errorString = "\"" + std::string(AXES[sweep.axis].name) + "\" is already swept";
+		}
+
+		if(errorString.empty())
+			sweeps.push_back(std::move(sweep));
+	}
+	else
+		errorString = "Unknown directive \"" + directive + "\"";
+
+	return errorString;
+}
+
+std::string StressBenchmark::ParseSweep(const std::string& arguments, Sweep& sweep) const
+{
+	std::istringstream stream(arguments);
+
+	std::string axisName;
+	std::string fromText;
+	std::string toText;
+	std::string factorText;
+	std::string rest;
+
+	stream >> axisName >> fromText >> toText >> factorText >> rest;
+
+	if(factorText.empty() || !rest.empty())
+		return "Expected \"sweep <axis> <from> <to> <factor>\"";
+
+	sweep.axis = FindAxis(axisName);
+	if(sweep.axis == -1)
+		return "Unknown axis \"" + axisName + "\"";
+
+	long long from = 0;
+	long long to = 0;
+	if(!ParseCount(fromText, from) || !ParseCount(toText, to) || from > to)
+		return "Expected from and to to be counts with from <= to";
+
+	char* end = nullptr;
+	double factor = std::strtod(factorText.c_str(), &end);
+	if(end != factorText.c_str() + factorText.size() || factor <= 1.0)
+		return "Expected a factor above 1";
+
+	//Starting at 0 would never grow, so the second value is 1
+	for(double value = static_cast<double>(from); value < static_cast<double>(to); value = std::max(value * factor, 1.0))
+	{
+		int32_t rounded = static_cast<int32_t>(std::llround(value));
+		if(sweep.values.empty() || sweep.values.back() != rounded)
+			sweep.values.push_back(rounded);
+	}
+
+	if(sweep.values.empty() || sweep.values.back() != to)
+		sweep.values.push_back(static_cast<int32_t>(to));
+
+	return "";
+}
+
+void StressBenchmark::StartRun()
+{
+	for(; currentRun < static_cast<int>(runs.size()); ++currentRun)
+	{
+		const Run& run = runs[currentRun];
+
+		Result result;
+		result.run = run;
+		result.settings = GetSettings(run);
+
+		std::string description = backends[run.backend] + ", " + AXES[sweeps[run.sweep].axis].name + " = " + std::to_string(sweeps[run.sweep].values[run.value]);
+
+		if(skipped[run.sweep][run.backend])
+		{
+			result.error = "Skipped";
+			results.push_back(std::move(result));
+			continue;
+		}
+
+		console->AddText("Stress benchmark " + std::to_string(currentRun + 1) + "/" + std::to_string(runs.size()) + ": " + description);
+
+		result.error = loadScene(result.settings, backends[run.backend], result.statistics);
+		results.push_back(std::move(result));
+
+		if(results.back().error.empty())
+			return;
+
+		//A bigger scene isn't going to fit either
+		skipped[run.sweep][run.backend] = true;
+		console->AddText("Couldn't load scene for " + description + ": " + results.back().error);
+	}
+
+	Finish("Stress benchmark finished");
+}
+
+void StressBenchmark::Finish(const std::string& message)
+{
+	running = false;
+	script.Restart();
+
+	std::string chartPath = script.GetOutputPath();
+	if(chartPath.size() >= 4 && chartPath.compare(chartPath.size() - 4, 4, ".csv") == 0)
+		chartPath.erase(chartPath.size() - 4);
+	chartPath += ".html";
+
+	if(WriteResults() && WriteCharts(chartPath))
+		console->AddText(message + ", results written to \"" + script.GetOutputPath() + "\" and \"" + chartPath + "\"");
+	else
+		console->AddText(message + ", but results couldn't be written to \"" + script.GetOutputPath() + "\" and \"" + chartPath + "\"");
+
+	if(finished)
+		finished();
+}
+
+SceneGeneratorSettings StressBenchmark::GetSettings(const Run& run) const
+{
+	SceneGeneratorSettings settings = baseSettings;
+
+	const Sweep& sweep = sweeps[run.sweep];
+	settings.*AXES[sweep.axis].member = sweep.values[run.value];
+
+	return settings;
+}
+
+bool StressBenchmark::WriteResults() const
+{
+	std::ofstream out(script.GetOutputPath(), std::ofstream::trunc);
+	if(!out.is_open())
+		return false;
+
+	std::set<std::string> timingNames = BenchmarkScript::GetTimingNames(results, &Result::timings);
+
+	out << "axis,value,backend,seed";
+	for(int i = 0; i < AXIS_COUNT; ++i)
+		out << ',' << AXES[i].name;
+	out << ",generated triangles,used lights,generate ms,build ms,memory bytes,bvh build ms,bvh nodes,bvh sah cost,bvh bytes,frames,error";
+
+	BenchmarkScript::WriteTimingHeader(out, timingNames);
+	out << '\n';
+
+	for(const Result& result : results)
+	{
+		const Sweep& sweep = sweeps[result.run.sweep];
+
+		out << AXES[sweep.axis].name << ',' << sweep.values[result.run.value] << ',' << BenchmarkScript::CSVField(backends[result.run.backend]) << ',' << result.settings.seed;
+		for(int i = 0; i < AXIS_COUNT; ++i)
+			out << ',' << result.settings.*AXES[i].member;
+
+		out << ',' << result.statistics.triangleCount
+			<< ',' << result.statistics.lightCount
+			<< ',' << result.statistics.generateTime
+			<< ',' << result.statistics.buildTime
+			<< ',' << result.statistics.memoryUsage
+			<< ',' << result.statistics.bvhBuildTime
+			<< ',' << result.statistics.bvhNodeCount
+			<< ',' << result.statistics.bvhSAHCost
+			<< ',' << result.statistics.bvhMemoryUsage
+			<< ',' << (result.error.empty() ? script.GetMeasureFrames() : 0)
+			<< ',' << BenchmarkScript::CSVField(result.error);
+
+		BenchmarkScript::WriteTimings(out, timingNames, result.timings);
+		out << '\n';
+	}
+
+	return static_cast<bool>(out);
+}
+
+bool StressBenchmark::WriteCharts(const std::string& path) const
+{
+	std::ofstream out(path, std::ofstream::trunc);
+	if(!out.is_open())
+		return false;
+
+	std::set<std::string> timingNames = BenchmarkScript::GetTimingNames(results, &Result::timings);
+
+	//Each chart plots one value per measured result, one line per backend
+	typedef std::function<bool(const Result& result, double& outValue)> ChartValue;
+
+	std::vector<std::pair<std::string, ChartValue>> charts;
+	charts.emplace_back("Generate (ms)", [](const Result& result, double& outValue) { outValue = result.statistics.generateTime; return true; });
+	charts.emplace_back("Build (ms)", [](const Result& result, double& outValue) { outValue = result.statistics.buildTime; return true; });
+	charts.emplace_back("Scene memory (MiB)", [](const Result& result, double& outValue) { outValue = result.statistics.memoryUsage / (1024.0 * 1024.0); return true; });
+	charts.emplace_back("BVH build (ms)", [](const Result& result, double& outValue) { outValue = result.statistics.bvhBuildTime; return true; });
+	charts.emplace_back("BVH SAH cost", [](const Result& result, double& outValue) { outValue = result.statistics.bvhSAHCost; return true; });
+	charts.emplace_back("BVH memory (MiB)", [](const Result& result, double& outValue) { outValue = result.statistics.bvhMemoryUsage / (1024.0 * 1024.0); return true; });
+
+	for(const std::string& name : timingNames)
+	{
+		charts.emplace_back(name + " (ms)", [name](const Result& result, double& outValue)
+		{
+			auto iter = result.timings.find(name);
+			if(iter == result.timings.end())
+				return false;
+
+			outValue = iter->second.GetAverage();
+			return true;
+		});
+	}
+
+	out << "<!DOCTYPE html>\n<html>\n<head><meta charset=\"utf-8\"><title>Stress benchmark</title></head>\n<body style=\"font-family: sans-serif\">\n";
+	out << "<p>Seed " << baseSettings.seed << ", " << script.GetMeasureFrames() << " measured frames per scene. Averages are shown, see \"" << script.GetOutputPath() << "\" for min and max</p>\n";
+
+	for(int sweepIndex = 0, sweepCount = static_cast<int>(sweeps.size()); sweepIndex < sweepCount; ++sweepIndex)
+	{
+		const char* axisName = AXES[sweeps[sweepIndex].axis].name;
+
+		out << "<h2>" << axisName << "</h2>\n<div>\n";
+
+		for(const auto& chart : charts)
+		{
+			std::vector<ChartSeries> series(backends.size());
+			for(size_t i = 0; i < backends.size(); ++i)
+				series[i].name = backends[i];
+
+			for(const Result& result : results)
+			{
+				double value = 0.0;
+
+				if(result.run.sweep == sweepIndex
+					&& result.error.empty()
+					&& chart.second(result, value))
+					series[result.run.backend].points.emplace_back(sweeps[sweepIndex].values[result.run.value], value);
+			}
+
+			WriteChart(out, chart.first, axisName, series);
+		}
+
+		out << "</div>\n";
+	}
+
+	out << "</body>\n</html>\n";
+
+	return static_cast<bool>(out);
+}
@@ -0,0 +1,159 @@
+#ifndef StressBenchmark_h__
+#define StressBenchmark_h__
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+#include <DXConsole/benchmarkScript.h>
+
+#include "SceneFile.h"
+
+class Console;
+
+/*Measures how each backend scales with scene size. Every axis of SceneGeneratorSettings is swept on its
+* own while the others are kept at their base value, and every backend renders every generated scene.
+*
+* A benchmark script is a BenchmarkScript, so warmup, measure and output work the same as there.
+* Charts are written next to the output as .html. The other directives are
+*
+* //Seed given to SceneGenerator, default 1
+* seed 1
+* //Backends to run, default every backend
+* backends sbuffer, supersampled
+* //base <axis> <value>, what an axis is kept at while another one is swept. Defaults to SceneGeneratorSettings
+* base triangles 4096
+* //sweep <axis> <from> <to> <factor>, multiplies by factor until to is reached. to is always included
+* sweep spheres 64 1048576 4
+* //A backend skips the rest of an axis once its average frame time is above this many milliseconds
+* maxFrameTime 500
+*
+* Axes are spheres, triangles, lights, instances and textures.
+*
+* Once per frame, call BeginFrame before updating, AddTiming for each timing and EndFrame after drawing.
+* Scenes are loaded through the LoadFunction given to Start in BeginFrame. The results are written as
+* a table with one row per scene and backend, along with an HTML page charting build time, memory
+* and every timing against each swept axis
+*/
+class StressBenchmark
+{
+public:
+	//What it cost to load a generated scene into a backend
+	struct SceneStatistics
+	{
+		SceneStatistics();
+
+		double generateTime;
+		//ShaderProgram::InitBuffers
+		double buildTime;
+		//ShaderProgram::GetSceneMemoryUsage
+		size_t memoryUsage;
+
+		//SceneQuery::BuildStatistics, part of buildTime
+		double bvhBuildTime;
+		int bvhNodeCount;
+		float bvhSAHCost;
+		size_t bvhMemoryUsage;
+
+		//What was actually used, after the generator and backend applied their limits
+		long long triangleCount;
+		int lightCount;
+	};
+
+	//std::string(const SceneGeneratorSettings& settings, const std::string& backend, SceneStatistics& outStatistics).
+	//Returns an empty string if the scene was loaded and backend is the one being drawn, otherwise an error message
+	typedef std::function<std::string(const SceneGeneratorSettings&, const std::string&, SceneStatistics&)> LoadFunction;
+
+	//Timing compared against maxFrameTime
+	static const std::string FRAME_TIMING;
+
+	StressBenchmark();
+	~StressBenchmark() = default;
+
+	//************************************
+	// Method:		Start
+	// FullName:	StressBenchmark::Start
+	// Access:		public
+	// Returns:		std::string - empty if the benchmark was started, otherwise an error message
+	// Qualifier:
+	// Argument:	const std::string& path - benchmark script
+	// Argument:	const std::vector<std::string>& backends - every backend that can be loaded into
+	// Argument:	LoadFunction loadScene
+	// Argument:	std::function<void()> finished - called once the benchmark is done or stopped, e.g. to reload the
+	//				scene that was used before
+	// Argument:	Console* console - progress is written to it
+	//************************************
+	std::string Start(const std::string& path, const std::vector<std::string>& backends, LoadFunction loadScene, std::function<void()> finished, Console* console);
+	//Writes results for every finished scene
+	void Stop();
+
+	bool IsRunning() const;
+
+	//Loads the next scene if the previous one is done
+	void BeginFrame();
+	//Ignored during warmup
+	void AddTiming(const std::string& name, double milliseconds);
+	void EndFrame();
+
+private:
+	struct Sweep
+	{
+		int axis;
+		std::vector<int32_t> values;
+	};
+
+	//One scene rendered by one backend
+	struct Run
+	{
+		int sweep;
+		int value;
+		int backend;
+	};
+
+	struct Result
+	{
+		Run run;
+		SceneGeneratorSettings settings;
+		SceneStatistics statistics;
+
+		//Set if the scene couldn't be loaded or was skipped, there are no timings then
+		std::string error;
+		BenchmarkScript::Timings timings;
+	};
+
+	Console* console;
+	LoadFunction loadScene;
+	std::function<void()> finished;
+
+	std::vector<std::string> backends;
+	SceneGeneratorSettings baseSettings;
+	std::vector<Sweep> sweeps;
+
+	BenchmarkScript script;
+	double maxFrameTime;
+
+	bool running;
+
+	std::vector<Run> runs;
+	std::vector<Result> results;
+	//[sweep][backend], set once a backend fails or gets too slow
+	std::vector<std::vector<bool>> skipped;
+
+	int currentRun;
+
+	//Everything but warmup, measure and output, which are handled by BenchmarkScript
+	std::string ParseDirective(const std::string& directive, const std::string& arguments, const std::vector<std::string>& availableBackends);
+	std::string ParseSweep(const std::string& arguments, Sweep& sweep) const;
+
+	//Loads runs until one succeeds, or finishes if there are none left
+	void StartRun();
+	void Finish(const std::string& message);
+
+	SceneGeneratorSettings GetSettings(const Run& run) const;
+
+	bool WriteResults() const;
+	bool WriteCharts(const std::string& path) const;
+};
+
+#endif // StressBenchmark_h__
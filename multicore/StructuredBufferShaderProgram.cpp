@@ -32,13 +32,25 @@ bool StructuredBufferShaderProgram::InitBuffers(ID3D11UnorderedAccessView* depth
 	if(!ShaderProgram::InitBuffers(depthBufferUAV, backBufferUAV))
 		return false;
 
+	//WriteScene reallocates the arrays sceneQuery reads from, so any running query has to finish first
+	sceneQuery.Clear();
+	WriteScene();
+
 	if(!sphereBufferData.empty())
 		LogErrorReturnFalse(sphereBuffer.Create<StructuredBufferSharedBuffers::Sphere>(device, D3D11_USAGE_DEFAULT, static_cast<D3D11_CPU_ACCESS_FLAG>(0), true, false, static_cast<int>(sphereBufferData.size()), sphereBufferData.empty() ? nullptr : &sphereBufferData[0]), "Couldn't create sphere buffer: ");
+	else
+		sphereBuffer.Release(); //Left over from a previous scene
 
 	LogErrorReturnFalse(triangleVertexBuffer.Create<StructuredBufferSharedBuffers::Vertex>(device, D3D11_USAGE_DEFAULT, static_cast<D3D11_CPU_ACCESS_FLAG>(0), true, false, static_cast<int>(vertexBufferData.size()), vertexBufferData.empty() ? nullptr : &vertexBufferData[0]), "Couldn't create triangle vertex buffer: ");
 	LogErrorReturnFalse(triangleBuffer.Create<StructuredBufferSharedBuffers::Triangle>(device, D3D11_USAGE_DEFAULT, static_cast<D3D11_CPU_ACCESS_FLAG>(0), true, false, static_cast<int>(triangleBufferData.size()), triangleBufferData.empty() ? nullptr : &triangleBufferData[0]), "Couldn't create triangle index buffer: ");
 	LogErrorReturnFalse(viewProjInverseBuffer.Create<DirectX::XMFLOAT4X4>(device, D3D11_BIND_CONSTANT_BUFFER, D3D11_USAGE_DYNAMIC, D3D11_CPU_ACCESS_WRITE), "Couldn't create triangle index buffer: ");
 
+	SceneGeometry sceneGeometry;
+	sceneGeometry.spheres = MakeStridedView<DirectX::XMFLOAT4>(sphereBufferData, &StructuredBufferSharedBuffers::Sphere::position);
+	sceneGeometry.vertices = MakeStridedView<DirectX::XMFLOAT3>(vertexBufferData, &StructuredBufferSharedBuffers::Vertex::position);
+	sceneGeometry.triangles = MakeStridedView<DirectX::XMINT3>(triangleBufferData, &StructuredBufferSharedBuffers::Triangle::indicies);
+	sceneQuery.Build(sceneGeometry, &contentManager->GetThreadPool());
+
 	if(!InitUAVSRV())
 		return false;
 	if(!InitShaders())
@@ -75,6 +87,16 @@ bool StructuredBufferShaderProgram::InitUAVSRV()
 
 bool StructuredBufferShaderProgram::InitShaders()
 {
+	//Only a single texture is supported, the one used by the last model added. A scene with only spheres has no model to take it from
+	const auto& models = sceneBuilder.GetModels();
+	if(models.empty() || models.back().material.diffuseTexture == nullptr)
+	{
+		Logger::LogLine(LOG_TYPE::FATAL, "The scene needs at least one model with a diffuse texture");
+		return false;
+	}
+
+	Texture2D* diffuseTexture = models.back().material.diffuseTexture;
+
 	//////////////////////////////////////////////////
 	//Primary rays
 	//////////////////////////////////////////////////
@@ -110,7 +132,7 @@ bool StructuredBufferShaderProgram::InitShaders()
 	//SRVs
 	traceResourceBindInitial.AddResource(rayPositionSRV[0].get(), 0);
 	traceResourceBindInitial.AddResource(rayDirectionSRV[0].get(), 1);
-	traceResourceBindInitial.AddResource(objFile->GetMeshes().front().material.diffuseTexture->GetTextureResourceView(), 2);
+	traceResourceBindInitial.AddResource(diffuseTexture->GetTextureResourceView(), 2);
 
 	//Samplers
 	traceResourceBindInitial.AddResource(SamplerStates::linearClamp, 0);
@@ -133,7 +155,7 @@ bool StructuredBufferShaderProgram::InitShaders()
 	//SRVs
 	traceResourceBinds0.AddResource(rayPositionSRV[0].get(), 0);
 	traceResourceBinds0.AddResource(rayDirectionSRV[0].get(), 1);
-	traceResourceBinds0.AddResource(objFile->GetMeshes().front().material.diffuseTexture->GetTextureResourceView(), 2);
+	traceResourceBinds0.AddResource(diffuseTexture->GetTextureResourceView(), 2);
 
 	//Samplers
 	traceResourceBinds0.AddResource(SamplerStates::linearClamp, 0);
@@ -154,7 +176,7 @@ bool StructuredBufferShaderProgram::InitShaders()
 	//SRVs
 	traceResourceBinds1.AddResource(rayPositionSRV[1].get(), 0);
 	traceResourceBinds1.AddResource(rayDirectionSRV[1].get(), 1);
-	traceResourceBinds1.AddResource(objFile->GetMeshes().front().material.diffuseTexture->GetTextureResourceView(), 2);
+	traceResourceBinds1.AddResource(diffuseTexture->GetTextureResourceView(), 2);
 
 	//Samplers
 	traceResourceBinds1.AddResource(SamplerStates::linearClamp, 0);
@@ -280,62 +302,41 @@ void StructuredBufferShaderProgram::DrawComposit(int config)
 	compositShader.Unbind(deviceContext);
 }
 
-void StructuredBufferShaderProgram::AddOBJ(const std::string& path, DirectX::XMFLOAT3 position, float scale)
+size_t StructuredBufferShaderProgram::GetSceneMemoryUsage() const
 {
-	objFile = contentManager->Load<OBJFile>(path);
-	if(objFile == nullptr)
-		return;
-
-	Mesh mesh = objFile->GetMeshes().front();
+	return sphereBufferData.size() * sizeof(StructuredBufferSharedBuffers::Sphere)
+		+ vertexBufferData.size() * sizeof(StructuredBufferSharedBuffers::Vertex)
+		+ triangleBufferData.size() * sizeof(StructuredBufferSharedBuffers::Triangle);
+}
 
-	int vertexOffset = 0;
+void StructuredBufferShaderProgram::WriteScene()
+{
+	ThreadPool* threadPool = &contentManager->GetThreadPool();
 
-	for(const auto& triangle : triangleBufferData)
+	const auto& spheres = sceneBuilder.GetSpheres();
+	sphereBufferData.resize(spheres.size());
+	for(int i = 0, end = static_cast<int>(spheres.size()); i < end; ++i)
 	{
-		vertexOffset = std::max(vertexOffset, triangle.indicies.x + 1);
-		vertexOffset = std::max(vertexOffset, triangle.indicies.y + 1);
-		vertexOffset = std::max(vertexOffset, triangle.indicies.z + 1);
+		sphereBufferData[i].position = spheres[i].position;
+		sphereBufferData[i].color = spheres[i].color;
 	}
 
-	for(int i = 0, end = static_cast<int>(mesh.vertices.size()); i < end; ++i)
+	vertexBufferData.resize(sceneBuilder.GetVertexCount());
+	sceneBuilder.WriteVertices(vertexBufferData.data(), [](const OBJVertex& vertex, StructuredBufferSharedBuffers::Vertex& outVertex)
 	{
-		StructuredBufferSharedBuffers::Vertex newVertex;
-
-		newVertex.position.x = mesh.vertices[i].position.x + position.x;
-		newVertex.position.y = mesh.vertices[i].position.y + position.y;
-		newVertex.position.z = mesh.vertices[i].position.z + position.z;
+		outVertex.position = vertex.position;
 
-		int u = mesh.vertices[i].texCoord.x * 0xFFFF;
-		int v = mesh.vertices[i].texCoord.y * 0xFFFF;
+		int u = vertex.texCoord.x * 0xFFFF;
+		int v = vertex.texCoord.y * 0xFFFF;
 
-		newVertex.texCoord = (u << 16) | v;
+		outVertex.texCoord = (u << 16) | v;
+	}, threadPool);
 
-		vertexBufferData.push_back(std::move(newVertex));
-	}
-
-	int triangleOffset = static_cast<int>(triangleBufferData.size());
-
-	for(int i = 0, end = static_cast<int>(mesh.indicies.size()) / 3; i < end; ++i)
+	triangleBufferData.resize(sceneBuilder.GetTriangleCount());
+	sceneBuilder.WriteTriangles(triangleBufferData.data(), [](const DirectX::XMINT3& indicies, int modelIndex, StructuredBufferSharedBuffers::Triangle& outTriangle)
 	{
-		StructuredBufferSharedBuffers::Triangle newTriangle;
-
-		newTriangle.indicies.x = vertexOffset + mesh.indicies[i * 3];
-		newTriangle.indicies.y = vertexOffset + mesh.indicies[i * 3 + 1];
-		newTriangle.indicies.z = vertexOffset + mesh.indicies[i * 3 + 2];
-		newTriangle.indicies.w = 0;
-
-		triangleBufferData.push_back(std::move(newTriangle));
-	}
-}
-
-void StructuredBufferShaderProgram::AddSphere(DirectX::XMFLOAT4 sphere, DirectX::XMFLOAT4 color)
-{
-	StructuredBufferSharedBuffers::Sphere newSphere;
-
-	newSphere.position = sphere;
-	newSphere.color = color;
-
-	sphereBufferData.push_back(std::move(newSphere));
+		outTriangle.indicies = DirectX::XMINT4(indicies.x, indicies.y, indicies.z, 0);
+	}, threadPool);
 }
 
 std::string StructuredBufferShaderProgram::ReloadShadersInternal()
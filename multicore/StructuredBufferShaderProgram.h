@@ -8,8 +8,6 @@
 
 #include "Shaders/StructuredBuffer/StructuredBufferSharedBuffers.h"
 
-class OBJFile;
-
 class StructuredBufferShaderProgram
 	: public ShaderProgram
 {
@@ -23,8 +21,7 @@ public:
 	void Update(std::chrono::nanoseconds delta) override;
 	std::map<std::string, double> Draw() override;
 
-	void AddSphere(DirectX::XMFLOAT4 sphere, DirectX::XMFLOAT4 color) override;
-	void AddOBJ(const std::string& path, DirectX::XMFLOAT3 position, float scale) override;
+	size_t GetSceneMemoryUsage() const override;
 private:
 	int dispatchX;
 	int dispatchY;
@@ -70,11 +67,12 @@ private:
 	ComputeShader intersectionShader;
 	ComputeShader compositShader;
 
-	OBJFile* objFile;
-
 	bool InitUAVSRV() override;
 	bool InitShaders() override;
 
+	//Writes sceneBuilder out into the CPU side of the buffers
+	void WriteScene();
+
 	std::string ReloadShadersInternal() override;
 
 	void DrawRayPrimary();
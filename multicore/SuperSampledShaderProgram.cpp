@@ -7,13 +7,13 @@
 #include <DXConsole/console.h>
 #include <DXConsole/commandGetterSetter.h>
 
+#include <chrono>
+
 SuperSampledShaderProgram::SuperSampledShaderProgram()
 	: primaryRayGenerator("main", "cs_5_0")
 	, traceShader("main", "cs_5_0")
 	, intersectionShader("main", "cs_5_0")
 	, compositShader("main", "cs_5_0")
-	, pickingShader("main", "cs_5_0")
-	, pickPosition(-1, -1)
 {}
 
 bool SuperSampledShaderProgram::Init(ID3D11Device* device, ID3D11DeviceContext* deviceContext, UINT backBufferWidth, UINT backBufferHeight, Console* console, ContentManager* contentManager)
@@ -47,8 +47,14 @@ bool SuperSampledShaderProgram::InitBuffers(ID3D11UnorderedAccessView* depthBuff
 	if(!ShaderProgram::InitBuffers(depthBufferUAV, backBufferUAV))
 		return false;
 
+	//WriteScene reallocates the arrays sceneQuery reads from, so any running query has to finish first
+	sceneQuery.Clear();
+	WriteScene();
+
 	if(!sphereBufferData.empty())
 		LogErrorReturnFalse(sphereBuffer.Create<SuperSampledSharedBuffers::Sphere>(device, D3D11_USAGE_DEFAULT, static_cast<D3D11_CPU_ACCESS_FLAG>(0), true, false, static_cast<int>(sphereBufferData.size()), sphereBufferData.empty() ? nullptr : &sphereBufferData[0]), "Couldn't create sphere buffer: ");
+	else
+		sphereBuffer.Release(); //Left over from a previous scene
 	LogErrorReturnFalse(triangleVertexBuffer.Create<SuperSampledSharedBuffers::Vertex>(device, D3D11_USAGE_DEFAULT, static_cast<D3D11_CPU_ACCESS_FLAG>(0), true, false, static_cast<int>(vertexBufferData.size()), vertexBufferData.empty() ? nullptr : &vertexBufferData[0]), "Couldn't create triangle vertex buffer: ");
 	LogErrorReturnFalse(triangleBuffer.Create<SuperSampledSharedBuffers::Triangle>(device, D3D11_USAGE_DEFAULT, static_cast<D3D11_CPU_ACCESS_FLAG>(0), true, false, static_cast<int>(triangleBufferData.size()), triangleBufferData.empty() ? nullptr : &triangleBufferData[0]), "Couldn't create triangle index buffer: ");
 	LogErrorReturnFalse(modelsBuffer.Create<SuperSampledSharedBuffers::Model>(device, D3D11_USAGE_DEFAULT, static_cast<D3D11_CPU_ACCESS_FLAG>(0), true, false, static_cast<int>(modelsBufferData.size()), modelsBufferData.empty() ? nullptr : &modelsBufferData[0]), "Couldn't create model buffer: ");
@@ -56,11 +62,12 @@ bool SuperSampledShaderProgram::InitBuffers(ID3D11UnorderedAccessView* depthBuff
 	LogErrorReturnFalse(viewProjInverseBuffer.Create<DirectX::XMFLOAT4X4>(device, D3D11_BIND_CONSTANT_BUFFER, D3D11_USAGE_DYNAMIC, D3D11_CPU_ACCESS_WRITE), "Couldn't create view proj inverse buffer: ");
 	LogErrorReturnFalse(superSampleBuffer.Create<int>(device, D3D11_BIND_CONSTANT_BUFFER, D3D11_USAGE_DYNAMIC, D3D11_CPU_ACCESS_WRITE, &superSampleCount), "Couldn't create view proj inverse buffer: ");
 
-	LogErrorReturnFalse(pickingMousePositionBuffer.Create<DirectX::XMINT2>(device, D3D11_BIND_CONSTANT_BUFFER, D3D11_USAGE_DYNAMIC, D3D11_CPU_ACCESS_WRITE), "Couldn't create view proj inverse buffer: "); //TODO D3D11_USAGE_STATIC ???
-	
-	if(!sphereBufferData.empty()
-		|| !triangleBufferData.empty())
-		LogErrorReturnFalse(pickingHitDataBuffer.Create<SuperSampledSharedBuffers::HitData>(device, D3D11_USAGE_DEFAULT, D3D11_CPU_ACCESS_READ, true, true, static_cast<int>(sphereBufferData.size() + triangleBufferData.size())), "Couldn't create picking hit data buffer: ");
+	SceneGeometry sceneGeometry;
+	sceneGeometry.spheres = MakeStridedView<DirectX::XMFLOAT4>(sphereBufferData, &SuperSampledSharedBuffers::Sphere::position);
+	sceneGeometry.vertices = MakeStridedView<DirectX::XMFLOAT3>(vertexBufferData, &SuperSampledSharedBuffers::Vertex::position);
+	sceneGeometry.triangles = MakeStridedView<DirectX::XMINT3>(triangleBufferData, &SuperSampledSharedBuffers::Triangle::indicies);
+	sceneGeometry.modelEndIndices = MakeStridedView<int>(modelsBufferData, &SuperSampledSharedBuffers::Model::endIndex);
+	sceneQuery.Build(sceneGeometry, &contentManager->GetThreadPool());
 
 	if(!InitUAVSRV())
 		return false;
@@ -272,22 +279,6 @@ bool SuperSampledShaderProgram::InitShaders()
 
 	LogErrorReturnFalse(compositShader.CreateFromFile(shaderPath + "Composit.hlsl", device, compositResourceBinds0, compositResourceBinds1), "");
 
-	//////////////////////////////////////////////////
-	//Picking
-	//////////////////////////////////////////////////
-	ShaderResourceBinds pickingIntersectionBinds;
-	pickingIntersectionBinds.AddResource(pickingMousePositionBuffer, 0);
-	pickingIntersectionBinds.AddResource(pickingHitDataBuffer.GetUAV(), 0);
-	pickingIntersectionBinds.AddResource(rayPositionSRV[0].get(), 0);
-	pickingIntersectionBinds.AddResource(rayDirectionSRV[0].get(), 1);
-
-	pickingIntersectionBinds.AddResource(sphereBuffer.GetSRV(), SuperSampledSharedBuffers::SPHERE_BUFFER_REGISTRY_INDEX);
-	pickingIntersectionBinds.AddResource(triangleVertexBuffer.GetSRV(), SuperSampledSharedBuffers::VERTEX_BUFFER_REGISTRY_INDEX);
-	pickingIntersectionBinds.AddResource(triangleBuffer.GetSRV(), SuperSampledSharedBuffers::TRIANGLE_BUFFER_REGISTRY_INDEX);
-	pickingIntersectionBinds.AddResource(modelsBuffer.GetSRV(), SuperSampledSharedBuffers::MODEL_BUFFER_REGISTRY_INDEX);
-
-	LogErrorReturnFalse(pickingShader.CreateFromFile(shaderPath + "PickingIntersection.hlsl", device, pickingIntersectionBinds), "");
-
 	return true;
 }
 
@@ -311,21 +302,6 @@ std::map<std::string, double> SuperSampledShaderProgram::Draw()
 	DrawRayPrimary();
 	d3d11Timer.Stop("Primary");
 
-	//Do picking here "for free"
-	if(pickPosition.x != -1
-		&& pickingCallback != nullptr)
-	{
-		pickPosition.x *= superSampleCount;
-		pickPosition.y *= superSampleCount;
-
-		pickingMousePositionBuffer.Update(deviceContext, &pickPosition);
-		pickPosition = DirectX::XMINT2(-1, -1);
-
-		DrawPick();
-
-		pickPosition.x = -1;
-	}
-
 	DrawRayIntersection(0);
 	d3d11Timer.Stop("Intersect0");
 	DrawRayShading(0);
@@ -373,163 +349,143 @@ void SuperSampledShaderProgram::DrawComposit(int config)
 	compositShader.Unbind(deviceContext);
 }
 
-void SuperSampledShaderProgram::DrawPick()
+void SuperSampledShaderProgram::Pick(const DirectX::XMINT2& mousePosition, std::function<void(const PickedObjectData&)> callback)
 {
-	pickingShader.Bind(deviceContext);
-	deviceContext->Dispatch(static_cast<int>(std::ceil((sphereBufferData.size() + triangleBufferData.size()) / 32.0f)), 1, 1);
-	pickingShader.Unbind(deviceContext);
-
-	std::vector<SuperSampledSharedBuffers::HitData> hitData;
-	hitData.resize(sphereBufferData.size() + triangleBufferData.size());
-
-	D3D11_MAPPED_SUBRESOURCE mappedBuffer;
-	deviceContext->Map(pickingHitDataBuffer.GetBuffer(), 0, D3D11_MAP_READ, 0, &mappedBuffer);
-	memcpy(&hitData[0], mappedBuffer.pData, sizeof(SuperSampledSharedBuffers::HitData) * (sphereBufferData.size() + triangleBufferData.size()));
-	deviceContext->Unmap(pickingHitDataBuffer.GetBuffer(), 0);
+	callback(Pick(std::vector<DirectX::XMINT2>(1, mousePosition)).front());
+}
 
-	float nearest = std::numeric_limits<float>::max();
-	int nearestIndex = -1;
+std::vector<PickedObjectData> SuperSampledShaderProgram::Pick(const std::vector<DirectX::XMINT2>& mousePositions)
+{
+	std::vector<PickedObjectData> pickedObjects;
+	pickedObjects.reserve(mousePositions.size());
 
-	for(int i = 0, end = static_cast<int>(hitData.size()); i < end; ++i)
+	for(const DirectX::XMINT2& mousePosition : mousePositions)
 	{
-		if(hitData[i].depth >= 0.0f
-			&& hitData[i].depth < nearest)
-		{
-			nearest = hitData[i].depth;
-			nearestIndex = i;
-		}
+		DirectX::XMFLOAT3 rayPosition;
+		DirectX::XMFLOAT3 rayDirection;
+		CalcPickingRay(mousePosition, rayPosition, rayDirection);
+
+		pickedObjects.push_back(PickRay(rayPosition, rayDirection));
 	}
 
+	return pickedObjects;
+}
+
+PickedObjectData SuperSampledShaderProgram::PickRay(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection) const
+{
 	PickedObjectData data;
-	
-	if(nearestIndex == -1)
+
+	SceneHit hit;
+	if(!sceneQuery.ClosestHit(rayPosition, rayDirection, std::numeric_limits<float>::max(), hit))
 	{
 		data.modelIndex = -1;
 		data.triangleIndex = -1;
 		data.position = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
 		data.color = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
 	}
+	else if(hit.sphereIndex != -1)
+	{
+		data.modelIndex = hit.sphereIndex;
+		data.triangleIndex = -1;
+		data.position = DirectX::XMLoadFloat3(sphereBufferData[hit.sphereIndex].position);
+		data.color = DirectX::XMLoadFloat3(sphereBufferData[hit.sphereIndex].color);
+	}
 	else
 	{
-		data.modelIndex = hitData[nearestIndex].modelIndex;
-		data.triangleIndex = hitData[nearestIndex].triangleIndex;
-
-		if(data.triangleIndex == -1)
-		{
-			data.position = DirectX::XMLoadFloat3(sphereBufferData[nearestIndex].position);
-			data.color = DirectX::XMLoadFloat3(sphereBufferData[nearestIndex].color);
-		}
-		else
-		{
-			data.position = DirectX::XMFLOAT3(-1.0f, -1.0f, -1.0f);
-			data.color = DirectX::XMFLOAT3(-1.0f, -1.0f, -1.0f);
-		}
+		data.modelIndex = hit.modelIndex;
+		data.triangleIndex = hit.triangleIndex;
+		data.position = hit.position;
+		data.color = DirectX::XMFLOAT3(-1.0f, -1.0f, -1.0f);
 	}
 
-	pickingCallback(data);
+	return data;
 }
 
-void SuperSampledShaderProgram::Pick(const DirectX::XMINT2& mousePosition, std::function<void(const PickedObjectData&)> callback)
+size_t SuperSampledShaderProgram::GetSceneMemoryUsage() const
 {
-	if(pickingHitDataBuffer.GetUAV() == nullptr)
-		return;
-
-	ShaderProgram::Pick(mousePosition, callback);
-
-	pickPosition = mousePosition;
+	return sphereBufferData.size() * sizeof(SuperSampledSharedBuffers::Sphere)
+		+ vertexBufferData.size() * sizeof(SuperSampledSharedBuffers::Vertex)
+		+ triangleBufferData.size() * sizeof(SuperSampledSharedBuffers::Triangle)
+		+ modelsBufferData.size() * sizeof(SuperSampledSharedBuffers::Model);
 }
 
-void SuperSampledShaderProgram::AddOBJ(const std::string& path, DirectX::XMFLOAT3 position, float scale)
+void SuperSampledShaderProgram::WriteScene()
 {
-	objFile = contentManager->Load<OBJFile>(path);
-	if(objFile == nullptr)
-		return;
-
-	DirectX::XMFLOAT3 aabbMin(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
-	DirectX::XMFLOAT3 aabbMax(std::numeric_limits<float>::min(), std::numeric_limits<float>::min(), std::numeric_limits<float>::min());
-
-	auto xmAABBMin = DirectX::XMLoadFloat3(&aabbMin);
-	auto xmAABBMax = DirectX::XMLoadFloat3(&aabbMax);
+	ThreadPool* threadPool = &contentManager->GetThreadPool();
 
-	int vertexOffset = 0;
-
-	for(const auto& triangle : triangleBufferData)
+	const auto& spheres = sceneBuilder.GetSpheres();
+	sphereBufferData.resize(spheres.size());
+	for(int i = 0, end = static_cast<int>(spheres.size()); i < end; ++i)
 	{
-		vertexOffset = std::max(vertexOffset, triangle.indicies.x + 1);
-		vertexOffset = std::max(vertexOffset, triangle.indicies.y + 1);
-		vertexOffset = std::max(vertexOffset, triangle.indicies.z + 1);
+		sphereBufferData[i].position = spheres[i].position;
+		sphereBufferData[i].color = spheres[i].color;
 	}
 
-	for(const auto& mesh : objFile->GetMeshes())
+	vertexBufferData.resize(sceneBuilder.GetVertexCount());
+	sceneBuilder.WriteVertices(vertexBufferData.data(), [](const OBJVertex& vertex, SuperSampledSharedBuffers::Vertex& outVertex)
 	{
-		for(int i = 0, end = static_cast<int>(mesh.vertices.size()); i < end; ++i)
-		{
-			SuperSampledSharedBuffers::Vertex newVertex;
+		outVertex.position = vertex.position;
 
-			newVertex.position.x = (mesh.vertices[i].position.x * scale) + position.x;
-			newVertex.position.y = (mesh.vertices[i].position.y * scale) + position.y;
-			newVertex.position.z = (mesh.vertices[i].position.z * scale) + position.z;
+		int u = vertex.texCoord.x * 0xFFFF;
+		int v = vertex.texCoord.y * 0xFFFF;
 
-			int u = mesh.vertices[i].texCoord.x * 0xFFFF;
-			int v = mesh.vertices[i].texCoord.y * 0xFFFF;
+		outVertex.texCoord = (u << 16) | v;
 
-			newVertex.texCoord = (u << 16) | v;
+		outVertex.tangent = vertex.tangent;
+		outVertex.normal = vertex.normal;
+	}, threadPool);
 
-			newVertex.tangent = mesh.vertices[i].tangent;
-			newVertex.normal = mesh.vertices[i].normal;
+	const auto& models = sceneBuilder.GetModels();
 
-			auto xmNewVertexPosition = DirectX::XMLoadFloat3(&newVertex.position);
-			xmAABBMin = DirectX::XMVectorMin(xmNewVertexPosition, xmAABBMin);
-			xmAABBMax = DirectX::XMVectorMax(xmNewVertexPosition, xmAABBMax);
+	//Texture IDs are handed out in the order the models were added
+	std::vector<int> modelTextureIDs;
+	modelTextureIDs.reserve(models.size());
 
-			vertexBufferData.push_back(std::move(newVertex));
-		}
+	textureSets.clear();
+	bool warnedAboutTextures = false;
 
-		int triangleCount = static_cast<int>(triangleBufferData.size());
+	modelsBufferData.resize(models.size());
+	for(int i = 0, end = static_cast<int>(models.size()); i < end; ++i)
+	{
+		TextureSet textureSet;
+		textureSet.diffuse = models[i].material.diffuseTexture;
+		textureSet.normal = models[i].material.normalTexture;
 
-		for(int i = 0, end = static_cast<int>(mesh.indicies.size()) / 3; i < end; ++i)
+		if(textureSets.find(textureSet) != textureSets.end())
 		{
-			SuperSampledSharedBuffers::Triangle newTriangle;
-
-			newTriangle.indicies.x = vertexOffset + mesh.indicies[i * 3];
-			newTriangle.indicies.y = vertexOffset + mesh.indicies[i * 3 + 1];
-			newTriangle.indicies.z = vertexOffset + mesh.indicies[i * 3 + 2];
-
-			TextureSet textureSet;
-			textureSet.diffuse = mesh.material.diffuseTexture;
-			textureSet.normal = mesh.material.normalTexture;
-
-			if(textureSets.find(textureSet) != textureSets.end())
+			modelTextureIDs.push_back(textureSets[textureSet]);
+		}
+		else
+		{
+			if(textureSets.size() == MAX_TEXTURES)
 			{
-				newTriangle.textureID = textureSets[textureSet];
+				//Once per scene rather than once per model, generated scenes can have thousands of them
+				if(!warnedAboutTextures)
+					Logger::LogLine(LOG_TYPE::WARNING, "Tried using more textures than " + std::to_string(MAX_TEXTURES) + " (MAX_TEXTURES). Will default to first used texture");
+
+				warnedAboutTextures = true;
+				modelTextureIDs.push_back(textureSets.begin()->second);
 			}
 			else
 			{
-				if(textureSets.size() == MAX_TEXTURES)
-				{
-					Logger::LogLine(LOG_TYPE::WARNING, "Tried using more textures than " + std::to_string(MAX_TEXTURES) + " (MAX_TEXTURES). Will default to first used texture");
-					newTriangle.textureID = textureSets.begin()->second;
-				}
-				else
-				{
-					textureSets[textureSet] = textureSets.size();
-
-					newTriangle.textureID = textureSets[textureSet];
-				}
-			}
+				textureSets[textureSet] = textureSets.size();
 
-			triangleBufferData.push_back(std::move(newTriangle));
+				modelTextureIDs.push_back(textureSets[textureSet]);
+			}
 		}
 
-		SuperSampledSharedBuffers::Model newModel;
-		DirectX::XMStoreFloat3(&newModel.aabb.min, xmAABBMin);
-		DirectX::XMStoreFloat3(&newModel.aabb.max, xmAABBMax);
-
-		newModel.beginIndex = triangleCount;
-		newModel.endIndex = static_cast<int>(triangleBufferData.size());
-
-		modelsBufferData.push_back(std::move(newModel));
+		modelsBufferData[i].aabb.min = models[i].aabbMin;
+		modelsBufferData[i].aabb.max = models[i].aabbMax;
+		modelsBufferData[i].beginIndex = models[i].beginIndex;
+		modelsBufferData[i].endIndex = models[i].endIndex;
 	}
+
+	triangleBufferData.resize(sceneBuilder.GetTriangleCount());
+	sceneBuilder.WriteTriangles(triangleBufferData.data(), [&modelTextureIDs](const DirectX::XMINT3& indicies, int modelIndex, SuperSampledSharedBuffers::Triangle& outTriangle)
+	{
+		outTriangle.indicies = indicies;
+		outTriangle.textureID = modelTextureIDs[modelIndex];
+	}, threadPool);
 }
 
 void SuperSampledShaderProgram::SetSuperSampleCount(UINT count)
@@ -553,16 +509,6 @@ UINT SuperSampledShaderProgram::GetSuperSampleCount() const
 	return superSampleCount;
 }
 
-void SuperSampledShaderProgram::AddSphere(DirectX::XMFLOAT4 sphere, DirectX::XMFLOAT4 color)
-{
-	SuperSampledSharedBuffers::Sphere newSphere;
-
-	newSphere.position = sphere;
-	newSphere.color = color;
-
-	sphereBufferData.push_back(std::move(newSphere));
-}
-
 std::string SuperSampledShaderProgram::ReloadShadersInternal()
 {
 	throw std::logic_error("The method or operation is not implemented.");
@@ -9,8 +9,6 @@
 #include "Shaders/SuperSampled/SuperSampledSharedBuffers.h"
 #include "Shaders/Picking/PickingSharedBuffers.h"
 
-class OBJFile;
-
 namespace
 {
 	struct TextureSet
@@ -44,10 +42,10 @@ public:
 	void Update(std::chrono::nanoseconds delta) override;
 	std::map<std::string, double> Draw() override;
 
-	void AddSphere(DirectX::XMFLOAT4 sphere, DirectX::XMFLOAT4 color) override;
-	void AddOBJ(const std::string& path, DirectX::XMFLOAT3 position, float scale) override;
+	size_t GetSceneMemoryUsage() const override;
 
 	void Pick(const DirectX::XMINT2& mousePosition, std::function<void(const PickedObjectData&)> callback) override;
+	std::vector<PickedObjectData> Pick(const std::vector<DirectX::XMINT2>& mousePositions) override;
 
 	void SetSuperSampleCount(UINT count);
 	UINT GetSuperSampleCount() const;
@@ -108,30 +106,23 @@ private:
 
 	DXConstantBuffer superSampleBuffer;
 
-	OBJFile* objFile;
-
-	//////////////////////////////////////////////////
-	//Picking
-	//////////////////////////////////////////////////
-	ComputeShader pickingShader;
-
-	DXConstantBuffer pickingMousePositionBuffer;
-	DXStructuredBuffer pickingHitDataBuffer;
-
-	DirectX::XMINT2 pickPosition;
-
 	std::map<TextureSet, int> textureSets;
 
 	bool InitUAVSRV() override;
 	bool InitShaders() override;
 
+	//Writes sceneBuilder out into the CPU side of the buffers
+	void WriteScene();
+
 	std::string ReloadShadersInternal() override;
 
 	void DrawRayPrimary();
 	void DrawRayIntersection(int config);
 	void DrawRayShading(int config);
 	void DrawComposit(int config);
-	void DrawPick();
+
+	//Picking is done on the CPU through sceneQuery rather than on the GPU, since reading back from the GPU stalls the pipeline
+	PickedObjectData PickRay(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection) const;
 };
 
 #endif //SuperSampledhaderProgram_h__
\ No newline at end of file
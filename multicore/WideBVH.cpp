@@ -0,0 +1,291 @@
+#include "WideBVH.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	const int QUANTIZED_MAX = 255;
+
+	float GetAxis(const DirectX::XMFLOAT3& vector, int axis)
+	{
+		return axis == 0 ? vector.x : (axis == 1 ? vector.y : vector.z);
+	}
+
+	float GetHalfArea(const BVH::AABB& aabb)
+	{
+		DirectX::XMFLOAT3 extent = RaySub(aabb.max, aabb.min);
+
+		return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+	}
+
+	//Same as the traversal, quantized * scale is exact so it doesn't matter whether it's fused with the add
+	float Dequantize(float origin, float scale, int quantized)
+	{
+		return origin + static_cast<float>(quantized) * scale;
+	}
+
+	//Largest value that dequantizes to value or less. value is never below origin
+	uint8_t QuantizeMin(float value, float origin, float scale)
+	{
+		int quantized = static_cast<int>(std::min(std::floor((value - origin) / scale), static_cast<float>(QUANTIZED_MAX)));
+		while(quantized > 0 && Dequantize(origin, scale, quantized) > value)
+			--quantized;
+
+		return static_cast<uint8_t>(std::max(quantized, 0));
+	}
+
+	//Smallest value that dequantizes to value or more, returns false if scale is too small for there to be one
+	bool QuantizeMax(float value, float origin, float scale, uint8_t& outQuantized)
+	{
+		float rounded = std::ceil((value - origin) / scale);
+		if(!(rounded <= static_cast<float>(QUANTIZED_MAX)))
+			return false;
+
+		int quantized = std::max(static_cast<int>(rounded), 0);
+		while(Dequantize(origin, scale, quantized) < value)
+		{
+			if(quantized == QUANTIZED_MAX)
+				return false;
+
+			++quantized;
+		}
+
+		outQuantized = static_cast<uint8_t>(quantized);
+
+		return true;
+	}
+}
+
+template<int WIDTH>
+WideBVH<WIDTH>::WideBVH()
+	: depth(0)
+{}
+
+template<int WIDTH>
+void WideBVH<WIDTH>::Build(const BVH& bvh)
+{
+	Clear();
+
+	if(bvh.IsEmpty())
+		return;
+
+	BuildChild root = GetBuildChild(bvh, 0);
+	bounds = root.bounds;
+
+	primitiveIndices.reserve(bvh.GetPrimitiveIndices().size());
+
+	nodes.emplace_back();
+	BuildNode(bvh, 0, root, 1);
+
+	nodes.shrink_to_fit();
+}
+
+template<int WIDTH>
+void WideBVH<WIDTH>::Clear()
+{
+	nodes.clear();
+	primitiveIndices.clear();
+	bounds = BVH::AABB();
+	depth = 0;
+}
+
+template<int WIDTH>
+bool WideBVH<WIDTH>::IsEmpty() const
+{
+	return nodes.empty();
+}
+
+template<int WIDTH>
+int WideBVH<WIDTH>::GetNodeCount() const
+{
+	return static_cast<int>(nodes.size());
+}
+
+template<int WIDTH>
+int WideBVH<WIDTH>::GetDepth() const
+{
+	return depth;
+}
+
+template<int WIDTH>
+size_t WideBVH<WIDTH>::GetMemoryUsage() const
+{
+	return nodes.size() * sizeof(Node) + primitiveIndices.size() * sizeof(int);
+}
+
+template<int WIDTH>
+void WideBVH<WIDTH>::BuildNode(const BVH& bvh, int nodeIndex, const BuildChild& parent, int currentDepth)
+{
+	depth = std::max(depth, currentDepth);
+
+	BuildChild children[WIDTH];
+	int childCount = GetChildren(bvh, parent, children);
+
+	const std::vector<int>& binaryPrimitiveIndices = bvh.GetPrimitiveIndices();
+
+	//Nodes are resized below, so node can't be used after that
+	Node& node = nodes[nodeIndex];
+	Quantize(children, childCount, node);
+
+	node.firstChild = static_cast<uint32_t>(nodes.size());
+	node.firstPrimitive = static_cast<uint32_t>(primitiveIndices.size());
+
+	int interiorCount = 0;
+	for(int i = 0; i < WIDTH; ++i)
+	{
+		if(i >= childCount)
+			node.meta[i] = EMPTY_CHILD;
+		else if(children[i].binaryNode == -1 && children[i].primitiveCount <= MAX_LEAF_SIZE)
+		{
+			node.meta[i] = static_cast<uint8_t>(children[i].primitiveCount);
+
+			auto begin = binaryPrimitiveIndices.begin() + children[i].firstPrimitive;
+			primitiveIndices.insert(primitiveIndices.end(), begin, begin + children[i].primitiveCount);
+		}
+		else
+		{
+			node.meta[i] = INTERIOR_CHILD;
+			++interiorCount;
+		}
+	}
+
+	int firstChild = static_cast<int>(node.firstChild);
+	nodes.resize(nodes.size() + interiorCount);
+
+	for(int i = 0; i < childCount; ++i)
+	{
+		if(nodes[nodeIndex].meta[i] == INTERIOR_CHILD)
+			BuildNode(bvh, firstChild++, children[i], currentDepth + 1);
+	}
+}
+
+template<int WIDTH>
+typename WideBVH<WIDTH>::BuildChild WideBVH<WIDTH>::GetBuildChild(const BVH& bvh, int binaryNode)
+{
+	const BVH::Node& node = bvh.GetNodes()[binaryNode];
+
+	BuildChild child;
+	child.bounds = BVH::AABB(node.min, node.max);
+
+	if(node.primitiveCount > 0)
+	{
+		child.binaryNode = -1;
+		child.firstPrimitive = node.firstIndex;
+		child.primitiveCount = node.primitiveCount;
+	}
+	else
+	{
+		child.binaryNode = binaryNode;
+		child.firstPrimitive = 0;
+		child.primitiveCount = 0;
+	}
+
+	return child;
+}
+
+template<int WIDTH>
+int WideBVH<WIDTH>::GetChildren(const BVH& bvh, const BuildChild& parent, BuildChild (&outChildren)[WIDTH])
+{
+	if(parent.binaryNode == -1)
+	{
+		//Only the root can be a single leaf
+		if(parent.primitiveCount <= MAX_LEAF_SIZE)
+		{
+			outChildren[0] = parent;
+			return 1;
+		}
+
+		//Primitives the binary BVH couldn't split, e.g. with the same center. Split them evenly, each part is
+		//split again if it's still too large. The parts overlap completely, so they all get the parent's bounds
+		int partCount = std::min(WIDTH, (parent.primitiveCount + MAX_LEAF_SIZE - 1) / MAX_LEAF_SIZE);
+		for(int i = 0; i < partCount; ++i)
+		{
+			int begin = static_cast<int>(static_cast<long long>(parent.primitiveCount) * i / partCount);
+			int end = static_cast<int>(static_cast<long long>(parent.primitiveCount) * (i + 1) / partCount);
+
+			outChildren[i] = parent;
+			outChildren[i].firstPrimitive = parent.firstPrimitive + begin;
+			outChildren[i].primitiveCount = end - begin;
+		}
+
+		return partCount;
+	}
+
+	const BVH::Node& node = bvh.GetNodes()[parent.binaryNode];
+
+	outChildren[0] = GetBuildChild(bvh, node.firstIndex);
+	outChildren[1] = GetBuildChild(bvh, node.firstIndex + 1);
+	int childCount = 2;
+
+	//The largest children are the ones most rays hit, so they're the ones worth skipping a level for
+	while(childCount < WIDTH)
+	{
+		int largest = -1;
+		float largestArea = -1.0f;
+
+		for(int i = 0; i < childCount; ++i)
+		{
+			if(outChildren[i].binaryNode == -1)
+				continue;
+
+			float area = GetHalfArea(outChildren[i].bounds);
+			if(area > largestArea)
+			{
+				largest = i;
+				largestArea = area;
+			}
+		}
+
+		if(largest == -1)
+			break;
+
+		const BVH::Node& opened = bvh.GetNodes()[outChildren[largest].binaryNode];
+
+		outChildren[largest] = GetBuildChild(bvh, opened.firstIndex);
+		outChildren[childCount++] = GetBuildChild(bvh, opened.firstIndex + 1);
+	}
+
+	return childCount;
+}
+
+template<int WIDTH>
+void WideBVH<WIDTH>::Quantize(const BuildChild* children, int childCount, Node& node)
+{
+	BVH::AABB nodeBounds;
+	for(int i = 0; i < childCount; ++i)
+		nodeBounds.Grow(children[i].bounds);
+
+	node.origin = nodeBounds.min;
+
+	std::memset(node.quantizedMin, 0, sizeof(node.quantizedMin));
+	std::memset(node.quantizedMax, 0, sizeof(node.quantizedMax));
+
+	float* scale = &node.scale.x;
+
+	for(int axis = 0; axis < 3; ++axis)
+	{
+		float origin = GetAxis(nodeBounds.min, axis);
+
+		//Smallest power of two that spans the node in QUANTIZED_MAX steps, unless rounding says otherwise
+		int exponent;
+		std::frexp((GetAxis(nodeBounds.max, axis) - origin) / static_cast<float>(QUANTIZED_MAX), &exponent);
+
+		bool fits;
+		do
+		{
+			scale[axis] = std::ldexp(1.0f, exponent++);
+
+			fits = true;
+			for(int i = 0; i < childCount && fits; ++i)
+			{
+				node.quantizedMin[axis][i] = QuantizeMin(GetAxis(children[i].bounds.min, axis), origin, scale[axis]);
+				fits = QuantizeMax(GetAxis(children[i].bounds.max, axis), origin, scale[axis], node.quantizedMax[axis][i]);
+			}
+		} while(!fits);
+	}
+}
+
+template class WideBVH<4>;
+template class WideBVH<8>;
@@ -0,0 +1,279 @@
+#ifndef WideBVH_h__
+#define WideBVH_h__
+
+#include <DXLib/DXMath.h>
+#include <DirectXPackedVector.h>
+
+#include <vector>
+#include <cstdint>
+
+#include "BVH.h"
+#include "RayIntersection.h"
+
+//BVH with WIDTH children per node and the children's bounds quantized to 8 bits, built by collapsing a binary BVH.
+//
+//A binary BVH stores a full float box and an index for every node, which adds up to about as much memory as the
+//triangles it's built over for dense meshes. Here each node stores its children's bounds relative to its own box,
+//one byte per plane, and a single index each for its interior children and its leaves' primitives, since both
+//are stored contiguously. That's less than half of the binary BVH's node memory, and the children are laid out
+//so RayAABBIntersection4 tests four of them at once.
+//
+//Dequantized bounds are always rounded outwards, so they may be slightly larger than the binary BVH's, never smaller
+template<int WIDTH>
+class WideBVH
+{
+	static_assert(WIDTH == 4 || WIDTH == 8, "WIDTH has to be 4 or 8");
+
+public:
+	//What a child is, see Node::meta. Anything else is the number of primitives in a leaf
+	static const uint8_t EMPTY_CHILD = 0;
+	static const uint8_t INTERIOR_CHILD = 255;
+	static const int MAX_LEAF_SIZE = 254;
+
+	//60 bytes for WIDTH 4, 88 bytes for WIDTH 8
+	struct Node
+	{
+		//Child bounds are origin + quantized * scale
+		DirectX::XMFLOAT3 origin;
+		//Powers of two, so quantized * scale is exact
+		DirectX::XMFLOAT3 scale;
+		//Interior children are stored contiguously from here, in the same order as in meta
+		uint32_t firstChild;
+		//Leaf children's primitives are stored contiguously in primitiveIndices from here, in the same order as in meta
+		uint32_t firstPrimitive;
+		//[axis][child], so four children are loaded at once. Every group of four starts 4 byte aligned
+		uint8_t quantizedMin[3][WIDTH];
+		uint8_t quantizedMax[3][WIDTH];
+		//EMPTY_CHILD, INTERIOR_CHILD or the number of primitives in the leaf. Empty children are always last
+		uint8_t meta[WIDTH];
+	};
+
+	WideBVH();
+	~WideBVH() = default;
+
+	WideBVH(WideBVH&& other) = default;
+	WideBVH& operator=(WideBVH&& other) = default;
+
+	//************************************
+	// Method:		Build
+	// FullName:	WideBVH<WIDTH>::Build
+	// Access:		public
+	// Returns:		void
+	// Qualifier:
+	// Argument:	const BVH& bvh - primitive indices are the same as the ones bvh was built with. bvh can be cleared afterwards
+	// Description:	Replaces any previously built hierarchy. Each node takes the WIDTH largest nodes in the
+	//				binary subtree below it as children
+	//************************************
+	void Build(const BVH& bvh);
+	void Clear();
+
+	//Same as BVH::Intersect
+	template<typename IntersectFunction>
+	bool Intersect(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float& maxDistance, IntersectFunction intersectPrimitive) const;
+	//Same as BVH::IntersectAny
+	template<typename IntersectFunction>
+	bool IntersectAny(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float maxDistance, IntersectFunction intersectPrimitive) const;
+
+	bool IsEmpty() const;
+	int GetNodeCount() const;
+	int GetDepth() const;
+	//Bytes used by nodes and primitive indices
+	size_t GetMemoryUsage() const;
+
+private:
+	//Deeper than a binary BVH can get, plus the levels leaves with more than MAX_LEAF_SIZE primitives are split into
+	static const int MAX_DEPTH = 80;
+
+	//A node of the binary BVH, or some of a binary leaf's primitives
+	struct BuildChild
+	{
+		BVH::AABB bounds;
+		//-1 for primitives
+		int binaryNode;
+		//Into the binary BVH's primitive indices
+		int firstPrimitive;
+		int primitiveCount;
+	};
+
+	//Leaves are pushed as primitive ranges so they're visited in order with the rest
+	struct StackEntry
+	{
+		//Node, or first primitive in primitiveIndices for leaves
+		uint32_t index;
+		//0 for nodes
+		int primitiveCount;
+		float distance;
+	};
+
+	std::vector<Node> nodes;
+	std::vector<int> primitiveIndices;
+
+	//Of the root, which isn't stored in any node
+	BVH::AABB bounds;
+	int depth;
+
+	//************************************
+	// Method:		BuildNode
+	// FullName:	WideBVH<WIDTH>::BuildNode
+	// Access:		private
+	// Returns:		void
+	// Qualifier:
+	// Argument:	const BVH& bvh
+	// Argument:	int nodeIndex - already allocated
+	// Argument:	const BuildChild& parent - binary node or primitives the node replaces
+	// Argument:	int currentDepth
+	//************************************
+	void BuildNode(const BVH& bvh, int nodeIndex, const BuildChild& parent, int currentDepth);
+	static BuildChild GetBuildChild(const BVH& bvh, int binaryNode);
+	//Opens the largest interior children until there are WIDTH of them
+	static int GetChildren(const BVH& bvh, const BuildChild& parent, BuildChild (&outChildren)[WIDTH]);
+	//Finds origin and scale so every child's bounds fit and quantizes them. Unused children are left empty
+	static void Quantize(const BuildChild* children, int childCount, Node& node);
+
+	template<bool ANY_HIT, typename IntersectFunction>
+	bool Traverse(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float& maxDistance, IntersectFunction& intersectPrimitive) const;
+};
+
+template<int WIDTH>
+template<typename IntersectFunction>
+bool WideBVH<WIDTH>::Intersect(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float& maxDistance, IntersectFunction intersectPrimitive) const
+{
+	return Traverse<false>(rayPosition, rayDirection, maxDistance, intersectPrimitive);
+}
+
+template<int WIDTH>
+template<typename IntersectFunction>
+bool WideBVH<WIDTH>::IntersectAny(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float maxDistance, IntersectFunction intersectPrimitive) const
+{
+	return Traverse<true>(rayPosition, rayDirection, maxDistance, intersectPrimitive);
+}
+
+template<int WIDTH>
+template<bool ANY_HIT, typename IntersectFunction>
+bool WideBVH<WIDTH>::Traverse(const DirectX::XMFLOAT3& rayPosition, const DirectX::XMFLOAT3& rayDirection, float& maxDistance, IntersectFunction& intersectPrimitive) const
+{
+	if(nodes.empty())
+		return false;
+
+	DirectX::XMFLOAT3 inverseDirection(1.0f / rayDirection.x, 1.0f / rayDirection.y, 1.0f / rayDirection.z);
+
+	float distance;
+	if(!RayAABBIntersection(rayPosition, inverseDirection, bounds.min, bounds.max, maxDistance, distance))
+		return false;
+
+	const DirectX::XMVECTOR rayPositions[3] = { DirectX::XMVectorReplicate(rayPosition.x), DirectX::XMVectorReplicate(rayPosition.y), DirectX::XMVectorReplicate(rayPosition.z) };
+	const DirectX::XMVECTOR inverseDirections[3] = { DirectX::XMVectorReplicate(inverseDirection.x), DirectX::XMVectorReplicate(inverseDirection.y), DirectX::XMVectorReplicate(inverseDirection.z) };
+
+	bool hit = false;
+
+	//Every node pushes all but one of its children
+	StackEntry stack[MAX_DEPTH * (WIDTH - 1) + 1];
+	int stackSize = 0;
+
+	StackEntry current = { 0, 0, distance };
+	while(true)
+	{
+		if(current.primitiveCount > 0)
+		{
+			for(uint32_t i = current.index, end = current.index + current.primitiveCount; i < end; ++i)
+			{
+				if(intersectPrimitive(primitiveIndices[i], maxDistance))
+				{
+					if(ANY_HIT)
+						return true;
+
+					hit = true;
+				}
+			}
+		}
+		else
+		{
+			const Node& node = nodes[current.index];
+
+			const DirectX::XMVECTOR origin[3] = { DirectX::XMVectorReplicate(node.origin.x), DirectX::XMVectorReplicate(node.origin.y), DirectX::XMVectorReplicate(node.origin.z) };
+			const DirectX::XMVECTOR scale[3] = { DirectX::XMVectorReplicate(node.scale.x), DirectX::XMVectorReplicate(node.scale.y), DirectX::XMVectorReplicate(node.scale.z) };
+
+			StackEntry hitChildren[WIDTH];
+			int hitCount = 0;
+
+			uint32_t childIndex = node.firstChild;
+			uint32_t primitiveIndex = node.firstPrimitive;
+
+			for(int group = 0; group < WIDTH && node.meta[group] != EMPTY_CHILD; group += 4)
+			{
+				DirectX::XMVECTOR childMin[3];
+				DirectX::XMVECTOR childMax[3];
+
+				for(int axis = 0; axis < 3; ++axis)
+				{
+					childMin[axis] = DirectX::XMVectorMultiplyAdd(DirectX::PackedVector::XMLoadUByte4(reinterpret_cast<const DirectX::PackedVector::XMUBYTE4*>(&node.quantizedMin[axis][group])), scale[axis], origin[axis]);
+					childMax[axis] = DirectX::XMVectorMultiplyAdd(DirectX::PackedVector::XMLoadUByte4(reinterpret_cast<const DirectX::PackedVector::XMUBYTE4*>(&node.quantizedMax[axis][group])), scale[axis], origin[axis]);
+				}
+
+				DirectX::XMFLOAT4 groupDistances;
+				int hitMask = RayAABBIntersection4(rayPositions, inverseDirections, childMin, childMax, maxDistance, groupDistances);
+
+				for(int i = 0; i < 4; ++i)
+				{
+					uint8_t meta = node.meta[group + i];
+					if(meta == EMPTY_CHILD)
+						break;
+
+					StackEntry child;
+					child.distance = (&groupDistances.x)[i];
+
+					if(meta == INTERIOR_CHILD)
+					{
+						child.index = childIndex++;
+						child.primitiveCount = 0;
+					}
+					else
+					{
+						child.index = primitiveIndex;
+						child.primitiveCount = meta;
+
+						primitiveIndex += meta;
+					}
+
+					if(hitMask & (1 << i))
+						hitChildren[hitCount++] = child;
+				}
+			}
+
+			if(hitCount > 0)
+			{
+				//Closest first. Order doesn't matter when any hit will do
+				if(!ANY_HIT)
+				{
+					for(int i = 1; i < hitCount; ++i)
+					{
+						StackEntry child = hitChildren[i];
+
+						int j = i;
+						for(; j > 0 && hitChildren[j - 1].distance > child.distance; --j)
+							hitChildren[j] = hitChildren[j - 1];
+
+						hitChildren[j] = child;
+					}
+				}
+
+				for(int i = hitCount - 1; i > 0; --i)
+					stack[stackSize++] = hitChildren[i];
+
+				current = hitChildren[0];
+				continue;
+			}
+		}
+
+		//The closest hit might have moved in front of children that were pushed earlier
+		do
+		{
+			if(stackSize == 0)
+				return hit;
+
+			current = stack[--stackSize];
+		} while(current.distance > maxDistance);
+	}
+}
+
+#endif // WideBVH_h__
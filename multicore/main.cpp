@@ -21,8 +21,15 @@ int CALLBACK WinMain(
 	int argc = 0;
 	LPWSTR* argv = CommandLineToArgvW(cmdLineWString.c_str(), &argc);
 
+	//multicore.exe [monitor] [scene]
+	if(argc >= 2)
+	{
+		std::wstring scenePath(argv[1]);
+		window.SetScenePath(std::string(scenePath.begin(), scenePath.end()));
+	}
+
 	int targetMonitor = 0;
-	if(argc == 1)
+	if(argc >= 1)
 	{
 		targetMonitor = _wtoi(argv[0]);
 		window.CreateDXWindow(hInstance, nCmdShow, targetMonitor);